@@ -25,6 +25,11 @@
 #define WRITE_IMG_OUTPUT        1
 #define EVALUATE_OUTPUT         1
 #define GLOBAL_VERBOSITY        3
+#define PROCESS_SOLVER_BENCHMARK 0
+#define STEREO_PYRAMID_LEVELS   0
+#define STEREO_PYRAMID_WIN_RAD  4
+#define STEREO_UNARY_REUSE_DIFF 0
+#define STEREO_REINIT_DIFF      0
 ////////////////////////////////
 #define DATASET_VAPTRIMOD       0
 #define DATASET_LITIV2014       0
@@ -435,6 +440,10 @@ void Analyze(std::string sWorkerName, lv::IDataHandlerPtr pBatch) {
     #if !DATASET_EVAL_APPROX_MASKS_ONLY && !DATASET_EVAL_OUTPUT_ONLY
         std::shared_ptr<SegmMatcher> pAlgo = std::make_shared<SegmMatcher>(nMinDisp,nMaxDisp);
         pAlgo->m_pDisplayHelper = pDisplayHelper;
+    #if STEREO_PYRAMID_LEVELS>0
+        pAlgo->setCoarseToFineStereo(STEREO_PYRAMID_LEVELS,STEREO_PYRAMID_WIN_RAD);
+    #endif //STEREO_PYRAMID_LEVELS>0
+        pAlgo->setStereoTemporalUpdates(STEREO_UNARY_REUSE_DIFF,STEREO_REINIT_DIFF);
         pAlgo->initialize(std::array<cv::Mat,2>{vROIs[0],vROIs[2]});
         oBatch.setFeaturesDirName(pAlgo->getFeatureExtractorName());
     #if WRITE_IMG_OUTPUT
@@ -661,7 +670,14 @@ void Analyze(std::string sWorkerName, lv::IDataHandlerPtr pBatch) {
                 //oBatch.saveFeatures(nCurrIdx,oNewFeatsPacket);
                 pAlgo->setNextFeatures(oNewFeatsPacket);
             }
+        #if PROCESS_SOLVER_BENCHMARK
+            // replays inference w/ every available solver pair on the same frame; energy vs time curves are logged
+            SegmMatcher::MatArrayOut aCurrOutput;
+            pAlgo->benchmarkSolvers(lv::convertVectorToArray<nExpectedAlgoInputCount>(vCurrInput),aCurrOutput);
+            std::copy(aCurrOutput.begin(),aCurrOutput.end(),vCurrOutput.begin());
+        #else //!PROCESS_SOLVER_BENCHMARK
             pAlgo->apply(vCurrInput,vCurrOutput/*,dDefaultThreshold*/);
+        #endif //!PROCESS_SOLVER_BENCHMARK
         #endif //!(DATASET_EVAL_APPROX_MASKS_ONLY || DATASET_EVAL_OUTPUT_ONLY)
             lvDbgAssert(vCurrOutput.size()==nExpectedAlgoOutputCount);
             using OutputLabelType = SegmMatcher::LabelType;
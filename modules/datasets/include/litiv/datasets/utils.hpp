@@ -454,24 +454,57 @@ namespace lv {
 
     /// general-purpose data packet precacher, fully implemented (i.e. can be used stand-alone)
     struct DataPrecacher {
-        /// attaches to data loader (will halt auto-precaching if an empty packet is fetched)
-        DataPrecacher(std::function<cv::Mat(size_t)> lDataLoaderCallback);
+        /// precaching statistics (reset every time precaching is started)
+        struct Stats {
+            size_t nRequests = 0; ///< number of packet requests received while precaching
+            size_t nHits = 0; ///< number of requests answered with an already-cached packet
+            size_t nStalls = 0; ///< number of requests which had to wait for a packet still being loaded (readahead mode only)
+            size_t nMisses = 0; ///< number of requests which had to be loaded on demand (out-of-order requests, or precacher falling behind)
+            double dTotStallTime = 0.0; ///< total time (in seconds) spent waiting on stalled requests (readahead mode only)
+            /// returns the ratio of requests answered with an already-cached packet
+            inline double getHitRate() const {return nRequests?double(nHits)/nRequests:0.0;}
+        };
+        /// attaches to data loader (the optional packet count bounds readahead; empty packets are otherwise treated as regular packets in that mode)
+        DataPrecacher(std::function<cv::Mat(size_t)> lDataLoaderCallback, std::function<size_t()> lPacketCountCallback=nullptr);
+        /// attaches to an in-place data loader which fills the given pool-allocated matrix (readahead packets are never copied, and buffers go back to the pool once released everywhere)
+        DataPrecacher(std::function<void(size_t,cv::Mat&)> lInplaceDataLoaderCallback, PooledMatAllocatorPtr pAllocator, std::function<size_t()> lPacketCountCallback=nullptr);
         /// default destructor (joins the precaching thread, if still running)
         ~DataPrecacher();
         /// fetches a packet, with or without precaching enabled (should never be called concurrently, returned packets should never be altered directly, and a single packet loaded twice is assumed identical)
         const cv::Mat& getPacket(size_t nIdx);
-        /// initializes precaching with a given buffer size (starts up thread)
-        bool startAsyncPrecaching(size_t nSuggestedBufferSize);
-        /// joins precaching thread and clears all internal buffers
+        /// initializes precaching with a given buffer size (starts up thread; the size is capped, but never raised); with more than one worker, the callback must be reentrant
+        bool startAsyncPrecaching(size_t nSuggestedBufferSize, size_t nWorkers=1, size_t nReadaheadDepth=0);
+        /// joins precaching thread(s) and clears all internal buffers
         void stopAsyncPrecaching();
         /// returns whether the precaching thread has already been started or not
         inline bool isActive() const {return m_bIsActive;}
         /// returns the last requested packet index (i.e. the index to data still being held)
         inline size_t getLastReqIdx() const {return m_nLastReqIdx;}
+        /// returns a copy of the current precaching statistics
+        Stats getStats();
+        /// returns the buffer pool used for in-place packet loading (null if using a regular data loader)
+        inline const PooledMatAllocatorPtr& getAllocator() const {return m_pAllocator;}
     private:
+        /// readahead window slot, holds a packet being loaded or ready to be fetched
+        struct ReadaheadSlot {
+            size_t nIdx = SIZE_MAX; ///< index of the packet held in this slot (SIZE_MAX if empty)
+            bool bReady = false; ///< defines whether the packet has been fully loaded or not
+            cv::Mat oPacket; ///< loaded packet data
+        };
         void entry(const size_t nBufferSize);
+        void entry_readahead(const size_t nBufferSize);
+        const cv::Mat& getPacket_readahead(size_t nIdx);
+        cv::Mat loadPacket(size_t nIdx);
         const std::function<cv::Mat(size_t)> m_lCallback;
+        const std::function<void(size_t,cv::Mat&)> m_lInplaceCallback;
+        const std::function<size_t()> m_lPacketCountCallback;
+        const PooledMatAllocatorPtr m_pAllocator;
         std::thread m_hWorker;
+        std::vector<std::thread> m_vhReadaheadWorkers;
+        std::vector<ReadaheadSlot> m_vReadaheadSlots;
+        size_t m_nReadaheadBeginIdx,m_nReadaheadNextIdx,m_nReadaheadEndIdx;
+        size_t m_nReadaheadGeneration,m_nReadaheadCachedSize;
+        Stats m_oStats;
         std::exception_ptr m_pWorkerException;
         std::mutex m_oSyncMutex;
         std::condition_variable m_oReqCondVar;
@@ -522,21 +555,35 @@ namespace lv {
         virtual bool isGTInfoConst() const = 0;
         /// returns whether this work batch is currently precaching data
         virtual bool isPrecaching() const override;
+        /// sets the number of packet loading threads and readahead depth used by precachers started afterwards (packet loading must be reentrant if nWorkers>1)
+        void setPrecachingWorkers(size_t nWorkers, size_t nReadaheadDepth=0);
+        /// returns a copy of the input packet precacher statistics
+        DataPrecacher::Stats getInputPrecachingStats();
+        /// sets the archive type used to save/load features packets (each type uses its own file extension, so caches of other types are ignored)
+        void setFeaturesArchiveType(MatArchiveList eArchiveType);
+        /// returns the archive type used to save/load features packets (defaults to lz4 blocks when available, and to raw binary otherwise)
+        inline MatArchiveList getFeaturesArchiveType() const {return m_eFeaturesArchiveType;}
     protected:
         /// types serve to automatically transform packets & define default implementations
         IIDataLoader(PacketPolicy eInputType, PacketPolicy eGTType, PacketPolicy eOutputType, MappingPolicy eGTMappingType, MappingPolicy eIOMappingType);
         /// features packet load function (can return empty mat)
         virtual cv::Mat loadRawFeatures(size_t nPacketIdx);
-        /// input packet transformation function (used e.g. for rescaling and color space conversion on images)
-        virtual cv::Mat getInput_redirect(size_t nPacketIdx);
-        /// gt packet transformation function (used e.g. for rescaling and color space conversion on images)
-        virtual cv::Mat getGT_redirect(size_t nPacketIdx);
+        /// input packet transformation function (used e.g. for rescaling and color space conversion on images; writes into the given pool-allocated packet when possible)
+        virtual void getInput_redirect(size_t nPacketIdx, cv::Mat& oPacket);
+        /// gt packet transformation function (used e.g. for rescaling and color space conversion on images; writes into the given pool-allocated packet when possible)
+        virtual void getGT_redirect(size_t nPacketIdx, cv::Mat& oPacket);
     private:
         /// required friend for access to precachers
         template<ArrayPolicy ePolicy>
         friend struct IDataLoader_;
         /// precacher objects which may spin up a thread to pre-fetch data packets
         DataPrecacher m_oInputPrecacher,m_oGTPrecacher,m_oFeaturesPrecacher;
+        /// number of packet loading threads and readahead depth used by precachers
+        size_t m_nPrecacheWorkers,m_nPrecacheReadaheadDepth;
+        /// archive type used to save/load features packets
+        MatArchiveList m_eFeaturesArchiveType;
+        /// returns the full path (with archive-specific extension) of a features packet
+        std::string getFeaturesFilePath(size_t nPacketIdx) const;
         /// input/gt/output packet policy types
         const PacketPolicy m_eInputType,m_eGTType,m_eOutputType;
         /// output-gt and input-output mapping policy types
@@ -782,7 +829,7 @@ namespace lv {
         ~DataWriter();
         /// returns whether the given packet could be added to the queue (true), or it would be dropped (false)
         bool queue_check(const cv::Mat& oPacket, size_t nIdx);
-        /// queues a packet, with or without async writing enabled, and returns its position in queue
+        /// queues a packet, with or without async writing enabled, and returns its position in queue (can be called concurrently; pending packets are written in idx order, and re-queuing an idx replaces its pending packet)
         size_t queue(const cv::Mat& oPacket, size_t nIdx);
         /// returns the current queue size, in packets
         inline size_t getCurrentQueueCount() const {return m_nQueueCount;}
@@ -797,14 +844,42 @@ namespace lv {
         /// returns whether the wariting thread has already been started or not
         inline bool isActive() const {return m_bIsActive;}
     private:
+        /// ring buffer slot, holds a queued packet along with its sequence number (based on D. Vyukov's bounded MPMC queue)
+        struct QueueSlot {
+            std::atomic_size_t nSeq; ///< slot sequence number, used to determine whether it can be filled or emptied
+            size_t nIdx; ///< index of the queued packet
+            cv::Mat oPacket; ///< local copy of the queued packet
+        };
         void entry();
+        /// queues a packet for the writing threads (the caller must be counted as an active producer)
+        size_t queue_async(const cv::Mat& oPacket, size_t nIdx);
+        /// reserves space for a packet and pushes it in the ring buffer (returns false if the queue is full)
+        bool tryPush(const cv::Mat& oPacket, size_t nIdx, size_t& nPacketPosition);
+        /// pops the oldest packet from the ring buffer (returns false if the queue is empty)
+        bool tryPop(cv::Mat& oPacket, size_t& nIdx);
+        /// replaces the pending packet with the same idx, if any, and if the queue budget allows it (sync mutex must be held)
+        bool tryReplace(const cv::Mat& oPacket, size_t nIdx, size_t& nPacketPosition);
+        /// moves all packets pushed so far from the ring buffer to the idx-sorted pending queue (waits on packets still being pushed)
+        void fetchQueuedPackets(lv::mutex_unique_lock& sync_lock);
+        /// returns the pending queue entry with the given idx, or the end of the pending queue if there is none (sync mutex must be held)
+        std::vector<std::pair<size_t,cv::Mat>>::iterator findPendingPacket(size_t nIdx);
+        /// pops the pending packet with the lowest idx (returns false if the pending queue is empty; sync mutex must be held)
+        bool popPendingPacket(cv::Mat& oPacket, size_t& nIdx);
+        /// returns whether the packet at the head of the ring buffer has been fully pushed
+        bool isNextSlotReady() const;
+        /// writes a popped packet via the callback, releases its space, and wakes up blocked producers
+        void commit(cv::Mat& oPacket, size_t nIdx);
         const std::function<size_t(const cv::Mat&,size_t)> m_lCallback;
         std::vector<std::thread> m_vhWorkers;
         std::stack<std::pair<std::exception_ptr,size_t>> m_vWorkerExceptions;
         std::mutex m_oSyncMutex;
         std::condition_variable m_oQueueCondVar;
         std::condition_variable m_oClearCondVar;
-        std::map<size_t,cv::Mat> m_mQueue;
+        std::unique_ptr<QueueSlot[]> m_aQueueSlots;
+        std::vector<std::pair<size_t,cv::Mat>> m_vPendingQueue; ///< idx-sorted pending packets (the entries before m_nPendingQueueHead were already popped)
+        size_t m_nPendingQueueHead;
+        std::atomic_size_t m_nEnqueuePos,m_nDequeuePos;
+        std::atomic_size_t m_nSleepingWorkers,m_nWaitingProducers,m_nActiveProducers;
         std::atomic_bool m_bIsActive;
         bool m_bAllowPacketDrop;
         size_t m_nQueueMaxSize;
@@ -996,8 +1071,24 @@ namespace lv {
 
 #endif //HAVE_GLSL
 
+    /// work batch processing report filled by DatasetHandler::processBatches (one per work batch)
+    struct BatchProcessReport {
+        std::string sBatchName; ///< name of the processed work batch
+        size_t nExpectedLoadSize = 0; ///< expected input data load size (in bytes) used for scheduling
+        size_t nPrecacheBufferSize = 0; ///< precaching buffer size (in bytes) allotted to the batch (0 if not precaching)
+        size_t nOutputCount = 0; ///< output packet count processed by the batch
+        double dWallTime = 0.0; ///< wall time (in seconds) taken to process the batch (including algo creation)
+        double dThroughput = 0.0; ///< processing throughput (in output packets per second)
+        std::exception_ptr pException; ///< exception thrown while processing the batch, if any
+    };
+
     /// full implementation of basic dataset handler interface functions
     struct DatasetHandler : public virtual IDataHandler {
+        /// batch processing function type used by processBatches (processes all packets of the given work batch)
+        using BatchProcessFunc = std::function<void(const IDataHandlerPtr&)>;
+        /// processes all work batches through 'lBatchFunc(batch,lAlgoFactory())' using 'nWorkers' threads (see processBatches_impl for more info)
+        template<typename TAlgoFactory, typename TBatchFunc>
+        std::vector<BatchProcessReport> processBatches(TAlgoFactory&& lAlgoFactory, TBatchFunc&& lBatchFunc, size_t nWorkers=0, bool bPrecache=true, bool bPrecacheInputOnly=true, size_t nTotCacheSize=SIZE_MAX);
         /// returns the dataset name
         virtual const std::string& getName() const override final;
         /// returns the dataset data path (always slash-terminated)
@@ -1029,6 +1120,8 @@ namespace lv {
         /// returns whether the pushed results will be evaluated or not
         virtual bool isEvaluating() const override final;
     protected:
+        /// dispatches work batches to 'nWorkers' threads (0 = all hardware threads) largest expected load first, sharing at most 'nTotCacheSize' bytes of precaching buffers (SIZE_MAX = CACHE_MAX_SIZE_MB) between concurrent batches
+        std::vector<BatchProcessReport> processBatches_impl(const BatchProcessFunc& lBatchFunc, size_t nWorkers, bool bPrecache, bool bPrecacheInputOnly, size_t nTotCacheSize);
         /// full dataset handler constructor; parameters are passed through lv::datasets::create<...>(...), and may be caught/simplified by a specialization
         DatasetHandler(
             const std::string& sDatasetName, ///< user-friendly dataset name (used for identification only)
@@ -1064,6 +1157,14 @@ namespace lv {
 
 } // namespace lv
 
+template<typename TAlgoFactory, typename TBatchFunc>
+std::vector<lv::BatchProcessReport> lv::DatasetHandler::processBatches(TAlgoFactory&& lAlgoFactory, TBatchFunc&& lBatchFunc, size_t nWorkers, bool bPrecache, bool bPrecacheInputOnly, size_t nTotCacheSize) {
+    // each batch gets its own algorithm instance, created by the worker thread that processes it
+    return processBatches_impl([&](const IDataHandlerPtr& pBatch) {
+        lBatchFunc(pBatch,lAlgoFactory());
+    },nWorkers,bPrecache,bPrecacheInputOnly,nTotCacheSize);
+}
+
 #if HAVE_GLSL
 
 template<lv::DatasetEvalList eDatasetEval>
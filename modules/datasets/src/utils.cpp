@@ -28,6 +28,7 @@
 #endif //(!(defined(...arch...)) && CACHE_MAX_SIZE_MB>2048)
 #define CACHE_MAX_SIZE size_t(((CACHE_MAX_SIZE_MB)*1024)*1024)
 #define CACHE_MIN_SIZE size_t(((10u)*1024)*1024) // 10mb
+#define WRITER_QUEUE_SLOT_COUNT            size_t(1024) // must be a power of two
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -299,12 +300,27 @@ void lv::DataGroupHandler::parseData() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-lv::DataPrecacher::DataPrecacher(std::function<cv::Mat(size_t)> lDataLoaderCallback) :
-        m_lCallback(lDataLoaderCallback) {
+lv::DataPrecacher::DataPrecacher(std::function<cv::Mat(size_t)> lDataLoaderCallback, std::function<size_t()> lPacketCountCallback) :
+        m_lCallback(lDataLoaderCallback),
+        m_lPacketCountCallback(lPacketCountCallback) {
     lvAssert_(m_lCallback,"invalid data precacher callback");
     m_bIsActive = m_bGotRequest = false;
     m_pWorkerException = nullptr;
     m_nAnswIdx = m_nReqIdx = m_nLastReqIdx = size_t(-1);
+    m_nReadaheadBeginIdx = m_nReadaheadNextIdx = m_nReadaheadGeneration = m_nReadaheadCachedSize = 0;
+    m_nReadaheadEndIdx = SIZE_MAX;
+}
+
+lv::DataPrecacher::DataPrecacher(std::function<void(size_t,cv::Mat&)> lInplaceDataLoaderCallback, PooledMatAllocatorPtr pAllocator, std::function<size_t()> lPacketCountCallback) :
+        m_lInplaceCallback(lInplaceDataLoaderCallback),
+        m_lPacketCountCallback(lPacketCountCallback),
+        m_pAllocator(pAllocator?pAllocator:lv::PooledMatAllocator::create()) {
+    lvAssert_(m_lInplaceCallback,"invalid data precacher callback");
+    m_bIsActive = m_bGotRequest = false;
+    m_pWorkerException = nullptr;
+    m_nAnswIdx = m_nReqIdx = m_nLastReqIdx = size_t(-1);
+    m_nReadaheadBeginIdx = m_nReadaheadNextIdx = m_nReadaheadGeneration = m_nReadaheadCachedSize = 0;
+    m_nReadaheadEndIdx = SIZE_MAX;
 }
 
 lv::DataPrecacher::~DataPrecacher() {
@@ -319,12 +335,15 @@ const cv::Mat& lv::DataPrecacher::getPacket(size_t nIdx) {
     }
     else if(!m_bIsActive) {
         lvLog_(4,"data precacher [%" PRIxPTR "] bypassing inactive precaching thread, fetching packet at idx = %zu...",uintptr_t(this),nIdx);
-        m_oLastReqPacket = m_lCallback(nIdx);
+        m_oLastReqPacket = loadPacket(nIdx);
         m_nLastReqIdx = nIdx;
         return m_oLastReqPacket;
     }
+    else if(!m_vhReadaheadWorkers.empty())
+        return getPacket_readahead(nIdx);
     lv::mutex_unique_lock sync_lock(m_oSyncMutex);
     lvAssert_(!m_bGotRequest,"data precacher trying two requests at once!");
+    ++m_oStats.nRequests;
     size_t nAnswIdx = size_t(-1);
     m_nReqIdx = nIdx;
     m_bGotRequest = true;
@@ -355,7 +374,88 @@ const cv::Mat& lv::DataPrecacher::getPacket(size_t nIdx) {
     return m_oLastReqPacket;
 }
 
-bool lv::DataPrecacher::startAsyncPrecaching(size_t nSuggestedBufferSize) {
+const cv::Mat& lv::DataPrecacher::getPacket_readahead(size_t nIdx) {
+    lv::mutex_unique_lock sync_lock(m_oSyncMutex);
+    ++m_oStats.nRequests;
+    if(nIdx>=m_nReadaheadEndIdx) {
+        // requests past the packet count are not precached, and not forwarded to the loader either (workers may still be
+        // using it, and most loaders are not reentrant) --- they would all return empty packets anyway
+        ++m_oStats.nMisses;
+        m_oLastReqPacket = cv::Mat();
+        m_nLastReqIdx = nIdx;
+        return m_oLastReqPacket;
+    }
+    const size_t nDepth = m_vReadaheadSlots.size();
+    const auto lReleaseSlot = [&](ReadaheadSlot& oSlot) {
+        if(oSlot.bReady)
+            m_nReadaheadCachedSize -= oSlot.oPacket.total()*oSlot.oPacket.elemSize();
+        oSlot = ReadaheadSlot();
+    };
+    bool bMissed = false;
+    if(nIdx<m_nReadaheadBeginIdx || nIdx>=m_nReadaheadBeginIdx+nDepth) {
+        lvLog_(3,"data precacher [%" PRIxPTR "] out-of-window request for packet at idx = %zu (expected = %zu), resetting readahead window",uintptr_t(this),nIdx,m_nReadaheadBeginIdx);
+        for(ReadaheadSlot& oSlot : m_vReadaheadSlots)
+            lReleaseSlot(oSlot);
+        ++m_nReadaheadGeneration; // packets currently being loaded for the old window will be dropped
+        m_nReadaheadBeginIdx = m_nReadaheadNextIdx = nIdx;
+        ++m_oStats.nMisses;
+        bMissed = true;
+    }
+    else {
+        if(nIdx>m_nReadaheadBeginIdx)
+            lvLog_(3,"data precacher [%" PRIxPTR "] skipping %zu packet(s) in readahead window",uintptr_t(this),nIdx-m_nReadaheadBeginIdx);
+        for(ReadaheadSlot& oSlot : m_vReadaheadSlots)
+            if(oSlot.nIdx!=SIZE_MAX && oSlot.nIdx<nIdx)
+                lReleaseSlot(oSlot);
+        m_nReadaheadBeginIdx = nIdx;
+        m_nReadaheadNextIdx = std::max(m_nReadaheadNextIdx,nIdx);
+    }
+    m_oReqCondVar.notify_all();
+    ReadaheadSlot& oSlot = m_vReadaheadSlots[nIdx%nDepth];
+    const auto lIsAnswered = [&](){return !m_bIsActive || m_pWorkerException || (oSlot.nIdx==nIdx && oSlot.bReady);};
+    if(!lIsAnswered()) {
+        if(!bMissed) {
+            lvLog_(4,"data precacher [%" PRIxPTR "] stalled on request for packet at idx = %zu",uintptr_t(this),nIdx);
+            ++m_oStats.nStalls;
+        }
+        lv::StopWatch oStallWatch;
+        m_oSyncCondVar.wait(sync_lock,lIsAnswered);
+        if(!bMissed)
+            m_oStats.dTotStallTime += oStallWatch.elapsed();
+    }
+    else if(!bMissed)
+        ++m_oStats.nHits;
+    if(m_pWorkerException) {
+        lvLog_(1,"data precacher [%" PRIxPTR "] caught precacher exception while requesting packet #%zu, will rethrow...",uintptr_t(this),nIdx);
+        sync_lock.unlock();
+        stopAsyncPrecaching();
+    }
+    else if(!m_bIsActive)
+        lvError_("could not fetch packet #%zu, data precacher [%" PRIxPTR "] shutting down",nIdx,uintptr_t(this));
+    m_oLastReqPacket = oSlot.oPacket;
+    m_nLastReqIdx = nIdx;
+    lReleaseSlot(oSlot);
+    m_nReadaheadBeginIdx = nIdx+1;
+    m_oReqCondVar.notify_all();
+    return m_oLastReqPacket;
+}
+
+cv::Mat lv::DataPrecacher::loadPacket(size_t nIdx) {
+    if(!m_lInplaceCallback)
+        return m_lCallback(nIdx);
+    // the packet buffer comes from the pool, and will be handed back to it once the last copy of the header is released
+    cv::Mat oPacket;
+    oPacket.allocator = m_pAllocator.get();
+    m_lInplaceCallback(nIdx,oPacket);
+    return oPacket;
+}
+
+lv::DataPrecacher::Stats lv::DataPrecacher::getStats() {
+    lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+    return m_oStats;
+}
+
+bool lv::DataPrecacher::startAsyncPrecaching(size_t nSuggestedBufferSize, size_t nWorkers, size_t nReadaheadDepth) {
     static_assert(PRECACHE_REQUEST_TIMEOUT_MS>0,"Precache request timeout must be a positive value");
     static_assert(PRECACHE_QUERY_TIMEOUT_MS>0,"Precache query timeout must be a positive value");
     static_assert(PRECACHE_QUERY_END_TIMEOUT_MS>0,"Precache query post-end timeout must be a positive value");
@@ -366,9 +466,25 @@ bool lv::DataPrecacher::startAsyncPrecaching(size_t nSuggestedBufferSize) {
         m_pWorkerException = nullptr;
         m_nAnswIdx = m_nReqIdx = size_t(-1);
         m_bGotRequest = false;
-        const size_t nBufferSize = std::max(std::min(nSuggestedBufferSize,CACHE_MAX_SIZE),CACHE_MIN_SIZE);
-        lvLog_(2,"data precacher [%" PRIxPTR "] precaching thread init w/ buffer size = %zu mb",uintptr_t(this),(nBufferSize/1024)/1024);
-        m_hWorker = std::thread(&DataPrecacher::entry,this,nBufferSize);
+        m_oStats = Stats();
+        // the buffer size is only ever capped; callers splitting a budget rely on never getting more than they asked for
+        const size_t nBufferSize = std::min(nSuggestedBufferSize,CACHE_MAX_SIZE);
+        if(nWorkers>1 || nReadaheadDepth>0) {
+            nWorkers = std::max(nWorkers,size_t(1));
+            nReadaheadDepth = std::max(nReadaheadDepth?nReadaheadDepth:nWorkers*4,nWorkers);
+            m_vReadaheadSlots = std::vector<ReadaheadSlot>(nReadaheadDepth);
+            m_nReadaheadBeginIdx = m_nReadaheadNextIdx = m_nReadaheadCachedSize = 0;
+            // empty packets do not mark the end of the stream here (gt can be sparse), so only a known count bounds the workers
+            m_nReadaheadEndIdx = m_lPacketCountCallback?m_lPacketCountCallback():SIZE_MAX;
+            ++m_nReadaheadGeneration;
+            lvLog_(2,"data precacher [%" PRIxPTR "] readahead threads init w/ buffer size = %zu mb, %zu worker(s), depth = %zu",uintptr_t(this),(nBufferSize/1024)/1024,nWorkers,nReadaheadDepth);
+            for(size_t nWorkerIdx=0; nWorkerIdx<nWorkers; ++nWorkerIdx)
+                m_vhReadaheadWorkers.emplace_back(&DataPrecacher::entry_readahead,this,nBufferSize);
+        }
+        else {
+            lvLog_(2,"data precacher [%" PRIxPTR "] precaching thread init w/ buffer size = %zu mb",uintptr_t(this),(nBufferSize/1024)/1024);
+            m_hWorker = std::thread(&DataPrecacher::entry,this,nBufferSize);
+        }
     }
     return m_bIsActive;
 }
@@ -377,8 +493,21 @@ void lv::DataPrecacher::stopAsyncPrecaching() {
     lvDbgExceptionWatch;
     if(m_bIsActive) {
         m_bIsActive = false;
-        lvLog_(2,"data precacher [%" PRIxPTR "] joining precaching thread",uintptr_t(this));
-        m_hWorker.join();
+        lvLog_(2,"data precacher [%" PRIxPTR "] joining precaching thread(s)",uintptr_t(this));
+        if(!m_vhReadaheadWorkers.empty()) {
+            {
+                lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+                m_oReqCondVar.notify_all();
+                m_oSyncCondVar.notify_all();
+            }
+            for(std::thread& oWorker : m_vhReadaheadWorkers)
+                oWorker.join();
+            m_vhReadaheadWorkers.clear();
+            m_vReadaheadSlots.clear();
+            m_nReadaheadCachedSize = 0;
+        }
+        else
+            m_hWorker.join();
         lvAssert_(!m_bGotRequest,"last request should have been answered");
     }
     if(m_pWorkerException)
@@ -402,7 +531,7 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
             cv::Mat oNextPacket;
             bool bAlreadyTested = false;
             if(nTargetPacketIdx!=nLastTargetPacketIdx) {
-                oLastTargetPacket = oNextPacket = m_lCallback(nTargetPacketIdx);
+                oLastTargetPacket = oNextPacket = loadPacket(nTargetPacketIdx);
                 nLastTargetPacketIdx = nTargetPacketIdx;
             }
             else {
@@ -474,6 +603,7 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
                         if(m_nReqIdx<nNextPrecacheIdx && m_nReqIdx>=nNextExpectedReqIdx) {
                             if(m_nReqIdx>nNextExpectedReqIdx)
                                 lvLog_(3,"data precacher [%" PRIxPTR "] popping %zu extra packet(s) from cache",uintptr_t(this),m_nReqIdx-nNextExpectedReqIdx);
+                            ++m_oStats.nHits;
                             while(m_nReqIdx-nNextExpectedReqIdx+1>0) {
                                 m_oReqPacket = lCache.front();
                                 m_nAnswIdx = m_nReqIdx;
@@ -484,8 +614,9 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
                         }
                         else {
                             lvLog_(3,"data precacher [%" PRIxPTR "] out-of-order request (expected = %zu), destroying cache",uintptr_t(this),nNextExpectedReqIdx);
+                            ++m_oStats.nMisses;
                             lCache = std::list<cv::Mat>();
-                            m_oReqPacket = m_lCallback(m_nReqIdx);
+                            m_oReqPacket = loadPacket(m_nReqIdx);
                             m_nAnswIdx = m_nReqIdx;
                             nFirstBufferIdx = nNextBufferIdx = size_t(-1);
                             nNextExpectedReqIdx = nNextPrecacheIdx = m_nReqIdx+1;
@@ -494,14 +625,17 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
                     }
                     else {
                         lvLog_(3,"data precacher [%" PRIxPTR "] answering request manually, precaching is falling behind",uintptr_t(this));
-                        m_oReqPacket = m_lCallback(m_nReqIdx);
+                        ++m_oStats.nMisses;
+                        m_oReqPacket = loadPacket(m_nReqIdx);
                         m_nAnswIdx = m_nReqIdx;
                         nFirstBufferIdx = nNextBufferIdx = size_t(-1);
                         nNextExpectedReqIdx = nNextPrecacheIdx = m_nReqIdx+1;
                     }
                 }
-                else
+                else {
                     lvLog_(3,"data precacher [%" PRIxPTR "] answering request using last packet at idx = %zu",uintptr_t(this),m_nReqIdx);
+                    ++m_oStats.nHits;
+                }
                 m_oSyncCondVar.notify_one();
             }
             else if(!bReachedEnd) {
@@ -529,6 +663,48 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
     }
 }
 
+void lv::DataPrecacher::entry_readahead(const size_t nBufferSize) {
+    try {
+        lvDbgExceptionWatch;
+        lv::mutex_unique_lock sync_lock(m_oSyncMutex);
+        const size_t nDepth = m_vReadaheadSlots.size();
+        const auto lCanLoadNextPacket = [&]() {
+            // the next packet required by the consumer is always loaded, even if the buffer is full
+            return m_nReadaheadNextIdx<m_nReadaheadEndIdx && m_nReadaheadNextIdx<m_nReadaheadBeginIdx+nDepth &&
+                   (m_nReadaheadCachedSize<nBufferSize || m_nReadaheadNextIdx==m_nReadaheadBeginIdx);
+        };
+        while(true) {
+            m_oReqCondVar.wait(sync_lock,[&](){return !m_bIsActive || m_pWorkerException || lCanLoadNextPacket();});
+            if(!m_bIsActive || m_pWorkerException)
+                break;
+            const size_t nPacketIdx = m_nReadaheadNextIdx++;
+            const size_t nGeneration = m_nReadaheadGeneration;
+            ReadaheadSlot& oSlot = m_vReadaheadSlots[nPacketIdx%nDepth];
+            lvDbgAssert(oSlot.nIdx==SIZE_MAX);
+            oSlot.nIdx = nPacketIdx;
+            cv::Mat oPacket;
+            {
+                lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock);
+                oPacket = loadPacket(nPacketIdx);
+            }
+            if(nGeneration!=m_nReadaheadGeneration || oSlot.nIdx!=nPacketIdx || oSlot.bReady)
+                continue; // window was reset or skipped while loading, packet is dropped
+            lvLog_(4,"data precacher [%" PRIxPTR "] cached packet at idx = %zu, with size = %zu kb",uintptr_t(this),nPacketIdx,(oPacket.total()*oPacket.elemSize())/1024);
+            oSlot.oPacket = oPacket;
+            oSlot.bReady = true;
+            m_nReadaheadCachedSize += oPacket.total()*oPacket.elemSize();
+            m_oSyncCondVar.notify_all();
+        }
+    }
+    catch(...) {
+        lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+        if(!m_pWorkerException)
+            m_pWorkerException = std::current_exception();
+        m_oSyncCondVar.notify_all();
+        m_oReqCondVar.notify_all();
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -537,11 +713,13 @@ void lv::IIDataLoader::startPrecaching(bool bPrecacheInputOnly, size_t nSuggeste
     lvDbgExceptionWatch;
     if(nSuggestedBufferSize==SIZE_MAX)
         nSuggestedBufferSize = getExpectedLoadSize();
-    lvLog_(3,"data loader [%" PRIxPTR "] for batch '%s' will start precaching w/ buffer size = %zu mb\n\tnote: precacher ids = %" PRIxPTR ", %" PRIxPTR ", %" PRIxPTR,uintptr_t(this),getName().c_str(),(nSuggestedBufferSize/1024)/1024,uintptr_t(&m_oInputPrecacher),uintptr_t(&m_oGTPrecacher),uintptr_t(&m_oFeaturesPrecacher));
-    lvAssert_(m_oInputPrecacher.startAsyncPrecaching(nSuggestedBufferSize),"could not start precaching input packets");
+    // the suggested size is the total for this loader, so it is split across all the precachers that get started
+    const size_t nPrecacherBufferSize = std::max(nSuggestedBufferSize/(bPrecacheInputOnly?1u:3u),size_t(1));
+    lvLog_(3,"data loader [%" PRIxPTR "] for batch '%s' will start precaching w/ buffer size = %zu mb per precacher\n\tnote: precacher ids = %" PRIxPTR ", %" PRIxPTR ", %" PRIxPTR,uintptr_t(this),getName().c_str(),(nPrecacherBufferSize/1024)/1024,uintptr_t(&m_oInputPrecacher),uintptr_t(&m_oGTPrecacher),uintptr_t(&m_oFeaturesPrecacher));
+    lvAssert_(m_oInputPrecacher.startAsyncPrecaching(nPrecacherBufferSize,m_nPrecacheWorkers,m_nPrecacheReadaheadDepth),"could not start precaching input packets");
     if(!bPrecacheInputOnly) {
-        lvAssert_(m_oGTPrecacher.startAsyncPrecaching(nSuggestedBufferSize),"could not start precaching gt packets");
-        lvAssert_(m_oFeaturesPrecacher.startAsyncPrecaching(nSuggestedBufferSize),"could not start precaching feature packets");
+        lvAssert_(m_oGTPrecacher.startAsyncPrecaching(nPrecacherBufferSize,m_nPrecacheWorkers,m_nPrecacheReadaheadDepth),"could not start precaching gt packets");
+        lvAssert_(m_oFeaturesPrecacher.startAsyncPrecaching(nPrecacherBufferSize,m_nPrecacheWorkers,m_nPrecacheReadaheadDepth),"could not start precaching feature packets");
     }
 }
 
@@ -570,9 +748,7 @@ void lv::IIDataLoader::saveFeatures(size_t nPacketIdx, const cv::Mat& oFeatures)
     lvDbgExceptionWatch;
     if(!oFeatures.empty()) {
         // could use a datawriter here for REALLY big features (but its unlikely that they can be produced faster than saved)
-        std::stringstream ssFeatsFilePath;
-        ssFeatsFilePath << getFeaturesPath() << getFeaturesName(nPacketIdx) << ".bin";
-        lv::write(ssFeatsFilePath.str(),oFeatures);
+        lv::write(getFeaturesFilePath(nPacketIdx),oFeatures,m_eFeaturesArchiveType);
     }
 }
 
@@ -588,25 +764,63 @@ bool lv::IIDataLoader::isPrecaching() const {
     return m_oInputPrecacher.isActive();
 }
 
+void lv::IIDataLoader::setPrecachingWorkers(size_t nWorkers, size_t nReadaheadDepth) {
+    lvAssert_(nWorkers>0,"precaching requires at least one worker");
+    m_nPrecacheWorkers = nWorkers;
+    m_nPrecacheReadaheadDepth = nReadaheadDepth;
+}
+
+lv::DataPrecacher::Stats lv::IIDataLoader::getInputPrecachingStats() {
+    return m_oInputPrecacher.getStats();
+}
+
+void lv::IIDataLoader::setFeaturesArchiveType(MatArchiveList eArchiveType) {
+    lvAssert_(!m_oFeaturesPrecacher.isActive(),"cannot change features archive type while precaching");
+    m_eFeaturesArchiveType = eArchiveType;
+}
+
+std::string lv::IIDataLoader::getFeaturesFilePath(size_t nPacketIdx) const {
+    // binary archives carry no type tag, so each type gets its own extension to keep old caches from being misread
+    std::stringstream ssFeatsFilePath;
+    ssFeatsFilePath << getFeaturesPath() << getFeaturesName(nPacketIdx);
+    switch(m_eFeaturesArchiveType) {
+        case MatArchive_FILESTORAGE: ssFeatsFilePath << ".yml"; break;
+        case MatArchive_PLAINTEXT: ssFeatsFilePath << ".txt"; break;
+        case MatArchive_BINARY: ssFeatsFilePath << ".bin"; break;
+#if USING_LZ4
+        case MatArchive_BINARY_LZ4: ssFeatsFilePath << ".lz4"; break;
+        case MatArchive_BINARY_LZ4_BLOCKS: ssFeatsFilePath << ".lz4b"; break;
+#endif //USING_LZ4
+        default: lvError("unexpected features archive type");
+    }
+    return ssFeatsFilePath.str();
+}
+
 lv::IIDataLoader::IIDataLoader(PacketPolicy eInputType, PacketPolicy eGTType, PacketPolicy eOutputType, MappingPolicy eGTMappingType, MappingPolicy eIOMappingType) :
-        m_oInputPrecacher(std::bind(&IIDataLoader::getInput_redirect,this,std::placeholders::_1)),
-        m_oGTPrecacher(std::bind(&IIDataLoader::getGT_redirect,this,std::placeholders::_1)),
-        m_oFeaturesPrecacher(std::bind(&IIDataLoader::loadRawFeatures,this,std::placeholders::_1)),
+        // gt and feature packets share the input packet indexing (gt may be sparse), so all precachers are bounded by the input count
+        m_oInputPrecacher(std::bind(&IIDataLoader::getInput_redirect,this,std::placeholders::_1,std::placeholders::_2),nullptr,std::bind(&IIDataLoader::getInputCount,this)),
+        m_oGTPrecacher(std::bind(&IIDataLoader::getGT_redirect,this,std::placeholders::_1,std::placeholders::_2),nullptr,std::bind(&IIDataLoader::getInputCount,this)),
+        m_oFeaturesPrecacher(std::bind(&IIDataLoader::loadRawFeatures,this,std::placeholders::_1),std::bind(&IIDataLoader::getInputCount,this)),
+        m_nPrecacheWorkers(1),m_nPrecacheReadaheadDepth(0),
+#if USING_LZ4
+        m_eFeaturesArchiveType(MatArchive_BINARY_LZ4_BLOCKS),
+#else //!USING_LZ4
+        m_eFeaturesArchiveType(MatArchive_BINARY),
+#endif //!USING_LZ4
         m_eInputType(eInputType),m_eGTType(eGTType),m_eOutputType(eOutputType),m_eGTMappingType(eGTMappingType),m_eIOMappingType(eIOMappingType) {}
 
 cv::Mat lv::IIDataLoader::loadRawFeatures(size_t nPacketIdx) {
     lvDbgExceptionWatch;
-    std::stringstream ssFeatsFilePath;
-    ssFeatsFilePath << getFeaturesPath() << getFeaturesName(nPacketIdx) << ".bin";
+    const std::string sFeatsFilePath = getFeaturesFilePath(nPacketIdx);
     // all features are user-defined, so we keep no mapping information, and offer no default transformations
-    if(lv::checkIfExists(ssFeatsFilePath.str()))
-        return lv::read(ssFeatsFilePath.str());
+    if(lv::checkIfExists(sFeatsFilePath))
+        return lv::read(sFeatsFilePath,m_eFeaturesArchiveType);
     return cv::Mat();
 }
 
 namespace {
 
-    cv::Mat transformImagePacket(size_t nPacketIdx, cv::Mat oPacket, const lv::MatInfo& oInfo) {
+    void transformImagePacket(size_t nPacketIdx, cv::Mat oPacket, const lv::MatInfo& oInfo, cv::Mat& oOutput) {
         lvDbgExceptionWatch;
         lvDbgAssert(!oPacket.empty());
         lvDbgAssert(!oInfo.size.empty());
@@ -619,46 +833,52 @@ namespace {
     #else //!HARDCODE_IMAGE_PACKET_INDEX
         UNUSED(nPacketIdx);
     #endif //!HARDCODE_IMAGE_PACKET_INDEX
-        cv::Mat oCvtOutput;
+        int nCvtCode = -1;
         if(oInfo.type.depth()==oPacket.depth() && oInfo.type.channels()!=oPacket.channels()) {
             if(oInfo.type.channels()==4 && oPacket.channels()==3)
-                cv::cvtColor(oPacket,oCvtOutput,cv::COLOR_BGR2BGRA);
+                nCvtCode = cv::COLOR_BGR2BGRA;
             else if(oInfo.type.channels()==1 && oPacket.channels()==3)
-                cv::cvtColor(oPacket,oCvtOutput,cv::COLOR_BGR2GRAY);
-            else
-                oCvtOutput = oPacket; // dont know how to handle this here; need override of 'redirect'
+                nCvtCode = cv::COLOR_BGR2GRAY;
+            // else, dont know how to handle this here; need override of 'redirect'
         }
+        const bool bResize = (oInfo.size!=oPacket.size());
+        if(nCvtCode<0 && !bResize) {
+            oOutput = oPacket; // nothing to transform, the raw packet is handed over as-is (no copy)
+            return;
+        }
+        // transformed packets are written straight into the output buffer (pool-allocated, if coming from the precacher)
+        cv::Mat oCvtOutput;
+        oCvtOutput.allocator = oOutput.allocator;
+        if(nCvtCode>=0)
+            cv::cvtColor(oPacket,bResize?oCvtOutput:oOutput,nCvtCode);
         else
             oCvtOutput = oPacket;
-        cv::Mat oResizeOutput;
-        if(oInfo.size!=oCvtOutput.size())
-            cv::resize(oCvtOutput,oResizeOutput,oInfo.size(),0,0,cv::INTER_NEAREST);
-        else
-            oResizeOutput = oCvtOutput;
-        return oResizeOutput;
+        if(bResize)
+            cv::resize(oCvtOutput,oOutput,oInfo.size(),0,0,cv::INTER_NEAREST);
     }
 
 } // anonymous namespace
 
-cv::Mat lv::IIDataLoader::getInput_redirect(size_t nPacketIdx) {
+void lv::IIDataLoader::getInput_redirect(size_t nPacketIdx, cv::Mat& oPacket) {
     lvDbgExceptionWatch;
     auto pNotArrayLoader = dynamic_cast<IDataLoader_<NotArray>*>(this);
     if(pNotArrayLoader) {
         lvDbgExceptionWatch;
         const lv::MatInfo& oPacketInfo = getInputInfo(nPacketIdx);
-        cv::Mat oLatestInput = pNotArrayLoader->getRawInput(nPacketIdx);
+        const cv::Mat oLatestInput = pNotArrayLoader->getRawInput(nPacketIdx);
         if(!oLatestInput.empty()) {
             if(m_eInputType==ImagePacket) {
                 lvAssert__(oLatestInput.dims<=2 && oPacketInfo.size.dims()<=2,"bad raw image formatting (packet = %s)",getInputName(nPacketIdx).c_str());
-                oLatestInput = transformImagePacket(nPacketIdx,oLatestInput,oPacketInfo);
+                transformImagePacket(nPacketIdx,oLatestInput,oPacketInfo,oPacket);
             }
-            else
+            else {
                 lvAssert_(m_eInputType==UnspecifiedPacket,"unexpected packet type for not-array loader");
-            lvAssert__(oLatestInput.type()==oPacketInfo.type() && oLatestInput.size==oPacketInfo.size,"unexpected post-transform packet size/type --- need redirect override (packet = %s)",getInputName(nPacketIdx).c_str());
+                oPacket = oLatestInput;
+            }
+            lvAssert__(oPacket.type()==oPacketInfo.type() && oPacket.size==oPacketInfo.size,"unexpected post-transform packet size/type --- need redirect override (packet = %s)",getInputName(nPacketIdx).c_str());
         }
         else
             lvAssert__(oPacketInfo.size.empty(),"unexpected empty raw image (packet = %s)",getInputName(nPacketIdx).c_str());
-        return oLatestInput;
     }
     else {
         auto pArrayLoader = dynamic_cast<IDataLoader_<Array>*>(this);
@@ -672,7 +892,8 @@ cv::Mat lv::IIDataLoader::getInput_redirect(size_t nPacketIdx) {
             if(!vLatestInput[nStreamIdx].empty()) {
                 if(m_eInputType==ImageArrayPacket) {
                     lvAssert__(vLatestInput[nStreamIdx].dims<=2 && vStreamInfos[nStreamIdx].size.dims()<=2,"bad raw image formatting (stream = %s, packet = %s)",pArrayLoader->getInputStreamName(nStreamIdx).c_str(),getInputName(nPacketIdx).c_str());
-                    vLatestInput[nStreamIdx] = transformImagePacket(nPacketIdx,vLatestInput[nStreamIdx],vStreamInfos[nStreamIdx]);
+                    const cv::Mat oRawStream = vLatestInput[nStreamIdx];
+                    transformImagePacket(nPacketIdx,oRawStream,vStreamInfos[nStreamIdx],vLatestInput[nStreamIdx]);
                 }
                 else
                     lvAssert_(m_eInputType==UnspecifiedPacket,"unexpected packet type for not-array loader");
@@ -682,29 +903,30 @@ cv::Mat lv::IIDataLoader::getInput_redirect(size_t nPacketIdx) {
             else
                 lvAssert__(vStreamInfos[nStreamIdx].size.empty(),"unexpected empty raw stream (stream = %s, packet = %s)",pArrayLoader->getInputStreamName(nStreamIdx).c_str(),getInputName(nPacketIdx).c_str());
         }
-        return lv::packData(vLatestInput);
+        lv::packData(vLatestInput,oPacket);
     }
 }
 
-cv::Mat lv::IIDataLoader::getGT_redirect(size_t nPacketIdx) {
+void lv::IIDataLoader::getGT_redirect(size_t nPacketIdx, cv::Mat& oPacket) {
     lvDbgExceptionWatch;
     auto pNotArrayLoader = dynamic_cast<IDataLoader_<NotArray>*>(this);
     if(pNotArrayLoader) {
         lvDbgExceptionWatch;
         const lv::MatInfo& oPacketInfo = getGTInfo(nPacketIdx);
-        cv::Mat oLatestGT = pNotArrayLoader->getRawGT(nPacketIdx);
+        const cv::Mat oLatestGT = pNotArrayLoader->getRawGT(nPacketIdx);
         if(!oLatestGT.empty()) {
             if(m_eGTType==ImagePacket) {
                 lvAssert__(oLatestGT.dims<=2 && oPacketInfo.size.dims()<=2,"bad raw image formatting (gt packet #%d)",(int)nPacketIdx);
-                oLatestGT = transformImagePacket(nPacketIdx,oLatestGT,oPacketInfo);
+                transformImagePacket(nPacketIdx,oLatestGT,oPacketInfo,oPacket);
             }
-            else
+            else {
                 lvAssert_(m_eGTType==UnspecifiedPacket,"unexpected packet type for not-array loader");
-            lvAssert__(oLatestGT.type()==oPacketInfo.type() && oLatestGT.size==oPacketInfo.size,"unexpected post-transform packet size/type --- need redirect override (gt packet #%d)",(int)nPacketIdx);
+                oPacket = oLatestGT;
+            }
+            lvAssert__(oPacket.type()==oPacketInfo.type() && oPacket.size==oPacketInfo.size,"unexpected post-transform packet size/type --- need redirect override (gt packet #%d)",(int)nPacketIdx);
         }
         else
             lvAssert__(oPacketInfo.size.empty(),"unexpected empty raw image (gt packet #%d)",(int)nPacketIdx);
-        return oLatestGT;
     }
     else {
         auto pArrayLoader = dynamic_cast<IDataLoader_<Array>*>(this);
@@ -718,7 +940,8 @@ cv::Mat lv::IIDataLoader::getGT_redirect(size_t nPacketIdx) {
             if(!vLatestGT[nStreamIdx].empty()) {
                 if(m_eGTType==ImageArrayPacket) {
                     lvAssert__(vLatestGT[nStreamIdx].dims<=2 && vStreamInfos[nStreamIdx].size.dims()<=2,"bad raw image formatting (stream = %s, gt packet #%d)",pArrayLoader->getGTStreamName(nStreamIdx).c_str(),(int)nPacketIdx);
-                    vLatestGT[nStreamIdx] = transformImagePacket(nPacketIdx,vLatestGT[nStreamIdx],vStreamInfos[nStreamIdx]);
+                    const cv::Mat oRawStream = vLatestGT[nStreamIdx];
+                    transformImagePacket(nPacketIdx,oRawStream,vStreamInfos[nStreamIdx],vLatestGT[nStreamIdx]);
                 }
                 else
                     lvAssert_(m_eGTType==UnspecifiedPacket,"unexpected packet type for not-array loader");
@@ -728,7 +951,7 @@ cv::Mat lv::IIDataLoader::getGT_redirect(size_t nPacketIdx) {
             else
                 lvAssert__(vStreamInfos[nStreamIdx].size.empty(),"unexpected empty raw stream (stream = %s, gt packet #%d)",pArrayLoader->getGTStreamName(nStreamIdx).c_str(),(int)nPacketIdx);
         }
-        return lv::packData(vLatestGT);
+        lv::packData(vLatestGT,oPacket);
     }
 }
 
@@ -1326,8 +1549,12 @@ lv::DataWriter::DataWriter(std::function<size_t(const cv::Mat&,size_t)> lDataArc
     lvAssert_(m_lCallback,"invalid data writer callback");
     m_bIsActive = false;
     m_bAllowPacketDrop = false;
+    m_nQueueMaxSize = 0;
     m_nQueueSize = 0;
     m_nQueueCount = 0;
+    m_nEnqueuePos = m_nDequeuePos = 0;
+    m_nSleepingWorkers = m_nWaitingProducers = m_nActiveProducers = 0;
+    m_nPendingQueueHead = 0;
 }
 
 lv::DataWriter::~DataWriter() {
@@ -1342,48 +1569,71 @@ bool lv::DataWriter::queue_check(const cv::Mat& oPacket, size_t nIdx) {
     lvAssert__(nPacketSize<=m_nQueueMaxSize,"packet too large for queue, max cache size must be increased (got %d, max is %d)",(int)nPacketSize,(int)m_nQueueMaxSize);
     if(!m_bAllowPacketDrop)
         return true; // since this config blocks, packet will never be dropped
-    lv::mutex_unique_lock sync_lock(m_oSyncMutex);
-    const auto pOldPacketIter = m_mQueue.find(nIdx);
-    const bool bIsNewPacket = pOldPacketIter==m_mQueue.end();
-    const size_t nOldPacketSize = bIsNewPacket?0u:(pOldPacketIter->second.total()*pOldPacketIter->second.elemSize());
-    return (m_nQueueSize+nPacketSize-nOldPacketSize<=m_nQueueMaxSize);
+    lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+    const auto pOldPacketIter = findPendingPacket(nIdx);
+    if(pOldPacketIter!=m_vPendingQueue.end() && m_nQueueSize+nPacketSize-pOldPacketIter->second.total()*pOldPacketIter->second.elemSize()<=m_nQueueMaxSize)
+        return true; // pending packet would be replaced, no ring buffer slot needed
+    return m_nQueueSize+nPacketSize<=m_nQueueMaxSize && m_nEnqueuePos-m_nDequeuePos<WRITER_QUEUE_SLOT_COUNT;
 }
 
 size_t lv::DataWriter::queue(const cv::Mat& oPacket, size_t nIdx) {
     lvDbgExceptionWatch;
     if(!m_bIsActive)
         return m_lCallback(oPacket,nIdx);
+    // active producers are counted so that the writer cannot be stopped (and drained) while a packet is still being pushed
+    ++m_nActiveProducers;
+    const auto lReleaseProducer = [&]() {
+        if(--m_nActiveProducers==0 && !m_bIsActive) {
+            lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+            m_oClearCondVar.notify_all();
+        }
+    };
+    size_t nPacketPosition;
+    try {
+        nPacketPosition = queue_async(oPacket,nIdx);
+    }
+    catch(...) {
+        lReleaseProducer();
+        throw;
+    }
+    lReleaseProducer();
+    return nPacketPosition;
+}
+
+size_t lv::DataWriter::queue_async(const cv::Mat& oPacket, size_t nIdx) {
+    if(!m_bIsActive)
+        return m_lCallback(oPacket,nIdx); // writer was stopped before this producer got counted
     const size_t nPacketSize = oPacket.total()*oPacket.elemSize();
     lvAssert__(nPacketSize<=m_nQueueMaxSize,"packet too large for queue, max cache size must be increased (got %d, max is %d)",(int)nPacketSize,(int)m_nQueueMaxSize);
+    lvLog_(4,"data writer [%" PRIxPTR "] received packet at idx = %zu...",uintptr_t(this),nIdx);
     size_t nPacketPosition;
-    {
-        lvLog_(4,"data writer [%" PRIxPTR "] received packet at idx = %zu...",uintptr_t(this),nIdx);
+    while(!tryPush(oPacket,nIdx,nPacketPosition)) {
         lv::mutex_unique_lock sync_lock(m_oSyncMutex);
-        if(!m_bAllowPacketDrop) {
-            m_oClearCondVar.wait(sync_lock,[&]{
-                const auto pOldPacketIter = m_mQueue.find(nIdx);
-                const bool bIsNewPacket = pOldPacketIter==m_mQueue.end();
-                const size_t nOldPacketSize = bIsNewPacket?0u:(pOldPacketIter->second.total()*pOldPacketIter->second.elemSize());
-                lvDbgAssert(m_nQueueSize>=nOldPacketSize);
-                return m_nQueueSize+nPacketSize-nOldPacketSize<=m_nQueueMaxSize;
-            });
-        }
-        const auto pOldPacketIter = m_mQueue.find(nIdx);
-        const bool bIsNewPacket = pOldPacketIter==m_mQueue.end();
-        const size_t nOldPacketSize = bIsNewPacket?0u:(pOldPacketIter->second.total()*pOldPacketIter->second.elemSize());
-        if(m_nQueueSize+nPacketSize-nOldPacketSize<=m_nQueueMaxSize) {
-            m_mQueue[nIdx] = oPacket.clone(); // local copy passed to writing thread; provider can recycle memory following this call
-            m_nQueueSize = m_nQueueSize+nPacketSize-nOldPacketSize;
-            // @@@ could cut a find operation here using C++17's map::insert_or_assign above
-            nPacketPosition = std::distance(m_mQueue.begin(),m_mQueue.find(nIdx));
-            if(bIsNewPacket)
-                ++m_nQueueCount;
-            m_oQueueCondVar.notify_one();
-        }
-        else {
+        if(tryReplace(oPacket,nIdx,nPacketPosition))
+            return nPacketPosition;
+        if(m_bAllowPacketDrop) {
             lvLog_(3,"data writer [%" PRIxPTR "] dropping packet at idx = %zu (reached max queue size)",uintptr_t(this),nIdx);
-            nPacketPosition = SIZE_MAX; // packet dropped
+            return SIZE_MAX; // packet dropped
         }
+        ++m_nWaitingProducers;
+        m_oClearCondVar.wait(sync_lock,[&]{
+            const auto pOldPacketIter = findPendingPacket(nIdx);
+            return !m_bIsActive || (m_nQueueSize+nPacketSize<=m_nQueueMaxSize && m_nEnqueuePos-m_nDequeuePos<WRITER_QUEUE_SLOT_COUNT) ||
+                   (pOldPacketIter!=m_vPendingQueue.end() && m_nQueueSize+nPacketSize-pOldPacketIter->second.total()*pOldPacketIter->second.elemSize()<=m_nQueueMaxSize);
+        });
+        --m_nWaitingProducers;
+        if(!m_bIsActive) {
+            lvLog_(3,"data writer [%" PRIxPTR "] writing packet at idx = %zu synchronously (writer stopped while queue was full)",uintptr_t(this),nIdx);
+            sync_lock.unlock();
+            return m_lCallback(oPacket,nIdx);
+        }
+        if(tryReplace(oPacket,nIdx,nPacketPosition))
+            return nPacketPosition;
+    }
+    if(m_nSleepingWorkers>0) {
+        // sleeping workers may be idle or waiting on this very packet, so they are all woken up
+        lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+        m_oQueueCondVar.notify_all();
     }
     if((nIdx%50)==0)
         lvLog_(3,"data writer [%" PRIxPTR "] queue currently at %d%% capacity",uintptr_t(this),(int)(((float)m_nQueueSize*100)/m_nQueueMaxSize));
@@ -1391,6 +1641,7 @@ size_t lv::DataWriter::queue(const cv::Mat& oPacket, size_t nIdx) {
 }
 
 bool lv::DataWriter::startAsyncWriting(size_t nSuggestedQueueSize, bool bDropPacketsIfFull, size_t nWorkers) {
+    static_assert(WRITER_QUEUE_SLOT_COUNT>0 && (WRITER_QUEUE_SLOT_COUNT&(WRITER_QUEUE_SLOT_COUNT-1))==0,"Writer queue slot count must be a power of two");
     stopAsyncWriting();
     if(nSuggestedQueueSize>0) {
         m_bIsActive = true;
@@ -1398,7 +1649,14 @@ bool lv::DataWriter::startAsyncWriting(size_t nSuggestedQueueSize, bool bDropPac
         m_nQueueMaxSize = std::max(std::min(nSuggestedQueueSize,CACHE_MAX_SIZE),CACHE_MIN_SIZE);
         m_nQueueSize = 0;
         m_nQueueCount = 0;
-        m_mQueue.clear();
+        m_aQueueSlots = std::make_unique<QueueSlot[]>(WRITER_QUEUE_SLOT_COUNT);
+        m_vPendingQueue.clear();
+        m_vPendingQueue.reserve(WRITER_QUEUE_SLOT_COUNT);
+        m_nPendingQueueHead = 0;
+        for(size_t nSlotIdx=0; nSlotIdx<WRITER_QUEUE_SLOT_COUNT; ++nSlotIdx)
+            m_aQueueSlots[nSlotIdx].nSeq = nSlotIdx;
+        m_nEnqueuePos = m_nDequeuePos = 0;
+        m_nSleepingWorkers = m_nWaitingProducers = m_nActiveProducers = 0;
         m_vhWorkers.clear();
         lvLog_(2,"data writer [%" PRIxPTR "] writing thread init (%zu) w/ queue size = %zu mb",uintptr_t(this),nWorkers,(m_nQueueMaxSize/1024)/1024);
         for(size_t n=0; n<nWorkers; ++n)
@@ -1415,9 +1673,24 @@ void lv::DataWriter::stopAsyncWriting() {
             lv::mutex_unique_lock sync_lock(m_oSyncMutex);
             m_bIsActive = false;
             m_oQueueCondVar.notify_all();
+            m_oClearCondVar.notify_all();
         }
         for(std::thread& oWorker : m_vhWorkers)
             oWorker.join();
+        m_vhWorkers.clear();
+        // packets pushed by producers racing with the shutdown are still written here (in idx order); producers that saw the
+        // writer as active are waited on first, so that none of them can push a packet once the queue has been drained
+        lv::mutex_unique_lock sync_lock(m_oSyncMutex);
+        m_oClearCondVar.wait(sync_lock,[&](){return m_nActiveProducers==0;});
+        cv::Mat oPacket;
+        size_t nIdx;
+        while(true) {
+            fetchQueuedPackets(sync_lock);
+            if(!popPendingPacket(oPacket,nIdx))
+                break;
+            lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock);
+            commit(oPacket,nIdx);
+        }
     }
     while(!m_vWorkerExceptions.empty()) {
         std::exception_ptr pLatestException = m_vWorkerExceptions.top().first; // add packet idx to exception...? somewhow?
@@ -1426,31 +1699,181 @@ void lv::DataWriter::stopAsyncWriting() {
     }
 }
 
+bool lv::DataWriter::tryPush(const cv::Mat& oPacket, size_t nIdx, size_t& nPacketPosition) {
+    // first, reserve the packet bytes in the queue budget (released by the worker once the packet is written)
+    const size_t nPacketSize = oPacket.total()*oPacket.elemSize();
+    size_t nCurrQueueSize = m_nQueueSize;
+    do {
+        if(nCurrQueueSize+nPacketSize>m_nQueueMaxSize)
+            return false;
+    } while(!m_nQueueSize.compare_exchange_weak(nCurrQueueSize,nCurrQueueSize+nPacketSize));
+    // then, claim a free slot in the ring buffer
+    size_t nPos = m_nEnqueuePos;
+    QueueSlot* pSlot;
+    while(true) {
+        pSlot = &m_aQueueSlots[nPos&(WRITER_QUEUE_SLOT_COUNT-1)];
+        const std::ptrdiff_t nSeqDiff = std::ptrdiff_t(pSlot->nSeq.load(std::memory_order_acquire))-std::ptrdiff_t(nPos);
+        if(nSeqDiff==0) {
+            if(m_nEnqueuePos.compare_exchange_weak(nPos,nPos+1))
+                break;
+        }
+        else if(nSeqDiff<0) {
+            m_nQueueSize -= nPacketSize; // ring buffer is full, give back the reserved bytes
+            return false;
+        }
+        else
+            nPos = m_nEnqueuePos;
+    }
+    pSlot->nIdx = nIdx;
+    pSlot->oPacket = oPacket.clone(); // local copy passed to writing thread; provider can recycle memory following this call
+    ++m_nQueueCount;
+    pSlot->nSeq.store(nPos+1); // seq-cst, as sleeping workers are counted right after (see 'isNextSlotReady')
+    const size_t nDequeuePos = m_nDequeuePos;
+    nPacketPosition = nPos>nDequeuePos?nPos-nDequeuePos:0;
+    return true;
+}
+
+bool lv::DataWriter::tryPop(cv::Mat& oPacket, size_t& nIdx) {
+    size_t nPos = m_nDequeuePos;
+    QueueSlot* pSlot;
+    while(true) {
+        pSlot = &m_aQueueSlots[nPos&(WRITER_QUEUE_SLOT_COUNT-1)];
+        const std::ptrdiff_t nSeqDiff = std::ptrdiff_t(pSlot->nSeq.load(std::memory_order_acquire))-std::ptrdiff_t(nPos+1);
+        if(nSeqDiff==0) {
+            if(m_nDequeuePos.compare_exchange_weak(nPos,nPos+1))
+                break;
+        }
+        else if(nSeqDiff<0)
+            return false; // ring buffer is empty (or the next packet is still being pushed)
+        else
+            nPos = m_nDequeuePos;
+    }
+    nIdx = pSlot->nIdx;
+    oPacket = pSlot->oPacket;
+    pSlot->oPacket = cv::Mat();
+    pSlot->nSeq.store(nPos+WRITER_QUEUE_SLOT_COUNT,std::memory_order_release);
+    return true;
+}
+
+bool lv::DataWriter::tryReplace(const cv::Mat& oPacket, size_t nIdx, size_t& nPacketPosition) {
+    const auto pOldPacketIter = findPendingPacket(nIdx);
+    if(pOldPacketIter==m_vPendingQueue.end())
+        return false;
+    const size_t nPacketSize = oPacket.total()*oPacket.elemSize();
+    const size_t nOldPacketSize = pOldPacketIter->second.total()*pOldPacketIter->second.elemSize();
+    if(m_nQueueSize+nPacketSize-nOldPacketSize>m_nQueueMaxSize)
+        return false;
+    lvLog_(4,"data writer [%" PRIxPTR "] replacing pending packet at idx = %zu",uintptr_t(this),nIdx);
+    pOldPacketIter->second = oPacket.clone(); // local copy passed to writing thread; provider can recycle memory following this call
+    m_nQueueSize += nPacketSize;
+    m_nQueueSize -= nOldPacketSize;
+    nPacketPosition = (size_t)std::distance(m_vPendingQueue.begin()+m_nPendingQueueHead,pOldPacketIter);
+    return true;
+}
+
+std::vector<std::pair<size_t,cv::Mat>>::iterator lv::DataWriter::findPendingPacket(size_t nIdx) {
+    const auto pPacketIter = std::lower_bound(m_vPendingQueue.begin()+m_nPendingQueueHead,m_vPendingQueue.end(),nIdx,
+                                              [](const std::pair<size_t,cv::Mat>& oPacket, size_t n) {return oPacket.first<n;});
+    return (pPacketIter!=m_vPendingQueue.end() && pPacketIter->first==nIdx)?pPacketIter:m_vPendingQueue.end();
+}
+
+bool lv::DataWriter::popPendingPacket(cv::Mat& oPacket, size_t& nIdx) {
+    if(m_nPendingQueueHead>=m_vPendingQueue.size())
+        return false;
+    std::pair<size_t,cv::Mat>& oHead = m_vPendingQueue[m_nPendingQueueHead++];
+    nIdx = oHead.first;
+    oPacket = oHead.second;
+    oHead.second = cv::Mat();
+    // popped entries are only reclaimed once they make up half of the buffer, so that pops do not shift the queue every time
+    if(m_nPendingQueueHead==m_vPendingQueue.size()) {
+        m_vPendingQueue.clear();
+        m_nPendingQueueHead = 0;
+    }
+    else if(m_nPendingQueueHead*2>=m_vPendingQueue.size()) {
+        m_vPendingQueue.erase(m_vPendingQueue.begin(),m_vPendingQueue.begin()+m_nPendingQueueHead);
+        m_nPendingQueueHead = 0;
+    }
+    return true;
+}
+
+bool lv::DataWriter::isNextSlotReady() const {
+    const size_t nPos = m_nDequeuePos;
+    return m_aQueueSlots[nPos&(WRITER_QUEUE_SLOT_COUNT-1)].nSeq.load()==nPos+1;
+}
+
+void lv::DataWriter::fetchQueuedPackets(lv::mutex_unique_lock& sync_lock) {
+    lvDbgAssert(sync_lock.owns_lock());
+    // ring buffer positions act as sequence numbers: all packets reserved before this point are fetched before any is written,
+    // so that the pending queue can hand them out in idx order regardless of how producers and workers interleave
+    const size_t nEndPos = m_nEnqueuePos;
+    bool bFetchedAny = false;
+    cv::Mat oPacket;
+    size_t nIdx;
+    while(m_nDequeuePos<nEndPos) {
+        if(!tryPop(oPacket,nIdx)) {
+            // next packet is still being copied by its producer, which will wake us up once done
+            ++m_nSleepingWorkers;
+            m_oQueueCondVar.wait(sync_lock,[&](){return m_nDequeuePos>=nEndPos || isNextSlotReady();});
+            --m_nSleepingWorkers;
+            continue;
+        }
+        bFetchedAny = true;
+        // packets mostly arrive in idx order, so the insertion point is usually the end of the buffer (no shifting)
+        const auto pPacketIter = std::lower_bound(m_vPendingQueue.begin()+m_nPendingQueueHead,m_vPendingQueue.end(),nIdx,
+                                                  [](const std::pair<size_t,cv::Mat>& oPendingPacket, size_t n) {return oPendingPacket.first<n;});
+        if(pPacketIter!=m_vPendingQueue.end() && pPacketIter->first==nIdx) {
+            // re-queued idx: only the latest packet is kept (and written)
+            lvLog_(4,"data writer [%" PRIxPTR "] replacing pending packet at idx = %zu",uintptr_t(this),nIdx);
+            m_nQueueSize -= pPacketIter->second.total()*pPacketIter->second.elemSize();
+            --m_nQueueCount;
+            pPacketIter->second = oPacket;
+        }
+        else
+            m_vPendingQueue.emplace(pPacketIter,nIdx,oPacket);
+    }
+    if(bFetchedAny && m_nWaitingProducers>0)
+        m_oClearCondVar.notify_all();
+}
+
+void lv::DataWriter::commit(cv::Mat& oPacket, size_t nIdx) {
+    const size_t nPacketSize = oPacket.total()*oPacket.elemSize();
+    try {
+        lvLog_(4,"data writer [%" PRIxPTR "] writing packet at idx = %zu, with size = %zu kb",uintptr_t(this),nIdx,nPacketSize/1024);
+        m_lCallback(oPacket,nIdx);
+    }
+    catch(...) {
+        lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+        m_vWorkerExceptions.push(std::make_pair(std::current_exception(),nIdx));
+    }
+    oPacket = cv::Mat();
+    m_nQueueSize -= nPacketSize;
+    --m_nQueueCount;
+    if(m_nWaitingProducers>0) {
+        lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+        m_oClearCondVar.notify_all();
+    }
+}
+
 void lv::DataWriter::entry() {
     lvDbgExceptionWatch;
     lv::mutex_unique_lock sync_lock(m_oSyncMutex);
-    while(m_bIsActive || m_nQueueCount>0) {
-        m_oQueueCondVar.wait(sync_lock,[&](){return !m_bIsActive || m_nQueueCount>0;});
-        if(m_nQueueCount>0) {
-            auto pCurrPacket = m_mQueue.begin();
-            if(pCurrPacket!=m_mQueue.end()) {
-                const size_t nPacketSize = pCurrPacket->second.total()*pCurrPacket->second.elemSize();
-                if(nPacketSize<=m_nQueueSize) {
-                    try {
-                        lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock);
-                        lvLog_(4,"data writer [%" PRIxPTR "] writing packet at idx = %zu, with size = %zu kb",uintptr_t(this),pCurrPacket->first,nPacketSize/1024);
-                        m_lCallback(pCurrPacket->second,pCurrPacket->first);
-                    }
-                    catch(...) {
-                        m_vWorkerExceptions.push(std::make_pair(std::current_exception(),pCurrPacket->first));
-                    }
-                    m_nQueueSize -= nPacketSize;
-                    m_mQueue.erase(pCurrPacket);
-                    --m_nQueueCount;
-                    m_oClearCondVar.notify_all();
-                }
-            }
+    while(true) {
+        fetchQueuedPackets(sync_lock);
+        cv::Mat oPacket;
+        size_t nIdx;
+        // the lowest pending idx is always written first
+        if(popPendingPacket(oPacket,nIdx)) {
+            if(m_nPendingQueueHead<m_vPendingQueue.size() && m_nSleepingWorkers>0)
+                m_oQueueCondVar.notify_all(); // other fetched packets can be written by idle workers in the meantime
+            lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock);
+            commit(oPacket,nIdx);
+            continue;
         }
+        if(!m_bIsActive)
+            break; // leftovers (if any) are written by the stopping thread
+        ++m_nSleepingWorkers;
+        m_oQueueCondVar.wait(sync_lock,[&](){return !m_bIsActive || m_nEnqueuePos!=m_nDequeuePos || m_nPendingQueueHead<m_vPendingQueue.size();});
+        --m_nSleepingWorkers;
     }
 }
 
@@ -1679,6 +2102,70 @@ bool lv::DatasetHandler::isEvaluating() const {
     return m_bUsingEvaluator;
 }
 
+std::vector<lv::BatchProcessReport> lv::DatasetHandler::processBatches_impl(const BatchProcessFunc& lBatchFunc, size_t nWorkers, bool bPrecache, bool bPrecacheInputOnly, size_t nTotCacheSize) {
+    lvAssert_(lBatchFunc,"batch processing function must be valid");
+    const IDataHandlerPtrArray vpBatches = getBatches(false);
+    std::vector<BatchProcessReport> vReports(vpBatches.size());
+    if(vpBatches.empty())
+        return vReports;
+    std::vector<size_t> vnBatchOrder(vpBatches.size());
+    std::iota(vnBatchOrder.begin(),vnBatchOrder.end(),size_t(0));
+    std::stable_sort(vnBatchOrder.begin(),vnBatchOrder.end(),[&](size_t a, size_t b) {
+        return compare_load(vpBatches[b].get(),vpBatches[a].get()); // largest load first, to avoid ending up with one big batch on a single thread
+    });
+    lv::WorkerPool<> oPool(nWorkers);
+    const size_t nActiveWorkers = std::min(oPool.workers(),vpBatches.size());
+    // precaching buffers are split among concurrent batches so that their sum never exceeds the total budget
+    std::mutex oCacheBudgetMutex;
+    size_t nFreeCacheSize = (nTotCacheSize==SIZE_MAX)?CACHE_MAX_SIZE:nTotCacheSize;
+    size_t nIdleWorkers = nActiveWorkers;
+    std::atomic_size_t nNextOrderIdx(0);
+    const auto lWorkerEntry = [&]() {
+        for(size_t nOrderIdx=nNextOrderIdx++; nOrderIdx<vnBatchOrder.size(); nOrderIdx=nNextOrderIdx++) {
+            const IDataHandlerPtr& pBatch = vpBatches[vnBatchOrder[nOrderIdx]];
+            BatchProcessReport& oReport = vReports[vnBatchOrder[nOrderIdx]];
+            oReport.sBatchName = pBatch->getName();
+            oReport.nExpectedLoadSize = pBatch->getExpectedLoadSize();
+            if(bPrecache) {
+                lv::mutex_lock_guard oLock(oCacheBudgetMutex);
+                oReport.nPrecacheBufferSize = std::min(oReport.nExpectedLoadSize,nFreeCacheSize/nIdleWorkers);
+                // shares too small for a minimal cache in each of the batch's precachers are dropped instead of being inflated past the budget
+                if(oReport.nPrecacheBufferSize<CACHE_MIN_SIZE*(bPrecacheInputOnly?1u:3u))
+                    oReport.nPrecacheBufferSize = 0;
+                nFreeCacheSize -= oReport.nPrecacheBufferSize;
+                --nIdleWorkers;
+            }
+            lvLog_(1,"\tbatch '%s' @ init (expected load = %zu mb, precache buffer = %zu mb)",oReport.sBatchName.c_str(),(oReport.nExpectedLoadSize/1024)/1024,(oReport.nPrecacheBufferSize/1024)/1024);
+            lv::StopWatch oStopWatch;
+            try {
+                if(oReport.nPrecacheBufferSize>0)
+                    pBatch->startPrecaching(bPrecacheInputOnly,oReport.nPrecacheBufferSize);
+                lBatchFunc(pBatch);
+            }
+            catch(...) {
+                oReport.pException = std::current_exception();
+                lvWarn_("batch '%s' processing function threw an exception",oReport.sBatchName.c_str());
+            }
+            if(pBatch->isPrecaching())
+                pBatch->stopPrecaching();
+            oReport.dWallTime = oStopWatch.elapsed();
+            oReport.nOutputCount = pBatch->getCurrentOutputCount();
+            oReport.dThroughput = oReport.dWallTime>0.0?double(oReport.nOutputCount)/oReport.dWallTime:0.0;
+            lvLog_(1,"\tbatch '%s' @ end (%.2f sec, %zu packets, %.2f Hz)",oReport.sBatchName.c_str(),oReport.dWallTime,oReport.nOutputCount,oReport.dThroughput);
+            if(bPrecache) {
+                lv::mutex_lock_guard oLock(oCacheBudgetMutex);
+                nFreeCacheSize += oReport.nPrecacheBufferSize;
+                ++nIdleWorkers;
+            }
+        }
+    };
+    lv::WorkerPool<>::TaskGroup oGroup;
+    for(size_t nWorkerIdx=0; nWorkerIdx<nActiveWorkers; ++nWorkerIdx)
+        oPool.queueTask(oGroup,lWorkerEntry);
+    oPool.wait(oGroup);
+    return vReports;
+}
+
 lv::DatasetHandler::DatasetHandler(const std::string& sDatasetName, const std::string& sDatasetDirPath, const std::string& sOutputDirPath,
                                    const std::vector<std::string>& vsWorkBatchDirs, const std::vector<std::string>& vsSkippedDirTokens,
                                    bool bSaveOutput, bool bUseEvaluator, bool bForce4ByteDataAlign, double dScaleFactor) :
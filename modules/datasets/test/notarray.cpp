@@ -2,6 +2,7 @@
 #include "litiv/datasets.hpp"
 #include "litiv/imgproc.hpp"
 #include "litiv/test.hpp"
+#include <set>
 
 TEST(datasets_notarray,regression_custom) {
     lv::setVerbosity(0);
@@ -84,6 +85,244 @@ TEST(datasets_notarray,regression_custom) {
     ASSERT_TRUE(lv::checkIfExists(sOutputRootPath+"/customtest.txt"));
 }
 
+TEST(datasets_notarray,regression_batch_runner) {
+    lv::setVerbosity(0);
+    using DatasetType = lv::Dataset_<lv::DatasetTask_EdgDet,lv::Dataset_Custom,lv::NonParallel>;
+    const std::string sOutputRootPath = TEST_OUTPUT_DATA_ROOT "/custom_dataset_runner_test/";
+    DatasetType::Ptr pDataset = DatasetType::create(
+        "customrunnertest",
+        lv::addDirSlashIfMissing(SAMPLES_DATA_ROOT)+"custom_dataset_ex/",
+        sOutputRootPath,
+        std::vector<std::string>{"batch1","batch2","batch3"},
+        std::vector<std::string>(),
+        false,
+        false,
+        false,
+        1.0
+    );
+    ASSERT_TRUE(pDataset.get()!=nullptr);
+    std::atomic_size_t nCreatedAlgos(0);
+    const auto lAlgoFactory = [&]() {
+        ++nCreatedAlgos;
+        return std::make_shared<EdgeDetectorLBSP>();
+    };
+    const auto lBatchFunc = [](const lv::IDataHandlerPtr& pBatch, const std::shared_ptr<IEdgeDetector>& pAlgo) {
+        DatasetType::WorkBatch& oBatch = dynamic_cast<DatasetType::WorkBatch&>(*pBatch);
+        oBatch.startProcessing();
+        for(size_t nPacketIdx=0; nPacketIdx<oBatch.getImageCount(); ++nPacketIdx) {
+            cv::Mat oEdgeMask;
+            pAlgo->apply(oBatch.getInput(nPacketIdx),oEdgeMask);
+            oBatch.push(oEdgeMask,nPacketIdx);
+        }
+        oBatch.stopProcessing();
+    };
+    const std::vector<lv::BatchProcessReport> vReports = pDataset->processBatches(lAlgoFactory,lBatchFunc,2);
+    const lv::IDataHandlerPtrArray vpBatches = pDataset->getBatches(false);
+    ASSERT_EQ(vReports.size(),vpBatches.size());
+    ASSERT_EQ(nCreatedAlgos.load(),vpBatches.size());
+    for(size_t nBatchIdx=0; nBatchIdx<vpBatches.size(); ++nBatchIdx) {
+        EXPECT_EQ(vReports[nBatchIdx].sBatchName,vpBatches[nBatchIdx]->getName());
+        EXPECT_EQ(vReports[nBatchIdx].nExpectedLoadSize,vpBatches[nBatchIdx]->getExpectedLoadSize());
+        EXPECT_EQ(vReports[nBatchIdx].nOutputCount,vpBatches[nBatchIdx]->getInputCount());
+        EXPECT_FALSE(vReports[nBatchIdx].pException);
+        EXPECT_GT(vReports[nBatchIdx].dWallTime,0.0);
+        EXPECT_GT(vReports[nBatchIdx].dThroughput,0.0);
+        EXPECT_FALSE(vpBatches[nBatchIdx]->isPrecaching());
+    }
+    const auto lThrowingFunc = [](const lv::IDataHandlerPtr&, const std::shared_ptr<IEdgeDetector>&) {
+        lvError("test");
+    };
+    const std::vector<lv::BatchProcessReport> vFailedReports = pDataset->processBatches(lAlgoFactory,lThrowingFunc,2,false);
+    ASSERT_EQ(vFailedReports.size(),vpBatches.size());
+    for(const lv::BatchProcessReport& oReport : vFailedReports) {
+        EXPECT_TRUE(bool(oReport.pException));
+        EXPECT_EQ(oReport.nPrecacheBufferSize,size_t(0));
+    }
+}
+
+TEST(datasets_precacher,regression_readahead) {
+    lv::setVerbosity(0);
+    const size_t nPacketCount = 50;
+    std::atomic_size_t nLoadCount(0);
+    // packets are sparse (like most gt streams), and empty ones must not end the stream early
+    const auto lIsSparseIdx = [](size_t nIdx) {return (nIdx%10)==5;};
+    lv::DataPrecacher oPrecacher([&](size_t nIdx) {
+        ++nLoadCount;
+        std::this_thread::sleep_for(std::chrono::milliseconds(rand()%3));
+        return (nIdx<nPacketCount && !lIsSparseIdx(nIdx))?cv::Mat(10,10,CV_32SC1,cv::Scalar_<int>(int(nIdx))):cv::Mat();
+    },[&](){return nPacketCount;});
+    ASSERT_TRUE(oPrecacher.startAsyncPrecaching(size_t(1024*1024),4,8));
+    ASSERT_TRUE(oPrecacher.isActive());
+    for(size_t nIdx=0; nIdx<nPacketCount; ++nIdx) {
+        const cv::Mat& oPacket = oPrecacher.getPacket(nIdx);
+        ASSERT_EQ(oPacket.empty(),lIsSparseIdx(nIdx));
+        if(!oPacket.empty())
+            ASSERT_EQ(oPacket.at<int>(5,5),int(nIdx));
+    }
+    ASSERT_TRUE(oPrecacher.getPacket(nPacketCount).empty());
+    ASSERT_TRUE(oPrecacher.getPacket(nPacketCount+3).empty());
+    ASSERT_EQ(oPrecacher.getPacket(10).at<int>(0,0),10); // out-of-window seek
+    ASSERT_EQ(oPrecacher.getPacket(13).at<int>(0,0),13); // in-window skip
+    ASSERT_EQ(oPrecacher.getPacket(13).at<int>(0,0),13); // repeated request
+    const lv::DataPrecacher::Stats oStats = oPrecacher.getStats();
+    EXPECT_EQ(oStats.nRequests,nPacketCount+4);
+    EXPECT_EQ(oStats.nHits+oStats.nStalls+oStats.nMisses,oStats.nRequests);
+    EXPECT_GE(oStats.nMisses,size_t(2));
+    EXPECT_GE(oStats.dTotStallTime,0.0);
+    EXPECT_GE(oStats.getHitRate(),0.0);
+    EXPECT_LE(oStats.getHitRate(),1.0);
+    oPrecacher.stopAsyncPrecaching();
+    ASSERT_FALSE(oPrecacher.isActive());
+    EXPECT_GE(nLoadCount.load(),nPacketCount);
+    ASSERT_EQ(oPrecacher.getPacket(20).at<int>(0,0),20);
+}
+
+TEST(datasets_precacher,regression_inplace) {
+    lv::setVerbosity(0);
+    const size_t nPacketCount = 50;
+    lv::PooledMatAllocatorPtr pAllocator = lv::PooledMatAllocator::create();
+    lv::DataPrecacher oPrecacher([&](size_t nIdx, cv::Mat& oPacket) {
+        if(nIdx<nPacketCount) {
+            oPacket.create(48,64,CV_8UC3);
+            oPacket = cv::Scalar_<uchar>::all(uchar(nIdx));
+        }
+    },pAllocator);
+    ASSERT_EQ(oPrecacher.getAllocator(),pAllocator);
+    ASSERT_EQ(oPrecacher.getPacket(3).at<cv::Vec3b>(5,5),cv::Vec3b::all(3)); // inactive precacher still uses the pool
+    ASSERT_EQ(oPrecacher.getPacket(3).allocator,pAllocator.get());
+    ASSERT_TRUE(oPrecacher.startAsyncPrecaching(size_t(1024*1024),2,8));
+    std::set<const uchar*> vsPacketAddrs;
+    for(size_t nIdx=0; nIdx<nPacketCount; ++nIdx) {
+        const cv::Mat& oPacket = oPrecacher.getPacket(nIdx);
+        ASSERT_FALSE(oPacket.empty());
+        ASSERT_EQ(oPacket.allocator,pAllocator.get());
+        ASSERT_EQ(oPacket.at<cv::Vec3b>(47,63),cv::Vec3b::all(uchar(nIdx)));
+        vsPacketAddrs.insert(oPacket.data);
+    }
+    ASSERT_TRUE(oPrecacher.getPacket(nPacketCount).empty());
+    // packets are handed over as-is, and released buffers get recycled by the pool for later packets
+    ASSERT_LT(vsPacketAddrs.size(),nPacketCount/2);
+    ASSERT_LE(vsPacketAddrs.size(),pAllocator->getHeapAllocCount());
+    oPrecacher.stopAsyncPrecaching();
+    ASSERT_EQ(pAllocator->getActiveBufferCount(),size_t(0));
+    ASSERT_EQ(pAllocator->getPooledBufferCount(),pAllocator->getHeapAllocCount());
+    // readahead stays opt-in, so the default setup falls back to the ring buffer even for in-place loaders
+    ASSERT_TRUE(oPrecacher.startAsyncPrecaching(size_t(1024*1024)));
+    for(size_t nIdx=0; nIdx<nPacketCount; ++nIdx)
+        ASSERT_EQ(oPrecacher.getPacket(nIdx).at<cv::Vec3b>(47,63),cv::Vec3b::all(uchar(nIdx)));
+    oPrecacher.stopAsyncPrecaching();
+}
+
+TEST(datasets_writer,regression_queue) {
+    lv::setVerbosity(0);
+    const size_t nProducers = 4, nPacketsPerProducer = 500;
+    for(bool bDropPacketsIfFull : {false,true}) {
+        std::atomic_size_t nWrittenCount(0), nWrittenSum(0);
+        lv::DataWriter oWriter([&](const cv::Mat& oPacket, size_t) {
+            ++nWrittenCount;
+            nWrittenSum += (size_t)oPacket.at<int>(0,0);
+            if(bDropPacketsIfFull)
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            return size_t(0);
+        });
+        ASSERT_TRUE(oWriter.startAsyncWriting(size_t(1),bDropPacketsIfFull,2));
+        ASSERT_TRUE(oWriter.isActive());
+        std::atomic_size_t nQueuedCount(0), nQueuedSum(0);
+        std::vector<std::thread> vProducers;
+        for(size_t nProducerIdx=0; nProducerIdx<nProducers; ++nProducerIdx) {
+            vProducers.emplace_back([&,nProducerIdx]() {
+                for(size_t nPacketIdx=0; nPacketIdx<nPacketsPerProducer; ++nPacketIdx) {
+                    const cv::Mat oPacket(256,256,CV_32SC1,cv::Scalar_<int>(int(nPacketIdx)));
+                    if(oWriter.queue(oPacket,nProducerIdx*nPacketsPerProducer+nPacketIdx)!=SIZE_MAX) {
+                        ++nQueuedCount;
+                        nQueuedSum += nPacketIdx;
+                    }
+                }
+            });
+        }
+        for(std::thread& oProducer : vProducers)
+            oProducer.join();
+        oWriter.stopAsyncWriting();
+        ASSERT_FALSE(oWriter.isActive());
+        if(!bDropPacketsIfFull)
+            ASSERT_EQ(nQueuedCount.load(),nProducers*nPacketsPerProducer);
+        ASSERT_EQ(nWrittenCount.load(),nQueuedCount.load());
+        ASSERT_EQ(nWrittenSum.load(),nQueuedSum.load());
+        ASSERT_EQ(oWriter.getCurrentQueueCount(),size_t(0));
+        ASSERT_EQ(oWriter.getCurrentQueueSize(),size_t(0));
+    }
+}
+
+TEST(datasets_writer,regression_order) {
+    lv::setVerbosity(0);
+    for(size_t nWorkers : {size_t(1),size_t(3)}) {
+        std::mutex oWrittenMutex;
+        std::vector<std::pair<size_t,int>> vWritten;
+        std::atomic_size_t nStarted(0);
+        std::atomic_bool bUnblocked(false);
+        lv::DataWriter oWriter([&](const cv::Mat& oPacket, size_t nIdx) {
+            ++nStarted;
+            while(!bUnblocked)
+                std::this_thread::yield();
+            lv::mutex_lock_guard oLock(oWrittenMutex);
+            vWritten.emplace_back(nIdx,oPacket.at<int>(0,0));
+            return size_t(0);
+        });
+        ASSERT_TRUE(oWriter.startAsyncWriting(size_t(1024*1024),false,nWorkers));
+        // all workers are kept busy while the next packets get queued in reverse order
+        for(size_t nWorkerIdx=0; nWorkerIdx<nWorkers; ++nWorkerIdx)
+            ASSERT_NE(oWriter.queue(cv::Mat(4,4,CV_32SC1,cv::Scalar_<int>(-1)),1000+nWorkerIdx),SIZE_MAX);
+        while(nStarted<nWorkers)
+            std::this_thread::yield();
+        const size_t nPacketCount = 50;
+        for(size_t nIdx=nPacketCount; nIdx>0; --nIdx)
+            ASSERT_NE(oWriter.queue(cv::Mat(4,4,CV_32SC1,cv::Scalar_<int>(int(nIdx-1))),nIdx-1),SIZE_MAX);
+        // re-queued idx should replace the pending packet instead of being written twice
+        ASSERT_NE(oWriter.queue(cv::Mat(4,4,CV_32SC1,cv::Scalar_<int>(-10)),10),SIZE_MAX);
+        bUnblocked = true;
+        oWriter.stopAsyncWriting();
+        ASSERT_EQ(vWritten.size(),nPacketCount+nWorkers);
+        std::map<size_t,int> mWritten;
+        for(const auto& oWritten : vWritten)
+            ASSERT_TRUE(mWritten.emplace(oWritten.first,oWritten.second).second);
+        for(size_t nIdx=0; nIdx<nPacketCount; ++nIdx)
+            ASSERT_EQ(mWritten[nIdx],nIdx==10?-10:int(nIdx));
+        if(nWorkers==1)
+            for(size_t nIdx=0; nIdx<nPacketCount; ++nIdx)
+                ASSERT_EQ(vWritten[nIdx+1].first,nIdx);
+        ASSERT_EQ(oWriter.getCurrentQueueCount(),size_t(0));
+        ASSERT_EQ(oWriter.getCurrentQueueSize(),size_t(0));
+    }
+}
+
+TEST(datasets_writer,regression_stop_race) {
+    lv::setVerbosity(0);
+    const size_t nProducers = 4, nPacketsPerProducer = 200;
+    for(size_t nRound=0; nRound<10; ++nRound) {
+        std::atomic_size_t nWrittenCount(0);
+        lv::DataWriter oWriter([&](const cv::Mat&, size_t) {
+            ++nWrittenCount;
+            return size_t(0);
+        });
+        ASSERT_TRUE(oWriter.startAsyncWriting(size_t(1024*1024),false,2));
+        std::vector<std::thread> vProducers;
+        for(size_t nProducerIdx=0; nProducerIdx<nProducers; ++nProducerIdx) {
+            vProducers.emplace_back([&,nProducerIdx]() {
+                for(size_t nPacketIdx=0; nPacketIdx<nPacketsPerProducer; ++nPacketIdx)
+                    oWriter.queue(cv::Mat(8,8,CV_32SC1,cv::Scalar_<int>(int(nPacketIdx))),nProducerIdx*nPacketsPerProducer+nPacketIdx);
+            });
+        }
+        // stopping while producers are still queuing must not strand any packet in the queue
+        std::this_thread::sleep_for(std::chrono::microseconds(rand()%500));
+        oWriter.stopAsyncWriting();
+        for(std::thread& oProducer : vProducers)
+            oProducer.join();
+        ASSERT_EQ(nWrittenCount.load(),nProducers*nPacketsPerProducer);
+        ASSERT_EQ(oWriter.getCurrentQueueCount(),size_t(0));
+        ASSERT_EQ(oWriter.getCurrentQueueSize(),size_t(0));
+    }
+}
+
 TEST(datasets_notarray,regression_specialization) {
     // ... @@@@ TODO
 }
\ No newline at end of file
@@ -18,6 +18,9 @@
 #pragma once
 
 #include "litiv/utils/opencv.hpp"
+#if USING_OPENMP
+#include <omp.h>
+#endif //USING_OPENMP
 
 // feature descriptor impls headers are included below
 
@@ -45,6 +48,40 @@ namespace lv {
         });
     }
 
+    /// calls 'lProcess(nSlotIdx,nItemIdx)' for all items in [0,nItems) using up to 'nMaxSlots' concurrent slots on the shared worker pool; each slot pulls items
+    /// one at a time, so per-slot state (e.g. extractor copies with their own scratch buffers) needs no locking (slot #0 always runs on the calling thread)
+    template<typename Tfunc>
+    inline void parallel_for_slots(size_t nItems, size_t nMaxSlots, Tfunc&& lProcess) {
+        const size_t nSlots = std::min(std::min(nItems,nMaxSlots),lv::getSharedWorkerPool().workers());
+        if(nSlots<=size_t(1)) {
+            for(size_t nItemIdx=0; nItemIdx<nItems; ++nItemIdx)
+                lProcess(size_t(0),nItemIdx);
+            return;
+        }
+    #if USING_OPENMP
+        // slots may run openmp-parallel impls concurrently, so their thread teams are shrunk to avoid oversubscription
+        const int nSlotThreads = std::max(omp_get_max_threads()/int(nSlots),1);
+    #endif //USING_OPENMP
+        std::atomic_size_t nNextItemIdx(0);
+        lv::getSharedWorkerPool().parallel_for(size_t(0),nSlots,[&](size_t nSlotIdx) {
+        #if USING_OPENMP
+            const int nPrevThreads = omp_get_max_threads();
+            omp_set_num_threads(nSlotThreads);
+            try {
+        #endif //USING_OPENMP
+                for(size_t nItemIdx=nNextItemIdx++; nItemIdx<nItems; nItemIdx=nNextItemIdx++)
+                    lProcess(nSlotIdx,nItemIdx);
+        #if USING_OPENMP
+            }
+            catch(...) {
+                omp_set_num_threads(nPrevThreads);
+                throw;
+            }
+            omp_set_num_threads(nPrevThreads);
+        #endif //USING_OPENMP
+        },size_t(1));
+    }
+
     /// helper struct containing joint & marginal probability histograms (dense/full-range version)
     template<bool bUseSparseMats, typename... TMatTypes>
     struct JointHistData {
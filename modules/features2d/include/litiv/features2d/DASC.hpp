@@ -70,6 +70,8 @@ public:
     bool isUsingRF() const;
     /// returns whether input images will be preprocessed using a gaussian filter or not
     bool isPreProcessing() const;
+    /// returns the peak scratch memory footprint (in bytes, excluding the output map) reached by the last dense computation
+    size_t getLastScratchSize() const;
 
     /// similar to DescriptorExtractor::compute(const cv::Mat& image, ...), but in this case, the descriptors matrix has the same shape as the input matrix, and all image points are described (note: descriptors close to borders will be invalid)
     void compute2(const cv::Mat& oImage, cv::Mat& oDescMap);
@@ -130,18 +132,20 @@ protected:
     const size_t m_nLUTSize;
 
 private:
-    /// helper/util function for recursive filtering
-    void recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef_V_dHdx, const cv::Mat_<float>& oRef_V_dVdy_t, cv::Mat_<float>& oOutput);
+    /// returns a new extractor with the same config (and its own scratch buffers) for concurrent batch processing
+    std::unique_ptr<DASC> createBatchWorker() const;
+    /// helper/util function for recursive filtering (horizontal weights are given in transposed layout)
+    void recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef_V_dHdx_t, const cv::Mat_<float>& oRef_V_dVdy, cv::Mat_<float>& oOutput);
     /// dense recursive filtering description approach impl
     void dasc_rf_impl(const cv::Mat& oImage, cv::Mat_<float>& oDescriptors);
     /// helper/util function for dense guided filtering
     void guidedFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef, cv::Mat_<float>& oOutput);
-    /// dense guided filtering description approach impl
+    /// dense guided filtering description approach impl (lookup pairs are filtered in batches, sharing the guide statistics)
     void dasc_gf_impl(const cv::Mat& oImage, cv::Mat_<float>& oDescriptors);
 
     // helper variables for internal impl (helps avoid continuous mem realloc)
     cv::Mat_<float> m_oTempTransp,m_oImageLocalDiff_Y,m_oImageLocalDiff_X;
-    cv::Mat_<float> m_oRef_dVdy,m_oRef_dHdx,m_oRef_V_dHdx,m_oRef_V_dVdy_t;
+    cv::Mat_<float> m_oRef_dVdy,m_oRef_dHdx,m_oRef_V_dHdx_t,m_oRef_V_dVdy;
     cv::Mat_<float> m_oImage_AdaptiveMean,m_oImage_AdaptiveMeanSqr;
     cv::Mat_<float> m_oLookupImage,m_oLookupImage_Sqr,m_oLookupImage_Mix;
     cv::Mat_<float> m_oLookupImage_AdaptiveMean,m_oLookupImage_AdaptiveMeanSqr,m_oLookupImage_AdaptiveMeanMix;
@@ -150,4 +154,5 @@ private:
     cv::Mat_<float> m_oNormVarDiff,m_oNormVarDiff_SubSampl,m_oNormVarDiff_SubSamplBlur;
     cv::Mat_<float> m_oNormVar,m_oNormVar_SubSampl,m_oNormVar_SubSamplBlur;
     cv::Size m_oImageSize,m_oSubSamplSize,m_oBlurKernelSize;
+    size_t m_nLastScratchSize;
 };
\ No newline at end of file
@@ -86,6 +86,9 @@ public:
     static void validateROI(cv::Mat& oROI);
     /// utility function, used to calculate per-desc Hamming distance between two descriptor sets/maps
     static void calcDistances(const cv::Mat& oDescriptors1, const cv::Mat& oDescriptors2, cv::Mat_<uchar>& oDistances);
+    /// utility function, used to calculate per-desc Hamming distances between two descriptor maps for a range of horizontal offsets (output is rows x cols x disps, desc2 is
+    /// sampled at col+disp, and out-of-bounds pairs are set to UCHAR_MAX)
+    static void calcDistances(const cv::Mat& oDescMap1, const cv::Mat& oDescMap2, const std::vector<int>& vDispRange, cv::Mat_<uchar>& oDistances);
 #if HAVE_GLSL
     /// utility function, returns the glsl source code required to describe an LBSP descriptor based on the image load store
     static std::string getShaderFunctionSource(size_t nChannels, bool bUseSharedDataPreload, const glm::uvec2& vWorkGroupSize);
@@ -183,6 +186,20 @@ public:
         });
     }
 
+    /// utility function, row-wise LBSP lookup function for a strip of contiguous pixels (multi-channel lookup only, same per-pixel layout as computeDescriptor_lookup)
+    template<size_t nChannels>
+    static inline void computeDescriptor_lookup_strip(const cv::Mat& oInputImg, const int _x, const int _y, const size_t nPxCount, uchar* aanVals) {
+        static_assert(nChannels>0,"need at least one image channel");
+        lvDbgAssert_(aanVals,"need to provide a valid pixel pointer");
+        lvDbgAssert__(!oInputImg.empty() && oInputImg.type()==CV_8UC(nChannels),"need to provide a non-empty matrix of %d channels",(int)nChannels);
+        lvDbgAssert__(_x>=(int)LBSP::PATCH_SIZE/2 && _y>=(int)LBSP::PATCH_SIZE/2,"descriptor centers need to be at least %d pixels from image borders",(int)LBSP::PATCH_SIZE/2);
+        lvDbgAssert__(_x+(int)nPxCount<=oInputImg.cols-(int)LBSP::PATCH_SIZE/2 && _y<oInputImg.rows-(int)LBSP::PATCH_SIZE/2,"descriptor centers need to be at least %d pixels from image borders",(int)LBSP::PATCH_SIZE/2);
+        const size_t nRowStep = oInputImg.step.p[0];
+        const size_t nColStep = oInputImg.step.p[1];
+        const uchar* const anData = oInputImg.data+_y*nRowStep+_x*nColStep;
+        LBSP::lookup_16bits_dbcross_strip(anData,nRowStep,nColStep,nPxCount*nChannels,aanVals);
+    }
+
     /// utility function, shortcut/lightweight/direct single-point LBSP computation function for extra flexibility (array thresholding only)
     static inline desc_t computeDescriptor_threshold(const std::array<uchar,LBSP::DESC_SIZE_BITS>& anVals, const uchar nRef, const uchar nThreshold) {
         static_assert(sizeof(std::array<uchar,LBSP::DESC_SIZE_BITS>)==sizeof(uchar)*LBSP::DESC_SIZE_BITS,"terrible impl of std::array right here");
@@ -223,6 +240,33 @@ public:
 #endif //(HAVE_SSE4_1 || HAVE_SSE2)
     }
 
+    /// utility function, row-wise LBSP computation function for a strip of contiguous pixels (all channels are described independently, and refs/thresholds/descs are given in interleaved order)
+    template<size_t nChannels>
+    static inline void computeDescriptor_strip(const cv::Mat& oInputImg, const int _x, const int _y, const size_t nPxCount, const uchar* const anRefs, const uchar* const anThresholds, desc_t* const anDesc) {
+        static_assert(nChannels>0,"need at least one image channel");
+        lvDbgAssert_(anRefs && anThresholds && anDesc,"need to provide valid ref/threshold/desc pointers");
+        lvDbgAssert__(!oInputImg.empty() && oInputImg.type()==CV_8UC(nChannels),"need to provide a non-empty matrix of %d channels",(int)nChannels);
+        lvDbgAssert__(_x>=(int)LBSP::PATCH_SIZE/2 && _y>=(int)LBSP::PATCH_SIZE/2,"descriptor centers need to be at least %d pixels from image borders",(int)LBSP::PATCH_SIZE/2);
+        lvDbgAssert__(_x+(int)nPxCount<=oInputImg.cols-(int)LBSP::PATCH_SIZE/2 && _y<oInputImg.rows-(int)LBSP::PATCH_SIZE/2,"descriptor centers need to be at least %d pixels from image borders",(int)LBSP::PATCH_SIZE/2);
+        const size_t nRowStep = oInputImg.step.p[0];
+        const size_t nColStep = oInputImg.step.p[1];
+        const uchar* const anData = oInputImg.data+_y*nRowStep+_x*nColStep;
+        LBSP::threshold_16bits_dbcross_strip(anData,nRowStep,nColStep,anRefs,anThresholds,nPxCount*nChannels,anDesc);
+    }
+
+    /// utility function, row-wise LBSP computation function for a strip of contiguous pixels, using a per-intensity threshold LUT (with the input image as ref)
+    template<size_t nChannels>
+    static inline void computeDescriptor_strip(const cv::Mat& oInputImg, const int _x, const int _y, const size_t nPxCount, const std::array<uchar,UCHAR_MAX+1>& anThresholdLUT, desc_t* const anDesc) {
+        static_assert(nChannels>0,"need at least one image channel");
+        static thread_local lv::AutoBuffer<uchar> s_aThresholds;
+        const size_t nValCount = nPxCount*nChannels;
+        s_aThresholds.resize(nValCount);
+        const uchar* const anRefs = oInputImg.ptr<uchar>(_y,_x);
+        for(size_t nValIdx=0; nValIdx<nValCount; ++nValIdx)
+            s_aThresholds[nValIdx] = anThresholdLUT[anRefs[nValIdx]];
+        LBSP::computeDescriptor_strip<nChannels>(oInputImg,_x,_y,nPxCount,anRefs,s_aThresholds.data(),anDesc);
+    }
+
     /// utility function, shortcut/lightweight/direct single-point LBSP gradient computation function (mixes rel+abs, returns max-channel only)
     template<size_t nChannels, size_t nAbsOffset=20, size_t nRelShift=2, typename Tr1=int, typename Tr2=uint>
     static inline void computeDescriptor_gradient(const std::array<std::array<uchar,DESC_SIZE_BITS>,nChannels>& aanVals, const std::array<uchar,nChannels>& anRefs, Tr1& nGradX, Tr1& nGradY, Tr2& nGradMag) {
@@ -317,4 +361,88 @@ protected:
         });
 //#endif //(!HAVE_SSE2)
     }
+
+    /// looks up the dbcross pattern of 'nCount' contiguous values (with a distance of 'nColStep' between pattern columns), 16 values at a time with SSE2
+    static inline void lookup_16bits_dbcross_strip(const uchar* const anData, const size_t nRowStep, const size_t nColStep, const size_t nCount, uchar* const aanVals) {
+        static_assert(LBSP::DESC_SIZE_BITS==16,"current strip impl can only manage 16-bit descriptors");
+        lvDbgAssert_(anData && aanVals,"need to provide valid data pointers");
+        size_t nIter = 0;
+#if HAVE_SSE2
+        std::array<ptrdiff_t,LBSP::DESC_SIZE_BITS> anOffsets;
+        lv::unroll<LBSP::DESC_SIZE_BITS>([&](int n) {
+            anOffsets[n] = ptrdiff_t(nRowStep)*s_oIdxLUT_16bitdbcross_y.anOffsets[n]+ptrdiff_t(nColStep)*s_oIdxLUT_16bitdbcross_x.anOffsets[n];
+        });
+        for(; nIter+16<=nCount; nIter+=16) {
+            // each pattern offset gives 16 contiguous values; a 16x16 byte transpose turns them into 16 per-value patterns
+            __m128i _aanRows[16];
+            lv::unroll<16>([&](int n) {
+                _aanRows[n] = _mm_loadu_si128((const __m128i*)(anData+nIter+anOffsets[n]));
+            });
+            lv::unroll<8>([&](int n) {
+                const __m128i _anLow = _mm_unpacklo_epi8(_aanRows[n*2],_aanRows[n*2+1]);
+                _aanRows[n*2+1] = _mm_unpackhi_epi8(_aanRows[n*2],_aanRows[n*2+1]);
+                _aanRows[n*2] = _anLow;
+            });
+            __m128i _aanTmp[16];
+            lv::unroll<4>([&](int n) {
+                _aanTmp[n*4+0] = _mm_unpacklo_epi16(_aanRows[n*4+0],_aanRows[n*4+2]);
+                _aanTmp[n*4+1] = _mm_unpackhi_epi16(_aanRows[n*4+0],_aanRows[n*4+2]);
+                _aanTmp[n*4+2] = _mm_unpacklo_epi16(_aanRows[n*4+1],_aanRows[n*4+3]);
+                _aanTmp[n*4+3] = _mm_unpackhi_epi16(_aanRows[n*4+1],_aanRows[n*4+3]);
+            });
+            lv::unroll<2>([&](int n) {
+                lv::unroll<4>([&](int m) {
+                    _aanRows[n*8+m*2+0] = _mm_unpacklo_epi32(_aanTmp[n*8+m],_aanTmp[n*8+m+4]);
+                    _aanRows[n*8+m*2+1] = _mm_unpackhi_epi32(_aanTmp[n*8+m],_aanTmp[n*8+m+4]);
+                });
+            });
+            // rows now hold 4 value patterns split in 4-byte chunks over the 4 row groups; the last stage merges the 64-bit halves
+            lv::unroll<8>([&](int n) {
+                _mm_storeu_si128((__m128i*)(aanVals+(nIter+n*2+0)*LBSP::DESC_SIZE_BITS),_mm_unpacklo_epi64(_aanRows[n],_aanRows[n+8]));
+                _mm_storeu_si128((__m128i*)(aanVals+(nIter+n*2+1)*LBSP::DESC_SIZE_BITS),_mm_unpackhi_epi64(_aanRows[n],_aanRows[n+8]));
+            });
+        }
+#endif //HAVE_SSE2
+        for(; nIter<nCount; ++nIter)
+            LBSP::lookup_16bits_dbcross<1>(anData+nIter,nRowStep,nColStep,aanVals+nIter*LBSP::DESC_SIZE_BITS);
+    }
+
+    /// thresholds the dbcross pattern of 'nCount' contiguous values (with a distance of 'nColStep' between pattern columns), 32 values at a time with AVX2
+    static inline void threshold_16bits_dbcross_strip(const uchar* const anData, const size_t nRowStep, const size_t nColStep, const uchar* const anRefs, const uchar* const anThresholds, const size_t nCount, desc_t* const anDesc) {
+        static_assert(LBSP::DESC_SIZE_BITS==16,"current strip impl can only manage 16-bit descriptors");
+        lvDbgAssert_(anData && anRefs && anThresholds && anDesc,"need to provide valid data pointers");
+        size_t nIter = 0;
+#if HAVE_AVX2
+        std::array<ptrdiff_t,LBSP::DESC_SIZE_BITS> anOffsets;
+        lv::unroll<LBSP::DESC_SIZE_BITS>([&](int n) {
+            anOffsets[n] = ptrdiff_t(nRowStep)*s_oIdxLUT_16bitdbcross_y.anOffsets[n]+ptrdiff_t(nColStep)*s_oIdxLUT_16bitdbcross_x.anOffsets[n];
+        });
+        for(; nIter+32<=nCount; nIter+=32) {
+            const __m256i _anRefVals = _mm256_loadu_si256((const __m256i*)(anRefs+nIter));
+            const __m256i _anThresholds = _mm256_loadu_si256((const __m256i*)(anThresholds+nIter));
+            // returns the n-th descriptor bit (at its position in the byte) for all 32 values, i.e. (|val-ref|>threshold)<<(n%8)
+            const auto lGetDescBits = [&](int n) {
+                const __m256i _anInputVals = _mm256_loadu_si256((const __m256i*)(anData+nIter+anOffsets[n]));
+                const __m256i _anDistVals = _mm256_or_si256(_mm256_subs_epu8(_anInputVals,_anRefVals),_mm256_subs_epu8(_anRefVals,_anInputVals));
+                const __m256i _abNotGreater = _mm256_cmpeq_epi8(_mm256_max_epu8(_anDistVals,_anThresholds),_anThresholds);
+                return _mm256_andnot_si256(_abNotGreater,_mm256_set1_epi8(char(1<<(n%8))));
+            };
+            __m256i _anDescLowBytes = _mm256_setzero_si256(), _anDescHighBytes = _mm256_setzero_si256();
+            lv::unroll<8>([&](int n) {
+                _anDescLowBytes = _mm256_or_si256(_anDescLowBytes,lGetDescBits(n));
+                _anDescHighBytes = _mm256_or_si256(_anDescHighBytes,lGetDescBits(n+8));
+            });
+            // byte interleaving works per 128-bit lane, so lanes must be reordered before storing
+            const __m256i _anDescs_0_7_16_23 = _mm256_unpacklo_epi8(_anDescLowBytes,_anDescHighBytes);
+            const __m256i _anDescs_8_15_24_31 = _mm256_unpackhi_epi8(_anDescLowBytes,_anDescHighBytes);
+            _mm256_storeu_si256((__m256i*)(anDesc+nIter),_mm256_permute2x128_si256(_anDescs_0_7_16_23,_anDescs_8_15_24_31,0x20));
+            _mm256_storeu_si256((__m256i*)(anDesc+nIter+16),_mm256_permute2x128_si256(_anDescs_0_7_16_23,_anDescs_8_15_24_31,0x31));
+        }
+#endif //HAVE_AVX2
+        for(; nIter<nCount; ++nIter) {
+            alignas(16) std::array<uchar,LBSP::DESC_SIZE_BITS> anVals;
+            LBSP::lookup_16bits_dbcross<1>(anData+nIter,nRowStep,nColStep,anVals.data());
+            anDesc[nIter] = LBSP::computeDescriptor_threshold(anVals.data(),anRefs[nIter],anThresholds[nIter]);
+        }
+    }
 };
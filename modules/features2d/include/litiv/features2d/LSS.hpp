@@ -143,7 +143,7 @@ protected:
 private:
     /// keypoint-based description approach impl
     void ssdescs_impl(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoints, cv::Mat_<float>& oDescriptors, bool bGenDescMap);
-    /// dense description approach impl
+    /// dense description approach impl (computes each lookup offset's ssd surface once for the whole image)
     void ssdescs_impl(const cv::Mat& oImage, cv::Mat_<float>& oDescriptors);
     /// descriptor normalisation approach impl
     void ssdescs_norm(cv::Mat_<float>& oDescriptors) const;
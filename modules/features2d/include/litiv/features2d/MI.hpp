@@ -38,6 +38,10 @@ public:
     void compute(const cv::Mat& oImage1, const cv::Mat& oImage2, const std::vector<cv::KeyPoint>& voKeypoints, std::vector<double>& vdScores);
     /// returns the mutual information scores for the given keypoints located in the image pair using subwindows of the size passed in constructor (inline version)
     std::vector<double> compute(const cv::Mat& oImage1, const cv::Mat& oImage2, const std::vector<cv::KeyPoint>& voKeypoints);
+    /// returns a dense (rows x cols x disps) map of mutual information scores between the windows of image1 and the windows of image2 offset by each disparity (in cols);
+    /// joint histograms are updated one window column at a time while sliding along rows, and pixels without a valid window pair or outside the ROIs are set to -1
+    void compute2(const cv::Mat& oImage1, const cv::Mat& oImage2, const std::vector<int>& vDispRange, cv::Mat_<float>& oScoreMap,
+                  const cv::Mat_<uchar>& oROI1=cv::Mat(), const cv::Mat_<uchar>& oROI2=cv::Mat());
     /// utility function, used to filter out bad keypoints that would trigger out of bounds error because they're too close to the image border
     void validateKeyPoints(std::vector<cv::KeyPoint>& voKeypoints, cv::Size oImgSize) const;
     /// utility function, used to filter out bad pixels in a ROI that would trigger out of bounds error because they're too close to the image border
@@ -97,6 +97,9 @@ public:
     void compute2(const cv::Mat& oImage, cv::Mat& oDescMap);
     /// similar to DescriptorExtractor::compute(const cv::Mat& image, ...), but in this case, the descriptors matrix has the same shape as the input matrix, and all image points are described (note: descriptors close to borders will be invalid)
     void compute2(const cv::Mat& oImage, cv::Mat_<float>& oDescMap);
+    /// incremental version of compute2(oImage,oDescMap) for temporally coherent inputs: oDescMap must hold the map previously computed for the input whose contour points are
+    /// given in oPrevContourPts (updated on return), and only descriptors whose support region touched a changed contour point (inside oUpdateROI, if not empty) are recomputed
+    void compute2(const cv::Mat& oImage, cv::Mat_<float>& oDescMap, cv::Mat_<cv::Point2f>& oPrevContourPts, const cv::Rect& oUpdateROI=cv::Rect());
     /// similar to DescriptorExtractor::compute(const cv::Mat& image, ...), but in this case, the descriptors matrix has the same shape as the input matrix
     void compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoints, cv::Mat_<float>& oDescMap);
     /// batch version of LBSP::compute2(const cv::Mat& image, ...)
@@ -179,6 +182,10 @@ protected:
 
 private:
 
+    /// returns the maximum number of images that can be described concurrently in batch calls
+    size_t getBatchSlotCount() const;
+    /// returns a copy of this extractor which shares its lookup masks but owns its per-image buffers, for concurrent batch processing
+    std::unique_ptr<ShapeContext> createBatchWorker() const;
     /// generates radius limits mask using internal parameters
     void scdesc_generate_radmask();
     /// generates angle limits mask using internal parameters
@@ -193,8 +200,10 @@ private:
     void scdesc_fill_desc(cv::Mat_<float>& oDescriptors, bool bGenDescMap);
     /// fills descriptor without using internal maps (only for absolute descs w/o rot inv)
     void scdesc_fill_desc_direct(cv::Mat_<float>& oDescriptors, bool bGenDescMap);
-    /// descriptor normalisation approach impl
-    void scdesc_norm(cv::Mat_<float>& oDescriptors) const;
+    /// fills dense descriptor map bins by scattering contour points, only updating pixels in the mask if one is given (only for absolute descs w/o rot inv)
+    void scdesc_fill_desc_scatter(cv::Mat_<float>& oDescriptors, const cv::Mat_<uchar>& oUpdateMask=cv::Mat_<uchar>());
+    /// descriptor normalisation approach impl (only normalizes descriptors of pixels in the mask if one is given)
+    void scdesc_norm(cv::Mat_<float>& oDescriptors, const cv::Mat_<uchar>& oUpdateMask=cv::Mat_<uchar>()) const;
 
     // helper variables for internal impl (helps avoid continuous mem realloc)
     std::vector<double> m_vAngularLimits,m_vRadialLimits;
@@ -18,6 +18,8 @@
 #include "litiv/features2d.hpp"
 
 #define LOCAL_EPS (1e-10)
+#define GF_LUT_BATCH_SIZE (4) // number of lookup pairs filtered per batched guided filter pass
+#define GF_TILE_ROWS (16) // number of (subsampled) rows owned by each batched guided filter tile
 
 // @@@@ test with nan in oob lookup
 
@@ -65,7 +67,8 @@ DASC::DASC(float fSigma_s, float fSigma_r, size_t nIters, bool bPreProcess) :
         m_nRadius(),
         m_fEpsilon(),
         m_nSubSamplFrac(),
-        m_nLUTSize(pretrained::nLUTSize) {
+        m_nLUTSize(pretrained::nLUTSize),
+        m_nLastScratchSize(0) {
     lvAssert_(fSigma_s>0.0f && fSigma_r>0.0f && nIters>0,"invalid parameter(s)");
 }
 
@@ -78,7 +81,8 @@ DASC::DASC(size_t nRadius, float fEpsilon, size_t nSubSamplFrac, bool bPreProces
         m_nRadius(nRadius),
         m_fEpsilon(fEpsilon),
         m_nSubSamplFrac(nSubSamplFrac),
-        m_nLUTSize(pretrained::nLUTSize) {
+        m_nLUTSize(pretrained::nLUTSize),
+        m_nLastScratchSize(0) {
     lvAssert_(nRadius>0 && fEpsilon>0.0f && nSubSamplFrac>0 && nRadius>=nSubSamplFrac,"invalid parameter(s)");
 }
 
@@ -133,6 +137,10 @@ bool DASC::isPreProcessing() const {
     return m_bPreProcess;
 }
 
+size_t DASC::getLastScratchSize() const {
+    return m_nLastScratchSize;
+}
+
 void DASC::compute2(const cv::Mat& oImage, cv::Mat& oDescMap_) {
     lvAssert_(oDescMap_.empty() || oDescMap_.type()==CV_32FC1,"wrong output desc map type");
     cv::Mat_<float> oDescMap = oDescMap_;
@@ -165,15 +173,33 @@ void DASC::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoint
 
 void DASC::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],voDescMapCollection[i]);
+    // intermediate maps are kept in member buffers, so each extra slot lazily gets its own extractor (reused for all the images it processes)
+    std::vector<std::unique_ptr<DASC>> vpSlotExtractors(lv::getSharedWorkerPool().workers());
+    lv::parallel_for_slots(voImageCollection.size(),vpSlotExtractors.size(),[&](size_t nSlotIdx, size_t nImageIdx) {
+        if(nSlotIdx>0 && !vpSlotExtractors[nSlotIdx])
+            vpSlotExtractors[nSlotIdx] = createBatchWorker();
+        DASC& oExtractor = (nSlotIdx==0)?*this:*vpSlotExtractors[nSlotIdx];
+        oExtractor.compute2(voImageCollection[nImageIdx],voDescMapCollection[nImageIdx]);
+    });
 }
 
 void DASC::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<std::vector<cv::KeyPoint> >& vvoPointCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     lvAssert_(voImageCollection.size()==vvoPointCollection.size(),"number of images must match number of keypoint lists");
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],vvoPointCollection[i],voDescMapCollection[i]);
+    std::vector<std::unique_ptr<DASC>> vpSlotExtractors(lv::getSharedWorkerPool().workers());
+    lv::parallel_for_slots(voImageCollection.size(),vpSlotExtractors.size(),[&](size_t nSlotIdx, size_t nImageIdx) {
+        if(nSlotIdx>0 && !vpSlotExtractors[nSlotIdx])
+            vpSlotExtractors[nSlotIdx] = createBatchWorker();
+        DASC& oExtractor = (nSlotIdx==0)?*this:*vpSlotExtractors[nSlotIdx];
+        oExtractor.compute2(voImageCollection[nImageIdx],vvoPointCollection[nImageIdx],voDescMapCollection[nImageIdx]);
+    });
+}
+
+std::unique_ptr<DASC> DASC::createBatchWorker() const {
+    if(m_bUsingRF)
+        return std::make_unique<DASC>(m_fSigma_s,m_fSigma_r,m_nIters,m_bPreProcess);
+    else
+        return std::make_unique<DASC>(m_nRadius,m_fEpsilon,m_nSubSamplFrac,m_bPreProcess);
 }
 
 void DASC::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMask, std::vector<cv::KeyPoint>& voKeypoints, cv::OutputArray _oDescriptors, bool bUseProvidedKeypoints) {
@@ -258,26 +284,152 @@ void DASC::calcDistances(const cv::Mat_<float>& oDescriptors1, const cv::Mat_<fl
     }
 }
 
-void DASC::recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef_V_dHdx, const cv::Mat_<float>& oRef_V_dVdy_t, cv::Mat_<float>& oOutput) {
-    lvDbgAssert(!oImage.empty() && !oRef_V_dHdx.empty() && !oRef_V_dHdx.empty() && m_nIters>0 && oImage.dims==2 && oRef_V_dHdx.dims==3 && oRef_V_dVdy_t.dims==3);
-    lvDbgAssert(oImage.rows==oRef_V_dHdx.size[1] && oImage.rows==oRef_V_dVdy_t.size[2] && oImage.cols==oRef_V_dHdx.size[2] && oImage.cols==oRef_V_dVdy_t.size[1]);
-    lvDbgAssert(oRef_V_dHdx.size[0]==(int)m_nIters && oRef_V_dVdy_t.size[0]==(int)m_nIters);
-    oImage.copyTo(oOutput);
-    const auto lTransfDomRecursFilter_H = [](cv::Mat_<float>& _oImage, const cv::Mat_<float>& oRef, int nIterIdx) {
-        lvDbgAssert(!_oImage.empty() && _oImage.dims==2 && !oRef.empty() && oRef.dims==3);
-        lvDbgAssert(_oImage.rows==oRef.size[1] && _oImage.cols==oRef.size[2]);
-        for(int nRowIdx=0; nRowIdx<_oImage.rows; ++nRowIdx) {
-            for(int nColIdx=1; nColIdx<_oImage.cols; ++nColIdx)
-                _oImage(nRowIdx,nColIdx) += oRef(nIterIdx,nRowIdx,nColIdx)*(_oImage(nRowIdx,nColIdx-1)-_oImage(nRowIdx,nColIdx));
-            for(int nColIdx=_oImage.cols-2; nColIdx>=0; --nColIdx)
-                _oImage(nRowIdx,nColIdx) += oRef(nIterIdx,nRowIdx,nColIdx+1)*(_oImage(nRowIdx,nColIdx+1)-_oImage(nRowIdx,nColIdx));
+namespace {
+
+    /// returns the total byte size of a set of (possibly empty) matrices
+    size_t getMatBytes(std::initializer_list<const cv::Mat*> lpMats) {
+        size_t nBytes = 0u;
+        for(const cv::Mat* pMat : lpMats)
+            nBytes += pMat->total()*pMat->elemSize();
+        return nBytes;
+    }
+
+    /// normalized box filter over an interleaved multi-channel row band using running sums (mirrors cv::blur with BORDER_REFLECT_101)
+    void boxFilterRowBand(const float* pSrc, int nSrcFirstRow, float* pDst, int nDstFirstRow, int nDstEndRow, int nRows, int nCols, int nChannels, int nRadius) {
+        lvDbgAssert(pSrc && pDst && nDstFirstRow<nDstEndRow && nRows>0 && nCols>0 && nChannels>0 && nRadius>0);
+        static thread_local lv::AutoBuffer<double> s_aColSums,s_aRowSums;
+        const size_t nRowElems = size_t(nCols)*nChannels;
+        s_aColSums.resize(nRowElems);
+        s_aRowSums.resize(size_t(nChannels));
+        double* aColSums = s_aColSums.data();
+        double* aRowSums = s_aRowSums.data();
+        const double dNorm = 1.0/((nRadius*2+1)*(nRadius*2+1));
+        const auto lSrcRow = [&](int nRowIdx) {
+            return pSrc+size_t(cv::borderInterpolate(nRowIdx,nRows,cv::BORDER_REFLECT_101)-nSrcFirstRow)*nRowElems;
+        };
+        const auto lColOffset = [&](int nColIdx) {
+            return size_t(cv::borderInterpolate(nColIdx,nCols,cv::BORDER_REFLECT_101))*nChannels;
+        };
+        std::fill_n(aColSums,nRowElems,0.0);
+        for(int nRowIdx=nDstFirstRow-nRadius; nRowIdx<=nDstFirstRow+nRadius; ++nRowIdx) {
+            const float* pSrcRow = lSrcRow(nRowIdx);
+            for(size_t nElemIdx=0; nElemIdx<nRowElems; ++nElemIdx)
+                aColSums[nElemIdx] += pSrcRow[nElemIdx];
         }
+        for(int nRowIdx=nDstFirstRow; nRowIdx<nDstEndRow; ++nRowIdx) {
+            if(nRowIdx>nDstFirstRow) {
+                const float* pAddRow = lSrcRow(nRowIdx+nRadius);
+                const float* pSubRow = lSrcRow(nRowIdx-nRadius-1);
+                for(size_t nElemIdx=0; nElemIdx<nRowElems; ++nElemIdx)
+                    aColSums[nElemIdx] += double(pAddRow[nElemIdx])-pSubRow[nElemIdx];
+            }
+            float* pDstRow = pDst+size_t(nRowIdx-nDstFirstRow)*nRowElems;
+            std::fill_n(aRowSums,nChannels,0.0);
+            for(int nColIdx=-nRadius; nColIdx<=nRadius; ++nColIdx) {
+                const double* pColSums = aColSums+lColOffset(nColIdx);
+                for(int nChIdx=0; nChIdx<nChannels; ++nChIdx)
+                    aRowSums[nChIdx] += pColSums[nChIdx];
+            }
+            for(int nChIdx=0; nChIdx<nChannels; ++nChIdx)
+                pDstRow[nChIdx] = float(aRowSums[nChIdx]*dNorm);
+            for(int nColIdx=1; nColIdx<nCols; ++nColIdx) {
+                const double* pAddCol = aColSums+lColOffset(nColIdx+nRadius);
+                const double* pSubCol = aColSums+lColOffset(nColIdx-nRadius-1);
+                float* pDstPx = pDstRow+size_t(nColIdx)*nChannels;
+                for(int nChIdx=0; nChIdx<nChannels; ++nChIdx) {
+                    aRowSums[nChIdx] += pAddCol[nChIdx]-pSubCol[nChIdx];
+                    pDstPx[nChIdx] = float(aRowSums[nChIdx]*dNorm);
+                }
+            }
+        }
+    }
+
+    /// bilinear upsampling lookup (mirrors cv::resize with INTER_LINEAR for float data)
+    struct LinearLookup {
+        int nIdx0,nIdx1;
+        float fAlpha;
     };
+
+    /// fills the bilinear upsampling lookups for one axis
+    void fillLinearLookups(int nSrcSize, int nDstSize, std::vector<LinearLookup>& vLookups) {
+        vLookups.resize(size_t(nDstSize));
+        const double dScale = double(nSrcSize)/nDstSize;
+        for(int nDstIdx=0; nDstIdx<nDstSize; ++nDstIdx) {
+            float fPos = float((nDstIdx+0.5)*dScale-0.5);
+            int nSrcIdx = cvFloor(fPos);
+            fPos -= nSrcIdx;
+            if(nSrcIdx<0)
+                fPos = 0.0f, nSrcIdx = 0;
+            if(nSrcIdx>=nSrcSize-1)
+                fPos = 0.0f, nSrcIdx = nSrcSize-1;
+            vLookups[nDstIdx] = {nSrcIdx,std::min(nSrcIdx+1,nSrcSize-1),fPos};
+        }
+    }
+
+    /// fills the nearest-neighbor downsampling lookups for one axis (mirrors cv::resize with INTER_NEAREST)
+    void fillNearestLookups(int nSrcSize, int nDstSize, std::vector<int>& vnLookups) {
+        vnLookups.resize(size_t(nDstSize));
+        const double dScale = 1.0/(double(nDstSize)/nSrcSize);
+        for(int nDstIdx=0; nDstIdx<nDstSize; ++nDstIdx)
+            vnLookups[nDstIdx] = std::min(cvFloor(nDstIdx*dScale),nSrcSize-1);
+    }
+
+    /// applies one recursive filter update (curr += weight*(prev-curr)) over a contiguous row segment
+    inline void recursFilterRowStep(float* pCurr, const float* pPrev, const float* pWeights, int nCount) {
+        int nIdx = 0;
+#if HAVE_AVX
+        for(; nIdx+8<=nCount; nIdx+=8) {
+            const __m256 afCurr = _mm256_loadu_ps(pCurr+nIdx);
+            const __m256 afDiff = _mm256_sub_ps(_mm256_loadu_ps(pPrev+nIdx),afCurr);
+            _mm256_storeu_ps(pCurr+nIdx,_mm256_add_ps(afCurr,_mm256_mul_ps(_mm256_loadu_ps(pWeights+nIdx),afDiff)));
+        }
+#endif //HAVE_AVX
+#if HAVE_SSE
+        for(; nIdx+4<=nCount; nIdx+=4) {
+            const __m128 afCurr = _mm_loadu_ps(pCurr+nIdx);
+            const __m128 afDiff = _mm_sub_ps(_mm_loadu_ps(pPrev+nIdx),afCurr);
+            _mm_storeu_ps(pCurr+nIdx,_mm_add_ps(afCurr,_mm_mul_ps(_mm_loadu_ps(pWeights+nIdx),afDiff)));
+        }
+#endif //HAVE_SSE
+        for(; nIdx<nCount; ++nIdx)
+            pCurr[nIdx] += pWeights[nIdx]*(pPrev[nIdx]-pCurr[nIdx]);
+    }
+
+    /// runs the forward+backward domain transform recursion along the rows of the image, with all columns filtered in lock-step (column strips are split across threads)
+    void recursFilterVert(cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef, int nIterIdx) {
+        lvDbgAssert(!oImage.empty() && oImage.dims==2 && !oRef.empty() && oRef.dims==3);
+        lvDbgAssert(oImage.rows==oRef.size[1] && oImage.cols==oRef.size[2]);
+        const int nRows = oImage.rows;
+        const int nCols = oImage.cols;
+        constexpr int nStripWidth = 64; // keeps each strip's row segments within a few cache lines
+        const int nStrips = (nCols+nStripWidth-1)/nStripWidth;
+#if USING_OPENMP
+        #pragma omp parallel for if(nStrips>1 && nRows*nCols>=64*64)
+#endif //USING_OPENMP
+        for(int nStripIdx=0; nStripIdx<nStrips; ++nStripIdx) {
+            const int nColIdx = nStripIdx*nStripWidth;
+            const int nCount = std::min(nStripWidth,nCols-nColIdx);
+            for(int nRowIdx=1; nRowIdx<nRows; ++nRowIdx)
+                recursFilterRowStep(oImage.ptr<float>(nRowIdx)+nColIdx,oImage.ptr<float>(nRowIdx-1)+nColIdx,oRef.ptr<float>(nIterIdx,nRowIdx)+nColIdx,nCount);
+            for(int nRowIdx=nRows-2; nRowIdx>=0; --nRowIdx)
+                recursFilterRowStep(oImage.ptr<float>(nRowIdx)+nColIdx,oImage.ptr<float>(nRowIdx+1)+nColIdx,oRef.ptr<float>(nIterIdx,nRowIdx+1)+nColIdx,nCount);
+        }
+    }
+
+} // anonymous namespace
+
+void DASC::recursFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef_V_dHdx_t, const cv::Mat_<float>& oRef_V_dVdy, cv::Mat_<float>& oOutput) {
+    lvDbgAssert(!oImage.empty() && !oRef_V_dHdx_t.empty() && !oRef_V_dVdy.empty() && m_nIters>0 && oImage.dims==2 && oRef_V_dHdx_t.dims==3 && oRef_V_dVdy.dims==3);
+    lvDbgAssert(oImage.rows==oRef_V_dHdx_t.size[2] && oImage.rows==oRef_V_dVdy.size[1] && oImage.cols==oRef_V_dHdx_t.size[1] && oImage.cols==oRef_V_dVdy.size[2]);
+    lvDbgAssert(oRef_V_dHdx_t.size[0]==(int)m_nIters && oRef_V_dVdy.size[0]==(int)m_nIters);
+    // horizontal passes are done on the transposed image so that both passes vectorize over contiguous rows
+    cv::transpose(oImage,m_oTempTransp);
     for(int nIterIdx=0; nIterIdx<(int)m_nIters; ++nIterIdx) {
-        lTransfDomRecursFilter_H(oOutput,oRef_V_dHdx,nIterIdx);
-        cv::transpose(oOutput,m_oTempTransp);
-        lTransfDomRecursFilter_H(m_oTempTransp,oRef_V_dVdy_t,nIterIdx);
+        if(nIterIdx>0)
+            cv::transpose(oOutput,m_oTempTransp);
+        recursFilterVert(m_oTempTransp,oRef_V_dHdx_t,nIterIdx);
         cv::transpose(m_oTempTransp,oOutput);
+        recursFilterVert(oOutput,oRef_V_dVdy,nIterIdx);
     }
 }
 
@@ -302,21 +454,21 @@ void DASC::dasc_rf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
     lv::localDiff<0,1>(oImage,m_oImageLocalDiff_X);
     m_oRef_dVdy = 1.0f + m_fSigma_s/m_fSigma_r*cv::abs(m_oImageLocalDiff_Y);
     m_oRef_dHdx = 1.0f + m_fSigma_s/m_fSigma_r*cv::abs(m_oImageLocalDiff_X);
-    const std::array<int,3> anRefDims = {(int)m_nIters,nRows,nCols};
-    m_oRef_V_dHdx.create(3,anRefDims.data());
     const std::array<int,3> anRefDims_t = {(int)m_nIters,nCols,nRows};
-    m_oRef_V_dVdy_t.create(3,anRefDims_t.data());
+    m_oRef_V_dHdx_t.create(3,anRefDims_t.data());
+    const std::array<int,3> anRefDims = {(int)m_nIters,nRows,nCols};
+    m_oRef_V_dVdy.create(3,anRefDims.data());
     for(int nIterIdx=0; nIterIdx<(int)m_nIters; ++nIterIdx) {
         const float fBase = std::exp(-std::sqrt(2.0f)/(m_fSigma_s*std::sqrt(3.0f)*(float)std::pow(2.0f,(int)m_nIters-(nIterIdx+1))/std::sqrt((float)std::pow(4.0f,(int)m_nIters)-1)));
         for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
             for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
-                m_oRef_V_dHdx(nIterIdx,nRowIdx,nColIdx) = std::pow(fBase,m_oRef_dHdx(nRowIdx,nColIdx));
-                m_oRef_V_dVdy_t(nIterIdx,nColIdx,nRowIdx) = std::pow(fBase,m_oRef_dVdy(nRowIdx,nColIdx));
+                m_oRef_V_dHdx_t(nIterIdx,nColIdx,nRowIdx) = std::pow(fBase,m_oRef_dHdx(nRowIdx,nColIdx));
+                m_oRef_V_dVdy(nIterIdx,nRowIdx,nColIdx) = std::pow(fBase,m_oRef_dVdy(nRowIdx,nColIdx));
             }
         }
     }
-    recursFilter(oImage,m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oImage_AdaptiveMean);
-    recursFilter(oImage.mul(oImage),m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oImage_AdaptiveMeanSqr);
+    recursFilter(oImage,m_oRef_V_dHdx_t,m_oRef_V_dVdy,m_oImage_AdaptiveMean);
+    recursFilter(oImage.mul(oImage),m_oRef_V_dHdx_t,m_oRef_V_dVdy,m_oImage_AdaptiveMeanSqr);
     m_oLookupImage.create(m_oImageSize);
     m_oLookupImage_Sqr.create(m_oImageSize);
     m_oLookupImage_Mix.create(m_oImageSize);
@@ -336,9 +488,9 @@ void DASC::dasc_rf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
                     m_oLookupImage(nRowIdx,nColIdx) = m_oLookupImage_Sqr(nRowIdx,nColIdx) = m_oLookupImage_Mix(nRowIdx,nColIdx) = 0.0f;
             }
         }
-        recursFilter(m_oLookupImage,m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oLookupImage_AdaptiveMean);
-        recursFilter(m_oLookupImage_Sqr,m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oLookupImage_AdaptiveMeanSqr);
-        recursFilter(m_oLookupImage_Mix,m_oRef_V_dHdx,m_oRef_V_dVdy_t,m_oLookupImage_AdaptiveMeanMix);
+        recursFilter(m_oLookupImage,m_oRef_V_dHdx_t,m_oRef_V_dVdy,m_oLookupImage_AdaptiveMean);
+        recursFilter(m_oLookupImage_Sqr,m_oRef_V_dHdx_t,m_oRef_V_dVdy,m_oLookupImage_AdaptiveMeanSqr);
+        recursFilter(m_oLookupImage_Mix,m_oRef_V_dHdx_t,m_oRef_V_dVdy,m_oLookupImage_AdaptiveMeanMix);
         for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
             for(int nColIdx = 0; nColIdx<nCols; ++nColIdx) {
                 const int nOffsetRowIdx = nRowIdx+pretrained::anRP1[nLUTIdx*2];
@@ -363,6 +515,9 @@ void DASC::dasc_rf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
                 oCurrDesc = std::sqrt(1.0f/pretrained::nLUTSize);
         }
     }
+    m_nLastScratchSize = getMatBytes({&oImageTemp,&m_oTempTransp,&m_oImageLocalDiff_Y,&m_oImageLocalDiff_X,&m_oRef_dVdy,&m_oRef_dHdx,&m_oRef_V_dHdx_t,&m_oRef_V_dVdy,
+                                      &m_oImage_AdaptiveMean,&m_oImage_AdaptiveMeanSqr,&m_oLookupImage,&m_oLookupImage_Sqr,&m_oLookupImage_Mix,
+                                      &m_oLookupImage_AdaptiveMean,&m_oLookupImage_AdaptiveMeanSqr,&m_oLookupImage_AdaptiveMeanMix});
 }
 
 void DASC::guidedFilter(const cv::Mat_<float>& oImage, const cv::Mat_<float>& oRef, cv::Mat_<float>& oOutput) {
@@ -409,39 +564,128 @@ void DASC::dasc_gf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
     m_oImage_SubSamplVar = m_oImage_SubSamplBlurSqr-m_oImage_SubSamplBlur.mul(m_oImage_SubSamplBlur)+m_fEpsilon;
     guidedFilter(oImage,oImage,m_oImage_AdaptiveMean);
     guidedFilter(oImage,oImage.mul(oImage),m_oImage_AdaptiveMeanSqr);
-    m_oLookupImage.create(m_oImageSize);
-    m_oLookupImage_Sqr.create(m_oImageSize);
-    m_oLookupImage_Mix.create(m_oImageSize);
     const std::array<int,3> anDescDims = {nRows,nCols,(int)pretrained::nLUTSize};
     oDescriptors.create(3,anDescDims.data());
-    for(int nLUTIdx=0; nLUTIdx<(int)pretrained::nLUTSize; nLUTIdx++) {
-        const int nRowOffset = pretrained::anRPDiff[nLUTIdx*2];
-        const int nColOffset = pretrained::anRPDiff[nLUTIdx*2+1];
-        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
-            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
-                if(nRowIdx+nRowOffset>=0 && nRowIdx+nRowOffset<nRows && nColIdx+nColOffset>=0 && nColIdx+nColOffset<nCols) {
-                    m_oLookupImage(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
-                    m_oLookupImage_Sqr(nRowIdx,nColIdx) = oImage(nRowIdx+nRowOffset,nColIdx+nColOffset)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
-                    m_oLookupImage_Mix(nRowIdx,nColIdx) = oImage(nRowIdx,nColIdx)*oImage(nRowIdx+nRowOffset,nColIdx+nColOffset);
+    oDescriptors = 0.0f;
+    // all lookup pairs share the guide statistics above; their lookup/sqr/mix maps are filtered in batches of
+    // GF_LUT_BATCH_SIZE pairs (interleaved as 6 channels per pair: p, p^2, i*p', then the same multiplied by the guide),
+    // and each batch is processed in bands of GF_TILE_ROWS subsampled rows so that the working set stays in cache
+    const int nSubRows = m_oSubSamplSize.height;
+    const int nSubCols = m_oSubSamplSize.width;
+    std::vector<int> vnSubRowLookups,vnSubColLookups;
+    fillNearestLookups(nRows,nSubRows,vnSubRowLookups);
+    fillNearestLookups(nCols,nSubCols,vnSubColLookups);
+    std::vector<LinearLookup> vUpRowLookups,vUpColLookups;
+    fillLinearLookups(nSubRows,nRows,vUpRowLookups);
+    fillLinearLookups(nSubCols,nCols,vUpColLookups);
+    constexpr int nBatchSize = GF_LUT_BATCH_SIZE;
+    constexpr int nChannels = nBatchSize*6;
+    static_assert((pretrained::nLUTSize%nBatchSize)==0,"lookup table size must be a multiple of the batch size");
+    const int nTiles = (nSubRows+GF_TILE_ROWS-1)/GF_TILE_ROWS;
+    const int nBatches = (int)pretrained::nLUTSize/nBatchSize;
+    const size_t nSubRowElems = size_t(nSubCols)*nChannels;
+#if USING_OPENMP
+    std::vector<size_t> vnWorkerScratchBytes(size_t(omp_get_max_threads()),0u);
+    #pragma omp parallel for schedule(dynamic)
+#else //!USING_OPENMP
+    std::vector<size_t> vnWorkerScratchBytes(1u,0u);
+#endif //!USING_OPENMP
+    for(int nJobIdx=0; nJobIdx<nBatches*nTiles; ++nJobIdx) {
+        const int nFirstLUTIdx = (nJobIdx/nTiles)*nBatchSize;
+        const int nTileIdx = nJobIdx%nTiles;
+        // owned subsampled rows, and the (clamped) row ranges required by each stage
+        const int nTileFirstRow = nTileIdx*GF_TILE_ROWS, nTileEndRow = std::min(nTileFirstRow+GF_TILE_ROWS,nSubRows);
+        const int nUpFirstRow = nTileFirstRow, nUpEndRow = std::min(nTileEndRow+1,nSubRows);
+        const int nCoeffFirstRow = std::max(nUpFirstRow-nKernelRadius,0), nCoeffEndRow = std::min(nUpEndRow+nKernelRadius,nSubRows);
+        const int nInputFirstRow = std::max(nCoeffFirstRow-nKernelRadius,0), nInputEndRow = std::min(nCoeffEndRow+nKernelRadius,nSubRows);
+        static thread_local lv::AutoBuffer<float> s_aBandData,s_aBandBlurData;
+        s_aBandData.resize(size_t(nInputEndRow-nInputFirstRow)*nSubRowElems);
+        s_aBandBlurData.resize(size_t(nCoeffEndRow-nCoeffFirstRow)*nSubRowElems);
+        float* const aBand = s_aBandData.data();
+        float* const aBandBlur = s_aBandBlurData.data();
+    #if USING_OPENMP
+        size_t& nWorkerScratchBytes = vnWorkerScratchBytes[size_t(omp_get_thread_num())];
+    #else //!USING_OPENMP
+        size_t& nWorkerScratchBytes = vnWorkerScratchBytes[0];
+    #endif //!USING_OPENMP
+        nWorkerScratchBytes = std::max(nWorkerScratchBytes,(s_aBandData.capacity()+s_aBandBlurData.capacity())*sizeof(float)+(nSubRowElems+nChannels)*sizeof(double));
+        for(int nSubRowIdx=nInputFirstRow; nSubRowIdx<nInputEndRow; ++nSubRowIdx) {
+            const int nRowIdx = vnSubRowLookups[nSubRowIdx];
+            float* pBandRow = aBand+size_t(nSubRowIdx-nInputFirstRow)*nSubRowElems;
+            for(int nSubColIdx=0; nSubColIdx<nSubCols; ++nSubColIdx) {
+                const int nColIdx = vnSubColLookups[nSubColIdx];
+                const float fGuide = oImage(nRowIdx,nColIdx);
+                float* pBandPx = pBandRow+size_t(nSubColIdx)*nChannels;
+                for(int nBatchOffset=0; nBatchOffset<nBatchSize; ++nBatchOffset) {
+                    const int nLUTIdx = nFirstLUTIdx+nBatchOffset;
+                    const int nLookupRowIdx = nRowIdx+pretrained::anRPDiff[nLUTIdx*2];
+                    const int nLookupColIdx = nColIdx+pretrained::anRPDiff[nLUTIdx*2+1];
+                    const float fLookup = (nLookupRowIdx>=0 && nLookupRowIdx<nRows && nLookupColIdx>=0 && nLookupColIdx<nCols)?oImage(nLookupRowIdx,nLookupColIdx):0.0f;
+                    float* pBandVals = pBandPx+nBatchOffset*6;
+                    pBandVals[0] = fLookup;
+                    pBandVals[1] = fLookup*fLookup;
+                    pBandVals[2] = fGuide*fLookup;
+                    pBandVals[3] = fGuide*pBandVals[0];
+                    pBandVals[4] = fGuide*pBandVals[1];
+                    pBandVals[5] = fGuide*pBandVals[2];
                 }
-                else
-                    m_oLookupImage(nRowIdx,nColIdx) = m_oLookupImage_Sqr(nRowIdx,nColIdx) = m_oLookupImage_Mix(nRowIdx,nColIdx) = 0.0f;
             }
         }
-        guidedFilter(oImage,m_oLookupImage,m_oLookupImage_AdaptiveMean);
-        guidedFilter(oImage,m_oLookupImage_Sqr,m_oLookupImage_AdaptiveMeanSqr);
-        guidedFilter(oImage,m_oLookupImage_Mix,m_oLookupImage_AdaptiveMeanMix);
+        boxFilterRowBand(aBand,nInputFirstRow,aBandBlur,nCoeffFirstRow,nCoeffEndRow,nSubRows,nSubCols,nChannels,nKernelRadius);
+        // linear coefficients (a,b) for each filtered map, stored in place of the first band rows
+        for(int nSubRowIdx=nCoeffFirstRow; nSubRowIdx<nCoeffEndRow; ++nSubRowIdx) {
+            const float* pBlurRow = aBandBlur+size_t(nSubRowIdx-nCoeffFirstRow)*nSubRowElems;
+            float* pCoeffRow = aBand+size_t(nSubRowIdx-nCoeffFirstRow)*nSubRowElems;
+            for(int nSubColIdx=0; nSubColIdx<nSubCols; ++nSubColIdx) {
+                const float fGuideMean = m_oImage_SubSamplBlur(nSubRowIdx,nSubColIdx);
+                const float fGuideVar = m_oImage_SubSamplVar(nSubRowIdx,nSubColIdx);
+                for(int nMapIdx=0; nMapIdx<nBatchSize*3; ++nMapIdx) {
+                    const float* pBlurVals = pBlurRow+size_t(nSubColIdx)*nChannels+(nMapIdx/3)*6+(nMapIdx%3);
+                    const float fMean = pBlurVals[0], fCrossMean = pBlurVals[3];
+                    const float fCoeffA = (fCrossMean-fGuideMean*fMean)/fGuideVar;
+                    float* pCoeffVals = pCoeffRow+size_t(nSubColIdx)*nChannels+nMapIdx*2;
+                    pCoeffVals[0] = fCoeffA;
+                    pCoeffVals[1] = fMean-fCoeffA*fGuideMean;
+                }
+            }
+        }
+        boxFilterRowBand(aBand,nCoeffFirstRow,aBandBlur,nUpFirstRow,nUpEndRow,nSubRows,nSubCols,nChannels,nKernelRadius);
+        // upsampled output evaluated at each offset pixel, scattered to the descriptor of its reference pixel
         for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
-            for(int nColIdx = 0; nColIdx<nCols; ++nColIdx) {
-                const int nOffsetRowIdx = nRowIdx+pretrained::anRP1[nLUTIdx*2];
-                const int nOffsetColIdx = nColIdx+pretrained::anRP1[nLUTIdx*2+1];
-                if(nOffsetRowIdx>0 && nOffsetRowIdx<nRows && nOffsetColIdx>0 && nOffsetColIdx<nCols) {
-                    const float fCorrSurfDenom = std::sqrt((m_oImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)) * (m_oLookupImage_AdaptiveMeanSqr(nOffsetRowIdx,nOffsetColIdx)-m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)));
-                    const float fVisDiff = m_oLookupImage_AdaptiveMeanMix(nOffsetRowIdx,nOffsetColIdx)-m_oImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx)*m_oLookupImage_AdaptiveMean(nOffsetRowIdx,nOffsetColIdx);
-                    oDescriptors(nRowIdx,nColIdx,nLUTIdx) = fCorrSurfDenom>LOCAL_EPS?std::min(std::exp(-(1-(fVisDiff)/fCorrSurfDenom)*2),1.0f):1.0f;
+            const LinearLookup& oRowLookup = vUpRowLookups[nRowIdx];
+            if(oRowLookup.nIdx0<nTileFirstRow || oRowLookup.nIdx0>=nTileEndRow || nRowIdx==0)
+                continue;
+            const float* pCoeffRow0 = aBandBlur+size_t(oRowLookup.nIdx0-nUpFirstRow)*nSubRowElems;
+            const float* pCoeffRow1 = aBandBlur+size_t(oRowLookup.nIdx1-nUpFirstRow)*nSubRowElems;
+            for(int nColIdx=1; nColIdx<nCols; ++nColIdx) {
+                const LinearLookup& oColLookup = vUpColLookups[nColIdx];
+                const float* pCoeffs00 = pCoeffRow0+size_t(oColLookup.nIdx0)*nChannels;
+                const float* pCoeffs01 = pCoeffRow0+size_t(oColLookup.nIdx1)*nChannels;
+                const float* pCoeffs10 = pCoeffRow1+size_t(oColLookup.nIdx0)*nChannels;
+                const float* pCoeffs11 = pCoeffRow1+size_t(oColLookup.nIdx1)*nChannels;
+                const float fGuide = oImage(nRowIdx,nColIdx);
+                const float fGuideMean = m_oImage_AdaptiveMean(nRowIdx,nColIdx);
+                const float fGuideMeanSqr = m_oImage_AdaptiveMeanSqr(nRowIdx,nColIdx);
+                for(int nBatchOffset=0; nBatchOffset<nBatchSize; ++nBatchOffset) {
+                    const int nLUTIdx = nFirstLUTIdx+nBatchOffset;
+                    const int nDescRowIdx = nRowIdx-pretrained::anRP1[nLUTIdx*2];
+                    const int nDescColIdx = nColIdx-pretrained::anRP1[nLUTIdx*2+1];
+                    if(nDescRowIdx<0 || nDescRowIdx>=nRows || nDescColIdx<0 || nDescColIdx>=nCols)
+                        continue;
+                    std::array<float,3> afMeans;
+                    for(int nMapIdx=0; nMapIdx<3; ++nMapIdx) {
+                        const int nOffset = (nBatchOffset*3+nMapIdx)*2;
+                        const auto lInterp = [&](int nValIdx) {
+                            const float fTop = pCoeffs00[nValIdx]+oColLookup.fAlpha*(pCoeffs01[nValIdx]-pCoeffs00[nValIdx]);
+                            const float fBottom = pCoeffs10[nValIdx]+oColLookup.fAlpha*(pCoeffs11[nValIdx]-pCoeffs10[nValIdx]);
+                            return fTop+oRowLookup.fAlpha*(fBottom-fTop);
+                        };
+                        afMeans[nMapIdx] = lInterp(nOffset)*fGuide+lInterp(nOffset+1);
+                    }
+                    const float fCorrSurfDenom = std::sqrt((fGuideMeanSqr-fGuideMean*fGuideMean)*(afMeans[1]-afMeans[0]*afMeans[0]));
+                    const float fVisDiff = afMeans[2]-fGuideMean*afMeans[0];
+                    oDescriptors(nDescRowIdx,nDescColIdx,nLUTIdx) = fCorrSurfDenom>LOCAL_EPS?std::min(std::exp(-(1-(fVisDiff)/fCorrSurfDenom)*2),1.0f):1.0f;
                 }
-                else
-                    oDescriptors(nRowIdx,nColIdx,nLUTIdx) = 0.0f;
             }
         }
     }
@@ -455,4 +699,11 @@ void DASC::dasc_gf_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
                 oCurrDesc = std::sqrt(1.0f/pretrained::nLUTSize);
         }
     }
+    // image-sized temporaries are all alive at once, and each worker additionally holds its own band buffers
+    m_nLastScratchSize = getMatBytes({&oImageTemp,&m_oImage_SubSampl,&m_oImage_SubSamplBlur,&m_oImage_SubSamplBlurSqr,&m_oImage_SubSamplVar,
+                                      &m_oRef_SubSampl,&m_oRef_SubSamplCross,&m_oRef_SubSamplBlur,&m_oRef_SubSamplCrossBlur,
+                                      &m_oNormVar_SubSampl,&m_oNormVarDiff_SubSampl,&m_oNormVar_SubSamplBlur,&m_oNormVarDiff_SubSamplBlur,
+                                      &m_oNormVar,&m_oNormVarDiff,&m_oImage_AdaptiveMean,&m_oImage_AdaptiveMeanSqr});
+    for(size_t nWorkerBytes : vnWorkerScratchBytes)
+        m_nLastScratchSize += nWorkerBytes;
 }
\ No newline at end of file
@@ -15,7 +15,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "litiv/features2d/LBSP.hpp"
+#include "litiv/features2d.hpp"
 
 // make sure static constexpr array addresses exist
 constexpr int LBSP::s_anIdxLUT_16bitdbcross[16][2];
@@ -24,6 +24,66 @@ constexpr int LBSP::s_anIdxLUT_16bitdbcross_GradY[16];
 constexpr LBSP::IdxLUTOffsetArray LBSP::s_oIdxLUT_16bitdbcross_x;
 constexpr LBSP::IdxLUTOffsetArray LBSP::s_oIdxLUT_16bitdbcross_y;
 
+namespace {
+
+    /// computes the Hamming distances between nCount pairs of contiguous 16-bit descriptor words, i.e. popcount(a^b) per word, 32 or 16 words at a time with AVX2/SSSE3 nibble lookups
+    inline void calcWordHammingDists(const LBSP::desc_t* anDesc1, const LBSP::desc_t* anDesc2, size_t nCount, uchar* anDists) {
+        static_assert(sizeof(LBSP::desc_t)==2,"simd impl below packs 16-bit lanes");
+        size_t nIter = 0;
+#if HAVE_AVX2
+        const __m256i _anNibblePopcntLUT = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m256i _anLowNibbleMask = _mm256_set1_epi8(0x0F);
+        const __m256i _anOnes = _mm256_set1_epi8(1);
+        // returns the popcount of the xor'd 16-bit words (as 16-bit lanes) for 16 descriptors
+        const auto lGetWordPopcnts = [&](size_t nOffset) {
+            const __m256i _anXorWords = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(anDesc1+nOffset)),_mm256_loadu_si256((const __m256i*)(anDesc2+nOffset)));
+            const __m256i _anLowPopcnts = _mm256_shuffle_epi8(_anNibblePopcntLUT,_mm256_and_si256(_anXorWords,_anLowNibbleMask));
+            const __m256i _anHighPopcnts = _mm256_shuffle_epi8(_anNibblePopcntLUT,_mm256_and_si256(_mm256_srli_epi16(_anXorWords,4),_anLowNibbleMask));
+            return _mm256_maddubs_epi16(_mm256_add_epi8(_anLowPopcnts,_anHighPopcnts),_anOnes);
+        };
+        for(; nIter+32<=nCount; nIter+=32) {
+            // 16-bit packing works per 128-bit lane, so 64-bit blocks must be reordered before storing
+            const __m256i _anDists = _mm256_packus_epi16(lGetWordPopcnts(nIter),lGetWordPopcnts(nIter+16));
+            _mm256_storeu_si256((__m256i*)(anDists+nIter),_mm256_permute4x64_epi64(_anDists,0xD8));
+        }
+#elif HAVE_SSSE3
+        const __m128i _anNibblePopcntLUT = _mm_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m128i _anLowNibbleMask = _mm_set1_epi8(0x0F);
+        const __m128i _anOnes = _mm_set1_epi8(1);
+        // returns the popcount of the xor'd 16-bit words (as 16-bit lanes) for 8 descriptors
+        const auto lGetWordPopcnts = [&](size_t nOffset) {
+            const __m128i _anXorWords = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(anDesc1+nOffset)),_mm_loadu_si128((const __m128i*)(anDesc2+nOffset)));
+            const __m128i _anLowPopcnts = _mm_shuffle_epi8(_anNibblePopcntLUT,_mm_and_si128(_anXorWords,_anLowNibbleMask));
+            const __m128i _anHighPopcnts = _mm_shuffle_epi8(_anNibblePopcntLUT,_mm_and_si128(_mm_srli_epi16(_anXorWords,4),_anLowNibbleMask));
+            return _mm_maddubs_epi16(_mm_add_epi8(_anLowPopcnts,_anHighPopcnts),_anOnes);
+        };
+        for(; nIter+16<=nCount; nIter+=16)
+            _mm_storeu_si128((__m128i*)(anDists+nIter),_mm_packus_epi16(lGetWordPopcnts(nIter),lGetWordPopcnts(nIter+8)));
+#endif //HAVE_SSSE3
+        for(; nIter<nCount; ++nIter)
+            anDists[nIter] = lv::hdist<LBSP::desc_t,uchar>(anDesc1[nIter],anDesc2[nIter]);
+    }
+
+    /// computes the Hamming distances between nCount pairs of contiguous multi-channel descriptors (word distances are summed over channels)
+    inline void calcDescHammingDists(const LBSP::desc_t* anDesc1, const LBSP::desc_t* anDesc2, size_t nCount, size_t nChannels, uchar* anDists) {
+        if(nChannels==1) {
+            calcWordHammingDists(anDesc1,anDesc2,nCount,anDists);
+            return;
+        }
+        static thread_local lv::AutoBuffer<uchar> s_aWordDists;
+        s_aWordDists.resize(nCount*nChannels);
+        calcWordHammingDists(anDesc1,anDesc2,nCount*nChannels,s_aWordDists.data());
+        for(size_t nDescIdx=0; nDescIdx<nCount; ++nDescIdx) {
+            const uchar* anWordDists = s_aWordDists.data()+nDescIdx*nChannels;
+            uchar nDist = 0;
+            for(size_t nChIdx=0; nChIdx<nChannels; ++nChIdx)
+                nDist += anWordDists[nChIdx];
+            anDists[nDescIdx] = nDist;
+        }
+    }
+
+} // anonymous namespace
+
 LBSP::LBSP(size_t nThreshold) :
         m_bOnlyUsingAbsThreshold(true),
         m_fRelThreshold(0), // unused
@@ -106,18 +166,19 @@ void lbsp_computeImpl(const cv::Mat& oInputImg, const cv::Mat& oRefImg, cv::Mat&
     const size_t nChannels = (size_t)oInputImg.channels();
     const cv::Mat& oRefMat = oRefImg.empty()?oInputImg:oRefImg;
     const uchar t = cv::saturate_cast<uchar>((int)nThreshold);
+    const int nBorderSize = int(LBSP::PATCH_SIZE)/2;
+    const size_t nPxCount = size_t(std::max(oInputImg.cols-nBorderSize*2,0));
+    lv::AutoBuffer<uchar> aThresholds(nPxCount*nChannels);
+    std::fill(aThresholds.begin(),aThresholds.end(),t);
     if(nChannels==1) {
         oDesc.create(oInputImg.size(),CV_16UC1);
-        for(int y=int(LBSP::PATCH_SIZE)/2; y<oInputImg.rows-int(LBSP::PATCH_SIZE)/2; ++y)
-            for(int x=int(LBSP::PATCH_SIZE)/2; x<oInputImg.cols-int(LBSP::PATCH_SIZE)/2; ++x)
-                LBSP::computeDescriptor<1>(oInputImg,oRefMat.at<uchar>(y,x),x,y,0,t,oDesc.at<ushort>(y,x));
+        for(int y=nBorderSize; y<oInputImg.rows-nBorderSize; ++y)
+            LBSP::computeDescriptor_strip<1>(oInputImg,nBorderSize,y,nPxCount,oRefMat.ptr<uchar>(y,nBorderSize),aThresholds.data(),oDesc.ptr<ushort>(y,nBorderSize));
     }
     else { //nChannels==3
         oDesc.create(oInputImg.size(),CV_16UC3);
-        alignas(16) const std::array<uchar,3> anThreshold = {t,t,t};
-        for(int y=int(LBSP::PATCH_SIZE)/2; y<oInputImg.rows-int(LBSP::PATCH_SIZE)/2; ++y)
-            for(int x=int(LBSP::PATCH_SIZE)/2; x<oInputImg.cols-int(LBSP::PATCH_SIZE)/2; ++x)
-                LBSP::computeDescriptor(oInputImg,oRefMat.ptr<uchar>(y,x),x,y,anThreshold,oDesc.ptr<ushort>(y,x));
+        for(int y=nBorderSize; y<oInputImg.rows-nBorderSize; ++y)
+            LBSP::computeDescriptor_strip<3>(oInputImg,nBorderSize,y,nPxCount,oRefMat.ptr<uchar>(y,nBorderSize),aThresholds.data(),oDesc.ptr<ushort>(y,nBorderSize));
     }
 }
 
@@ -128,26 +189,21 @@ void lbsp_computeImpl(const cv::Mat& oInputImg, const cv::Mat& oRefImg, cv::Mat&
     lvAssert_(fThreshold>=0,"lbsp internal relative threshold must be non-negative");
     const size_t nChannels = (size_t)oInputImg.channels();
     const cv::Mat& oRefMat = oRefImg.empty()?oInputImg:oRefImg;
-    if(nChannels==1) {
-        oDesc.create(oInputImg.size(),CV_16UC1);
-        for(int y=int(LBSP::PATCH_SIZE)/2; y<oInputImg.rows-int(LBSP::PATCH_SIZE)/2; ++y) {
-            for(int x=int(LBSP::PATCH_SIZE)/2; x<oInputImg.cols-int(LBSP::PATCH_SIZE)/2; ++x) {
-                const uchar nThreshold = cv::saturate_cast<uchar>(oRefMat.at<uchar>(y,x)*fThreshold+nThresholdOffset);
-                LBSP::computeDescriptor<1>(oInputImg,oRefMat.at<uchar>(y,x),x,y,0,nThreshold,oDesc.at<ushort>(y,x));
-            }
-        }
-    }
-    else { //nChannels==3
-        oDesc.create(oInputImg.size(),CV_16UC3);
-        for(int y=int(LBSP::PATCH_SIZE)/2; y<oInputImg.rows-int(LBSP::PATCH_SIZE)/2; ++y) {
-            for(int x=int(LBSP::PATCH_SIZE)/2; x<oInputImg.cols-int(LBSP::PATCH_SIZE)/2; ++x) {
-                const uchar* acRef = oRefMat.ptr<uchar>(y,x);
-                alignas(16) const std::array<uchar,3> anThreshold = {cv::saturate_cast<uchar>(acRef[0]*fThreshold+nThresholdOffset),
-                                                                     cv::saturate_cast<uchar>(acRef[1]*fThreshold+nThresholdOffset),
-                                                                     cv::saturate_cast<uchar>(acRef[2]*fThreshold+nThresholdOffset)};
-                LBSP::computeDescriptor(oInputImg,acRef,x,y,anThreshold,oDesc.ptr<ushort>(y,x));
-            }
-        }
+    const int nBorderSize = int(LBSP::PATCH_SIZE)/2;
+    const size_t nPxCount = size_t(std::max(oInputImg.cols-nBorderSize*2,0));
+    std::array<uchar,UCHAR_MAX+1> anThresholdLUT;
+    for(size_t nVal=0; nVal<=UCHAR_MAX; ++nVal)
+        anThresholdLUT[nVal] = cv::saturate_cast<uchar>(nVal*fThreshold+nThresholdOffset);
+    lv::AutoBuffer<uchar> aThresholds(nPxCount*nChannels);
+    oDesc.create(oInputImg.size(),CV_16UC((int)nChannels));
+    for(int y=nBorderSize; y<oInputImg.rows-nBorderSize; ++y) {
+        const uchar* const anRefs = oRefMat.ptr<uchar>(y,nBorderSize);
+        for(size_t nValIdx=0; nValIdx<nPxCount*nChannels; ++nValIdx)
+            aThresholds[nValIdx] = anThresholdLUT[anRefs[nValIdx]];
+        if(nChannels==1)
+            LBSP::computeDescriptor_strip<1>(oInputImg,nBorderSize,y,nPxCount,anRefs,aThresholds.data(),oDesc.ptr<ushort>(y,nBorderSize));
+        else //nChannels==3
+            LBSP::computeDescriptor_strip<3>(oInputImg,nBorderSize,y,nPxCount,anRefs,aThresholds.data(),oDesc.ptr<ushort>(y,nBorderSize));
     }
 }
 
@@ -251,15 +307,18 @@ void LBSP::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoint
 
 void LBSP::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<cv::Mat>& voDescMapCollection) const {
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i], voDescMapCollection[i]);
+    // the impl has no per-image member state, so all images can be described concurrently by this instance
+    lv::parallel_for_slots(voImageCollection.size(),SIZE_MAX,[&](size_t /*nSlotIdx*/, size_t nImageIdx) {
+        compute2(voImageCollection[nImageIdx],voDescMapCollection[nImageIdx]);
+    });
 }
 
 void LBSP::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<std::vector<cv::KeyPoint>>& vvoPointCollection, std::vector<cv::Mat>& voDescMapCollection) const {
     lvAssert_(voImageCollection.size()==vvoPointCollection.size(),"number of images must match number of keypoint lists");
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i], vvoPointCollection[i], voDescMapCollection[i]);
+    lv::parallel_for_slots(voImageCollection.size(),SIZE_MAX,[&](size_t /*nSlotIdx*/, size_t nImageIdx) {
+        compute2(voImageCollection[nImageIdx],vvoPointCollection[nImageIdx],voDescMapCollection[nImageIdx]);
+    });
 }
 
 void LBSP::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMask, std::vector<cv::KeyPoint>& voKeypoints, cv::OutputArray _oDescriptors, bool bUseProvidedKeypoints) {
@@ -322,39 +381,33 @@ void LBSP::calcDescImgDiff(const cv::Mat& oDesc1, const cv::Mat& oDesc2, cv::Mat
     lvAssert_(oDesc1.size()==oDesc2.size() && oDesc1.type()==oDesc2.type(),"size/type of descriptor mats must match");
     lvDbgAssert(oDesc1.step.p[0]==oDesc2.step.p[0] && oDesc1.step.p[1]==oDesc2.step.p[1]);
     const float fScaleFactor = (float)UCHAR_MAX/(LBSP::DESC_SIZE_BITS);
+    // word distances are scaled through lookup tables (same float arithmetic as a direct per-word computation)
+    std::array<uchar,LBSP::DESC_SIZE_BITS+1> anScaledDistLUT,anMergedScaledDistLUT;
+    for(size_t nDist=0; nDist<=LBSP::DESC_SIZE_BITS; ++nDist) {
+        anScaledDistLUT[nDist] = (uchar)(fScaleFactor*nDist);
+        anMergedScaledDistLUT[nDist] = (uchar)((fScaleFactor*nDist)/3);
+    }
     const size_t nChannels = CV_MAT_CN(oDesc1.type());
-    const size_t _step_row = oDesc1.step.p[0];
-    if(nChannels==1) {
+    const size_t nRowWords = size_t(oDesc1.cols)*nChannels;
+    if(nChannels==1 || !bForceMergeChannels)
+        oOutput.create(oDesc1.size(),CV_8UC(int(nChannels)));
+    else
         oOutput.create(oDesc1.size(),CV_8UC1);
-        oOutput = cv::Scalar(0);
-        for(int i=0; i<oDesc1.rows; ++i) {
-            const size_t idx = _step_row*i;
-            const ushort* const desc1_ptr = (ushort*)(oDesc1.data+idx);
-            const ushort* const desc2_ptr = (ushort*)(oDesc2.data+idx);
-            for(int j=0; j<oDesc1.cols; ++j)
-                oOutput.at<uchar>(i,j) = (uchar)(fScaleFactor*lv::hdist(desc1_ptr[j],desc2_ptr[j]));
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nRowIdx=0; nRowIdx<oDesc1.rows; ++nRowIdx) {
+        uchar* anOutput = oOutput.ptr<uchar>(nRowIdx);
+        static thread_local lv::AutoBuffer<uchar> s_aWordDists;
+        s_aWordDists.resize(nRowWords);
+        calcWordHammingDists(oDesc1.ptr<ushort>(nRowIdx),oDesc2.ptr<ushort>(nRowIdx),nRowWords,s_aWordDists.data());
+        if(nChannels==1 || !bForceMergeChannels) {
+            for(size_t nWordIdx=0; nWordIdx<nRowWords; ++nWordIdx)
+                anOutput[nWordIdx] = anScaledDistLUT[s_aWordDists[nWordIdx]];
         }
-    }
-    else { //nChannels==3
-        if(bForceMergeChannels)
-            oOutput.create(oDesc1.size(),CV_8UC1);
-        else
-            oOutput.create(oDesc1.size(),CV_8UC3);
-        oOutput = cv::Scalar::all(0);
-        for(int i=0; i<oDesc1.rows; ++i) {
-            const size_t idx =  _step_row*i;
-            const ushort* const desc1_ptr = (ushort*)(oDesc1.data+idx);
-            const ushort* const desc2_ptr = (ushort*)(oDesc2.data+idx);
-            uchar* output_ptr = oOutput.data + oOutput.step.p[0]*i;
-            for(int j=0; j<oDesc1.cols; ++j) {
-                for(size_t n=0;n<3; ++n) {
-                    const size_t idx2 = 3*j+n;
-                    if(bForceMergeChannels)
-                        output_ptr[j] += (uchar)((fScaleFactor*lv::hdist(desc1_ptr[idx2],desc2_ptr[idx2]))/3);
-                    else
-                        output_ptr[idx2] = (uchar)(fScaleFactor*lv::hdist(desc1_ptr[idx2],desc2_ptr[idx2]));
-                }
-            }
+        else {
+            for(int nColIdx=0; nColIdx<oDesc1.cols; ++nColIdx)
+                anOutput[nColIdx] = uchar(anMergedScaledDistLUT[s_aWordDists[nColIdx*3]]+anMergedScaledDistLUT[s_aWordDists[nColIdx*3+1]]+anMergedScaledDistLUT[s_aWordDists[nColIdx*3+2]]);
         }
     }
 }
@@ -376,23 +429,47 @@ void LBSP::calcDistances(const cv::Mat& oDescriptors1, const cv::Mat& oDescripto
     lvAssert_(oDescriptors1.dims==2 && oDescriptors2.dims==2 && oDescriptors1.size()==oDescriptors2.size(),"descriptor mat sizes mismatch");
     lvAssert_(oDescriptors1.depth()==CV_16U && oDescriptors2.depth()==CV_16U,"unexpected descriptor matrix type");
     lvAssert_(oDescriptors1.type()==oDescriptors2.type(),"descriptor mat types mismatch");
+    lvAssert_(oDescriptors1.channels()<=4,"unexpected descriptor matrix channel count");
     oDistances.create(oDescriptors1.rows,oDescriptors1.cols);
-    if(oDescriptors1.channels()==1)
-        for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
-            for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx)
-                oDistances(nDescRowIdx,nDescColIdx) = lv::hdist<ushort,uchar>(oDescriptors1.at<ushort>(nDescRowIdx,nDescColIdx),oDescriptors2.at<ushort>(nDescRowIdx,nDescColIdx));
-    else if(oDescriptors1.channels()==2)
-        for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
-            for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx)
-                oDistances(nDescRowIdx,nDescColIdx) = lv::hdist<2,ushort,uchar>(oDescriptors1.ptr<ushort>(nDescRowIdx,nDescColIdx),oDescriptors2.ptr<ushort>(nDescRowIdx,nDescColIdx));
-    else if(oDescriptors1.channels()==3)
-        for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
-            for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx)
-                oDistances(nDescRowIdx,nDescColIdx) = lv::hdist<3,ushort,uchar>(oDescriptors1.ptr<ushort>(nDescRowIdx,nDescColIdx),oDescriptors2.ptr<ushort>(nDescRowIdx,nDescColIdx));
-    else if(oDescriptors1.channels()==4)
-        for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
-            for(int nDescColIdx=0; nDescColIdx<oDescriptors1.cols; ++nDescColIdx)
-                oDistances(nDescRowIdx,nDescColIdx) = lv::hdist<4,ushort,uchar>(oDescriptors1.ptr<ushort>(nDescRowIdx,nDescColIdx),oDescriptors2.ptr<ushort>(nDescRowIdx,nDescColIdx));
+    const size_t nChannels = size_t(oDescriptors1.channels());
+    for(int nDescRowIdx=0; nDescRowIdx<oDescriptors1.rows; ++nDescRowIdx)
+        calcDescHammingDists(oDescriptors1.ptr<ushort>(nDescRowIdx),oDescriptors2.ptr<ushort>(nDescRowIdx),size_t(oDescriptors1.cols),nChannels,oDistances.ptr<uchar>(nDescRowIdx));
+}
+
+void LBSP::calcDistances(const cv::Mat& oDescMap1, const cv::Mat& oDescMap2, const std::vector<int>& vDispRange, cv::Mat_<uchar>& oDistances) {
+    lvAssert_(oDescMap1.dims==2 && oDescMap2.dims==2 && oDescMap1.size()==oDescMap2.size(),"descriptor map sizes mismatch");
+    lvAssert_(oDescMap1.depth()==CV_16U && oDescMap2.depth()==CV_16U,"unexpected descriptor map type");
+    lvAssert_(oDescMap1.type()==oDescMap2.type(),"descriptor map types mismatch");
+    lvAssert_(oDescMap1.channels()<=4,"unexpected descriptor map channel count");
+    lvAssert_(!vDispRange.empty(),"bad disparity range");
+    const int nRows = oDescMap1.rows;
+    const int nCols = oDescMap1.cols;
+    const int nOffsets = int(vDispRange.size());
+    const size_t nChannels = size_t(oDescMap1.channels());
+    const std::array<int,3> anDistMapDims = {nRows,nCols,nOffsets};
+    oDistances.create(3,anDistMapDims.data());
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+        const ushort* anDescRow1 = oDescMap1.ptr<ushort>(nRowIdx);
+        const ushort* anDescRow2 = oDescMap2.ptr<ushort>(nRowIdx);
+        uchar* anDistRow = oDistances.ptr<uchar>(nRowIdx);
+        std::fill_n(anDistRow,size_t(nCols*nOffsets),uchar(UCHAR_MAX)); // default value for OOB pairs
+        static thread_local lv::AutoBuffer<uchar> s_aOffsetDists;
+        s_aOffsetDists.resize(size_t(nCols));
+        for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+            // each offset compares a contiguous run of descriptors from both rows, which keeps the popcount kernel on packed data
+            const int nColOffset = vDispRange[nOffsetIdx];
+            const int nFirstColIdx = std::max(0,-nColOffset);
+            const int nEndColIdx = std::min(nCols,nCols-nColOffset);
+            if(nFirstColIdx>=nEndColIdx)
+                continue;
+            calcDescHammingDists(anDescRow1+nFirstColIdx*nChannels,anDescRow2+(nFirstColIdx+nColOffset)*nChannels,size_t(nEndColIdx-nFirstColIdx),nChannels,s_aOffsetDists.data());
+            for(int nColIdx=nFirstColIdx; nColIdx<nEndColIdx; ++nColIdx)
+                anDistRow[nColIdx*nOffsets+nOffsetIdx] = s_aOffsetDists[nColIdx-nFirstColIdx];
+        }
+    }
 }
 
 #if HAVE_GLSL
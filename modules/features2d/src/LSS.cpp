@@ -45,6 +45,7 @@ LSS::LSS(int nInnerRadius, int nOuterRadius, int nDescPatchSize, int nAngularBin
     lvAssert_(m_nRadialBins>0,"invalid parameter");
     lvAssert_(m_nAngularBins>0,"invalid parameter");
     lvAssert_(m_fStaticNoiseVar>0.0f,"invalid parameter");
+    lvAssert_(int64_t(m_nPatchSize)*m_nPatchSize*3*UCHAR_MAX*UCHAR_MAX<=int64_t(std::numeric_limits<int>::max()),"patch size too large for integer ssd accumulation");
     lv::getLogPolarMask(m_nCorrPatchSize,m_nRadialBins,m_nAngularBins,m_oDescLUMap,m_bUsingLienhartMask,(float)m_nInnerRadius,&m_nFirstMaskIdx,&m_nLastMaskIdx);
     lvDbgAssert(m_oDescLUMap.cols==m_nCorrPatchSize && m_oDescLUMap.rows==m_nCorrPatchSize);
     lvDbgAssert(m_nFirstMaskIdx>=0 && m_nLastMaskIdx>=m_nFirstMaskIdx);
@@ -129,15 +130,18 @@ void LSS::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoints
 
 void LSS::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],voDescMapCollection[i]);
+    // the impl only uses the (read-only) lookup mask and thread-local scratch buffers, so all images can be described concurrently by this instance
+    lv::parallel_for_slots(voImageCollection.size(),SIZE_MAX,[&](size_t /*nSlotIdx*/, size_t nImageIdx) {
+        compute2(voImageCollection[nImageIdx],voDescMapCollection[nImageIdx]);
+    });
 }
 
 void LSS::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<std::vector<cv::KeyPoint> >& vvoPointCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     lvAssert_(voImageCollection.size()==vvoPointCollection.size(),"number of images must match number of keypoint lists");
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],vvoPointCollection[i],voDescMapCollection[i]);
+    lv::parallel_for_slots(voImageCollection.size(),SIZE_MAX,[&](size_t /*nSlotIdx*/, size_t nImageIdx) {
+        compute2(voImageCollection[nImageIdx],vvoPointCollection[nImageIdx],voDescMapCollection[nImageIdx]);
+    });
 }
 
 void LSS::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMask, std::vector<cv::KeyPoint>& voKeypoints, cv::OutputArray _oDescriptors, bool bUseProvidedKeypoints) {
@@ -210,6 +214,78 @@ void LSS::calcDistances(const cv::Mat_<float>& oDescriptors1, const cv::Mat_<flo
     }
 }
 
+namespace {
+
+    template<int nChannels>
+    inline int calcPatchSSD(const cv::Mat& oImage, int nRowIdx, int nColIdx, int nRowOffset, int nColOffset, int nPatchRadius) {
+        int nSSD = 0;
+        for(int nPatchRowIdx=nRowIdx-nPatchRadius; nPatchRowIdx<=nRowIdx+nPatchRadius; ++nPatchRowIdx) {
+            const uchar* pRow = oImage.ptr<uchar>(nPatchRowIdx,nColIdx-nPatchRadius);
+            const uchar* pShiftedRow = oImage.ptr<uchar>(nPatchRowIdx+nRowOffset,nColIdx-nPatchRadius+nColOffset);
+            for(int nElemIdx=0; nElemIdx<(nPatchRadius*2+1)*nChannels; ++nElemIdx) {
+                const int nDiff = int(pRow[nElemIdx])-int(pShiftedRow[nElemIdx]);
+                nSSD += nDiff*nDiff;
+            }
+        }
+        return nSSD;
+    }
+
+    inline int calcPatchSSD(const cv::Mat& oImage, int nRowIdx, int nColIdx, int nRowOffset, int nColOffset, int nPatchRadius) {
+        if(oImage.channels()==1)
+            return calcPatchSSD<1>(oImage,nRowIdx,nColIdx,nRowOffset,nColOffset,nPatchRadius);
+        else //oImage.channels()==3
+            return calcPatchSSD<3>(oImage,nRowIdx,nColIdx,nRowOffset,nColOffset,nPatchRadius);
+    }
+
+    // computes the patch-wise SSD between the image and its shifted copy for all pixels outside the border using running
+    // column sums, and folds each result into the (row-major, border-less) output buffer via the provided reducer
+    template<int nChannels, typename TReducer>
+    void reduceShiftedSSDs(const cv::Mat& oImage, int nBorderSize, int nPatchRadius, int nRowOffset, int nColOffset, int* aColSums, int* aOutput, TReducer lReducer) {
+        const int nPatchSize = nPatchRadius*2+1;
+        const int nOutRows = oImage.rows-nBorderSize*2;
+        const int nOutCols = oImage.cols-nBorderSize*2;
+        const int nSumCols = nOutCols+nPatchSize-1;
+        const int nFirstColIdx = nBorderSize-nPatchRadius;
+        const auto lAccumRow = [&](int nRowIdx, int nSign) {
+            const uchar* pRow = oImage.ptr<uchar>(nRowIdx,nFirstColIdx);
+            const uchar* pShiftedRow = oImage.ptr<uchar>(nRowIdx+nRowOffset,nFirstColIdx+nColOffset);
+            for(int nColIdx=0; nColIdx<nSumCols; ++nColIdx) {
+                int nPxSSD = 0;
+                for(int nChIdx=0; nChIdx<nChannels; ++nChIdx) {
+                    const int nDiff = int(pRow[nColIdx*nChannels+nChIdx])-int(pShiftedRow[nColIdx*nChannels+nChIdx]);
+                    nPxSSD += nDiff*nDiff;
+                }
+                aColSums[nColIdx] += nSign*nPxSSD;
+            }
+        };
+        std::fill_n(aColSums,nSumCols,0);
+        for(int nRowIdx=nBorderSize-nPatchRadius; nRowIdx<=nBorderSize+nPatchRadius; ++nRowIdx)
+            lAccumRow(nRowIdx,1);
+        for(int nOutRowIdx=0; nOutRowIdx<nOutRows; ++nOutRowIdx) {
+            if(nOutRowIdx>0) {
+                lAccumRow(nBorderSize+nOutRowIdx+nPatchRadius,1);
+                lAccumRow(nBorderSize+nOutRowIdx-nPatchRadius-1,-1);
+            }
+            int* pOutputRow = aOutput+size_t(nOutRowIdx)*nOutCols;
+            int nSSD = std::accumulate(aColSums,aColSums+nPatchSize,0);
+            lReducer(pOutputRow[0],nSSD);
+            for(int nOutColIdx=1; nOutColIdx<nOutCols; ++nOutColIdx) {
+                nSSD += aColSums[nOutColIdx+nPatchSize-1]-aColSums[nOutColIdx-1];
+                lReducer(pOutputRow[nOutColIdx],nSSD);
+            }
+        }
+    }
+
+    template<typename TReducer>
+    void reduceShiftedSSDs(const cv::Mat& oImage, int nBorderSize, int nPatchRadius, int nRowOffset, int nColOffset, int* aColSums, int* aOutput, TReducer lReducer) {
+        if(oImage.channels()==1)
+            reduceShiftedSSDs<1>(oImage,nBorderSize,nPatchRadius,nRowOffset,nColOffset,aColSums,aOutput,lReducer);
+        else //oImage.channels()==3
+            reduceShiftedSSDs<3>(oImage,nBorderSize,nPatchRadius,nRowOffset,nColOffset,aColSums,aOutput,lReducer);
+    }
+
+} // anonymous namespace
+
 void LSS::ssdescs_impl(const cv::Mat& _oImage, std::vector<cv::KeyPoint>& voKeypoints, cv::Mat_<float>& oDescriptors, bool bGenDescMap) {
     lvAssert_(!_oImage.empty() && ((_oImage.type()==CV_8UC1) || (_oImage.type()==CV_8UC3)),"invalid input image");
     lvAssert__(m_nCorrWinSize<=_oImage.cols && m_nCorrWinSize<=_oImage.rows,"image is too small to compute descriptors with current correlation area size -- need at least (%d,%d) and got (%d,%d)",m_nCorrWinSize,m_nCorrWinSize,_oImage.cols,_oImage.rows);
@@ -224,41 +300,43 @@ void LSS::ssdescs_impl(const cv::Mat& _oImage, std::vector<cv::KeyPoint>& voKeyp
         cv::GaussianBlur(_oImage,oImage,cv::Size(7,7),1.0);
     else
         oImage = _oImage;
-    const int nCorrWinRadius = m_nCorrWinSize/2;
     const int nPatchRadius = m_nPatchSize/2;
     const int nDescSize = m_nRadialBins*m_nAngularBins;
-    static thread_local lv::AutoBuffer<float> s_aCorrData;
-    s_aCorrData.resize(size_t(m_nCorrPatchSize*m_nCorrPatchSize));
-    cv::Mat_<float> oCorrMap(m_nCorrPatchSize,m_nCorrPatchSize,s_aCorrData.data());
-    static thread_local lv::AutoBuffer<float> s_aTempDesc;
-    s_aTempDesc.resize(((size_t)nDescSize));
-    cv::Mat_<float> oTempDesc(1,nDescSize,s_aTempDesc.data());
     if(bGenDescMap)
         oDescriptors.create(3,std::array<int,3>{oImage.rows,oImage.cols,nDescSize}.data());
     else
         oDescriptors.create(int(voKeypoints.size()),nDescSize);
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
     for(int nKeyPtIdx=0; nKeyPtIdx<int(voKeypoints.size()); ++nKeyPtIdx) {
+        static thread_local lv::AutoBuffer<int> s_aBinSSDs;
+        s_aBinSSDs.resize(size_t(nDescSize));
+        static thread_local lv::AutoBuffer<float> s_aTempDesc;
+        s_aTempDesc.resize(size_t(nDescSize));
+        cv::Mat_<float> oTempDesc(1,nDescSize,s_aTempDesc.data());
         const cv::KeyPoint& oCurrKeyPt = voKeypoints[nKeyPtIdx];
         const int nRowIdx = int(oCurrKeyPt.pt.y);
         const int nColIdx = int(oCurrKeyPt.pt.x);
         lvDbgAssert(nRowIdx>=0 && nColIdx>=0);
-        const cv::Mat oWindow = oImage(cv::Rect(nColIdx-nCorrWinRadius,nRowIdx-nCorrWinRadius,m_nCorrWinSize,m_nCorrWinSize));
-        const cv::Mat oTempl = oImage(cv::Rect(nColIdx-nPatchRadius,nRowIdx-nPatchRadius,m_nPatchSize,m_nPatchSize));
-        cv::matchTemplate(oWindow,oTempl,oCorrMap,cv::TM_SQDIFF);
+        std::fill_n(s_aBinSSDs.data(),nDescSize,std::numeric_limits<int>::max());
+        for(int nDescBinIdx=m_nFirstMaskIdx; nDescBinIdx<=m_nLastMaskIdx; ++nDescBinIdx) {
+            if(m_oDescLUMap(nDescBinIdx)!=-1) {
+                const int nSSD = calcPatchSSD(oImage,nRowIdx,nColIdx,nDescBinIdx/m_nCorrPatchSize-m_nOuterRadius,nDescBinIdx%m_nCorrPatchSize-m_nOuterRadius,nPatchRadius);
+                s_aBinSSDs[m_oDescLUMap(nDescBinIdx)] = std::min(s_aBinSSDs[m_oDescLUMap(nDescBinIdx)],nSSD);
+            }
+        }
 #if USE_STATIC_VAR_NOISE
         const float fVarNormFact = -1.0f/m_fStaticNoiseVar;
 #else //!USE_STATIC_VAR_NOISE
-        float fMaxLocalVarNoise = 1000.0f;
+        int nMaxLocalVarNoise = 1000;
         for(int nRowOffset=-1; nRowOffset<=1 ; ++nRowOffset)
             for(int nColOffset=-1; nColOffset<=1; ++nColOffset)
-                fMaxLocalVarNoise = std::max(fMaxLocalVarNoise,oCorrMap(m_nCorrPatchSize/2+nRowOffset,m_nCorrPatchSize/2+nColOffset));
-        const float fVarNormFact = -1.0f/fMaxLocalVarNoise;
+                nMaxLocalVarNoise = std::max(nMaxLocalVarNoise,calcPatchSSD(oImage,nRowIdx,nColIdx,nRowOffset,nColOffset,nPatchRadius));
+        const float fVarNormFact = -1.0f/float(nMaxLocalVarNoise);
 #endif //!USE_STATIC_VAR_NOISE
-        oTempDesc = std::numeric_limits<float>::max();
-        for(int nDescBinIdx=m_nFirstMaskIdx; nDescBinIdx<=m_nLastMaskIdx; ++nDescBinIdx)
-            if(m_oDescLUMap(nDescBinIdx)!=-1)
-                s_aTempDesc[m_oDescLUMap(nDescBinIdx)] = std::min(s_aTempDesc[m_oDescLUMap(nDescBinIdx)],((float*)oCorrMap.data)[nDescBinIdx]);
-        oTempDesc *= fVarNormFact;
+        for(int nDescIdx=0; nDescIdx<nDescSize; ++nDescIdx)
+            s_aTempDesc[nDescIdx] = float(s_aBinSSDs[nDescIdx])*fVarNormFact;
         cv::exp(oTempDesc,cv::Mat_<float>(1,nDescSize,bGenDescMap?oDescriptors.ptr<float>(nRowIdx,nColIdx):oDescriptors.ptr<float>(nKeyPtIdx)));
     }
     if(m_bNormalizeBins)
@@ -283,36 +361,60 @@ void LSS::ssdescs_impl(const cv::Mat& _oImage, cv::Mat_<float>& oDescriptors) {
     oDescriptors.create(3,anDescDims);
     std::fill_n(oDescriptors.ptr<float>(0,0),nDescSize*nCorrWinRadius*nCols,0.0f);
     std::fill_n(oDescriptors.ptr<float>(nRows-nCorrWinRadius,0),nDescSize*nCorrWinRadius*nCols,0.0f);
+    const int nOutCols = nCols-nCorrWinRadius*2;
+    const size_t nOutPxCount = size_t(nRows-nCorrWinRadius*2)*size_t(nOutCols);
+    // each lookup offset's SSD surface is computed once for the whole image, and min-reduced into its bin plane
+    std::vector<std::vector<cv::Point2i>> vvBinOffsets(size_t(nDescSize));
+    for(int nDescBinIdx=m_nFirstMaskIdx; nDescBinIdx<=m_nLastMaskIdx; ++nDescBinIdx)
+        if(m_oDescLUMap(nDescBinIdx)!=-1)
+            vvBinOffsets[m_oDescLUMap(nDescBinIdx)].emplace_back(nDescBinIdx%m_nCorrPatchSize-m_nOuterRadius,nDescBinIdx/m_nCorrPatchSize-m_nOuterRadius);
+#if !USE_STATIC_VAR_NOISE
+    // extra plane used to max-reduce the local noise variation around each pixel
+    vvBinOffsets.emplace_back();
+    for(int nRowOffset=-1; nRowOffset<=1 ; ++nRowOffset)
+        for(int nColOffset=-1; nColOffset<=1; ++nColOffset)
+            vvBinOffsets.back().emplace_back(nColOffset,nRowOffset);
+#endif //!USE_STATIC_VAR_NOISE
+    // the bin planes span the whole image (tens of MB), so they are released on return instead of being kept alive per thread
+    lv::AutoBuffer<int> aBinSSDPlanes(vvBinOffsets.size()*nOutPxCount);
+    int* const aBinSSDs = aBinSSDPlanes.data();
+#if USING_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif //USING_OPENMP
+    for(int nPlaneIdx=0; nPlaneIdx<int(vvBinOffsets.size()); ++nPlaneIdx) {
+        static thread_local lv::AutoBuffer<int> s_aColSums;
+        s_aColSums.resize(size_t(nOutCols+m_nPatchSize-1));
+        int* const aPlaneSSDs = aBinSSDs+nPlaneIdx*nOutPxCount;
+        if(nPlaneIdx<nDescSize) {
+            std::fill_n(aPlaneSSDs,nOutPxCount,std::numeric_limits<int>::max());
+            for(const cv::Point2i& oOffset : vvBinOffsets[nPlaneIdx])
+                reduceShiftedSSDs(oImage,nCorrWinRadius,nPatchRadius,oOffset.y,oOffset.x,s_aColSums.data(),aPlaneSSDs,[](int& nCurr, int nNew) {nCurr = std::min(nCurr,nNew);});
+        }
+        else {
+            std::fill_n(aPlaneSSDs,nOutPxCount,1000);
+            for(const cv::Point2i& oOffset : vvBinOffsets[nPlaneIdx])
+                reduceShiftedSSDs(oImage,nCorrWinRadius,nPatchRadius,oOffset.y,oOffset.x,s_aColSums.data(),aPlaneSSDs,[](int& nCurr, int nNew) {nCurr = std::max(nCurr,nNew);});
+        }
+    }
+#if USE_STATIC_VAR_NOISE
+    const float fVarNormFact = -1.0f/m_fStaticNoiseVar;
+#endif //USE_STATIC_VAR_NOISE
 #if USING_OPENMP
     #pragma omp parallel for
 #endif //USING_OPENMP
     for(int nRowIdx=nCorrWinRadius; nRowIdx<nRows-nCorrWinRadius; ++nRowIdx) {
-        static thread_local lv::AutoBuffer<float> s_aCorrData;
-        s_aCorrData.resize(size_t(m_nCorrPatchSize*m_nCorrPatchSize));
-        cv::Mat_<float> oCorrMap(m_nCorrPatchSize,m_nCorrPatchSize,s_aCorrData.data());
         static thread_local lv::AutoBuffer<float> s_aTempDesc;
         s_aTempDesc.resize(size_t(nDescSize));
         cv::Mat_<float> oTempDesc(1,nDescSize,s_aTempDesc.data());
         std::fill_n(oDescriptors.ptr<float>(nRowIdx,0),nDescSize*nCorrWinRadius,0.0f);
         std::fill_n(oDescriptors.ptr<float>(nRowIdx,nCols-nCorrWinRadius),nDescSize*nCorrWinRadius,0.0f);
         for(int nColIdx=nCorrWinRadius; nColIdx<nCols-nCorrWinRadius; ++nColIdx) {
-            const cv::Mat oWindow = oImage(cv::Rect(nColIdx-nCorrWinRadius,nRowIdx-nCorrWinRadius,m_nCorrWinSize,m_nCorrWinSize));
-            const cv::Mat oTempl = oImage(cv::Rect(nColIdx-nPatchRadius,nRowIdx-nPatchRadius,m_nPatchSize,m_nPatchSize));
-            cv::matchTemplate(oWindow,oTempl,oCorrMap,cv::TM_SQDIFF);
-#if USE_STATIC_VAR_NOISE
-            const float fVarNormFact = -1.0f/m_fStaticNoiseVar;
-#else //!USE_STATIC_VAR_NOISE
-            float fMaxLocalVarNoise = 1000.0f;
-            for(int nRowOffset=-1; nRowOffset<=1 ; ++nRowOffset)
-                for(int nColOffset=-1; nColOffset<=1; ++nColOffset)
-                    fMaxLocalVarNoise = std::max(fMaxLocalVarNoise,oCorrMap(m_nCorrPatchSize/2+nRowOffset,m_nCorrPatchSize/2+nColOffset));
-            const float fVarNormFact = -1.0f/fMaxLocalVarNoise;
+            const size_t nOutPxIdx = size_t(nRowIdx-nCorrWinRadius)*nOutCols+size_t(nColIdx-nCorrWinRadius);
+#if !USE_STATIC_VAR_NOISE
+            const float fVarNormFact = -1.0f/float(aBinSSDs[nDescSize*nOutPxCount+nOutPxIdx]);
 #endif //!USE_STATIC_VAR_NOISE
-            oTempDesc = std::numeric_limits<float>::max();
-            for(int nDescBinIdx=m_nFirstMaskIdx; nDescBinIdx<=m_nLastMaskIdx; ++nDescBinIdx)
-                if(m_oDescLUMap(nDescBinIdx)!=-1)
-                    s_aTempDesc[m_oDescLUMap(nDescBinIdx)] = std::min(s_aTempDesc[m_oDescLUMap(nDescBinIdx)],((float*)oCorrMap.data)[nDescBinIdx]);
-            oTempDesc *= fVarNormFact;
+            for(int nDescIdx=0; nDescIdx<nDescSize; ++nDescIdx)
+                s_aTempDesc[nDescIdx] = float(aBinSSDs[nDescIdx*nOutPxCount+nOutPxIdx])*fVarNormFact;
             cv::exp(oTempDesc,cv::Mat_<float>(1,nDescSize,oDescriptors.ptr<float>(nRowIdx,nColIdx)));
         }
     }
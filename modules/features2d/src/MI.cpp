@@ -20,6 +20,7 @@
 #define SKIP_MINMAX_HIST    false
 
 #include "litiv/features2d/MI.hpp"
+#include <unordered_map>
 
 namespace {
     // helper variables for internal impl (helps avoid continuous mem realloc)
@@ -27,6 +28,128 @@ namespace {
     thread_local lv::JointSparseHistData<ushort,uchar> g_oSparse24BitHistData;
     thread_local lv::JointDenseHistData<uchar,uchar> g_oDenseHistData;
     thread_local lv::JointDenseHistData<ushort,uchar> g_oDense24BitHistData;
+
+    inline void resetJointCounts(std::vector<int>& vJointCounts, size_t nJointStates) {
+        vJointCounts.assign(nJointStates,0);
+    }
+
+    inline void resetJointCounts(std::unordered_map<uint,int>& mJointCounts, size_t /*nJointStates*/) {
+        mJointCounts.clear();
+    }
+
+    inline int updateJointCount(std::vector<int>& vJointCounts, uint nJointIdx, int nIncr) {
+        return (vJointCounts[nJointIdx] += nIncr);
+    }
+
+    inline int updateJointCount(std::unordered_map<uint,int>& mJointCounts, uint nJointIdx, int nIncr) {
+        const auto pJointCount = mJointCounts.emplace(nJointIdx,0).first;
+        const int nNewJointCount = (pJointCount->second += nIncr);
+        if(nNewJointCount==0)
+            mJointCounts.erase(pJointCount); // keeps the map small while sliding over large images
+        return nNewJointCount;
+    }
+
+    /// joint & marginal histogram counts for a sliding window; keeps the sum(c*log2(c)) terms needed to evaluate the MI score in O(1) up to date
+    template<typename T1, typename T2>
+    struct SlidingJointHist {
+        static constexpr size_t s_nStates1 = size_t(std::numeric_limits<T1>::max())+1;
+        static constexpr size_t s_nStates2 = size_t(std::numeric_limits<T2>::max())+1;
+        /// 8-bit pairs use a flat joint histogram, but a 24-bit pair would require 64MB per thread, so a hash map is used instead
+        typedef std::conditional_t<(sizeof(T1)+sizeof(T2)<=2),std::vector<int>,std::unordered_map<uint,int>> JointCountMap;
+        /// prepares the c*log2(c) lookup table for windows of up to nMaxCount elements; counts are only cleared here on first use, as callers
+        /// are expected to remove all the samples they added (which is much cheaper than clearing full histograms for each row sweep)
+        void reset(int nMaxCount) {
+            if(m_vXLog2X.size()!=size_t(nMaxCount+1)) {
+                m_vXLog2X.resize(size_t(nMaxCount+1));
+                m_vXLog2X[0] = 0.0;
+                for(int nCount=1; nCount<=nMaxCount; ++nCount)
+                    m_vXLog2X[nCount] = nCount*std::log2(double(nCount));
+                m_vMargCounts1.assign(s_nStates1,0);
+                m_vMargCounts2.assign(s_nStates2,0);
+                resetJointCounts(m_oJointCounts,s_nStates1*s_nStates2);
+                m_nCount = 0;
+            }
+            lvDbgAssert(m_nCount==0);
+            m_dMargSum1 = m_dMargSum2 = m_dJointSum = 0.0; // drops the rounding errors accumulated in the previous sweep
+        }
+        /// adds (nIncr=1) or removes (nIncr=-1) a sample pair from the histograms
+        inline void update(T1 nVal1, T2 nVal2, int nIncr) {
+            int& nMargCount1 = m_vMargCounts1[nVal1];
+            m_dMargSum1 -= m_vXLog2X[nMargCount1];
+            m_dMargSum1 += m_vXLog2X[nMargCount1+=nIncr];
+            int& nMargCount2 = m_vMargCounts2[nVal2];
+            m_dMargSum2 -= m_vXLog2X[nMargCount2];
+            m_dMargSum2 += m_vXLog2X[nMargCount2+=nIncr];
+            const int nNewJointCount = updateJointCount(m_oJointCounts,uint(nVal1)*uint(s_nStates2)+uint(nVal2),nIncr);
+            m_dJointSum += m_vXLog2X[nNewJointCount]-m_vXLog2X[nNewJointCount-nIncr];
+            m_nCount += nIncr;
+            lvDbgAssert(nMargCount1>=0 && nMargCount2>=0 && nNewJointCount>=0 && m_nCount>=0);
+        }
+        /// returns the MI score of the samples currently in the histograms, i.e. sum(p12*log2(p12/p1/p2)) rewritten using raw counts
+        inline double score(bool bNormalize) const {
+            lvDbgAssert(m_nCount>0);
+            const double dCount = double(m_nCount);
+            const double dLog2Count = std::log2(dCount);
+            const double dMutualInfoScore = std::max((m_dJointSum-m_dMargSum1-m_dMargSum2)/dCount+dLog2Count,0.0);
+            if(bNormalize) {
+                // sums are updated incrementally, so constant windows might give slightly non-null entropies (the smallest valid one is ~log2(N)/N)
+                const double dMargEntropy1 = dLog2Count-m_dMargSum1/dCount;
+                const double dMargEntropy2 = dLog2Count-m_dMargSum2/dCount;
+                if(dMargEntropy1>1e-6 && dMargEntropy2>1e-6)
+                    return dMutualInfoScore/std::sqrt(dMargEntropy1*dMargEntropy2);
+            }
+            return dMutualInfoScore;
+        }
+        std::vector<double> m_vXLog2X;
+        std::vector<int> m_vMargCounts1,m_vMargCounts2;
+        JointCountMap m_oJointCounts;
+        double m_dMargSum1,m_dMargSum2,m_dJointSum;
+        int m_nCount;
+    };
+
+    /// fills the dense MI score map by sliding windows along each row, for each disparity offset (windows in image2 are offset by +disp cols)
+    template<typename T1, typename T2>
+    void calcSlidingMutualInfo(const cv::Mat_<T1>& oImage1, const cv::Mat_<T2>& oImage2, const cv::Size& oWinSize, bool bNormalize,
+                               const std::vector<int>& vDispRange, cv::Mat_<float>& oScoreMap,
+                               const cv::Mat_<uchar>& oROI1, const cv::Mat_<uchar>& oROI2) {
+        const int nRows = oImage1.rows;
+        const int nCols = oImage1.cols;
+        const int nWinRadiusX = oWinSize.width/2;
+        const int nWinRadiusY = oWinSize.height/2;
+        const int nOffsets = int(vDispRange.size());
+        const int nValidRows = nRows-nWinRadiusY*2;
+        const bool bValidROI1 = !oROI1.empty();
+        const bool bValidROI2 = !oROI2.empty();
+    #if USING_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif //USING_OPENMP
+        for(int nJobIdx=0; nJobIdx<nValidRows*nOffsets; ++nJobIdx) {
+            const int nRowIdx = nJobIdx/nOffsets+nWinRadiusY;
+            const int nOffsetIdx = nJobIdx%nOffsets;
+            const int nColOffset = vDispRange[nOffsetIdx];
+            const int nFirstColIdx = std::max(nWinRadiusX,nWinRadiusX-nColOffset);
+            const int nEndColIdx = std::min(nCols-nWinRadiusX,nCols-nWinRadiusX-nColOffset);
+            if(nFirstColIdx>=nEndColIdx)
+                continue;
+            static thread_local SlidingJointHist<T1,T2> s_oHist;
+            s_oHist.reset(oWinSize.area());
+            const auto lUpdateColumn = [&](int nColIdx, int nIncr) {
+                for(int nWinRowIdx=nRowIdx-nWinRadiusY; nWinRowIdx<=nRowIdx+nWinRadiusY; ++nWinRowIdx)
+                    s_oHist.update(oImage1(nWinRowIdx,nColIdx),oImage2(nWinRowIdx,nColIdx+nColOffset),nIncr);
+            };
+            for(int nWinColIdx=nFirstColIdx-nWinRadiusX; nWinColIdx<nFirstColIdx+nWinRadiusX; ++nWinColIdx)
+                lUpdateColumn(nWinColIdx,1);
+            for(int nColIdx=nFirstColIdx; nColIdx<nEndColIdx; ++nColIdx) {
+                if(nColIdx>nFirstColIdx)
+                    lUpdateColumn(nColIdx-nWinRadiusX-1,-1);
+                lUpdateColumn(nColIdx+nWinRadiusX,1);
+                if((!bValidROI1 || oROI1(nRowIdx,nColIdx)) && (!bValidROI2 || oROI2(nRowIdx,nColIdx+nColOffset)))
+                    oScoreMap(nRowIdx,nColIdx,nOffsetIdx) = float(s_oHist.score(bNormalize));
+            }
+            for(int nWinColIdx=nEndColIdx-1-nWinRadiusX; nWinColIdx<=nEndColIdx-1+nWinRadiusX; ++nWinColIdx)
+                lUpdateColumn(nWinColIdx,-1);
+        }
+    }
 }
 
 MutualInfo::MutualInfo(const cv::Size& oWinSize, bool bNormalize, bool bUseDenseHist, bool bUse24BitPair) :
@@ -143,6 +266,26 @@ void MutualInfo::compute(const cv::Mat& _oImage1, const cv::Mat& _oImage2, const
         lvError("unsupported input matrices types (need 8uc1 on both, or 8uc1+8uc3 if using 24bit pair)");
 }
 
+void MutualInfo::compute2(const cv::Mat& _oImage1, const cv::Mat& _oImage2, const std::vector<int>& vDispRange, cv::Mat_<float>& oScoreMap,
+                          const cv::Mat_<uchar>& oROI1, const cv::Mat_<uchar>& oROI2) {
+    lvAssert_(!_oImage1.empty() && _oImage1.dims==2 && _oImage1.size()==_oImage2.size(),"invalid input image(s) size");
+    lvAssert_(_oImage1.rows>=m_oWinSize.height && _oImage1.cols>=m_oWinSize.width,"window too large for input images");
+    lvAssert_(oROI1.empty() || oROI1.size()==_oImage1.size(),"bad ROI1 map size");
+    lvAssert_(oROI2.empty() || oROI2.size()==_oImage2.size(),"bad ROI2 map size");
+    lvAssert_(!vDispRange.empty(),"bad disparity range");
+    const std::array<int,3> anScoreMapDims = {_oImage1.rows,_oImage1.cols,int(vDispRange.size())};
+    oScoreMap.create(3,anScoreMapDims.data());
+    oScoreMap = -1.0f; // default value for OOB pixels
+    if(m_bUse24BitPair && _oImage1.type()==CV_8UC3 && _oImage2.type()==CV_8UC1)
+        calcSlidingMutualInfo(lv::cvtBGRToPackedYCbCr(_oImage1),cv::Mat_<uchar>(_oImage2),m_oWinSize,m_bNormalize,vDispRange,oScoreMap,oROI1,oROI2);
+    else if(m_bUse24BitPair && _oImage1.type()==CV_8UC1 && _oImage2.type()==CV_8UC3)
+        calcSlidingMutualInfo(cv::Mat_<uchar>(_oImage1),lv::cvtBGRToPackedYCbCr(_oImage2),m_oWinSize,m_bNormalize,vDispRange,oScoreMap,oROI1,oROI2);
+    else if(_oImage1.type()==CV_8UC1 && _oImage2.type()==CV_8UC1)
+        calcSlidingMutualInfo(cv::Mat_<uchar>(_oImage1),cv::Mat_<uchar>(_oImage2),m_oWinSize,m_bNormalize,vDispRange,oScoreMap,oROI1,oROI2);
+    else
+        lvError("unsupported input matrices types (need 8uc1 on both, or 8uc1+8uc3 if using 24bit pair)");
+}
+
 std::vector<double> MutualInfo::compute(const cv::Mat& oImage1, const cv::Mat& oImage2, const std::vector<cv::KeyPoint>& voKeypoints) {
     std::vector<double> vdScores;
     compute(oImage1,oImage2,voKeypoints,vdScores);
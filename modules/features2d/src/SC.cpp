@@ -239,6 +239,51 @@ void ShapeContext::compute2(const cv::Mat& oImage, cv::Mat_<float>& oDescMap) {
         scdesc_fill_desc(oDescMap,true);
 }
 
+void ShapeContext::compute2(const cv::Mat& oImage, cv::Mat_<float>& oDescMap, cv::Mat_<cv::Point2f>& oPrevContourPts, const cv::Rect& oUpdateROI) {
+    lvAssert_(!oImage.empty() && oImage.dims==2,"input image must be non-empty and 2D");
+    bool bCanUpdate = USE_LIENHART_LOOKUP_MASK && !m_bUseRelativeSpace && !m_bRotationInvariant &&
+                      oDescMap.dims==3 && oDescMap.size[0]==oImage.rows && oDescMap.size[1]==oImage.cols && oDescMap.size[2]==m_nDescSize;
+#if HAVE_CUDA
+    bCanUpdate &= !m_bUseCUDA;
+#endif //HAVE_CUDA
+    if(!bCanUpdate) {
+        compute2(oImage,oDescMap);
+        m_oContourPts.copyTo(oPrevContourPts);
+        return;
+    }
+    scdesc_fill_contours(oImage);
+    // contour points that were added or removed since the previous input (duplicates are counted)
+    cv::Mat_<short> oContourDiff(m_oCurrImageSize,short(0));
+    const cv::Rect oImageRect(cv::Point(0,0),m_oCurrImageSize);
+    const cv::Rect oValidROI = (oUpdateROI.area()>0)?(oUpdateROI&oImageRect):oImageRect;
+    const auto lAccumContourPts = [&](const cv::Mat_<cv::Point2f>& oContourPts, short nIncr) {
+        for(int nContourPtIdx=0; nContourPtIdx<(int)oContourPts.total(); ++nContourPtIdx) {
+            const cv::Point2f& vContourPt = ((const cv::Point2f*)oContourPts.data)[nContourPtIdx];
+            const cv::Point vContourPtInt((int)std::round(vContourPt.x),(int)std::round(vContourPt.y));
+            if(oValidROI.contains(vContourPtInt))
+                oContourDiff(vContourPtInt) += nIncr;
+        }
+    };
+    lAccumContourPts(oPrevContourPts,short(-1));
+    lAccumContourPts(m_oContourPts,short(1));
+    m_oContourPts.copyTo(oPrevContourPts);
+    const cv::Mat_<uchar> oChangedMask = (oContourDiff!=0);
+    if(cv::countNonZero(oChangedMask)==0)
+        return;
+    // pixels whose support region (or dist mask status) may have been touched by a changed contour point
+    cv::Mat_<uchar> oUpdateMask;
+    cv::dilate(oChangedMask,oUpdateMask,m_oDilateKernel);
+    cv::dilate(oUpdateMask,oUpdateMask,cv::Mat());
+    const float fInitVal = m_bNonZeroInitBins?std::max(10.0f/m_nDescSize,0.5f):0.0f;
+    for(int nRowIdx=0; nRowIdx<m_oCurrImageSize.height; ++nRowIdx)
+        for(int nColIdx=0; nColIdx<m_oCurrImageSize.width; ++nColIdx)
+            if(oUpdateMask(nRowIdx,nColIdx))
+                std::fill_n(oDescMap.ptr<float>(nRowIdx,nColIdx),m_nDescSize,fInitVal);
+    scdesc_fill_desc_scatter(oDescMap,oUpdateMask);
+    if(m_bNormalizeBins)
+        scdesc_norm(oDescMap,oUpdateMask);
+}
+
 void ShapeContext::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& voKeypoints, cv::Mat_<float>& oDescMap) {
     scdesc_fill_contours(oImage);
     m_bUsingFullKeyPtMap = false;
@@ -265,15 +310,48 @@ void ShapeContext::compute2(const cv::Mat& oImage, std::vector<cv::KeyPoint>& vo
 
 void ShapeContext::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],voDescMapCollection[i]);
+    // contours & maps are kept in member buffers, so each extra slot lazily gets its own extractor copy (which shares the lookup masks)
+    std::vector<std::unique_ptr<ShapeContext>> vpSlotExtractors(getBatchSlotCount());
+    lv::parallel_for_slots(voImageCollection.size(),vpSlotExtractors.size(),[&](size_t nSlotIdx, size_t nImageIdx) {
+        if(nSlotIdx>0 && !vpSlotExtractors[nSlotIdx])
+            vpSlotExtractors[nSlotIdx] = createBatchWorker();
+        ShapeContext& oExtractor = (nSlotIdx==0)?*this:*vpSlotExtractors[nSlotIdx];
+        oExtractor.compute2(voImageCollection[nImageIdx],voDescMapCollection[nImageIdx]);
+    });
 }
 
 void ShapeContext::compute2(const std::vector<cv::Mat>& voImageCollection, std::vector<std::vector<cv::KeyPoint> >& vvoPointCollection, std::vector<cv::Mat_<float>>& voDescMapCollection) {
     lvAssert_(voImageCollection.size()==vvoPointCollection.size(),"number of images must match number of keypoint lists");
     voDescMapCollection.resize(voImageCollection.size());
-    for(size_t i=0; i<voImageCollection.size(); i++)
-        compute2(voImageCollection[i],vvoPointCollection[i],voDescMapCollection[i]);
+    std::vector<std::unique_ptr<ShapeContext>> vpSlotExtractors(getBatchSlotCount());
+    lv::parallel_for_slots(voImageCollection.size(),vpSlotExtractors.size(),[&](size_t nSlotIdx, size_t nImageIdx) {
+        if(nSlotIdx>0 && !vpSlotExtractors[nSlotIdx])
+            vpSlotExtractors[nSlotIdx] = createBatchWorker();
+        ShapeContext& oExtractor = (nSlotIdx==0)?*this:*vpSlotExtractors[nSlotIdx];
+        oExtractor.compute2(voImageCollection[nImageIdx],vvoPointCollection[nImageIdx],voDescMapCollection[nImageIdx]);
+    });
+}
+
+size_t ShapeContext::getBatchSlotCount() const {
+#if HAVE_CUDA
+    if(m_bUseCUDA)
+        return size_t(1); // device buffers & lookup texture belong to this instance, images are processed one at a time
+#endif //HAVE_CUDA
+    return lv::getSharedWorkerPool().workers();
+}
+
+std::unique_ptr<ShapeContext> ShapeContext::createBatchWorker() const {
+    std::unique_ptr<ShapeContext> pWorker(new ShapeContext(*this));
+    // limits & lookup maps are only written at construction, so they stay shared; per-image buffers must be detached
+    pWorker->m_oDistMap.release();
+    pWorker->m_oAngMap.release();
+    pWorker->m_oKeyPts.release();
+    pWorker->m_oContourPts.release();
+    pWorker->m_oBinMask.release();
+    pWorker->m_oDistMask.release();
+    pWorker->m_oCurrImageSize = cv::Size();
+    pWorker->m_bUsingFullKeyPtMap = false;
+    return pWorker;
 }
 
 void ShapeContext::detectAndCompute(cv::InputArray _oImage, cv::InputArray _oMask, std::vector<cv::KeyPoint>& voKeypoints, cv::OutputArray _oDescriptors, bool bUseProvidedKeypoints) {
@@ -447,8 +525,11 @@ void ShapeContext::scdesc_fill_maps(double dMeanDist) {
         vMassCenter.x = vMassCenter.x/m_oContourPts.total();
         vMassCenter.y = vMassCenter.y/m_oContourPts.total();
     }
-    cv::Matx12f vPtDiff;
+#if USING_OPENMP
+    #pragma omp parallel for
+#endif //USING_OPENMP
     for(int nKeyPtIdx=0; nKeyPtIdx<(int)m_oKeyPts.total(); ++nKeyPtIdx) {
+        cv::Matx12f vPtDiff;
         for(int nContourPtIdx=0; nContourPtIdx<(int)m_oContourPts.total(); ++nContourPtIdx) {
             const cv::Point2f& vKeyPt = ((cv::Point2f*)m_oKeyPts.data)[nKeyPtIdx];
             const cv::Point2f& vContourPt = ((cv::Point2f*)m_oContourPts.data)[nContourPtIdx];
@@ -485,6 +566,9 @@ void ShapeContext::scdesc_fill_desc(cv::Mat_<float>& oDescriptors, bool bGenDesc
         oDescriptors.create((int)m_oKeyPts.total(),m_nDescSize);
     oDescriptors = m_bNonZeroInitBins?std::max(10.0f/m_nDescSize,0.5f):0.0f;
     scdesc_fill_maps();
+#if USING_OPENMP
+    #pragma omp parallel for if(!bGenDescMap || m_bUsingFullKeyPtMap)
+#endif //USING_OPENMP
     for(int nKeyPtIdx=0; nKeyPtIdx<(int)m_oKeyPts.total(); ++nKeyPtIdx) {
         const cv::Point2f& vKeyPt = ((cv::Point2f*)m_oKeyPts.data)[nKeyPtIdx];
         const int nKeyPtRowIdx = (int)std::round(vKeyPt.y);
@@ -552,6 +636,14 @@ void ShapeContext::scdesc_fill_desc_direct(cv::Mat_<float>& oDescriptors, bool b
     else
         oDescriptors.create((int)m_oKeyPts.total(),m_nDescSize);
     oDescriptors = m_bNonZeroInitBins?std::max(10.0f/m_nDescSize,0.5f):0.0f;
+#if USE_LIENHART_LOOKUP_MASK
+    if(bGenDescMap && m_bUsingFullKeyPtMap) {
+        scdesc_fill_desc_scatter(oDescriptors);
+        if(m_bNormalizeBins)
+            scdesc_norm(oDescriptors);
+        return;
+    }
+#endif //USE_LIENHART_LOOKUP_MASK
 #if USING_OPENMP
     #pragma omp parallel for
 #endif //USING_OPENMP
@@ -604,17 +696,83 @@ void ShapeContext::scdesc_fill_desc_direct(cv::Mat_<float>& oDescriptors, bool b
         scdesc_norm(oDescriptors);
 }
 
-void ShapeContext::scdesc_norm(cv::Mat_<float>& oDescriptors) const {
+void ShapeContext::scdesc_fill_desc_scatter(cv::Mat_<float>& oDescriptors, const cv::Mat_<uchar>& oUpdateMask) {
+    lvAssert_(!m_bUseRelativeSpace && !m_bRotationInvariant,"scatter impl cannot handle relative dist space/rot inv");
+    lvAssert_(USE_LIENHART_LOOKUP_MASK,"scatter impl requires lienhart-style lookup mask");
+    lvDbgAssert(oDescriptors.dims==3 && oDescriptors.size[0]==m_oCurrImageSize.height && oDescriptors.size[1]==m_oCurrImageSize.width && oDescriptors.size[2]==m_nDescSize);
+    lvDbgAssert(oUpdateMask.empty() || oUpdateMask.size()==m_oCurrImageSize);
+    lvDbgAssert(m_oDistMask.size()==m_oCurrImageSize);
+    // dense maps are filled by scattering each contour point into the descriptors of the pixels it falls around (instead of
+    // gathering all contour points for each pixel); output rows are split into bands so that threads never share a descriptor
+    const int nRows = m_oCurrImageSize.height;
+    const int nCols = m_oCurrImageSize.width;
+    const int nContourPts = (int)m_oContourPts.total();
+    cv::Rect oUpdateBBox(0,0,nCols,nRows);
+    if(!oUpdateMask.empty()) {
+        int nMinRowIdx=nRows,nMaxRowIdx=-1,nMinColIdx=nCols,nMaxColIdx=-1;
+        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+            const uchar* pUpdateMaskRow = oUpdateMask.ptr<uchar>(nRowIdx);
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                if(pUpdateMaskRow[nColIdx]) {
+                    nMinRowIdx = std::min(nMinRowIdx,nRowIdx);
+                    nMaxRowIdx = std::max(nMaxRowIdx,nRowIdx);
+                    nMinColIdx = std::min(nMinColIdx,nColIdx);
+                    nMaxColIdx = std::max(nMaxColIdx,nColIdx);
+                }
+            }
+        }
+        if(nMaxRowIdx<0)
+            return;
+        oUpdateBBox = cv::Rect(nMinColIdx,nMinRowIdx,nMaxColIdx-nMinColIdx+1,nMaxRowIdx-nMinRowIdx+1);
+    }
+    std::vector<std::vector<cv::Vec2i>> vvLookupRows((size_t)m_oAbsDescLUMap.rows);
+    for(int nLookupRow=0; nLookupRow<m_oAbsDescLUMap.rows; ++nLookupRow)
+        for(int nLookupCol=0; nLookupCol<m_oAbsDescLUMap.cols; ++nLookupCol)
+            if(m_oAbsDescLUMap(nLookupRow,nLookupCol)!=-1)
+                vvLookupRows[nLookupRow].emplace_back(nLookupCol-m_nOuterRadius,m_oAbsDescLUMap(nLookupRow,nLookupCol));
+    constexpr int nBandSize = 8;
+    const int nBands = (oUpdateBBox.height+nBandSize-1)/nBandSize;
+#if USING_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif //USING_OPENMP
+    for(int nBandIdx=0; nBandIdx<nBands; ++nBandIdx) {
+        const int nBandFirstRow = oUpdateBBox.y+nBandIdx*nBandSize;
+        const int nBandEndRow = std::min(nBandFirstRow+nBandSize,oUpdateBBox.y+oUpdateBBox.height);
+        for(int nContourPtIdx=0; nContourPtIdx<nContourPts; ++nContourPtIdx) {
+            const cv::Point2f& vContourPt = ((cv::Point2f*)m_oContourPts.data)[nContourPtIdx];
+            const int nContourPtRowIdx = (int)std::round(vContourPt.y);
+            const int nContourPtColIdx = (int)std::round(vContourPt.x);
+            if(nContourPtColIdx+m_nOuterRadius<oUpdateBBox.x || nContourPtColIdx-m_nOuterRadius>=oUpdateBBox.x+oUpdateBBox.width)
+                continue;
+            const int nFirstRowIdx = std::max(nBandFirstRow,nContourPtRowIdx-m_nOuterRadius);
+            const int nEndRowIdx = std::min(nBandEndRow,nContourPtRowIdx+m_nOuterRadius+1);
+            for(int nRowIdx=nFirstRowIdx; nRowIdx<nEndRowIdx; ++nRowIdx) {
+                const uchar* pDistMaskRow = m_oDistMask.ptr<uchar>(nRowIdx);
+                const uchar* pUpdateMaskRow = oUpdateMask.empty()?pDistMaskRow:oUpdateMask.ptr<uchar>(nRowIdx);
+                for(const cv::Vec2i& vLookup : vvLookupRows[nContourPtRowIdx-nRowIdx+m_nOuterRadius]) {
+                    const int nColIdx = nContourPtColIdx-vLookup[0];
+                    if(nColIdx>=0 && nColIdx<nCols && pDistMaskRow[nColIdx] && pUpdateMaskRow[nColIdx])
+                        ++(oDescriptors.ptr<float>(nRowIdx,nColIdx)[vLookup[1]]);
+                }
+            }
+        }
+    }
+}
+
+void ShapeContext::scdesc_norm(cv::Mat_<float>& oDescriptors, const cv::Mat_<uchar>& oUpdateMask) const {
     if(oDescriptors.empty())
         return;
     lvDbgAssert((oDescriptors.total()%size_t(m_nDescSize))==0);
     lvDbgAssert(oDescriptors.size[oDescriptors.dims-1]==m_nDescSize);
     lvDbgAssert(oDescriptors.isContinuous());
+    lvDbgAssert(oUpdateMask.empty() || (oUpdateMask.isContinuous() && oUpdateMask.total()*m_nDescSize==oDescriptors.total()));
     const float fDefaultVal = std::sqrt(1.0f/m_nDescSize);
 #if USING_OPENMP
     #pragma omp parallel for
 #endif //USING_OPENMP
     for(int nDescIdx=0; nDescIdx<(int)oDescriptors.total(); nDescIdx+=m_nDescSize) {
+        if(!oUpdateMask.empty() && !oUpdateMask.data[nDescIdx/m_nDescSize])
+            continue;
         cv::Mat_<float> oCurrDesc(1,m_nDescSize,((float*)oDescriptors.data)+nDescIdx);
         const double dNorm = cv::norm(oCurrDesc,cv::NORM_L2);
         if(dNorm>1e-5)
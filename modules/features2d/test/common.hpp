@@ -0,0 +1,37 @@
+#pragma once
+
+#include "litiv/utils/opencv.hpp"
+#include "litiv/test.hpp"
+
+/// checks that batch descriptor computation matches image-by-image computation (dense maps, and keypoint maps if requested)
+template<typename TElem, typename TDescMap, typename TExtractor>
+void testBatchCompute(TExtractor& oExtractor, const std::vector<cv::Mat>& voInputs, bool bCheckKeyPoints=true) {
+    std::vector<TDescMap> voBatchDescMaps;
+    oExtractor.compute2(voInputs,voBatchDescMaps);
+    ASSERT_EQ(voBatchDescMaps.size(),voInputs.size());
+    for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx) {
+        TDescMap oDescMap;
+        oExtractor.compute2(voInputs[nImageIdx],oDescMap);
+        ASSERT_EQ(lv::MatInfo(oDescMap),lv::MatInfo(voBatchDescMaps[nImageIdx])) << "nImageIdx=" << nImageIdx;
+        ASSERT_TRUE(lv::isEqual<TElem>(oDescMap,voBatchDescMaps[nImageIdx])) << "nImageIdx=" << nImageIdx;
+    }
+    if(!bCheckKeyPoints)
+        return;
+    std::vector<std::vector<cv::KeyPoint>> vvoBatchKeyPoints(voInputs.size());
+    for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx)
+        for(int nRowIdx=0; nRowIdx<voInputs[nImageIdx].rows; nRowIdx+=3)
+            for(int nColIdx=0; nColIdx<voInputs[nImageIdx].cols; nColIdx+=5)
+                vvoBatchKeyPoints[nImageIdx].emplace_back(cv::Point2f(float(nColIdx),float(nRowIdx)),1.0f);
+    const std::vector<std::vector<cv::KeyPoint>> vvoKeyPoints = vvoBatchKeyPoints;
+    std::vector<TDescMap> voBatchKPDescMaps;
+    oExtractor.compute2(voInputs,vvoBatchKeyPoints,voBatchKPDescMaps);
+    ASSERT_EQ(vvoBatchKeyPoints.size(),voInputs.size());
+    ASSERT_EQ(voBatchKPDescMaps.size(),voInputs.size());
+    for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx) {
+        std::vector<cv::KeyPoint> voKeyPoints = vvoKeyPoints[nImageIdx];
+        TDescMap oKPDescMap;
+        oExtractor.compute2(voInputs[nImageIdx],voKeyPoints,oKPDescMap);
+        ASSERT_EQ(voKeyPoints.size(),vvoBatchKeyPoints[nImageIdx].size()) << "nImageIdx=" << nImageIdx;
+        ASSERT_TRUE(lv::isEqual<TElem>(oKPDescMap,voBatchKPDescMaps[nImageIdx])) << "nImageIdx=" << nImageIdx;
+    }
+}
@@ -1,6 +1,10 @@
 
 #include "litiv/features2d/DASC.hpp"
 #include "litiv/test.hpp"
+#include "common.hpp"
+#if USING_OPENMP
+#include <omp.h>
+#endif //USING_OPENMP
 
 TEST(dasc_rf,regression_constr) {
     EXPECT_THROW_LV_QUIET(std::make_unique<DASC>(0.0f,0.05f));
@@ -144,6 +148,40 @@ TEST(dasc_rf,regression_large_compute) {
 #endif //ndef(_MSC_VER)
 }
 
+TEST(dasc_rf,regression_dense_thread_invariance) {
+    // odd sizes exercise the scalar tails of the vectorized row steps and the partial column strips
+    for(const cv::Size& oSize : {cv::Size(131,97),cv::Size(67,203)}) {
+        cv::Mat oInput(oSize,CV_8UC3);
+        cv::randu(oInput,0,256);
+        cv::Mat_<float> oDescMap_1t, oDescMap_nt;
+    #if USING_OPENMP
+        const int nPrevThreads = omp_get_max_threads();
+        omp_set_num_threads(1);
+    #endif //USING_OPENMP
+        std::make_unique<DASC>(DASC_DEFAULT_RF_SIGMAS,DASC_DEFAULT_RF_SIGMAR)->compute2(oInput,oDescMap_1t);
+    #if USING_OPENMP
+        omp_set_num_threads(std::max(nPrevThreads,4));
+    #endif //USING_OPENMP
+        std::unique_ptr<DASC> pDASC = std::make_unique<DASC>(DASC_DEFAULT_RF_SIGMAS,DASC_DEFAULT_RF_SIGMAR);
+        pDASC->compute2(oInput,oDescMap_nt);
+        cv::Mat_<float> oDescMap_reuse;
+        pDASC->compute2(oInput,oDescMap_reuse);
+    #if USING_OPENMP
+        omp_set_num_threads(nPrevThreads);
+    #endif //USING_OPENMP
+        ASSERT_EQ(lv::MatInfo(oDescMap_1t),lv::MatInfo(oDescMap_nt));
+        ASSERT_EQ(oDescMap_1t.size[0],oSize.height);
+        ASSERT_EQ(oDescMap_1t.size[1],oSize.width);
+        ASSERT_TRUE(lv::isEqual<float>(oDescMap_1t,oDescMap_nt)) << "oSize=" << oSize;
+        ASSERT_TRUE(lv::isEqual<float>(oDescMap_nt,oDescMap_reuse)) << "oSize=" << oSize;
+        for(auto pVal=oDescMap_1t.begin(); pVal!=oDescMap_1t.end(); ++pVal) {
+            ASSERT_FALSE(std::isnan(*pVal));
+            ASSERT_GE(*pVal,0.0f);
+            ASSERT_LE(*pVal,1.0f+1e-5f);
+        }
+    }
+}
+
 TEST(dasc_gf,regression_constr) {
     EXPECT_THROW_LV_QUIET(lv::doNotOptimize(std::make_unique<DASC>(size_t(0),0.05f)));
     EXPECT_THROW_LV_QUIET(lv::doNotOptimize(std::make_unique<DASC>(size_t(1),0.0f)));
@@ -284,4 +322,68 @@ TEST(dasc_gf,regression_large_compute) {
     else
         lv::write(TEST_CURR_INPUT_DATA_ROOT "/test_dasc_gf_large.bin",oOutputDescs);
 #endif //ndef(_MSC_VER)
-}
\ No newline at end of file
+}
+
+TEST(dasc_gf,regression_batch_compute) {
+    std::unique_ptr<DASC> pDASC = std::make_unique<DASC>(DASC_DEFAULT_GF_RADIUS,DASC_DEFAULT_GF_EPS);
+    std::vector<cv::Mat> voInputs(7);
+    for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx) {
+        voInputs[nImageIdx].create(cv::Size(64+int(nImageIdx)*8,48),CV_8UC3);
+        cv::randu(voInputs[nImageIdx],0,256);
+    }
+    testBatchCompute<float,cv::Mat_<float>>(*pDASC,voInputs,false);
+}
+
+namespace {
+
+    void dasc_rf_perftest(benchmark::State& st) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        cv::Mat oInput(oSize,CV_8UC3);
+        cv::randu(oInput,0,256);
+        std::unique_ptr<DASC> pDASC = std::make_unique<DASC>(DASC_DEFAULT_RF_SIGMAS,DASC_DEFAULT_RF_SIGMAR);
+        cv::Mat_<float> oDescMap;
+        while(st.KeepRunning()) {
+            pDASC->compute2(oInput,oDescMap);
+            benchmark::DoNotOptimize(oDescMap.data);
+        }
+    }
+
+    void dasc_gf_perftest(benchmark::State& st) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        cv::Mat oInput(oSize,CV_8UC3);
+        cv::randu(oInput,0,256);
+        std::unique_ptr<DASC> pDASC = std::make_unique<DASC>(DASC_DEFAULT_GF_RADIUS,DASC_DEFAULT_GF_EPS,size_t(st.range(1)));
+        cv::Mat_<float> oDescMap;
+        while(st.KeepRunning()) {
+            pDASC->compute2(oInput,oDescMap);
+            benchmark::DoNotOptimize(oDescMap.data);
+        }
+        // items/s gives the throughput in pixels; the label gives the peak scratch footprint (all workers) per megapixel
+        st.SetItemsProcessed(int64_t(st.iterations())*oSize.area());
+        st.SetLabel(lv::putf("%.1f MB/MPx scratch",double(pDASC->getLastScratchSize())/oSize.area()));
+    }
+
+    void dasc_gf_batch_perftest(benchmark::State& st) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        std::vector<cv::Mat> voInputs(size_t(st.range(1)));
+        for(cv::Mat& oInput : voInputs) {
+            oInput.create(oSize,CV_8UC3);
+            cv::randu(oInput,0,256);
+        }
+        std::unique_ptr<DASC> pDASC = std::make_unique<DASC>(DASC_DEFAULT_GF_RADIUS,DASC_DEFAULT_GF_EPS);
+        std::vector<cv::Mat_<float>> voDescMaps;
+        while(st.KeepRunning()) {
+            pDASC->compute2(voInputs,voDescMaps);
+            benchmark::DoNotOptimize(voDescMaps.data());
+        }
+        st.SetItemsProcessed(int64_t(st.iterations())*int64_t(voInputs.size()));
+    }
+
+}
+
+// args = {image width}
+BENCHMARK(dasc_rf_perftest)->Arg(320)->Arg(640)->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+// args = {image width, subsampling factor}
+BENCHMARK(dasc_gf_perftest)->Args({320,1})->Args({640,1})->Args({640,2})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+// args = {image width, batch size}
+BENCHMARK(dasc_gf_batch_perftest)->Args({320,8})->Args({640,8})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
@@ -1,6 +1,7 @@
 
 #include "litiv/features2d/LBSP.hpp"
 #include "litiv/test.hpp"
+#include "common.hpp"
 
 TEST(lbsp,regression_constr) {
     EXPECT_THROW_LV_QUIET(std::make_unique<LBSP>(-0.5f));
@@ -77,4 +78,139 @@ TEST(lbsp,regression_compute) {
             ++nKeyPointIdx;
         }
     }
-}
\ No newline at end of file
+}
+
+namespace {
+
+    template<size_t nChannels>
+    void testStripDescriptors(const cv::Size& oSize) {
+        cv::Mat oInput(oSize,CV_8UC(int(nChannels)));
+        cv::randu(oInput,0,256);
+        std::array<uchar,UCHAR_MAX+1> anThresholdLUT;
+        for(size_t nVal=0; nVal<=UCHAR_MAX; ++nVal)
+            anThresholdLUT[nVal] = cv::saturate_cast<uchar>(nVal*0.333f+3);
+        const int nBorderSize = (int)LBSP::PATCH_SIZE/2;
+        const size_t nRowPxCount = size_t(oSize.width-nBorderSize*2);
+        std::vector<LBSP::desc_t> vnStripDescs(nRowPxCount*nChannels);
+        std::vector<uchar> vnStripLookups(nRowPxCount*nChannels*LBSP::DESC_SIZE_BITS);
+        for(int nRowIdx=nBorderSize; nRowIdx<oSize.height-nBorderSize; ++nRowIdx) {
+            LBSP::computeDescriptor_strip<nChannels>(oInput,nBorderSize,nRowIdx,nRowPxCount,anThresholdLUT,vnStripDescs.data());
+            LBSP::computeDescriptor_lookup_strip<nChannels>(oInput,nBorderSize,nRowIdx,nRowPxCount,vnStripLookups.data());
+            for(int nColIdx=nBorderSize; nColIdx<oSize.width-nBorderSize; ++nColIdx) {
+                alignas(16) std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,nChannels> aanVals;
+                LBSP::computeDescriptor_lookup<nChannels>(oInput,nColIdx,nRowIdx,aanVals);
+                for(size_t nChIdx=0; nChIdx<nChannels; ++nChIdx) {
+                    const uchar nRef = oInput.ptr<uchar>(nRowIdx,nColIdx)[nChIdx];
+                    LBSP::desc_t nDesc;
+                    LBSP::computeDescriptor<nChannels>(oInput,nRef,nColIdx,nRowIdx,nChIdx,anThresholdLUT[nRef],nDesc);
+                    ASSERT_EQ(vnStripDescs[(nColIdx-nBorderSize)*nChannels+nChIdx],nDesc) << "y=" << nRowIdx << ", x=" << nColIdx << ", c=" << nChIdx;
+                    const uchar* anStripVals = vnStripLookups.data()+((nColIdx-nBorderSize)*nChannels+nChIdx)*LBSP::DESC_SIZE_BITS;
+                    ASSERT_TRUE(std::equal(aanVals[nChIdx].begin(),aanVals[nChIdx].end(),anStripVals)) << "y=" << nRowIdx << ", x=" << nColIdx << ", c=" << nChIdx;
+                }
+            }
+        }
+    }
+
+}
+
+TEST(lbsp,regression_strip) {
+    testStripDescriptors<1>(cv::Size(67,13));
+    testStripDescriptors<3>(cv::Size(67,13));
+    testStripDescriptors<4>(cv::Size(9,7));
+}
+
+namespace {
+
+    template<size_t nChannels>
+    void testDisparityDistances(const cv::Size& oSize, const std::vector<int>& vDispRange) {
+        cv::Mat oDescMap1(oSize,CV_16UC(int(nChannels))),oDescMap2(oSize,CV_16UC(int(nChannels)));
+        cv::randu(oDescMap1,0,USHRT_MAX);
+        cv::randu(oDescMap2,0,USHRT_MAX);
+        cv::Mat_<uchar> oDistMap;
+        LBSP::calcDistances(oDescMap1,oDescMap2,vDispRange,oDistMap);
+        ASSERT_EQ(oDistMap.dims,3);
+        ASSERT_EQ(oDistMap.size[0],oSize.height);
+        ASSERT_EQ(oDistMap.size[1],oSize.width);
+        ASSERT_EQ(oDistMap.size[2],(int)vDispRange.size());
+        for(int nRowIdx=0; nRowIdx<oSize.height; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<oSize.width; ++nColIdx) {
+                for(int nOffsetIdx=0; nOffsetIdx<(int)vDispRange.size(); ++nOffsetIdx) {
+                    const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
+                    const uchar nDist = oDistMap(nRowIdx,nColIdx,nOffsetIdx);
+                    if(nOffsetColIdx<0 || nOffsetColIdx>=oSize.width)
+                        ASSERT_EQ(nDist,uchar(UCHAR_MAX));
+                    else
+                        ASSERT_EQ(nDist,(lv::hdist<nChannels,ushort,uchar>(oDescMap1.ptr<ushort>(nRowIdx,nColIdx),oDescMap2.ptr<ushort>(nRowIdx,nOffsetColIdx)))) << "y=" << nRowIdx << ", x=" << nColIdx << ", d=" << vDispRange[nOffsetIdx];
+                }
+            }
+        }
+        cv::Mat_<uchar> oDirectDistMap;
+        LBSP::calcDistances(oDescMap1,oDescMap2,oDirectDistMap);
+        ASSERT_EQ(oDirectDistMap.size(),oSize);
+        for(int nRowIdx=0; nRowIdx<oSize.height; ++nRowIdx)
+            for(int nColIdx=0; nColIdx<oSize.width; ++nColIdx)
+                ASSERT_EQ(oDirectDistMap(nRowIdx,nColIdx),(lv::hdist<nChannels,ushort,uchar>(oDescMap1.ptr<ushort>(nRowIdx,nColIdx),oDescMap2.ptr<ushort>(nRowIdx,nColIdx))));
+    }
+
+}
+
+TEST(lbsp,regression_disp_distances) {
+    const std::vector<int> vDispRange = {-70,-33,-1,0,1,2,17,64};
+    testDisparityDistances<1>(cv::Size(67,13),vDispRange);
+    testDisparityDistances<2>(cv::Size(45,3),vDispRange);
+    testDisparityDistances<3>(cv::Size(67,13),vDispRange);
+    testDisparityDistances<4>(cv::Size(9,7),vDispRange);
+}
+
+TEST(lbsp,regression_batch_compute) {
+    std::unique_ptr<LBSP> pLBSP = std::make_unique<LBSP>(size_t(20));
+    for(int nChannels : {1,3}) {
+        std::vector<cv::Mat> voInputs(7);
+        for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx) {
+            voInputs[nImageIdx].create(cv::Size(64+int(nImageIdx)*8,48),CV_8UC(nChannels));
+            cv::randu(voInputs[nImageIdx],0,256);
+        }
+        SCOPED_TRACE(lv::putf("nChannels=%d",nChannels));
+        ASSERT_NO_FATAL_FAILURE((testBatchCompute<ushort,cv::Mat>(*pLBSP,voInputs)));
+    }
+}
+
+namespace {
+
+    void lbsp_compute_perftest(benchmark::State& st) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        cv::Mat oInput(oSize,CV_8UC(int(st.range(1))));
+        cv::randu(oInput,0,256);
+        std::unique_ptr<LBSP> pLBSP = std::make_unique<LBSP>(size_t(20));
+        cv::Mat oDescMap;
+        while(st.KeepRunning()) {
+            pLBSP->compute2(oInput,oDescMap);
+            benchmark::DoNotOptimize(oDescMap.data);
+        }
+    }
+
+}
+
+// args = {image width, channel count}
+BENCHMARK(lbsp_compute_perftest)->Args({320,1})->Args({320,3})->Args({640,1})->Args({640,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+
+namespace {
+
+    void lbsp_dispdist_perftest(benchmark::State& st) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        cv::Mat oDescMap1(oSize,CV_16UC(int(st.range(1)))),oDescMap2(oSize,CV_16UC(int(st.range(1))));
+        cv::randu(oDescMap1,0,USHRT_MAX);
+        cv::randu(oDescMap2,0,USHRT_MAX);
+        std::vector<int> vDispRange(size_t(st.range(2)));
+        std::iota(vDispRange.begin(),vDispRange.end(),-int(vDispRange.size()/2));
+        cv::Mat_<uchar> oDistMap;
+        while(st.KeepRunning()) {
+            LBSP::calcDistances(oDescMap1,oDescMap2,vDispRange,oDistMap);
+            benchmark::DoNotOptimize(oDistMap.data);
+        }
+    }
+
+}
+
+// args = {image width, channel count, disparity count}
+BENCHMARK(lbsp_dispdist_perftest)->Args({320,1,32})->Args({320,3,32})->Args({640,1,64})->Args({640,3,64})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
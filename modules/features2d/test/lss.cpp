@@ -1,6 +1,7 @@
 
 #include "litiv/features2d/LSS.hpp"
 #include "litiv/test.hpp"
+#include "common.hpp"
 
 TEST(lss,regression_default_constr) {
     std::unique_ptr<LSS> pLSS = std::make_unique<LSS>();
@@ -206,4 +207,66 @@ TEST(lss,regression_large_transl_invert_compute) {
     const cv::Mat_<float> oOutputKPDesc2(3,std::array<int,3>{1,1,oOutputDescMap2.size[2]}.data(),oOutputDescMap2.ptr<float>(oTargetPt_new.y,oTargetPt_new.x));
     ASSERT_FLOAT_EQ((float)cv::norm(oOutputKPDesc2,cv::NORM_L2),1.0f);
     ASSERT_NEAR(float(pLSS->calcDistance(oOutputKPDesc1,oOutputKPDesc2)),0.0f,(float)1e-5);
-}
\ No newline at end of file
+}
+
+TEST(lss,regression_dense_vs_matchtemplate) {
+    const int nOuterRadius = 20, nPatchSize = 5, nAngularBins = 12, nRadialBins = 3;
+    const float fNoiseVar = 300000.f;
+    std::unique_ptr<LSS> pLSS = std::make_unique<LSS>(0,nOuterRadius,nPatchSize,nAngularBins,nRadialBins,fNoiseVar,false,false,true);
+    const cv::Mat oInput = cv::imread(SAMPLES_DATA_ROOT "/108073.jpg");
+    ASSERT_TRUE(!oInput.empty());
+    const cv::Mat oInputCrop = oInput(cv::Rect(300,80,120,100)).clone();
+    cv::Mat_<float> oOutputDescMap;
+    pLSS->compute2(oInputCrop,oOutputDescMap);
+    ASSERT_EQ(oOutputDescMap.dims,3);
+    const int nCorrWinSize = pLSS->windowSize().width;
+    const int nCorrPatchSize = nCorrWinSize-nPatchSize+1;
+    const int nDescSize = nAngularBins*nRadialBins;
+    ASSERT_EQ(oOutputDescMap.size[2],nDescSize);
+    cv::Mat_<int> oDescLUMap;
+    lv::getLogPolarMask(nCorrPatchSize,nRadialBins,nAngularBins,oDescLUMap,true,0.0f);
+    cv::Mat_<float> oCorrMap;
+    std::vector<float> vfRefDesc(size_t(nDescSize));
+    for(int nRowIdx=nCorrWinSize/2; nRowIdx<oInputCrop.rows-nCorrWinSize/2; nRowIdx+=7) {
+        for(int nColIdx=nCorrWinSize/2; nColIdx<oInputCrop.cols-nCorrWinSize/2; nColIdx+=5) {
+            const cv::Mat oWindow = oInputCrop(cv::Rect(nColIdx-nCorrWinSize/2,nRowIdx-nCorrWinSize/2,nCorrWinSize,nCorrWinSize));
+            const cv::Mat oTempl = oInputCrop(cv::Rect(nColIdx-nPatchSize/2,nRowIdx-nPatchSize/2,nPatchSize,nPatchSize));
+            cv::matchTemplate(oWindow,oTempl,oCorrMap,cv::TM_SQDIFF);
+            std::fill(vfRefDesc.begin(),vfRefDesc.end(),std::numeric_limits<float>::max());
+            for(int nLUIdx=0; nLUIdx<nCorrPatchSize*nCorrPatchSize; ++nLUIdx)
+                if(oDescLUMap(nLUIdx)!=-1)
+                    vfRefDesc[oDescLUMap(nLUIdx)] = std::min(vfRefDesc[oDescLUMap(nLUIdx)],std::max(((float*)oCorrMap.data)[nLUIdx],0.0f));
+            for(int nDescIdx=0; nDescIdx<nDescSize; ++nDescIdx)
+                ASSERT_NEAR(oOutputDescMap(nRowIdx,nColIdx,nDescIdx),std::exp(-vfRefDesc[nDescIdx]/fNoiseVar),1e-4f);
+        }
+    }
+}
+
+TEST(lss,regression_batch_compute) {
+    std::unique_ptr<LSS> pLSS = std::make_unique<LSS>();
+    std::vector<cv::Mat> voInputs(7);
+    for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx) {
+        voInputs[nImageIdx].create(cv::Size(64+int(nImageIdx)*8,48),(nImageIdx%2)?CV_8UC3:CV_8UC1);
+        cv::randu(voInputs[nImageIdx],0,256);
+    }
+    testBatchCompute<float,cv::Mat_<float>>(*pLSS,voInputs);
+}
+
+namespace {
+
+    void lss_dense_perftest(benchmark::State& st) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        cv::Mat oInput(oSize,CV_8UC(int(st.range(1))));
+        cv::randu(oInput,0,256);
+        std::unique_ptr<LSS> pLSS = std::make_unique<LSS>();
+        cv::Mat_<float> oDescMap;
+        while(st.KeepRunning()) {
+            pLSS->compute2(oInput,oDescMap);
+            benchmark::DoNotOptimize(oDescMap.data);
+        }
+    }
+
+}
+
+// args = {image width, channel count}
+BENCHMARK(lss_dense_perftest)->Args({320,1})->Args({320,3})->Args({640,3})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
@@ -56,4 +56,69 @@ TEST(mi,regression_compute) {
     }
     else
         lv::write(TEST_CURR_INPUT_DATA_ROOT "/test_mi.bin",oOutputScoresMat);
-}
\ No newline at end of file
+}
+
+TEST(mi,regression_dense_vs_window) {
+    std::unique_ptr<MutualInfo> pMI = std::make_unique<MutualInfo>(cv::Size(15,11),true);
+    const cv::Mat oInput1 = cv::imread(SAMPLES_DATA_ROOT "/multispectral_stereo_ex/img2.png");
+    ASSERT_TRUE(!oInput1.empty());
+    const cv::Mat oInput2 = cv::imread(SAMPLES_DATA_ROOT "/multispectral_stereo_ex/img1_corr_h0v8.png",cv::IMREAD_GRAYSCALE);
+    ASSERT_TRUE(!oInput2.empty());
+    const cv::Rect oCropZone(540,80,121,71);
+    const std::vector<int> vDispRange = {-9,-1,0,4,30};
+    for(int nTestIdx=0; nTestIdx<2; ++nTestIdx) {
+        // first test uses the 24-bit color/gray pair, second uses gray/gray
+        cv::Mat oInputCrop1 = oInput1(oCropZone).clone();
+        if(nTestIdx==1)
+            cv::cvtColor(oInputCrop1,oInputCrop1,cv::COLOR_BGR2GRAY);
+        const cv::Mat oInputCrop2 = oInput2(oCropZone).clone();
+        cv::Mat_<uchar> oROI(oInputCrop1.size(),uchar(255));
+        oROI(cv::Rect(20,20,10,10)) = 0u;
+        cv::Mat_<float> oScoreMap;
+        pMI->compute2(oInputCrop1,oInputCrop2,vDispRange,oScoreMap,oROI);
+        ASSERT_EQ(oScoreMap.dims,3);
+        ASSERT_EQ(oScoreMap.size[0],oInputCrop1.rows);
+        ASSERT_EQ(oScoreMap.size[1],oInputCrop1.cols);
+        ASSERT_EQ(oScoreMap.size[2],(int)vDispRange.size());
+        const cv::Size oWinSize = pMI->windowSize();
+        const cv::Rect oValidZone(oWinSize.width/2,oWinSize.height/2,oInputCrop1.cols-oWinSize.width+1,oInputCrop1.rows-oWinSize.height+1);
+        for(int nRowIdx=0; nRowIdx<oInputCrop1.rows; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<oInputCrop1.cols; ++nColIdx) {
+                for(int nOffsetIdx=0; nOffsetIdx<(int)vDispRange.size(); ++nOffsetIdx) {
+                    const cv::Point oOffsetPt(nColIdx+vDispRange[nOffsetIdx],nRowIdx);
+                    const float fScore = oScoreMap(nRowIdx,nColIdx,nOffsetIdx);
+                    if(!oValidZone.contains(cv::Point(nColIdx,nRowIdx)) || !oValidZone.contains(oOffsetPt) || !oROI(nRowIdx,nColIdx)) {
+                        ASSERT_EQ(fScore,-1.0f) << "r=" << nRowIdx << ", c=" << nColIdx << ", d=" << vDispRange[nOffsetIdx];
+                        continue;
+                    }
+                    const cv::Rect oWindow(nColIdx-oWinSize.width/2,nRowIdx-oWinSize.height/2,oWinSize.width,oWinSize.height);
+                    const cv::Rect oOffsetWindow(oOffsetPt.x-oWinSize.width/2,oOffsetPt.y-oWinSize.height/2,oWinSize.width,oWinSize.height);
+                    const double dRefScore = pMI->compute(oInputCrop1(oWindow),oInputCrop2(oOffsetWindow));
+                    ASSERT_NEAR(double(fScore),dRefScore,1e-4) << "r=" << nRowIdx << ", c=" << nColIdx << ", d=" << vDispRange[nOffsetIdx];
+                }
+            }
+        }
+    }
+}
+
+namespace {
+
+    void mi_dense_perftest(benchmark::State& st) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        cv::Mat oInput1(oSize,CV_8UC1),oInput2(oSize,CV_8UC1);
+        cv::randu(oInput1,0,256);
+        cv::randu(oInput2,0,256);
+        std::vector<int> vDispRange(size_t(st.range(1)));
+        std::iota(vDispRange.begin(),vDispRange.end(),0);
+        std::unique_ptr<MutualInfo> pMI = std::make_unique<MutualInfo>(cv::Size(41,41),true);
+        cv::Mat_<float> oScoreMap;
+        while(st.KeepRunning()) {
+            pMI->compute2(oInput1,oInput2,vDispRange,oScoreMap);
+            benchmark::DoNotOptimize(oScoreMap.data);
+        }
+    }
+
+}
+
+// args = {image width, disparity count}
+BENCHMARK(mi_dense_perftest)->Args({320,16})->Args({320,64})->Args({640,32})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
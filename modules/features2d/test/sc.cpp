@@ -1,6 +1,7 @@
 
 #include "litiv/features2d/SC.hpp"
 #include "litiv/test.hpp"
+#include "common.hpp"
 
 TEST(sc,regression_default_params) {
     std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(2),size_t(5));
@@ -87,6 +88,87 @@ TEST(sc,regression_full_compute_abs_nogpu) {
     ASSERT_EQ(oOutputDescs.cols,oOutputDescMap.size[2]);
 }
 
+TEST(sc,regression_dense_vs_sparse_abs_nogpu) {
+    std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(2),size_t(40),12,5);
+#if HAVE_CUDA
+    pShapeContext->enableCUDA(false);
+#endif //HAVE_CUDA
+    cv::Mat oInput(121,163,CV_8UC1);
+    oInput = 0;
+    cv::circle(oInput,cv::Point(50,60),7,cv::Scalar_<uchar>(255),-1);
+    cv::rectangle(oInput,cv::Point(100,30),cv::Point(130,45),cv::Scalar_<uchar>(255),-1);
+    cv::line(oInput,cv::Point(10,110),cv::Point(150,90),cv::Scalar_<uchar>(255));
+    oInput = oInput>0;
+    cv::Mat_<float> oOutputDescMap;
+    pShapeContext->compute2(oInput,oOutputDescMap);
+    ASSERT_EQ(oOutputDescMap.dims,3);
+    ASSERT_EQ(oInput.size[0],oOutputDescMap.size[0]);
+    ASSERT_EQ(oInput.size[1],oOutputDescMap.size[1]);
+    std::vector<cv::KeyPoint> vTargetPts;
+    for(int nRowIdx=0; nRowIdx<oInput.rows; ++nRowIdx)
+        for(int nColIdx=0; nColIdx<oInput.cols; ++nColIdx)
+            vTargetPts.emplace_back(cv::Point2f(float(nColIdx),float(nRowIdx)),1.0f);
+    cv::Mat_<float> oOutputDescs;
+    pShapeContext->compute(oInput,vTargetPts,oOutputDescs);
+    ASSERT_EQ(oOutputDescs.rows,(int)vTargetPts.size());
+    ASSERT_EQ(oOutputDescs.cols,oOutputDescMap.size[2]);
+    const int nDescSize = oOutputDescMap.size[2];
+    for(int i=0; i<(int)vTargetPts.size(); ++i) {
+        const float* aDesc1 = oOutputDescs.ptr<float>(i);
+        const float* aDesc2 = oOutputDescMap.ptr<float>(int(vTargetPts[i].pt.y),int(vTargetPts[i].pt.x));
+        ASSERT_TRUE(std::equal(aDesc1,aDesc1+nDescSize,aDesc2,aDesc2+nDescSize)) << "i=" << i;
+    }
+}
+
+TEST(sc,regression_incremental_abs_nogpu) {
+    std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(2),size_t(40),12,5);
+#if HAVE_CUDA
+    pShapeContext->enableCUDA(false);
+#endif //HAVE_CUDA
+    cv::Mat oInput(121,163,CV_8UC1);
+    oInput = 0;
+    cv::circle(oInput,cv::Point(50,60),7,cv::Scalar_<uchar>(255),-1);
+    cv::rectangle(oInput,cv::Point(100,30),cv::Point(130,45),cv::Scalar_<uchar>(255),-1);
+    cv::Mat_<float> oIncrDescMap;
+    cv::Mat_<cv::Point2f> oPrevContourPts;
+    pShapeContext->compute2(oInput,oIncrDescMap,oPrevContourPts);
+    ASSERT_EQ(oIncrDescMap.dims,3);
+    ASSERT_FALSE(oPrevContourPts.empty());
+    const auto lCheckAgainstFullMap = [&](const cv::Mat& oCurrInput) {
+        cv::Mat_<float> oFullDescMap;
+        pShapeContext->compute2(oCurrInput,oFullDescMap);
+        ASSERT_EQ(oFullDescMap.dims,3);
+        for(int nDimIdx=0; nDimIdx<3; ++nDimIdx)
+            ASSERT_EQ(oFullDescMap.size[nDimIdx],oIncrDescMap.size[nDimIdx]);
+        const int nDescSize = oFullDescMap.size[2];
+        for(int nRowIdx=0; nRowIdx<oCurrInput.rows; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<oCurrInput.cols; ++nColIdx) {
+                const float* aDesc1 = oFullDescMap.ptr<float>(nRowIdx,nColIdx);
+                const float* aDesc2 = oIncrDescMap.ptr<float>(nRowIdx,nColIdx);
+                ASSERT_TRUE(std::equal(aDesc1,aDesc1+nDescSize,aDesc2,aDesc2+nDescSize)) << "r=" << nRowIdx << ", c=" << nColIdx;
+            }
+        }
+    };
+    lCheckAgainstFullMap(oInput);
+    // move the circle, keep the rectangle in place
+    oInput = 0;
+    cv::circle(oInput,cv::Point(56,63),7,cv::Scalar_<uchar>(255),-1);
+    cv::rectangle(oInput,cv::Point(100,30),cv::Point(130,45),cv::Scalar_<uchar>(255),-1);
+    pShapeContext->compute2(oInput,oIncrDescMap,oPrevContourPts);
+    lCheckAgainstFullMap(oInput);
+    // add a new shape near the border
+    cv::rectangle(oInput,cv::Point(140,100),cv::Point(162,120),cv::Scalar_<uchar>(255),-1);
+    pShapeContext->compute2(oInput,oIncrDescMap,oPrevContourPts);
+    lCheckAgainstFullMap(oInput);
+    // no change at all
+    pShapeContext->compute2(oInput,oIncrDescMap,oPrevContourPts);
+    lCheckAgainstFullMap(oInput);
+    // remove everything
+    oInput = 0;
+    pShapeContext->compute2(oInput,oIncrDescMap,oPrevContourPts);
+    lCheckAgainstFullMap(oInput);
+}
+
 TEST(sc,regression_full_compute_abs) {
     std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(2),size_t(40),12,5);
     cv::Mat oInput(257,257,CV_8UC1);
@@ -512,14 +594,37 @@ TEST(sc,regression_emd_check) {
     }
 }
 
+TEST(sc,regression_batch_compute_nogpu) {
+    std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(2),size_t(40),12,5);
+#if HAVE_CUDA
+    pShapeContext->enableCUDA(false);
+#endif //HAVE_CUDA
+    cv::RNG oRNG(42);
+    std::vector<cv::Mat> voInputs(7);
+    for(size_t nImageIdx=0; nImageIdx<voInputs.size(); ++nImageIdx) {
+        voInputs[nImageIdx].create(cv::Size(97+int(nImageIdx)*8,81),CV_8UC1);
+        voInputs[nImageIdx] = 0;
+        for(int nShapeIdx=0; nShapeIdx<3; ++nShapeIdx)
+            cv::circle(voInputs[nImageIdx],cv::Point(oRNG.uniform(10,87),oRNG.uniform(10,71)),oRNG.uniform(3,12),cv::Scalar_<uchar>(255),-1);
+        cv::line(voInputs[nImageIdx],cv::Point(oRNG.uniform(0,97),0),cv::Point(oRNG.uniform(0,97),80),cv::Scalar_<uchar>(255));
+    }
+    testBatchCompute<float,cv::Mat_<float>>(*pShapeContext,voInputs);
+}
+
 namespace {
 
     void sc_abs_perftest(benchmark::State& state) {
         std::unique_ptr<ShapeContext> pShapeContext = std::make_unique<ShapeContext>(size_t(state.range(0)),size_t(state.range(1)));
-        cv::Mat oInput(257,257,CV_8UC1);
+        const int nCols = int(state.range(2));
+        cv::Mat oInput(nCols==257?257:nCols*3/4,nCols,CV_8UC1);
         oInput = 0;
-        cv::circle(oInput,cv::Point(128,128),7,cv::Scalar_<uchar>(255),-1);
-        cv::rectangle(oInput,cv::Point(180,180),cv::Point(190,190),cv::Scalar_<uchar>(255),-1);
+        // the base shape pair is repeated on a 128px grid wherever it fits (only once for the original 257x257 case)
+        for(int nRowOffset=0; nRowOffset+190<oInput.rows; nRowOffset+=128) {
+            for(int nColOffset=0; nColOffset+190<oInput.cols; nColOffset+=128) {
+                cv::circle(oInput,cv::Point(128+nColOffset,128+nRowOffset),7,cv::Scalar_<uchar>(255),-1);
+                cv::rectangle(oInput,cv::Point(180+nColOffset,180+nRowOffset),cv::Point(190+nColOffset,190+nRowOffset),cv::Scalar_<uchar>(255),-1);
+            }
+        }
         oInput = oInput>0;
         cv::Mat_<float> oOutputDescMap;
         while (state.KeepRunning()) {
@@ -531,4 +636,5 @@ namespace {
     }
 }
 
-BENCHMARK(sc_abs_perftest)->Args({2,20})->Args({2,30})->Args({2,40})->Args({5,40})->Args({5,80})->Repetitions(15)->ReportAggregatesOnly(true);
\ No newline at end of file
+// args = {inner radius, outer radius, image width}
+BENCHMARK(sc_abs_perftest)->Args({2,20,257})->Args({2,30,257})->Args({2,40,257})->Args({5,40,257})->Args({5,80,257})->Args({2,40,320})->Args({2,40,640})->Args({5,80,640})->Repetitions(15)->ReportAggregatesOnly(true);
\ No newline at end of file
@@ -42,6 +42,13 @@ namespace lv {
         AffinityDist_SSD
     };
 
+    /// possible storage modes for dense descriptor maps (see lv::quantizeDescriptorMap)
+    enum DescMapStorageType {
+        DescMapStorage_Float=0, ///< full precision (CV_32F)
+        DescMapStorage_Half, ///< half precision floats, stored as raw IEEE 754 binary16 words (CV_16U)
+        DescMapStorage_UInt8 ///< per-channel min/max-scaled bytes (CV_8U), with (offset,scale) dequantization params stored separately
+    };
+
     /// 'thins' the provided image (currently only works on 1ch 8UC1 images, treated as binary)
     void thinning(const cv::Mat& oInput, cv::Mat& oOutput, ThinningMode eMode=ThinningMode_LamLeeSuen);
 
@@ -72,6 +79,16 @@ namespace lv {
                                    cv::Mat_<float>& oAffinityMap, const std::vector<int>& vDispRange, AffinityDistType eDist,
                                    const cv::Mat_<uchar>& oROI1=cv::Mat(), const cv::Mat_<uchar>& oROI2=cv::Mat(),
                                    const cv::Mat_<float>& oEMDCostMap=cv::Mat(), bool bAllowCUDA=true);
+    /// computes a 3d affinity map from two quantized 3d descriptor maps (see lv::quantizeDescriptorMap) by matching them in patches across a given stereo disparity range
+    void computeDescriptorAffinity(const cv::Mat& oQuantDescMap1, const cv::Mat_<float>& oQuantParams1,
+                                   const cv::Mat& oQuantDescMap2, const cv::Mat_<float>& oQuantParams2, int nPatchSize,
+                                   cv::Mat_<float>& oAffinityMap, const std::vector<int>& vDispRange, AffinityDistType eDist,
+                                   const cv::Mat_<uchar>& oROI1=cv::Mat(), const cv::Mat_<uchar>& oROI2=cv::Mat(),
+                                   const cv::Mat_<float>& oEMDCostMap=cv::Mat());
+    /// converts a 3d float descriptor map to a more compact storage type; for 8-bit storage, 'oQuantParams' receives the per-channel offsets & scales as a 2xd map
+    void quantizeDescriptorMap(const cv::Mat_<float>& oDescMap, cv::Mat& oQuantDescMap, cv::Mat_<float>& oQuantParams, DescMapStorageType eType);
+    /// converts a quantized 3d descriptor map (see lv::quantizeDescriptorMap) back to full precision floats
+    void dequantizeDescriptorMap(const cv::Mat& oQuantDescMap, const cv::Mat_<float>& oQuantParams, cv::Mat_<float>& oDescMap);
 #if HAVE_CUDA
     /// computes a 3d affinity map from two 2d descriptor maps by matching them in patches across a given stereo disparity range
     /// note: expects descriptor maps to have 2d size (nxm)xd, where nxm is the map size, and d is the desc length
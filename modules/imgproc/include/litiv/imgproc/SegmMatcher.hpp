@@ -75,6 +75,50 @@ struct SegmMatcher : ICosegmentor<int32_t,4> { // camera count could be template
         OutputPackOffset_Mask=1,
     };
 
+    /// defines the move-making inference solvers that can be selected at runtime for the stereo/resegm graph models
+    enum InferenceSolverType {
+        InferenceSolver_FGBZ=0, ///< higher-order reduction of Fix et al. + QPBO fusion moves (requires OpenGM ext lib w/ QPBO)
+        InferenceSolver_FastPD, ///< FastPD of Komodakis et al. (requires OpenGM ext lib w/ FastPD; stereo model only)
+        InferenceSolver_SoSPD, ///< sum-of-submodular primal-dual of Fix et al. w/ IBFS (requires boost)
+        InferenceSolverCount,
+    };
+
+    /// holds the solver selection and iteration/time budgets used for inference on one of the graph models
+    struct InferenceSolverParams {
+        /// solver used for move-making on the graph model
+        InferenceSolverType eSolver;
+        /// maximum move-making iteration count (for resegm, this budget applies to each pass)
+        size_t nMaxMoveCount;
+        /// maximum wall-clock time (in seconds) allowed for move-making (for resegm, applies to each pass; <=0 means unbounded)
+        double dMaxTimeSec;
+        /// side length (in nodes) of the checkerboard tiles solved concurrently in each move (0 = solve moves over the whole graph; FGBZ stereo only)
+        size_t nMoveTileSize;
+        /// max relative energy increase (w.r.t. the lowest energy reached so far) tolerated after a tiled move before it is reverted and solved over the whole graph instead
+        double dMaxTiledMoveEnergyGap;
+        /// number of cheapest real labels kept explicitly in each unary term, others being pruned (0 = dense; stereo only, fixed at 'initialize')
+        size_t nTopKLabels;
+    };
+
+    /// holds a single energy vs wall-clock time sample recorded during a solver benchmark run
+    struct InferenceTracePoint {
+        /// time elapsed (in seconds) since inference started
+        double dElapsedSec;
+        /// stereo/resegm move iteration counts at sampling time
+        size_t nStereoMoveIter,nResegmMoveIter;
+        /// stereo/resegm graph energies at sampling time (resegm energy is max until the first resegm move)
+        ValueType tStereoEnergy,tResegmEnergy;
+    };
+
+    /// holds the full energy vs wall-clock time curve obtained by a stereo/resegm solver pair during a benchmark run
+    struct InferenceSolverTrace {
+        /// solvers used for this run
+        InferenceSolverType eStereoSolver,eResegmSolver;
+        /// total inference time (in seconds), including post-processing
+        double dTotalTimeSec;
+        /// samples recorded after each stereo/resegm move
+        std::vector<InferenceTracePoint> vPoints;
+    };
+
     // interface forward declarations for pimpl helpers
     struct GraphModelData;
     struct StereoGraphInference;
@@ -108,14 +152,54 @@ struct SegmMatcher : ICosegmentor<int32_t,4> { // camera count could be template
     cv::Mat getStereoDispMapDisplay(size_t nLayerIdx, size_t nCamIdx) const;
     /// helper func to display scaled assoc count maps (for primary cam only)
     cv::Mat getAssocCountsMapDisplay() const;
+    /// returns whether the given solver can be used for stereo inference in the current build
+    static bool isStereoSolverAvailable(InferenceSolverType eSolver);
+    /// returns whether the given solver can be used for resegm inference in the current build
+    static bool isResegmSolverAvailable(InferenceSolverType eSolver);
+    /// returns the (friendly) name of the given inference solver
+    static std::string getSolverName(InferenceSolverType eSolver);
+    /// sets the solver and budgets to use for stereo inference (can be changed between 'apply' calls)
+    virtual void setStereoSolver(InferenceSolverType eSolver, size_t nMaxMoveCount, double dMaxTimeSec=0.0);
+    /// sets the tile size and energy gap used to parallelize stereo moves (tile size of 0 disables tiling; can be changed between 'apply' calls)
+    virtual void setStereoMoveTiling(size_t nTileSize, double dMaxEnergyGap=0.0);
+    /// sets the number of cheapest real labels kept in each stereo unary term (0 disables pruning; must be called before 'initialize')
+    virtual void setStereoLabelPruning(size_t nTopKLabels);
+    /// sets the number of downsampled (x2) levels to solve first (stereo only), and the label window radius around their upsampled solution used to restrict candidate labels and saliency curves (must be called before 'initialize')
+    virtual void setCoarseToFineStereo(size_t nPyramidLevels, size_t nLabelWindowRad);
+    /// sets the raw temporal diff above which init stereo unaries are re-evaluated instead of reused, and the motion-compensated diff above which warped labels restart from wta (0 disables either; can be changed between 'apply' calls)
+    virtual void setStereoTemporalUpdates(size_t nUnaryReuseDiff, size_t nReinitDiff);
+    /// sets the storage types used for descriptor maps when computing affinities, and for affinity maps in feature packets (packets only support float/half; must be called before 'initialize')
+    virtual void setDescriptorStorage(lv::DescMapStorageType eDescMapStorage, lv::DescMapStorageType eFeatsPackStorage);
+    /// sets the solver and budgets to use for resegm inference (can be changed between 'apply' calls)
+    virtual void setResegmSolver(InferenceSolverType eSolver, size_t nMaxMoveCount, double dMaxTimeSec=0.0);
+    /// returns the solver and budgets currently used for stereo inference
+    const InferenceSolverParams& getStereoSolver() const;
+    /// returns the solver and budgets currently used for resegm inference
+    const InferenceSolverParams& getResegmSolver() const;
+    /// benchmark version of 'apply'; replays inference on the same model data for every available stereo/resegm solver pair and returns their energy vs time curves (outputs come from the selected solvers)
+    virtual std::vector<InferenceSolverTrace> benchmarkSolvers(const MatArrayIn& aInputs, MatArrayOut& aOutputs);
 
 protected:
+    /// copies new inputs into the model, shifts temporal layers, and readies features for the next inference
+    void updateInputs(const MatArrayIn& aInputs);
+    /// solves stereo at the next (coarser) pyramid level, and upsamples its labeling as the candidate label prior of the model
+    void updateStereoLabelPrior(const MatArrayIn& aInputs);
     /// disparity label step size (will be passed to model constr)
     size_t m_nDispStep;
+    /// solver selection & budgets for stereo/resegm inference (will be passed to model constr)
+    InferenceSolverParams m_oStereoSolverParams,m_oResegmSolverParams;
     /// output disparity label set (will be passed to model constr)
     std::vector<OutputLabelType> m_vStereoLabels;
+    /// coarse-to-fine stereo pyramid level count and candidate label window radius (will be passed to coarse matcher)
+    size_t m_nStereoPyramidLevels,m_nStereoLabelWindowRad;
+    /// descriptor map and feature packet affinity storage types (will be passed to model)
+    lv::DescMapStorageType m_eDescMapStorage,m_eFeatsPackStorage;
+    /// stereo unary reuse and label reinit temporal diff thresholds (will be passed to model)
+    size_t m_nStereoUnaryReuseDiff,m_nStereoReinitDiff;
     /// holds bimodel data & inference algo impls
     std::unique_ptr<GraphModelData> m_pModelData;
+    /// matcher used to solve the next (coarser) pyramid level, if coarse-to-fine stereo is enabled
+    std::unique_ptr<SegmMatcher> m_pCoarseMatcher;
     /*/// converts a floating point value to the model's value type, rounding if necessary
     template<typename TVal>
     static inline std::enable_if_t<std::is_floating_point<TVal>::value,ValueType> cost_cast(TVal val) {return (ValueType)std::round(val);}
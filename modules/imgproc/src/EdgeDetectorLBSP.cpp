@@ -109,11 +109,13 @@ void EdgeDetectorLBSP::apply_internal_lookup(const cv::Mat& oInputImg) {
             size_t nColIter = 0;
             for(; nColIter<nROIBorderSize; ++nColIter)
                 lBorderColLookup(nRowIter,nCurrRowLUTIdx,nColIter);
+            // all inner lookups of the row are gathered at once (same lut layout as the per-pixel lookup)
+            if(nCurrScaleCols>nROIBorderSize*2)
+                LBSP::computeDescriptor_lookup_strip<nChannels>(oCurrPyrInputMap,int(nColIter),int(nRowIter),nCurrScaleCols-nROIBorderSize*2,m_vvuLBSPLookupMaps[nLevelIter].data()+nCurrRowLUTIdx+nColIter*nColLUTStep);
             for(; nColIter<nCurrScaleCols-nROIBorderSize; ++nColIter) {
                 const size_t nCurrColLUTIdx = nCurrRowLUTIdx+nColIter*nColLUTStep;
                 uchar* aanCurrLUT = m_vvuLBSPLookupMaps[nLevelIter].data()+nCurrColLUTIdx;
                 lvDbgAssert(nCurrColLUTIdx<m_vvuLBSPLookupMaps[nLevelIter].size() && (nCurrColLUTIdx%LBSP::DESC_SIZE_BITS)==0);
-                LBSP::computeDescriptor_lookup<nChannels>(oCurrPyrInputMap,int(nColIter),int(nRowIter),aanCurrLUT);
                 if(nNextScaleMapSize && !(nRowIter%2) && !(nColIter%2)) {
                     const size_t nNextColLUTIdx = (nRowIter/2)*nNextRowLUTStep + (nColIter/2)*nColLUTStep;
                     for(size_t nChIter = 0; nChIter<nChannels; ++nChIter) {
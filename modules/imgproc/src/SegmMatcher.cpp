@@ -29,11 +29,6 @@
 #define SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS   0
 #define SEGMMATCH_CONFIG_USE_DISP_BG_HRST      0
 #define SEGMMATCH_CONFIG_USE_GMM_LOCAL_BACKGR  1
-#define SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF   1
-#define SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF 0
-#define SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF  0
-#define SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF   0
-#define SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF  1
 #define SEGMMATCH_CONFIG_USE_PROGRESS_BARS     0
 #define SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN     0
 #define SEGMMATCH_CONFIG_USE_TEMPORAL_CONN     1
@@ -50,6 +45,16 @@
 #define SEGMMATCH_DEFAULT_DISPARITY_STEP       (size_t(1))
 #define SEGMMATCH_DEFAULT_MAX_STEREO_ITER      (size_t(500))
 #define SEGMMATCH_DEFAULT_MAX_RESEGM_ITER      (size_t(30))
+#define SEGMMATCH_DEFAULT_STEREO_SOLVER        (SegmMatcher::InferenceSolver_FGBZ)
+#define SEGMMATCH_DEFAULT_RESEGM_SOLVER        (SegmMatcher::InferenceSolver_SoSPD)
+#define SEGMMATCH_DEFAULT_STEREO_TILE_SIZE     (size_t(0))
+#define SEGMMATCH_DEFAULT_STEREO_TILE_GAP      (0.0)
+#define SEGMMATCH_DEFAULT_STEREO_PYR_LEVELS    (size_t(0))
+#define SEGMMATCH_DEFAULT_STEREO_PYR_WIN_RAD   (size_t(4))
+#define SEGMMATCH_DEFAULT_STEREO_OOW_COST      (10000)
+#define SEGMMATCH_DEFAULT_STEREO_TOPK_LABELS   (size_t(0))
+#define SEGMMATCH_DEFAULT_STEREO_REUSE_DIFF    (size_t(0))
+#define SEGMMATCH_DEFAULT_STEREO_REINIT_DIFF   (size_t(0))
 #define SEGMMATCH_DEFAULT_SCDESC_WIN_RAD       (size_t(50))
 #define SEGMMATCH_DEFAULT_SCDESC_RAD_BINS      (size_t(3))
 #define SEGMMATCH_DEFAULT_SCDESC_ANG_BINS      (size_t(10))
@@ -63,6 +68,8 @@
 #define SEGMMATCH_DEFAULT_ITER_PER_RESEGM      (m_nStereoLabels)
 #define SEGMMATCH_DEFAULT_SALIENT_SHP_RAD      (3)
 #define SEGMMATCH_DEFAULT_DESC_PATCH_SIZE      (15)
+#define SEGMMATCH_DEFAULT_DESC_MAP_STORAGE     (lv::DescMapStorage_Float)
+#define SEGMMATCH_DEFAULT_FEATS_PACK_STORAGE   (lv::DescMapStorage_Float)
 #define SEGMMATCH_DEFAULT_CONTOUR_DC_SIZE      (0)
 #define SEGMMATCH_DEFAULT_BG_ZONE_SIZE         (45)
 #define SEGMMATCH_DEFAULT_GMM_3CH_COMPONENTS   (6)
@@ -91,28 +98,28 @@
 #define SEGMMATCH_UNIQUE_COST_INCR_REL(n)      (float((n)*3)/((n)+2))
 #define SEGMMATCH_UNIQUE_COST_ZERO_COUNT       (1)
 
-#if (SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF)
-#if !HAVE_OPENGM_EXTLIB
-#error "SegmMatcher config requires OpenGM external lib w/ QPBO for inference."
-#endif //!HAVE_OPENGM_EXTLIB
-#if !HAVE_OPENGM_EXTLIB_QPBO
-#error "SegmMatcher config requires OpenGM external lib w/ QPBO for inference."
-#endif //!HAVE_OPENGM_EXTLIB_QPBO
-#endif //(SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF)
-#if SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
-#if !HAVE_OPENGM_EXTLIB
-#error "SegmMatcher config requires OpenGM external lib w/ FastPD for inference."
-#endif //!HAVE_OPENGM_EXTLIB
-#if !HAVE_OPENGM_EXTLIB_FASTPD
-#error "SegmMatcher config requires OpenGM external lib w/ FastPD for inference."
-#endif //!HAVE_OPENGM_EXTLIB_FASTPD
-#endif //SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
-#if (SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
-#if !HAVE_BOOST
-#error "SegmMatcher config requires boost due to 3rdparty sospd module for inference."
+// solver availability (runtime-selectable, see SegmMatcher::InferenceSolverType)
+#if (HAVE_OPENGM_EXTLIB && HAVE_OPENGM_EXTLIB_QPBO)
+#define SEGMMATCH_HAVE_FGBZ_INF   1
+#else //!(HAVE_OPENGM_EXTLIB && HAVE_OPENGM_EXTLIB_QPBO)
+#define SEGMMATCH_HAVE_FGBZ_INF   0
+#endif //!(HAVE_OPENGM_EXTLIB && HAVE_OPENGM_EXTLIB_QPBO)
+#if (HAVE_OPENGM_EXTLIB && HAVE_OPENGM_EXTLIB_FASTPD)
+#define SEGMMATCH_HAVE_FASTPD_INF 1
+#else //!(HAVE_OPENGM_EXTLIB && HAVE_OPENGM_EXTLIB_FASTPD)
+#define SEGMMATCH_HAVE_FASTPD_INF 0
+#endif //!(HAVE_OPENGM_EXTLIB && HAVE_OPENGM_EXTLIB_FASTPD)
+#if HAVE_BOOST
+#define SEGMMATCH_HAVE_SOSPD_INF  1
+#else //!HAVE_BOOST
+#define SEGMMATCH_HAVE_SOSPD_INF  0
 #endif //!HAVE_BOOST
+#if !(SEGMMATCH_HAVE_FGBZ_INF || SEGMMATCH_HAVE_SOSPD_INF)
+#error "SegmMatcher requires OpenGM external lib w/ QPBO or boost (for 3rdparty sospd module) for inference."
+#endif //!(SEGMMATCH_HAVE_FGBZ_INF || SEGMMATCH_HAVE_SOSPD_INF)
+#if SEGMMATCH_HAVE_SOSPD_INF
 #define SEGMMATCH_CONFIG_USE_SOSPD_ALPHA_HEIGHTS_LABEL_ORDERING 0
-#endif //(SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
+#endif //SEGMMATCH_HAVE_SOSPD_INF
 #if (SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY+\
      SEGMMATCH_CONFIG_USE_DASCRF_AFFINITY+\
      SEGMMATCH_CONFIG_USE_LSS_AFFINITY+\
@@ -122,17 +129,7 @@
 #error "Must specify only one image affinity map computation approach to use."
 #endif //(features config ...)!=1
 #define SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY (SEGMMATCH_CONFIG_USE_DASCGF_AFFINITY||SEGMMATCH_CONFIG_USE_DASCRF_AFFINITY||SEGMMATCH_CONFIG_USE_LSS_AFFINITY)
-#if (SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF+\
-     SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF+\
-     SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF/*+...*/\
-    )!=1
-#error "Must specify only one stereo inference approach to use."
-#endif //(stereo inf config ...)!=1
-#if (SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF+\
-     SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF/*+...*/\
-    )!=1
-#error "Must specify only one resegm inference approach to use."
-#endif //(resegm inf config ...)!=1
+static_assert(SEGMMATCH_DEFAULT_FEATS_PACK_STORAGE==lv::DescMapStorage_Float || SEGMMATCH_DEFAULT_FEATS_PACK_STORAGE==lv::DescMapStorage_Half,"feature packets need a storage type without per-frame quantization params");
 
 namespace {
 
@@ -146,7 +143,8 @@ namespace {
     using ExplicitFunction = lv::gm::ExplicitViewFunction<ValueType,IndexType,InternalLabelType>; ///< shortcut for explicit view function
     using ExplicitAllocFunction = opengm::ExplicitFunction<ValueType,IndexType,InternalLabelType>; ///< shortcut for explicit allocated function
     using ExplicitScaledFunction = lv::gm::ExplicitScaledViewFunction<ValueType,IndexType,InternalLabelType>; ///< shortcut for explicit scaled view function
-    using FunctionTypeList = opengm::meta::TypeListGenerator<ExplicitFunction,ExplicitAllocFunction,ExplicitScaledFunction>::type;  ///< list of all functions the models can use
+    using SparseExplicitFunction = lv::gm::SparseExplicitViewFunction<ValueType,IndexType,InternalLabelType>; ///< shortcut for sparse explicit view function (for pruned stereo unary factors)
+    using FunctionTypeList = opengm::meta::TypeListGenerator<ExplicitFunction,ExplicitAllocFunction,ExplicitScaledFunction,SparseExplicitFunction>::type;  ///< list of all functions the models can use
     constexpr size_t s_nEpipolarCliqueOrder = SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN?size_t(3):size_t(0); ///< epipolar clique order (i.e. node count)
     constexpr size_t s_nEpipolarCliqueEdges = SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN?size_t(2):size_t(0); ///< epipolar clique edge count (i.e. connections to main node)
     constexpr size_t s_nEpipolarCliqueStride = SEGMMATCH_HOENERGY_STEREO_STRIDE; ///< epipolar clique stride size (i.e. skipped connections; 1=fully connected)
@@ -169,6 +167,7 @@ namespace {
     using FuncIdentifType = StereoModelType::FunctionIdentifier; ///< shortcut for graph model function identifier type (for both stereo and resegm models)
     using FuncPairType = std::pair<FuncIdentifType,ExplicitFunction&>; ///< funcid-funcobj pair used as viewer to explicit data (for both stereo and resegm models)
     using ScaledFuncPairType = std::pair<FuncIdentifType,ExplicitScaledFunction&>; ///< funcid-funcobj pair used as scaled viewer to explicit data (for stereo pairw factors)
+    using SparseFuncPairType = std::pair<FuncIdentifType,SparseExplicitFunction&>; ///< funcid-funcobj pair used as sparse viewer to explicit data (for stereo unary factors)
     constexpr size_t s_nMaxOrder = lv::get_next_pow2((uint32_t)std::max(std::max(s_nTemporalCliqueOrder,s_nEpipolarCliqueOrder),size_t(2))); ///< used to limit internal static array sizes
     constexpr size_t s_nPairwOrients = size_t(2); ///< number of pairwise links owned by each node in the graph (2 = 1st order neighb connections)
     static_assert(s_nPairwOrients>size_t(0),"pairwise orientation count must be strictly positive");
@@ -229,10 +228,10 @@ namespace {
         size_t nLayerIdx;
         /// id for this node's unary factor (not SIZE_MAX only if valid)
         size_t nUnaryFactID;
-        /// pointer to this node's unary function (non-null only if valid)
-        ExplicitFunction* pUnaryFunc;
         /// weights for this node's pairwise costs (mutable for possible updates during inference)
         mutable std::array<float,s_nPairwOrients> afPairwWeights;
+        /// whether the energy tables of cliques owned by this node changed since the last primal-dual setup (their duals cannot be reused)
+        mutable bool bUpdatedCliques;
         /// vector of pointers to all (valid) cliques owned by this node as 1st member (all must evaluate to true)
         lv::AutoBuffer<Clique*,4> vpCliques;
         /// array of pairwise cliques owned by this node as 1st member (evaluates to true only if valid)
@@ -243,12 +242,16 @@ namespace {
 
     /// basic info struct used for node-level stereo graph model updates and data lookups
     struct StereoNodeInfo : NodeInfo {
+        /// pointer to this node's (pruned) unary function (non-null only if valid)
+        SparseExplicitFunction* pUnaryFunc;
         /// epipolar clique owned by this node as 1st member (evaluates to true only if valid)
         EpipolarClique oEpipolarClique;
     };
 
     /// basic info struct used for node-level resegm graph model updates and data lookups
     struct ResegmNodeInfo : NodeInfo {
+        /// pointer to this node's unary function (non-null only if valid)
+        ExplicitFunction* pUnaryFunc;
         /// stacked (multi-layer) map element index associated with this node
         size_t nStackedIdx;
         /// temporal clique owned by this node as 1st member (evaluates to true only if valid)
@@ -260,9 +263,10 @@ namespace {
 /// holds graph model data for both stereo and resegmentation models
 struct SegmMatcher::GraphModelData {
     /// default constructor; receives model construction data from algo constructor
-    GraphModelData(const CamArray<cv::Mat>& aROIs, const std::vector<OutputLabelType>& vRealStereoLabels, size_t nStereoLabelStep, size_t nPrimaryCamIdx);
-    /// (pre)calculates features required for model updates, and optionally returns them in packet format
-    void calcFeatures(const MatArrayIn& aInputs, cv::Mat* pFeaturesPacket=nullptr);
+    GraphModelData(const CamArray<cv::Mat>& aROIs, const std::vector<OutputLabelType>& vRealStereoLabels, size_t nStereoLabelStep, size_t nPrimaryCamIdx,
+                   const InferenceSolverParams& oStereoSolverParams, const InferenceSolverParams& oResegmSolverParams);
+    /// (pre)calculates features required for model updates, and optionally returns them in packet format (affinity can be limited to the label prior windows)
+    void calcFeatures(const MatArrayIn& aInputs, cv::Mat* pFeaturesPacket=nullptr, bool bUseLabelPrior=false);
     /// sets a previously precalculated features packet to be used in the next model updates (do not modify it before that!)
     void setNextFeatures(const cv::Mat& oPackedFeatures);
     /// performs the actual bi-model, bi-spectral inference
@@ -292,10 +296,14 @@ struct SegmMatcher::GraphModelData {
 
     /// number of frame sets processed so far (used to toggle temporal links on/off)
     size_t m_nFramesProcessed;
-    /// max move making iteration count allowed during stereo/resegm inference
-    size_t m_nMaxStereoMoveCount,m_nMaxResegmMoveCount;
+    /// solver selection & budgets (max move count, max time) used during stereo/resegm inference
+    InferenceSolverParams m_oStereoSolverParams,m_oResegmSolverParams;
+    /// energy vs time curve filled during inference, if not null (used for solver benchmarking)
+    std::vector<InferenceTracePoint>* m_pInferenceTrace;
     /// random seeds to use to initialize labeling/label-order arrays
     size_t m_nStereoLabelOrderRandomSeed,m_nStereoLabelingRandomSeed;
+    /// random seed used for the (thread-local) rng during gmm kmeans initialization only, so that inference replays are deterministic
+    size_t m_nResegmGMMRandomSeed;
     /// contains the (internal) stereo label ordering to use for each iteration
     std::vector<InternalLabelType> m_vStereoLabelOrdering;
     /// holds the set of features to use (or used) during the next (or past) inference (mutable, as shape features will change during inference)
@@ -312,6 +320,14 @@ struct SegmMatcher::GraphModelData {
     mutable cv::Mat_<AssocIdxType> m_oAssocMap;
     /// 2d map which contains transient unary factor labeling costs for all stereo/resegm graph nodes (mutable for inference)
     mutable cv::Mat_<ValueType> m_oStereoUnaryCosts,m_oResegmUnaryCosts;
+    /// 2d map of candidate label window centers for the primary cam, upsampled from a coarser solution ('dontcare' = unrestricted; empty = disabled)
+    cv::Mat_<InternalLabelType> m_oStereoLabelPriorMap;
+    /// radius of the candidate label windows centered on the prior map labels
+    size_t m_nStereoLabelWindowRad;
+    /// flags for stereo labels that are kept by at least one node after pruning/windowing (others are skipped during inference)
+    std::vector<uchar> m_vActiveStereoLabels;
+    /// flags for real stereo labels covered by at least one candidate label window (all set if the prior map is disabled)
+    std::vector<uchar> m_vWindowedStereoLabels;
     /// contains the ROIs used for grid setup passed in the constructor
     const CamArray<cv::Mat_<uchar>> m_aROIs;
     /// contains the predetermined (max) 2D grid size for the graph models
@@ -324,6 +340,8 @@ struct SegmMatcher::GraphModelData {
     const size_t m_nRealStereoLabels;
     /// total number of stereo disparity labels (including reserved ones)
     const size_t m_nStereoLabels;
+    /// number of stereo labels that keep explicit unary costs for each node after pruning (including reserved ones)
+    const size_t m_nStereoSparseLabels;
     /// contains the step size between stereo labels (i.e. the disparity granularity)
     const size_t m_nDispOffsetStep;
     /// contains the minimum disparity offset value
@@ -362,6 +380,8 @@ struct SegmMatcher::GraphModelData {
     FuncIdentifType m_oStereoPairwFuncID_base,m_oResegmPairwFuncID_base;
     /// functions data arrays (contiguous blocks for all factors)
     std::unique_ptr<ValueType[]> m_aStereoFuncsData,m_aResegmFuncsData;
+    /// sorted label sets of the pruned stereo unary functions (sparse view data)
+    std::unique_ptr<InternalLabelType[]> m_aStereoUnaryFuncsLabels;
     /// stereo model unary/pairw/epipolar functions base pointers
     ValueType *m_pStereoUnaryFuncsDataBase,*m_pStereoPairwFuncsDataBase,*m_pStereoEpipolarFuncsDataBase,*m_pStereoFuncsDataEnd;
     /// resegm model unary/pairw/temporal functions base pointers
@@ -399,6 +419,10 @@ struct SegmMatcher::GraphModelData {
 #endif //SEGMMATCH_CONFIG_USE_..._AFFINITY
     /// holds the feature extractor to use on input shapes
     std::unique_ptr<ShapeContext> m_pShpDescExtractor;
+    /// holds the latest shape descriptor maps (kept across frames for incremental updates)
+    CamArray<cv::Mat_<float>> m_aShpDescs;
+    /// holds the contour points used to compute the latest shape descriptor maps
+    CamArray<cv::Mat_<cv::Point2f>> m_aShpContourPts;
     /// defines the minimum grid border size based on the feature extractors used
     size_t m_nGridBorderSize;
     /// holds the last/next features packet info vector
@@ -409,9 +433,49 @@ struct SegmMatcher::GraphModelData {
     TemporalArray<MatArrayIn> m_aaInputs;
     /// defines whether the next model update should use precalc features
     bool m_bUsePrecalcFeaturesNext;
+    /// defines whether inference only solves the stereo model (no shape features, gmm or resegm; used for coarse pyramid levels)
+    bool m_bStereoOnly;
+    /// storage types used for descriptor maps when computing affinities, and for affinity maps in feature packets
+    lv::DescMapStorageType m_eDescMapStorage,m_eFeatsPackStorage;
+    /// raw temporal diff threshold above which cached stereo init unaries are re-evaluated (0 = always re-evaluate all nodes)
+    size_t m_nStereoUnaryReuseDiff;
+    /// motion-compensated temporal diff threshold above which warped stereo labels restart from the wta init (0 = never)
+    size_t m_nStereoReinitDiff;
+    /// stereo init unary labels & values cached for each graph node ('m_nStereoSparseLabels' entries per node)
+    std::vector<InternalLabelType> m_vCachedStereoUnaryLabels;
+    std::vector<ValueType> m_vCachedStereoUnaryValues;
+    /// stereo init unary default values & img/shp saliencies cached for each graph node
+    std::vector<ValueType> m_vCachedStereoUnaryDefaults;
+    std::vector<std::array<float,2>> m_vCachedStereoUnarySaliencies;
+    /// gray input images & masks the cached stereo unaries were computed from
+    CamArray<cv::Mat> m_aCachedStereoUnaryImages,m_aCachedStereoUnaryMasks;
     /// used for debug only; passed from top-level algo when available
     lv::DisplayHelperPtr m_pDisplayHelper;
 
+    /// holds a copy of all model data modified by 'infer' (used to replay inference with different solvers)
+    struct InferenceState {
+        /// super-stacked stereo/resegm labelings
+        cv::Mat_<InternalLabelType> oStereoLabeling,oResegmLabeling;
+        /// features for all temporal layers (shape features change during inference)
+        TemporalArray<std::vector<cv::Mat>> avFeatures;
+        /// cached shape descriptor maps & contour points used for incremental updates
+        CamArray<cv::Mat_<float>> aShpDescs;
+        CamArray<cv::Mat_<cv::Point2f>> aShpContourPts;
+        /// gmm fg/bg model params (raw copies, as gmm objects hold pointers to their own buffers)
+        CamArray<std::vector<double>> avFGModelData_3ch,avBGModelData_3ch,avFGModelData_1ch,avBGModelData_1ch;
+        /// stereo pairwise weights & clique update flags of all valid nodes (they decide which duals get reused)
+        std::vector<float> vStereoPairwWeights;
+        std::vector<uchar> vStereoUpdatedCliques;
+    #if SEGMMATCH_HAVE_SOSPD_INF
+        /// stereo duals kept from the previous inference (used as warm start)
+        cv::Mat_<ValueType> oStereoDualMap;
+    #endif //SEGMMATCH_HAVE_SOSPD_INF
+    };
+    /// copies all model data modified by 'infer' into the given state object
+    void saveInferenceState(InferenceState& oState);
+    /// restores all model data modified by 'infer' from the given state object (in-place, views stay valid)
+    void loadInferenceState(const InferenceState& oState);
+
 protected:
     /// adds a stereo association for a given node coord set & origin column idx
     void addAssoc(int nRowIdx, int nColIdx, InternalLabelType nLabel) const;
@@ -421,6 +485,8 @@ protected:
     void buildStereoModel();
     /// updates a stereo graph model using new features data
     void updateStereoModel(bool bInit);
+    /// flags stereo nodes whose init unaries can be reused, i.e. whose input neighborhoods did not change since they were cached (empty if the cache is invalid)
+    void calcReusableStereoNodes(cv::Mat_<uchar>& oReusableNodes);
     /// resets primary+secondary stereo graph labelings using current model data
     void resetStereoLabelings();
     /// resets a secondary stereo graph labeling by projecting the primary disparity map data
@@ -435,9 +501,12 @@ protected:
     /// updates a shape graph model using new features data
     void updateResegmModel(bool bInit);
     /// calculates image features required for model updates using the provided input image array
-    void calcImageFeatures(const CamArray<cv::Mat>& aInputImages, std::vector<cv::Mat>& vFeatures);
+    void calcImageFeatures(const CamArray<cv::Mat>& aInputImages, std::vector<cv::Mat>& vFeatures, bool bUseLabelPrior);
     /// calculates shape features required for model updates using the provided input mask array
-    void calcShapeFeatures(const CamArray<cv::Mat_<InternalLabelType>>& aInputMasks, std::vector<cv::Mat>& vFeatures);
+    void calcShapeFeatures(const CamArray<cv::Mat_<InternalLabelType>>& aInputMasks, std::vector<cv::Mat>& vFeatures, bool bUseLabelPrior);
+    /// fills a dense stereo affinity map via 'lAffinityFunc', only evaluating windowed labels if required (others are flagged as invalid, i.e. -1)
+    template<typename TAffinityFunc>
+    void calcStereoAffinity(cv::Mat_<float>& oAffinity, bool bUseLabelPrior, TAffinityFunc&& lAffinityFunc) const;
     /// calculates shape mask distance features required for model updates using the provided input mask & camera index
     void calcShapeDistFeatures(const cv::Mat_<InternalLabelType>& oInputMask, size_t nCamIdx, std::vector<cv::Mat>& vFeatures);
     /// initializes foreground and background GMM parameters via KNN using the given image and mask (where all values >0 are considered foreground)
@@ -450,26 +519,29 @@ protected:
     double getGMMFGProb(const cv::Mat& oInput, size_t nElemIdx, size_t nCamIdx) const;
     /// evaluates background segmentation probability density for a given image & lookup index
     double getGMMBGProb(const cv::Mat& oInput, size_t nElemIdx, size_t nCamIdx) const;
+    /// returns whether a stereo label is part of the candidate label window of a given node (always true w/o a label prior)
+    bool isStereoLabelInWindow(size_t nLUTNodeIdx, InternalLabelType nLabel) const;
     /// calculates a stereo unary move cost for a single graph node
     ValueType calcStereoUnaryMoveCost(size_t nGraphNodeIdx, InternalLabelType nOldLabel, InternalLabelType nNewLabel) const;
     /// fill internal temporary energy cost mats for the given stereo move operation
     void calcStereoMoveCosts(InternalLabelType nNewLabel) const;
     /// fill internal temporary energy cost mats for the given resegm move operation
     void calcResegmMoveCosts(InternalLabelType nNewLabel) const;
-#if (SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
+#if SEGMMATCH_HAVE_SOSPD_INF
     /// init minimizer for later inference using SoSPD (returns active clique count)
     template<typename TNode>
     size_t initMinimizer(sospd::SubmodularIBFS<ValueType,IndexType>& oMinimizer,
                          const std::vector<TNode>& vNodeMap,
                          const std::vector<size_t>& vGraphIdxToMapIdxLUT);
-    /// setup graph, dual, and cliques for later inference using SoSPD (returns active clique count)
+    /// setup graph, dual, and cliques for later inference using SoSPD (returns active clique count; previous duals of unchanged cliques can be kept as warm start)
     template<typename TFunc, typename TNode>
     size_t setupPrimalDual(const std::vector<TNode>& vNodeMap,
                            const std::vector<size_t>& vGraphIdxToMapIdxLUT,
                            const cv::Mat_<InternalLabelType>& oLabeling,
                            cv::Mat_<ValueType>& oDualMap,
                            cv::Mat_<ValueType>& oHeightMap,
-                           size_t nTotLabels, size_t nMaxCliques);
+                           size_t nTotLabels, size_t nMaxCliques,
+                           bool bReuseDuals=false);
     /// solves a move operation using the SoSPD algo of Fix et al.; see "A Primal-Dual Algorithm for Higher-Order Multilabel Markov Random Fields" in CVPR2014 for more info
     template<typename TFunc, typename TNode>
     void solvePrimalDual(sospd::SubmodularIBFS<ValueType,IndexType>& oMinimizer,
@@ -484,7 +556,14 @@ protected:
                          bool bUpdateAssocs,
                          TemporalArray<CamArray<size_t>>& aanChangedLabels);
     cv::Mat_<ValueType> m_oStereoDualMap,m_oStereoHeightMap,m_oResegmDualMap,m_oResegmHeightMap;
-#endif //(SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
+    /// stereo primal-dual minimizer kept across frames (the stereo graph topology never changes, so its cliques are only built once)
+    std::unique_ptr<sospd::SubmodularIBFS<ValueType,IndexType>> m_pStereoIBFSMinimizer;
+#endif //SEGMMATCH_HAVE_SOSPD_INF
+#if SEGMMATCH_HAVE_FGBZ_INF
+    /// fgbz reducers & qpbo minimizers kept across frames (their graph buffers are reset between moves instead of reallocated)
+    std::unique_ptr<kolmogorov::qpbo::QPBO<ValueType>> m_pStereoQPBOMinimizer,m_pResegmQPBOMinimizer;
+    std::unique_ptr<HigherOrderEnergy<ValueType,s_nMaxOrder>> m_pStereoReducer,m_pResegmReducer;
+#endif //SEGMMATCH_HAVE_FGBZ_INF
     /// holds stereo disparity graph inference algorithm interface (redirects for bi-model inference)
     std::unique_ptr<StereoGraphInference> m_pStereoInf;
     /// holds resegmentation graph inference algorithm interface (redirects for bi-model inference)
@@ -721,6 +800,14 @@ SegmMatcher::SegmMatcher(size_t nMinDispOffset, size_t nMaxDispOffset) {
     m_vStereoLabels = lv::make_range((OutputLabelType)nMinDispOffset,(OutputLabelType)nMaxDispOffset,(OutputLabelType)m_nDispStep);
     lvDbgAssert(nExpectedDispLabelCount==m_vStereoLabels.size());
     lvAssert_(m_vStereoLabels.size()>1,"graph must have at least two possible output labels, beyond reserved ones");
+    m_oStereoSolverParams = {isStereoSolverAvailable(SEGMMATCH_DEFAULT_STEREO_SOLVER)?SEGMMATCH_DEFAULT_STEREO_SOLVER:InferenceSolver_SoSPD,SEGMMATCH_DEFAULT_MAX_STEREO_ITER,0.0,SEGMMATCH_DEFAULT_STEREO_TILE_SIZE,SEGMMATCH_DEFAULT_STEREO_TILE_GAP,SEGMMATCH_DEFAULT_STEREO_TOPK_LABELS};
+    m_oResegmSolverParams = {isResegmSolverAvailable(SEGMMATCH_DEFAULT_RESEGM_SOLVER)?SEGMMATCH_DEFAULT_RESEGM_SOLVER:InferenceSolver_FGBZ,SEGMMATCH_DEFAULT_MAX_RESEGM_ITER,0.0,size_t(0),0.0,size_t(0)};
+    m_nStereoPyramidLevels = SEGMMATCH_DEFAULT_STEREO_PYR_LEVELS;
+    m_nStereoLabelWindowRad = SEGMMATCH_DEFAULT_STEREO_PYR_WIN_RAD;
+    m_eDescMapStorage = SEGMMATCH_DEFAULT_DESC_MAP_STORAGE;
+    m_eFeatsPackStorage = SEGMMATCH_DEFAULT_FEATS_PACK_STORAGE;
+    m_nStereoUnaryReuseDiff = SEGMMATCH_DEFAULT_STEREO_REUSE_DIFF;
+    m_nStereoReinitDiff = SEGMMATCH_DEFAULT_STEREO_REINIT_DIFF;
 }
 
 SegmMatcher::~SegmMatcher() {}
@@ -733,12 +820,168 @@ void SegmMatcher::initialize(const std::array<cv::Mat,s_nCameraCount>& aROIs, si
     lvAssert_(m_nDispStep>0,"specified disparity offset step size must be strictly positive");
     lvAssert_(m_vStereoLabels.size()>1,"graph must have at least two possible output labels, beyond reserved ones");
     lvAssert_(nPrimaryCamIdx<getCameraCount(),"primary camera idx is out of range");
-    m_pModelData = std::make_unique<GraphModelData>(aROIs,m_vStereoLabels,m_nDispStep,nPrimaryCamIdx);
+    m_pModelData = std::make_unique<GraphModelData>(aROIs,m_vStereoLabels,m_nDispStep,nPrimaryCamIdx,m_oStereoSolverParams,m_oResegmSolverParams);
     if(m_pDisplayHelper)
         m_pModelData->m_pDisplayHelper = m_pDisplayHelper;
+    m_pModelData->m_eDescMapStorage = m_eDescMapStorage;
+    m_pModelData->m_eFeatsPackStorage = m_eFeatsPackStorage;
+    m_pModelData->m_nStereoUnaryReuseDiff = m_nStereoUnaryReuseDiff;
+    m_pModelData->m_nStereoReinitDiff = m_nStereoReinitDiff;
+    m_pCoarseMatcher = nullptr;
+    if(m_nStereoPyramidLevels>0u) {
+        // coarse level uses half the resolution and half the disparity range; it may itself be solved coarse-to-fine
+        const size_t nCoarseMinDispOffset = size_t(m_vStereoLabels.front())/2u;
+        const size_t nCoarseMaxDispOffset = (size_t(m_vStereoLabels.back())+1u)/2u;
+        lvAssert_(nCoarseMaxDispOffset>nCoarseMinDispOffset,"disparity range too small for coarse-to-fine stereo");
+        std::array<cv::Mat,s_nCameraCount> aCoarseROIs;
+        for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+            cv::resize(aROIs[nCamIdx],aCoarseROIs[nCamIdx],cv::Size((aROIs[nCamIdx].cols+1)/2,(aROIs[nCamIdx].rows+1)/2),0,0,cv::INTER_NEAREST);
+        m_pCoarseMatcher = std::make_unique<SegmMatcher>(nCoarseMinDispOffset,nCoarseMaxDispOffset);
+        m_pCoarseMatcher->m_oStereoSolverParams = m_oStereoSolverParams;
+        m_pCoarseMatcher->m_oResegmSolverParams = m_oResegmSolverParams;
+        m_pCoarseMatcher->setCoarseToFineStereo(m_nStereoPyramidLevels-1u,m_nStereoLabelWindowRad);
+        m_pCoarseMatcher->setDescriptorStorage(m_eDescMapStorage,m_eFeatsPackStorage);
+        m_pCoarseMatcher->setStereoTemporalUpdates(m_nStereoUnaryReuseDiff,m_nStereoReinitDiff);
+        m_pCoarseMatcher->initialize(aCoarseROIs,nPrimaryCamIdx);
+        m_pCoarseMatcher->m_pModelData->m_bStereoOnly = true; // coarse levels only provide a stereo label prior
+    }
+}
+
+void SegmMatcher::updateStereoLabelPrior(const MatArrayIn& aInputs) {
+    static_assert(s_nInputArraySize==4 && getCameraCount()==2,"lots of hardcoded indices below");
+    lvDbgExceptionWatch;
+    lvAssert_(m_pModelData,"model must be initialized first");
+    if(!m_pCoarseMatcher)
+        return;
+    lv::StopWatch oLocalTimer;
+    const cv::Size oCoarseSize = m_pCoarseMatcher->m_pModelData->m_oGridSize;
+    MatArrayIn aCoarseInputs;
+    for(size_t nInputIdx=0u; nInputIdx<aInputs.size(); ++nInputIdx) // masks must stay binary, so they are not interpolated
+        cv::resize(aInputs[nInputIdx],aCoarseInputs[nInputIdx],oCoarseSize,0,0,((nInputIdx%InputPackOffset)==InputPackOffset_Mask)?cv::INTER_NEAREST:cv::INTER_AREA);
+    MatArrayOut aCoarseOutputs;
+    m_pCoarseMatcher->apply(aCoarseInputs,aCoarseOutputs);
+    const GraphModelData& oCoarseModel = *m_pCoarseMatcher->m_pModelData;
+    cv::Mat_<InternalLabelType> oCoarseLabeling = oCoarseModel.m_aaStereoLabelings[0][oCoarseModel.m_nPrimaryCamIdx].clone();
+    // special (occluded/dontcare) and out-of-roi coarse labels give no disparity hint; they are inferred from their closest valid neighbor
+    const cv::Mat_<uchar> oInvalidCoarseMask = oCoarseLabeling>=InternalLabelType(oCoarseModel.m_nRealStereoLabels);
+    const int nInvalidCoarseLabels = cv::countNonZero(oInvalidCoarseMask);
+    if(nInvalidCoarseLabels>0 && nInvalidCoarseLabels<(int)oCoarseLabeling.total()) {
+        std::vector<InternalLabelType> vValidCoarseLabels; // in scan order, as indexed by the voronoi labels below
+        vValidCoarseLabels.reserve(oCoarseLabeling.total()-size_t(nInvalidCoarseLabels));
+        for(size_t nIdx=0; nIdx<oCoarseLabeling.total(); ++nIdx)
+            if(!oInvalidCoarseMask.data[nIdx])
+                vValidCoarseLabels.push_back(((InternalLabelType*)oCoarseLabeling.data)[nIdx]);
+        cv::Mat_<float> oClosestValidDist;
+        cv::Mat_<int> oClosestValidIdxs;
+        cv::distanceTransform(oInvalidCoarseMask,oClosestValidDist,oClosestValidIdxs,cv::DIST_L2,cv::DIST_MASK_5,cv::DIST_LABEL_PIXEL);
+        for(size_t nIdx=0; nIdx<oCoarseLabeling.total(); ++nIdx) {
+            if(oInvalidCoarseMask.data[nIdx]) {
+                const int nClosestValidIdx = ((int*)oClosestValidIdxs.data)[nIdx]-1;
+                lvDbgAssert(nClosestValidIdx>=0 && nClosestValidIdx<(int)vValidCoarseLabels.size());
+                ((InternalLabelType*)oCoarseLabeling.data)[nIdx] = vValidCoarseLabels[nClosestValidIdx];
+            }
+        }
+    }
+    GraphModelData& oModel = *m_pModelData;
+    const int nRows = (int)oModel.m_oGridSize(0), nCols = (int)oModel.m_oGridSize(1);
+    const cv::Mat_<uchar>& oROI = oModel.m_aROIs[oModel.m_nPrimaryCamIdx];
+    oModel.m_oStereoLabelPriorMap.create(nRows,nCols);
+    oModel.m_nStereoLabelWindowRad = m_nStereoLabelWindowRad;
+    std::fill(oModel.m_vWindowedStereoLabels.begin(),oModel.m_vWindowedStereoLabels.end(),uchar(0));
+    for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+        for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+            const InternalLabelType nCoarseLabel = oCoarseLabeling(nRowIdx/2,nColIdx/2);
+            InternalLabelType& nPriorLabel = oModel.m_oStereoLabelPriorMap(nRowIdx,nColIdx);
+            if(nCoarseLabel>=oCoarseModel.m_nRealStereoLabels) // only left if the coarse pass found no valid label at all; window stays unrestricted
+                nPriorLabel = oModel.m_nDontCareLabelIdx;
+            else {
+                const int nRealLabel = (int)oCoarseModel.getRealLabel(nCoarseLabel)*2;
+                const int nStep = (int)oModel.m_nDispOffsetStep;
+                const int nLabelIdx = (nRealLabel-(int)oModel.m_nMinDispOffset+nStep/2)/nStep;
+                nPriorLabel = (InternalLabelType)std::max(std::min(nLabelIdx,(int)oModel.m_nRealStereoLabels-1),0);
+            }
+            if(!oROI(nRowIdx,nColIdx))
+                continue;
+            const int nWindowRad = (int)m_nStereoLabelWindowRad;
+            const int nWindowStart = (nPriorLabel<oModel.m_nRealStereoLabels)?std::max((int)nPriorLabel-nWindowRad,0):0;
+            const int nWindowEnd = (nPriorLabel<oModel.m_nRealStereoLabels)?std::min((int)nPriorLabel+nWindowRad,(int)oModel.m_nRealStereoLabels-1):(int)oModel.m_nRealStereoLabels-1;
+            std::fill(oModel.m_vWindowedStereoLabels.begin()+nWindowStart,oModel.m_vWindowedStereoLabels.begin()+nWindowEnd+1,uchar(1));
+        }
+    }
+    lvLog_(4,"Coarse stereo label prior windows cover %d labels out of %d",(int)std::count(oModel.m_vWindowedStereoLabels.begin(),oModel.m_vWindowedStereoLabels.end(),uchar(1)),(int)oModel.m_nRealStereoLabels);
+    lvLog_(2,"Coarse stereo label prior computed in %f second(s).",oLocalTimer.tock());
 }
 
 void SegmMatcher::apply(const MatArrayIn& aInputs, MatArrayOut& aOutputs) {
+    static_assert(s_nInputArraySize==4 && getCameraCount()==2,"lots of hardcoded indices below");
+    lvDbgExceptionWatch;
+    lvAssert_(m_pModelData,"model must be initialized first");
+    updateStereoLabelPrior(aInputs);
+    updateInputs(aInputs);
+    m_pModelData->infer();
+    ++m_pModelData->m_nFramesProcessed;
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        // copy over latest labelings as output; note: the segm masks may change over future iterations --- user will have to revalidate
+        m_pModelData->m_aaStereoLabelings[0][nCamIdx].copyTo(aOutputs[nCamIdx*OutputPackOffset+OutputPackOffset_Disp]);
+        m_pModelData->m_aaResegmLabelings[0][nCamIdx].copyTo(aOutputs[nCamIdx*OutputPackOffset+OutputPackOffset_Mask]);
+    }
+}
+
+std::vector<SegmMatcher::InferenceSolverTrace> SegmMatcher::benchmarkSolvers(const MatArrayIn& aInputs, MatArrayOut& aOutputs) {
+    static_assert(s_nInputArraySize==4 && getCameraCount()==2,"lots of hardcoded indices below");
+    lvDbgExceptionWatch;
+    lvAssert_(m_pModelData,"model must be initialized first");
+    updateStereoLabelPrior(aInputs);
+    updateInputs(aInputs);
+    GraphModelData::InferenceState oInitState;
+    m_pModelData->saveInferenceState(oInitState);
+    std::vector<InferenceSolverTrace> vTraces;
+    for(int nStereoSolverIdx=0; nStereoSolverIdx<(int)InferenceSolverCount; ++nStereoSolverIdx) {
+        const InferenceSolverType eStereoSolver = (InferenceSolverType)nStereoSolverIdx;
+        if(!isStereoSolverAvailable(eStereoSolver))
+            continue;
+        for(int nResegmSolverIdx=0; nResegmSolverIdx<(int)InferenceSolverCount; ++nResegmSolverIdx) {
+            const InferenceSolverType eResegmSolver = (InferenceSolverType)nResegmSolverIdx;
+            if(!isResegmSolverAvailable(eResegmSolver))
+                continue;
+            lvLog_(1,"Benchmarking inference w/ stereo solver '%s' and resegm solver '%s'...",getSolverName(eStereoSolver).c_str(),getSolverName(eResegmSolver).c_str());
+            m_pModelData->loadInferenceState(oInitState);
+            m_pModelData->m_oStereoSolverParams.eSolver = eStereoSolver;
+            m_pModelData->m_oResegmSolverParams.eSolver = eResegmSolver;
+            vTraces.push_back(InferenceSolverTrace{eStereoSolver,eResegmSolver,0.0,{}});
+            m_pModelData->m_pInferenceTrace = &vTraces.back().vPoints;
+            lv::StopWatch oRunTimer;
+            try {
+                m_pModelData->infer();
+            }
+            catch(...) {
+                m_pModelData->m_pInferenceTrace = nullptr;
+                m_pModelData->m_oStereoSolverParams = m_oStereoSolverParams;
+                m_pModelData->m_oResegmSolverParams = m_oResegmSolverParams;
+                throw;
+            }
+            vTraces.back().dTotalTimeSec = oRunTimer.tock();
+            m_pModelData->m_pInferenceTrace = nullptr;
+            for(const InferenceTracePoint& oPoint : vTraces.back().vPoints)
+                lvLog_(2,"\tt = %f   stereo e = %d   resegm e = %d   [stereo-iter=%d, resegm-iter=%d]",oPoint.dElapsedSec,(int)oPoint.tStereoEnergy,(int)oPoint.tResegmEnergy,(int)oPoint.nStereoMoveIter,(int)oPoint.nResegmMoveIter);
+            lvLog_(1,"\tdone in %f second(s); final stereo e = %d, final resegm e = %d",vTraces.back().dTotalTimeSec,
+                   vTraces.back().vPoints.empty()?-1:(int)vTraces.back().vPoints.back().tStereoEnergy,vTraces.back().vPoints.empty()?-1:(int)vTraces.back().vPoints.back().tResegmEnergy);
+        }
+    }
+    // final (kept) inference uses the selected solvers, starting from the same initial state
+    m_pModelData->loadInferenceState(oInitState);
+    m_pModelData->m_oStereoSolverParams = m_oStereoSolverParams;
+    m_pModelData->m_oResegmSolverParams = m_oResegmSolverParams;
+    m_pModelData->infer();
+    ++m_pModelData->m_nFramesProcessed;
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        m_pModelData->m_aaStereoLabelings[0][nCamIdx].copyTo(aOutputs[nCamIdx*OutputPackOffset+OutputPackOffset_Disp]);
+        m_pModelData->m_aaResegmLabelings[0][nCamIdx].copyTo(aOutputs[nCamIdx*OutputPackOffset+OutputPackOffset_Mask]);
+    }
+    return vTraces;
+}
+
+void SegmMatcher::updateInputs(const MatArrayIn& aInputs) {
     static_assert(s_nInputArraySize==4 && getCameraCount()==2,"lots of hardcoded indices below");
     lvDbgExceptionWatch;
     lvAssert_(m_pModelData,"model must be initialized first");
@@ -776,7 +1019,7 @@ void SegmMatcher::apply(const MatArrayIn& aInputs, MatArrayOut& aOutputs) {
         std::swap(m_pModelData->m_vLoadedFeatures,m_pModelData->m_avFeatures[0]);
     }
     else {
-        m_pModelData->calcFeatures(m_pModelData->m_aaInputs[0]);
+        m_pModelData->calcFeatures(m_pModelData->m_aaInputs[0],nullptr,true);
         lvDbgAssert(m_pModelData->m_vTempFeatures.size()==FeatPackSize);
         std::swap(m_pModelData->m_vTempFeatures,m_pModelData->m_avFeatures[0]);
     }
@@ -792,13 +1035,6 @@ void SegmMatcher::apply(const MatArrayIn& aInputs, MatArrayOut& aOutputs) {
                 m_pModelData->m_aaResegmLabelings[0][nCamIdx].copyTo(m_pModelData->m_aaResegmLabelings[nLayerIdx][nCamIdx]);
         }
     }
-    m_pModelData->infer();
-    ++m_pModelData->m_nFramesProcessed;
-    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
-        // copy over latest labelings as output; note: the segm masks may change over future iterations --- user will have to revalidate
-        m_pModelData->m_aaStereoLabelings[0][nCamIdx].copyTo(aOutputs[nCamIdx*OutputPackOffset+OutputPackOffset_Disp]);
-        m_pModelData->m_aaResegmLabelings[0][nCamIdx].copyTo(aOutputs[nCamIdx*OutputPackOffset+OutputPackOffset_Mask]);
-    }
 }
 
 void SegmMatcher::getOutput(size_t nTemporalLayerIdx, MatArrayOut& aOutputs) const {
@@ -827,6 +1063,8 @@ void SegmMatcher::setNextFeatures(const cv::Mat& oPackedFeatures) {
 void SegmMatcher::resetTemporalModel() {
     lvDbgExceptionWatch;
     m_pModelData->m_nFramesProcessed = 0u;
+    if(m_pCoarseMatcher)
+        m_pCoarseMatcher->resetTemporalModel();
 }
 
 std::string SegmMatcher::getFeatureExtractorName() const {
@@ -873,31 +1111,143 @@ cv::Mat SegmMatcher::getAssocCountsMapDisplay() const {
     return m_pModelData->getAssocCountsMapDisplay();
 }
 
+bool SegmMatcher::isStereoSolverAvailable(InferenceSolverType eSolver) {
+    switch(eSolver) {
+        case InferenceSolver_FGBZ: return bool(SEGMMATCH_HAVE_FGBZ_INF);
+        case InferenceSolver_FastPD: return bool(SEGMMATCH_HAVE_FASTPD_INF) && !bool(SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN); // pairwise terms only
+        case InferenceSolver_SoSPD: return bool(SEGMMATCH_HAVE_SOSPD_INF);
+        default: return false;
+    }
+}
+
+bool SegmMatcher::isResegmSolverAvailable(InferenceSolverType eSolver) {
+    switch(eSolver) {
+        case InferenceSolver_FGBZ: return bool(SEGMMATCH_HAVE_FGBZ_INF);
+        case InferenceSolver_SoSPD: return bool(SEGMMATCH_HAVE_SOSPD_INF);
+        default: return false; // fastpd cannot handle the temporal (higher-order) cliques of the resegm model
+    }
+}
+
+std::string SegmMatcher::getSolverName(InferenceSolverType eSolver) {
+    switch(eSolver) {
+        case InferenceSolver_FGBZ: return "fgbz-qpbo";
+        case InferenceSolver_FastPD: return "fastpd";
+        case InferenceSolver_SoSPD: return "sospd-ibfs";
+        default: lvError("unknown inference solver type");
+    }
+}
+
+void SegmMatcher::setStereoSolver(InferenceSolverType eSolver, size_t nMaxMoveCount, double dMaxTimeSec) {
+    lvDbgExceptionWatch;
+    lvAssert__(isStereoSolverAvailable(eSolver),"stereo inference solver '%s' is unavailable in this build",getSolverName(eSolver).c_str());
+    lvAssert_(nMaxMoveCount>0u,"max iter count must be strictly positive");
+    m_oStereoSolverParams.eSolver = eSolver;
+    m_oStereoSolverParams.nMaxMoveCount = nMaxMoveCount;
+    m_oStereoSolverParams.dMaxTimeSec = dMaxTimeSec;
+    if(m_pModelData)
+        m_pModelData->m_oStereoSolverParams = m_oStereoSolverParams;
+}
+
+void SegmMatcher::setStereoMoveTiling(size_t nTileSize, double dMaxEnergyGap) {
+    lvDbgExceptionWatch;
+    lvAssert_(nTileSize==0u || nTileSize>1u,"move tiles must be at least two nodes wide");
+    lvAssert_(dMaxEnergyGap>=0.0,"tiled move energy gap must be non-negative");
+    m_oStereoSolverParams.nMoveTileSize = nTileSize;
+    m_oStereoSolverParams.dMaxTiledMoveEnergyGap = dMaxEnergyGap;
+    if(m_pModelData)
+        m_pModelData->m_oStereoSolverParams = m_oStereoSolverParams;
+}
+
+void SegmMatcher::setStereoLabelPruning(size_t nTopKLabels) {
+    lvDbgExceptionWatch;
+    lvAssert_(!m_pModelData,"stereo label pruning must be set up before initialization");
+    m_oStereoSolverParams.nTopKLabels = nTopKLabels;
+}
+
+void SegmMatcher::setCoarseToFineStereo(size_t nPyramidLevels, size_t nLabelWindowRad) {
+    lvDbgExceptionWatch;
+    lvAssert_(!m_pModelData,"coarse-to-fine stereo must be set up before initialization");
+    m_nStereoPyramidLevels = nPyramidLevels;
+    m_nStereoLabelWindowRad = nLabelWindowRad;
+}
+
+void SegmMatcher::setStereoTemporalUpdates(size_t nUnaryReuseDiff, size_t nReinitDiff) {
+    lvDbgExceptionWatch;
+    lvAssert_(nUnaryReuseDiff<=255u && nReinitDiff<=255u,"temporal diff thresholds must be in the 8-bit intensity range");
+    m_nStereoUnaryReuseDiff = nUnaryReuseDiff;
+    m_nStereoReinitDiff = nReinitDiff;
+    if(m_pModelData) {
+        m_pModelData->m_nStereoUnaryReuseDiff = m_nStereoUnaryReuseDiff;
+        m_pModelData->m_nStereoReinitDiff = m_nStereoReinitDiff;
+    }
+    if(m_pCoarseMatcher)
+        m_pCoarseMatcher->setStereoTemporalUpdates(nUnaryReuseDiff,nReinitDiff);
+}
+
+void SegmMatcher::setDescriptorStorage(lv::DescMapStorageType eDescMapStorage, lv::DescMapStorageType eFeatsPackStorage) {
+    lvDbgExceptionWatch;
+    lvAssert_(!m_pModelData,"descriptor storage types must be set up before initialization");
+    lvAssert_(eFeatsPackStorage==lv::DescMapStorage_Float || eFeatsPackStorage==lv::DescMapStorage_Half,"feature packets need a storage type without per-frame quantization params");
+    m_eDescMapStorage = eDescMapStorage;
+    m_eFeatsPackStorage = eFeatsPackStorage;
+}
+
+void SegmMatcher::setResegmSolver(InferenceSolverType eSolver, size_t nMaxMoveCount, double dMaxTimeSec) {
+    lvDbgExceptionWatch;
+    lvAssert__(isResegmSolverAvailable(eSolver),"resegm inference solver '%s' is unavailable in this build",getSolverName(eSolver).c_str());
+    lvAssert_(nMaxMoveCount>0u,"max iter count must be strictly positive");
+    m_oResegmSolverParams.eSolver = eSolver;
+    m_oResegmSolverParams.nMaxMoveCount = nMaxMoveCount;
+    m_oResegmSolverParams.dMaxTimeSec = dMaxTimeSec;
+    if(m_pModelData)
+        m_pModelData->m_oResegmSolverParams = m_oResegmSolverParams;
+}
+
+const SegmMatcher::InferenceSolverParams& SegmMatcher::getStereoSolver() const {
+    return m_oStereoSolverParams;
+}
+
+const SegmMatcher::InferenceSolverParams& SegmMatcher::getResegmSolver() const {
+    return m_oResegmSolverParams;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 constexpr size_t SegmMatcher::GraphModelData::s_nResegmLabels;
 
-SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, const std::vector<OutputLabelType>& vRealStereoLabels, size_t nStereoLabelStep, size_t nPrimaryCamIdx) :
+SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, const std::vector<OutputLabelType>& vRealStereoLabels, size_t nStereoLabelStep, size_t nPrimaryCamIdx,
+                                            const InferenceSolverParams& oStereoSolverParams, const InferenceSolverParams& oResegmSolverParams) :
         m_nFramesProcessed(0u),
-        m_nMaxStereoMoveCount(SEGMMATCH_DEFAULT_MAX_STEREO_ITER),
-        m_nMaxResegmMoveCount(SEGMMATCH_DEFAULT_MAX_RESEGM_ITER),
+        m_oStereoSolverParams(oStereoSolverParams),
+        m_oResegmSolverParams(oResegmSolverParams),
+        m_pInferenceTrace(nullptr),
         m_nStereoLabelOrderRandomSeed(0u),
         m_nStereoLabelingRandomSeed(0u),
+        m_nResegmGMMRandomSeed(0u),
+        m_nStereoLabelWindowRad(0u),
+        m_vWindowedStereoLabels(vRealStereoLabels.size(),uchar(1)),
         m_aROIs(CamArray<cv::Mat_<uchar>>{aROIs[0]>0,aROIs[1]>0}),
         m_oGridSize(m_aROIs[0].size()),
         m_vStereoLabels(lv::concat<OutputLabelType>(vRealStereoLabels,std::vector<OutputLabelType>{s_nDontCareLabel,s_nOccludedLabel})),
         m_nRealStereoLabels(vRealStereoLabels.size()),
         m_nStereoLabels(vRealStereoLabels.size()+2u),
+        m_nStereoSparseLabels(((oStereoSolverParams.nTopKLabels>0u)?std::min(oStereoSolverParams.nTopKLabels,vRealStereoLabels.size()):vRealStereoLabels.size())+2u),
         m_nDispOffsetStep(nStereoLabelStep),
         m_nMinDispOffset(size_t(m_vStereoLabels[0])),
         m_nMaxDispOffset(size_t(m_vStereoLabels.size()>3u?m_vStereoLabels[m_vStereoLabels.size()-3u]:m_vStereoLabels.back())),
         m_nPrimaryCamIdx(nPrimaryCamIdx),
         m_nDontCareLabelIdx(InternalLabelType(m_vStereoLabels.size()-2u)),
         m_nOccludedLabelIdx(InternalLabelType(m_vStereoLabels.size()-1u)),
-        m_bUsePrecalcFeaturesNext(false) {
+        m_bUsePrecalcFeaturesNext(false),
+        m_bStereoOnly(false),
+        m_eDescMapStorage(SEGMMATCH_DEFAULT_DESC_MAP_STORAGE),
+        m_eFeatsPackStorage(SEGMMATCH_DEFAULT_FEATS_PACK_STORAGE),
+        m_nStereoUnaryReuseDiff(SEGMMATCH_DEFAULT_STEREO_REUSE_DIFF),
+        m_nStereoReinitDiff(SEGMMATCH_DEFAULT_STEREO_REINIT_DIFF) {
     static_assert(getCameraCount()==2,"bad static array size, hardcoded stuff in constr init list and below will break");
     lvDbgExceptionWatch;
-    lvAssert_(m_nMaxStereoMoveCount>0u && m_nMaxResegmMoveCount>0u,"max iter counts must be strictly positive");
+    lvAssert_(m_oStereoSolverParams.nMaxMoveCount>0u && m_oResegmSolverParams.nMaxMoveCount>0u,"max iter counts must be strictly positive");
+    lvAssert_(isStereoSolverAvailable(m_oStereoSolverParams.eSolver) && isResegmSolverAvailable(m_oResegmSolverParams.eSolver),"selected inference solvers are unavailable");
     for(size_t nCamIdx=0u; nCamIdx<getCameraCount(); ++nCamIdx) {
         lvAssert_(lv::MatInfo(m_aROIs[0])==lv::MatInfo(m_aROIs[nCamIdx]),"ROIs info must match");
         lvAssert_(cv::countNonZero(m_aROIs[nCamIdx]>0)>1,"ROIs must have at least two nodes");
@@ -1002,7 +1352,7 @@ SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, cons
         nTotValidNodes += anValidGraphNodes[nCamIdx];
         cv::erode(m_aROIs[nCamIdx],m_aDescROIs[nCamIdx],cv::getStructuringElement(cv::MORPH_RECT,oDescWinSize),cv::Point(-1,-1),1,cv::BORDER_CONSTANT,cv::Scalar_<uchar>::all(0));
     }
-    const size_t nStereoUnaryFuncDataSize = anValidGraphNodes[m_nPrimaryCamIdx]*m_nStereoLabels;
+    const size_t nStereoUnaryFuncDataSize = anValidGraphNodes[m_nPrimaryCamIdx]*m_nStereoSparseLabels;
     const size_t nStereoPairwFuncDataSize = 0u;/*removed 2018/02, now using scaled view arrays*/ //anValidGraphNodes[m_nPrimaryCamIdx]*s_nPairwOrients*(m_nStereoLabels*m_nStereoLabels);
     const size_t nStereoEpipolarFuncDataSize = SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN?(anValidGraphNodes[m_nPrimaryCamIdx]*(int)std::pow((int)m_nStereoLabels,(int)s_nEpipolarCliqueOrder)):size_t(0); // epipolar stride not taken into account here
     const size_t nStereoFuncDataSize = nStereoUnaryFuncDataSize+nStereoPairwFuncDataSize+nStereoEpipolarFuncDataSize;
@@ -1029,11 +1379,7 @@ SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, cons
     const std::array<int,3> anAssocMapDims{int(m_oGridSize[0]),int((m_oGridSize[1]+m_nMaxDispOffset/*for oob usage*/)/m_nDispOffsetStep),int(m_nRealStereoLabels*m_nDispOffsetStep)};
     m_oAssocCounts.create(2,anAssocMapDims.data());
     m_oAssocMap.create(3,anAssocMapDims.data());
-#if SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF
     m_oStereoUnaryCosts.create(m_oGridSize);
-#elif SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
-    m_oStereoUnaryCosts.create(int(m_nStereoLabels),int(anValidGraphNodes[m_nPrimaryCamIdx])); // flip for optim?
-#endif //SEGMMATCH_CONFIG_USE_..._STEREO_INF
     m_oResegmUnaryCosts.create(int(m_oGridSize[0]*nTemporalLayerCount*nCameraCount),int(m_oGridSize[1]));
     m_vStereoGraphIdxToMapIdxLUT.reserve(anValidGraphNodes[m_nPrimaryCamIdx]);
     m_vResegmGraphIdxToMapIdxLUT.reserve(nTotValidNodes*nTemporalLayerCount);
@@ -1088,6 +1434,7 @@ SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, cons
                         oStereoNode.nUnaryFactID = SIZE_MAX;
                         oStereoNode.pUnaryFunc = nullptr;
                         std::fill_n(oStereoNode.afPairwWeights.begin(),s_nPairwOrients,0.0f);
+                        oStereoNode.bUpdatedCliques = true;
                         if(oStereoNode.bValidGraphNode) {
                             oStereoNode.nGraphNodeIdx = m_nValidStereoGraphNodes++;
                             m_vStereoGraphIdxToMapIdxLUT.push_back(nMapIdx);
@@ -1110,6 +1457,7 @@ SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, cons
                     oResegmNode.pUnaryFunc = nullptr;
                     oResegmNode.nStackedIdx = nStackedMapIdx;
                     std::fill_n(oResegmNode.afPairwWeights.begin(),s_nPairwOrients,0.0f);
+                    oResegmNode.bUpdatedCliques = true;
                     if(oResegmNode.bValidGraphNode) {
                         oResegmNode.nGraphNodeIdx = m_nValidResegmGraphNodes++;
                         m_vResegmGraphIdxToMapIdxLUT.push_back(nLUTIdx);
@@ -1126,6 +1474,7 @@ SegmMatcher::GraphModelData::GraphModelData(const CamArray<cv::Mat>& aROIs, cons
     m_pStereoPairwFuncsDataBase = m_pStereoUnaryFuncsDataBase+nStereoUnaryFuncDataSize;
     m_pStereoEpipolarFuncsDataBase = m_pStereoPairwFuncsDataBase+nStereoPairwFuncDataSize;
     m_pStereoFuncsDataEnd = m_pStereoEpipolarFuncsDataBase+nStereoEpipolarFuncDataSize;
+    m_aStereoUnaryFuncsLabels = std::make_unique<InternalLabelType[]>(nStereoUnaryFuncDataSize);
     m_aResegmFuncsData = std::make_unique<ValueType[]>(nTotResegmFuncDataSize);
     m_pResegmUnaryFuncsDataBase = m_aResegmFuncsData.get();
     m_pResegmPairwFuncsDataBase = m_pResegmUnaryFuncsDataBase+nTotResegmUnaryFuncDataSize;
@@ -1147,7 +1496,7 @@ void SegmMatcher::GraphModelData::buildStereoModel() {
     // reserves on graph created below need to be accurate (or larger than needed), otherwise function vectors will be reallocated, and pointers will be bad
     const size_t nStereoMaxMultiFactorsPerNode = /*pairw*/s_nPairwOrients + /*ho*/(SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN?size_t(1):size_t(0)); // epipolar stride not taken into account here
     m_pStereoModel = std::make_unique<StereoModelType>(StereoSpaceType(m_nValidStereoGraphNodes,(InternalLabelType)m_nStereoLabels),nStereoMaxMultiFactorsPerNode+1u);
-    m_pStereoModel->reserveFunctions<ExplicitFunction>(m_nValidStereoGraphNodes); // unary factors only
+    m_pStereoModel->reserveFunctions<SparseExplicitFunction>(m_nValidStereoGraphNodes); // unary factors only
     m_pStereoModel->reserveFunctions<ExplicitScaledFunction>(m_nValidStereoGraphNodes*nStereoMaxMultiFactorsPerNode);
     m_pStereoModel->reserveFunctions<ExplicitAllocFunction>(size_t(1)); // for pairw func base
     const std::vector<size_t> aPairwStereoFuncDims(s_nPairwOrients,m_nStereoLabels);
@@ -1176,18 +1525,21 @@ void SegmMatcher::GraphModelData::buildStereoModel() {
     oStereoBaseFunc(m_nOccludedLabelIdx,m_nOccludedLabelIdx) = cost_cast(0);
     lvLog(2,"\tadding unary factors to stereo graph...");
     m_nStereoUnaryFactCount = size_t(0);
-    const std::array<size_t,1> aUnaryStereoFuncDims = {m_nStereoLabels};
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
         const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
         StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
         lvDbgAssert(oNode.bValidGraphNode && oNode.nGraphNodeIdx==nGraphNodeIdx);
         oNode.vpCliques.clear();
         oNode.vCliqueMemberLUT.clear();
-        FuncPairType oStereoFunc = m_pStereoModel->addFunctionWithRefReturn(ExplicitFunction());
-        lvDbgAssert((&m_pStereoModel->getFunction<ExplicitFunction>(oStereoFunc.first))==(&oStereoFunc.second));
-        oStereoFunc.second.assign(aUnaryStereoFuncDims.begin(),aUnaryStereoFuncDims.end(),m_pStereoUnaryFuncsDataBase+(nGraphNodeIdx*m_nStereoLabels));
-        lvDbgAssert(&oStereoFunc.second(0)<m_pStereoPairwFuncsDataBase);
-        lvDbgAssert(oStereoFunc.second.strides(0)==1); // expect no padding
+        SparseFuncPairType oStereoFunc = m_pStereoModel->addFunctionWithRefReturn(SparseExplicitFunction());
+        lvDbgAssert((&m_pStereoModel->getFunction<SparseExplicitFunction>(oStereoFunc.first))==(&oStereoFunc.second));
+        // initial sparse label set holds the first real labels + both reserved labels (i.e. stays sorted), and is pruned in model updates
+        InternalLabelType* pSparseLabels = m_aStereoUnaryFuncsLabels.get()+(nGraphNodeIdx*m_nStereoSparseLabels);
+        std::iota(pSparseLabels,pSparseLabels+m_nStereoSparseLabels-2u,InternalLabelType(0));
+        pSparseLabels[m_nStereoSparseLabels-2u] = m_nDontCareLabelIdx;
+        pSparseLabels[m_nStereoSparseLabels-1u] = m_nOccludedLabelIdx;
+        oStereoFunc.second.assign(m_nStereoLabels,m_nStereoSparseLabels,pSparseLabels,m_pStereoUnaryFuncsDataBase+(nGraphNodeIdx*m_nStereoSparseLabels),cost_cast(SEGMMATCH_DEFAULT_STEREO_OOW_COST));
+        lvDbgAssert(oStereoFunc.second.values()+m_nStereoSparseLabels<=m_pStereoPairwFuncsDataBase);
         const std::array<size_t,1> aGraphNodeIndices = {nGraphNodeIdx};
         oNode.nUnaryFactID = m_pStereoModel->addFactorNonFinalized(oStereoFunc.first,aGraphNodeIndices.begin(),aGraphNodeIndices.end());
         lvDbgAssert(FuncIdentifType((*m_pStereoModel)[oNode.nUnaryFactID].functionIndex(),(*m_pStereoModel)[oNode.nUnaryFactID].functionType())==oStereoFunc.first);
@@ -1298,6 +1650,12 @@ void SegmMatcher::GraphModelData::updateStereoModel(bool bInit) {
     }
     lvLog(4,"Updating stereo graph model energy terms based on new features...");
     lv::StopWatch oLocalTimer;
+    // init unaries only depend on local features, unless descriptors are quantized w/ per-frame params, or candidate label windows are used
+    const bool bCacheStereoUnaries = bInit && m_nStereoUnaryReuseDiff>0u && !SEGMMATCH_CONFIG_USE_DISP_BG_HRST &&
+                                     m_oStereoLabelPriorMap.empty() && m_eDescMapStorage!=lv::DescMapStorage_UInt8;
+    cv::Mat_<uchar> oReusableStereoNodes;
+    if(bCacheStereoUnaries)
+        calcReusableStereoNodes(oReusableStereoNodes);
 #if SEGMMATCH_CONFIG_USE_PROGRESS_BARS
     lv::ProgressBarManager oProgressBarMgr("\tprogress:");
 #endif //SEGMMATCH_CONFIG_USE_PROGRESS_BARS
@@ -1315,47 +1673,103 @@ void SegmMatcher::GraphModelData::updateStereoModel(bool bInit) {
         const InternalLabelType nMedianShapeLabel = m_avMedianShapeLabels[m_nPrimaryCamIdx][nShapeIdx];
     #endif //SEGMMATCH_CONFIG_USE_MEDIAN_DIST_COST
         // update unary terms for each grid node
+        // note: on new frames, nodes whose inputs did not change (see 'calcReusableStereoNodes') keep the unaries cached at the last init update,
+        // as long as their saliencies are also unchanged (these are normalized over the whole frame)
         lvDbgAssert(nLUTNodeIdx==size_t(nRowIdx*nCols+nColIdx));
         lvDbgAssert(oNode.nUnaryFactID!=SIZE_MAX && oNode.nUnaryFactID<m_nStereoUnaryFactCount && oNode.pUnaryFunc);
         lvDbgAssert(m_pStereoModel->operator[](oNode.nUnaryFactID).numberOfVariables()==size_t(1));
-        ExplicitFunction& vUnaryStereoLUT = *oNode.pUnaryFunc;
-        lvDbgAssert(vUnaryStereoLUT.dimension()==1 && vUnaryStereoLUT.size()==m_nStereoLabels);
+        SparseExplicitFunction& vUnaryStereoLUT = *oNode.pUnaryFunc;
+        lvDbgAssert(vUnaryStereoLUT.dimension()==1 && vUnaryStereoLUT.size()==m_nStereoLabels && vUnaryStereoLUT.sparseSize()==m_nStereoSparseLabels);
         lvDbgAssert__(oImgSaliency(nRowIdx,nColIdx)>=-1e-6f && oImgSaliency(nRowIdx,nColIdx)<=1.0f+1e-6f,"fImgSaliency = %1.10f @ [%d,%d]",oImgSaliency(nRowIdx,nColIdx),nRowIdx,nColIdx);
         lvDbgAssert__(oShpSaliency(nRowIdx,nColIdx)>=-1e-6f && oShpSaliency(nRowIdx,nColIdx)<=1.0f+1e-6f,"fShpSaliency = %1.10f @ [%d,%d]",oShpSaliency(nRowIdx,nColIdx),nRowIdx,nColIdx);
         const float fImgSaliency = std::max(oImgSaliency(nRowIdx,nColIdx),0.0f);
         const float fShpSaliency = std::max(oShpSaliency(nRowIdx,nColIdx),0.0f);
-        ValueType tTotUnaryCost = cost_cast(0);
-        int nValidUnaryCosts = 0;
-        for(InternalLabelType nLabelIdx=0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx) {
-            vUnaryStereoLUT(nLabelIdx) = cost_cast(0);
-        #if SEGMMATCH_CONFIG_USE_MEDIAN_DIST_COST
-            if(nShapeIdx!=0 && nMedianShapeLabel<m_nRealStereoLabels)
-                vUnaryStereoLUT(nLabelIdx) += cost_cast(std::abs((int)nMedianShapeLabel-(int)nLabelIdx)*SEGMMATCH_LBLSIM_MEDIAN_DIST_SCALE_CST);
-        #endif //SEGMMATCH_CONFIG_USE_MEDIAN_DIST_COST
-            const int nOffsetColIdx = getOffsetColIdx(m_nPrimaryCamIdx,nColIdx,nLabelIdx);
-            if(nOffsetColIdx>=0 && nOffsetColIdx<nCols && m_aROIs[m_nPrimaryCamIdx^1](nRowIdx,nOffsetColIdx)) {
-                const float fImgAffinity = oImgAffinity(nRowIdx,nColIdx,nLabelIdx);
-                const float fShpAffinity = oShpAffinity(nRowIdx,nColIdx,nLabelIdx);
-                lvDbgAssert__(fImgAffinity>=0.0f,"fImgAffinity = %1.10f @ [%d,%d]",fImgAffinity,nRowIdx,nColIdx);
-                lvDbgAssert__(fShpAffinity>=0.0f,"fShpAffinity = %1.10f @ [%d,%d]",fShpAffinity,nRowIdx,nColIdx);
-                vUnaryStereoLUT(nLabelIdx) += cost_cast(fImgAffinity*fImgSaliency*SEGMMATCH_IMGSIM_COST_DESC_SCALE);
-                vUnaryStereoLUT(nLabelIdx) += cost_cast(fShpAffinity*fShpSaliency*SEGMMATCH_SHPSIM_COST_DESC_SCALE);
-            #if SEGMMATCH_CONFIG_USE_DISP_BG_HRST
-                if(((InternalLabelType*)(m_aaResegmLabelings[oNode.nLayerIdx][m_nPrimaryCamIdx]).data)[oNode.nMapIdx]==s_nBackgroundLabelIdx)
-                vUnaryStereoLUT(nLabelIdx) += cost_cast((float(nLabelIdx)/m_nRealStereoLabels)*100);
-            #endif //SEGMMATCH_CONFIG_USE_DISP_BG_HRST
-                tTotUnaryCost += vUnaryStereoLUT(nLabelIdx);
-                ++nValidUnaryCosts;
+        const size_t nSparseRealLabels = m_nStereoSparseLabels-2u;
+        InternalLabelType* pSparseLabels = vUnaryStereoLUT.labels();
+        ValueType* pSparseValues = vUnaryStereoLUT.values();
+        const bool bReuseCachedUnary = !oReusableStereoNodes.empty() && oReusableStereoNodes(nRowIdx,nColIdx) &&
+                                       m_vCachedStereoUnarySaliencies[nGraphNodeIdx][0]==fImgSaliency && m_vCachedStereoUnarySaliencies[nGraphNodeIdx][1]==fShpSaliency;
+        if(bReuseCachedUnary) {
+            std::copy_n(m_vCachedStereoUnaryLabels.begin()+nGraphNodeIdx*m_nStereoSparseLabels,m_nStereoSparseLabels,pSparseLabels);
+            std::copy_n(m_vCachedStereoUnaryValues.begin()+nGraphNodeIdx*m_nStereoSparseLabels,m_nStereoSparseLabels,pSparseValues);
+            vUnaryStereoLUT.setDefaultValue(m_vCachedStereoUnaryDefaults[nGraphNodeIdx]);
+        }
+        else {
+            static thread_local lv::AutoBuffer<ValueType> s_aUnaryStereoCosts;
+            s_aUnaryStereoCosts.resize(m_nStereoLabels);
+            ValueType tTotUnaryCost = cost_cast(0);
+            int nValidUnaryCosts = 0;
+            for(InternalLabelType nLabelIdx=0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx) {
+                if(!isStereoLabelInWindow(nLUTNodeIdx,nLabelIdx)) {
+                    s_aUnaryStereoCosts[nLabelIdx] = cost_cast(SEGMMATCH_DEFAULT_STEREO_OOW_COST);
+                    continue;
+                }
+                s_aUnaryStereoCosts[nLabelIdx] = cost_cast(0);
+            #if SEGMMATCH_CONFIG_USE_MEDIAN_DIST_COST
+                if(nShapeIdx!=0 && nMedianShapeLabel<m_nRealStereoLabels)
+                    s_aUnaryStereoCosts[nLabelIdx] += cost_cast(std::abs((int)nMedianShapeLabel-(int)nLabelIdx)*SEGMMATCH_LBLSIM_MEDIAN_DIST_SCALE_CST);
+            #endif //SEGMMATCH_CONFIG_USE_MEDIAN_DIST_COST
+                const int nOffsetColIdx = getOffsetColIdx(m_nPrimaryCamIdx,nColIdx,nLabelIdx);
+                if(nOffsetColIdx>=0 && nOffsetColIdx<nCols && m_aROIs[m_nPrimaryCamIdx^1](nRowIdx,nOffsetColIdx)) {
+                    const float fImgAffinity = oImgAffinity(nRowIdx,nColIdx,nLabelIdx);
+                    const float fShpAffinity = oShpAffinity(nRowIdx,nColIdx,nLabelIdx);
+                    lvDbgAssert__(fImgAffinity>=0.0f,"fImgAffinity = %1.10f @ [%d,%d]",fImgAffinity,nRowIdx,nColIdx);
+                    lvDbgAssert__(fShpAffinity>=0.0f,"fShpAffinity = %1.10f @ [%d,%d]",fShpAffinity,nRowIdx,nColIdx);
+                    s_aUnaryStereoCosts[nLabelIdx] += cost_cast(fImgAffinity*fImgSaliency*SEGMMATCH_IMGSIM_COST_DESC_SCALE);
+                    s_aUnaryStereoCosts[nLabelIdx] += cost_cast(fShpAffinity*fShpSaliency*SEGMMATCH_SHPSIM_COST_DESC_SCALE);
+                #if SEGMMATCH_CONFIG_USE_DISP_BG_HRST
+                    if(((InternalLabelType*)(m_aaResegmLabelings[oNode.nLayerIdx][m_nPrimaryCamIdx]).data)[oNode.nMapIdx]==s_nBackgroundLabelIdx)
+                    s_aUnaryStereoCosts[nLabelIdx] += cost_cast((float(nLabelIdx)/m_nRealStereoLabels)*100);
+                #endif //SEGMMATCH_CONFIG_USE_DISP_BG_HRST
+                    tTotUnaryCost += s_aUnaryStereoCosts[nLabelIdx];
+                    ++nValidUnaryCosts;
+                }
+                else
+                    s_aUnaryStereoCosts[nLabelIdx] = cost_cast(tTotUnaryCost/(nValidUnaryCosts+1));
+            }
+            s_aUnaryStereoCosts[m_nDontCareLabelIdx] = cost_cast(10000);
+        #if SEGMMATCH_CONFIG_USE_OCCLUDED_LABELS
+            s_aUnaryStereoCosts[m_nOccludedLabelIdx] = cost_cast((m_aOcclusionMaps[m_nPrimaryCamIdx].data[oNode.nMapIdx]>0u)?0:10000);
+        #else //!SEGMMATCH_CONFIG_USE_OCCLUDED_LABELS
+            s_aUnaryStereoCosts[m_nOccludedLabelIdx] = cost_cast(10000);
+        #endif //!SEGMMATCH_CONFIG_USE_OCCLUDED_LABELS
+            // label pruning: only the cheapest real labels keep explicit costs (plus the current one, once the labeling is initialized)
+            if(nSparseRealLabels<m_nRealStereoLabels) {
+                static thread_local lv::AutoBuffer<InternalLabelType> s_aSortedStereoLabels;
+                s_aSortedStereoLabels.resize(m_nRealStereoLabels);
+                std::iota(s_aSortedStereoLabels.begin(),s_aSortedStereoLabels.end(),InternalLabelType(0));
+                const auto lLabelCostComp = [&](InternalLabelType nLabel1, InternalLabelType nLabel2) {
+                    return s_aUnaryStereoCosts[nLabel1]<s_aUnaryStereoCosts[nLabel2] || (s_aUnaryStereoCosts[nLabel1]==s_aUnaryStereoCosts[nLabel2] && nLabel1<nLabel2);
+                };
+                const auto pKeptLabelsEnd = s_aSortedStereoLabels.begin()+nSparseRealLabels;
+                std::nth_element(s_aSortedStereoLabels.begin(),pKeptLabelsEnd,s_aSortedStereoLabels.end(),lLabelCostComp);
+                if(!bInit) {
+                    const InternalLabelType nCurrLabel = ((InternalLabelType*)m_aaStereoLabelings[0][m_nPrimaryCamIdx].data)[nLUTNodeIdx];
+                    if(nCurrLabel<m_nRealStereoLabels && std::find(s_aSortedStereoLabels.begin(),pKeptLabelsEnd,nCurrLabel)==pKeptLabelsEnd)
+                        *std::max_element(s_aSortedStereoLabels.begin(),pKeptLabelsEnd,lLabelCostComp) = nCurrLabel;
+                }
+                std::sort(s_aSortedStereoLabels.begin(),pKeptLabelsEnd);
+                ValueType tMaxUnaryCost = cost_cast(SEGMMATCH_DEFAULT_STEREO_OOW_COST);
+                for(size_t nSparseIdx=0; nSparseIdx<nSparseRealLabels; ++nSparseIdx) {
+                    pSparseLabels[nSparseIdx] = s_aSortedStereoLabels[nSparseIdx];
+                    pSparseValues[nSparseIdx] = s_aUnaryStereoCosts[pSparseLabels[nSparseIdx]];
+                }
+                for(InternalLabelType nLabelIdx=0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx)
+                    tMaxUnaryCost = std::max(tMaxUnaryCost,s_aUnaryStereoCosts[nLabelIdx]);
+                vUnaryStereoLUT.setDefaultValue(tMaxUnaryCost); // pruned labels must never look cheaper than kept ones
             }
             else
-                vUnaryStereoLUT(nLabelIdx) = cost_cast(tTotUnaryCost/(nValidUnaryCosts+1));
-        }
-        vUnaryStereoLUT(m_nDontCareLabelIdx) = cost_cast(10000);
-    #if SEGMMATCH_CONFIG_USE_OCCLUDED_LABELS
-        vUnaryStereoLUT(m_nOccludedLabelIdx) = cost_cast((m_aOcclusionMaps[m_nPrimaryCamIdx].data[oNode.nMapIdx]>0u)?0:10000);
-    #else //!SEGMMATCH_CONFIG_USE_OCCLUDED_LABELS
-        vUnaryStereoLUT(m_nOccludedLabelIdx) = cost_cast(10000);
-    #endif //!SEGMMATCH_CONFIG_USE_OCCLUDED_LABELS
+                std::copy_n(s_aUnaryStereoCosts.begin(),nSparseRealLabels,pSparseValues);
+            lvDbgAssert(pSparseLabels[nSparseRealLabels]==m_nDontCareLabelIdx && pSparseLabels[nSparseRealLabels+1u]==m_nOccludedLabelIdx);
+            pSparseValues[nSparseRealLabels] = s_aUnaryStereoCosts[m_nDontCareLabelIdx];
+            pSparseValues[nSparseRealLabels+1u] = s_aUnaryStereoCosts[m_nOccludedLabelIdx];
+            if(bCacheStereoUnaries) {
+                std::copy_n(pSparseLabels,m_nStereoSparseLabels,m_vCachedStereoUnaryLabels.begin()+nGraphNodeIdx*m_nStereoSparseLabels);
+                std::copy_n(pSparseValues,m_nStereoSparseLabels,m_vCachedStereoUnaryValues.begin()+nGraphNodeIdx*m_nStereoSparseLabels);
+                m_vCachedStereoUnaryDefaults[nGraphNodeIdx] = vUnaryStereoLUT.defaultValue();
+                m_vCachedStereoUnarySaliencies[nGraphNodeIdx] = {fImgSaliency,fShpSaliency};
+            }
+        }
         if(bInit) { // inter-spectral pairwise/epipolar term updates do not change w.r.t. segm or stereo updates
             for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx) {
                 PairwClique& oPairwClique = oNode.aPairwCliques[nOrientIdx];
@@ -1372,6 +1786,8 @@ void SegmMatcher::GraphModelData::updateStereoModel(bool bInit) {
                     const float fGradScaleFact = m_aLabelSimCostGradFactLUT.eval_raw(nLocalGrad);
                     const float fPairwWeight = (float)(fGradScaleFact*SEGMMATCH_LBLSIM_STEREO_SCALE_CST); // should be constant & uncapped for use in fastpd/bcd
                     // all stereo pairw functions are identical, but weighted differently (see base init in constructor)
+                    if(oNode.afPairwWeights[nOrientIdx]!=fPairwWeight)
+                        oNode.bUpdatedCliques = true; // duals kept from the previous frame for this clique are now stale
                     oNode.afPairwWeights[nOrientIdx] = fPairwWeight;
                     vPairwiseStereoFunc.setScale(fPairwWeight);
                     // explicit debug check below VERY SLOW with large label space...
@@ -1401,9 +1817,78 @@ void SegmMatcher::GraphModelData::updateStereoModel(bool bInit) {
             oProgressBarMgr.update(float(nGraphNodeIdx)/m_anValidGraphNodes[m_nPrimaryCamIdx]);
     #endif //SEGMMATCH_CONFIG_USE_PROGRESS_BARS
     }
+    // real labels that are out-of-window (or pruned) for all nodes can never be picked; their moves are skipped during inference
+    m_vActiveStereoLabels.assign(m_nStereoLabels,uchar(1));
+    std::copy(m_vWindowedStereoLabels.begin(),m_vWindowedStereoLabels.end(),m_vActiveStereoLabels.begin());
+    if(m_nStereoSparseLabels<m_nStereoLabels) {
+        std::fill_n(m_vActiveStereoLabels.begin(),m_nRealStereoLabels,uchar(0));
+        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+            // only the explicitly kept labels that also lie in the node's own window can be picked
+            const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
+            const SparseExplicitFunction& vUnaryStereoLUT = *m_vStereoNodeMap[nLUTNodeIdx].pUnaryFunc;
+            for(size_t nSparseIdx=0; nSparseIdx<m_nStereoSparseLabels-2u; ++nSparseIdx)
+                if(isStereoLabelInWindow(nLUTNodeIdx,vUnaryStereoLUT.labels()[nSparseIdx]))
+                    m_vActiveStereoLabels[vUnaryStereoLUT.labels()[nSparseIdx]] = uchar(1);
+        }
+    }
+    if(!m_oStereoLabelPriorMap.empty() || m_nStereoSparseLabels<m_nStereoLabels)
+        lvLog_(4,"Stereo label pruning leaves %d active labels out of %d",(int)std::count(m_vActiveStereoLabels.begin(),m_vActiveStereoLabels.begin()+m_nRealStereoLabels,uchar(1)),(int)m_nRealStereoLabels);
     lvLog_(4,"Stereo graph model energy terms update completed in %f second(s).",oLocalTimer.tock());
 }
 
+void SegmMatcher::GraphModelData::calcReusableStereoNodes(cv::Mat_<uchar>& oReusableNodes) {
+    static_assert(getCameraCount()==2,"bad static array size, hardcoded stuff below will break");
+    lvDbgExceptionWatch;
+    lvDbgAssert(m_nStereoUnaryReuseDiff>0u);
+    const bool bValidCache = m_vCachedStereoUnarySaliencies.size()==m_nValidStereoGraphNodes && !m_aCachedStereoUnaryImages[0].empty() && !m_aCachedStereoUnaryImages[1].empty();
+    if(!bValidCache) {
+        m_vCachedStereoUnaryLabels.resize(m_nValidStereoGraphNodes*m_nStereoSparseLabels);
+        m_vCachedStereoUnaryValues.resize(m_nValidStereoGraphNodes*m_nStereoSparseLabels);
+        m_vCachedStereoUnaryDefaults.resize(m_nValidStereoGraphNodes);
+        m_vCachedStereoUnarySaliencies.resize(m_nValidStereoGraphNodes);
+    }
+    // image terms rely on descriptors & affinity patches around each node, and shape terms on shape context windows
+    const int nImgSupportRad = (int)m_nGridBorderSize+SEGMMATCH_DEFAULT_DESC_PATCH_SIZE/2;
+    const int nShpSupportRad = (int)std::max(m_nGridBorderSize,SEGMMATCH_DEFAULT_SCDESC_WIN_RAD)+SEGMMATCH_DEFAULT_DESC_PATCH_SIZE/2;
+    cv::Mat_<uchar> oChangedNodes((int)m_oGridSize(0),(int)m_oGridSize(1),uchar(0));
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        const cv::Mat& oInputImg = m_aaInputs[0][nCamIdx*InputPackOffset+InputPackOffset_Img];
+        const cv::Mat& oInputMask = m_aaInputs[0][nCamIdx*InputPackOffset+InputPackOffset_Mask];
+        cv::Mat oGrayInput;
+        if(oInputImg.channels()==3)
+            cv::cvtColor(oInputImg,oGrayInput,cv::COLOR_BGR2GRAY);
+        else
+            oGrayInput = oInputImg;
+        if(!bValidCache) {
+            oGrayInput.copyTo(m_aCachedStereoUnaryImages[nCamIdx]);
+            oInputMask.copyTo(m_aCachedStereoUnaryMasks[nCamIdx]);
+            continue;
+        }
+        cv::Mat oImgDiff;
+        cv::absdiff(oGrayInput,m_aCachedStereoUnaryImages[nCamIdx],oImgDiff);
+        cv::Mat oChangedImg = oImgDiff>(double)m_nStereoUnaryReuseDiff;
+        cv::Mat oChangedMask = oInputMask!=m_aCachedStereoUnaryMasks[nCamIdx];
+        // unchanged pixels keep their reference value, so small diffs cannot accumulate over frames
+        oGrayInput.copyTo(m_aCachedStereoUnaryImages[nCamIdx],oChangedImg);
+        oInputMask.copyTo(m_aCachedStereoUnaryMasks[nCamIdx],oChangedMask);
+        cv::dilate(oChangedImg,oChangedImg,cv::getStructuringElement(cv::MORPH_RECT,cv::Size(nImgSupportRad*2+1,nImgSupportRad*2+1)));
+        cv::dilate(oChangedMask,oChangedMask,cv::getStructuringElement(cv::MORPH_RECT,cv::Size(nShpSupportRad*2+1,nShpSupportRad*2+1)));
+        cv::bitwise_or(oChangedNodes,oChangedImg,oChangedNodes);
+        cv::bitwise_or(oChangedNodes,oChangedMask,oChangedNodes);
+    }
+    if(!bValidCache) {
+        oReusableNodes.release();
+        return;
+    }
+    // nodes also read the other camera's features along their row over the whole disparity range
+    int nMaxAbsOffset = 0;
+    for(InternalLabelType nLabelIdx=0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx)
+        nMaxAbsOffset = std::max(nMaxAbsOffset,std::abs(getOffsetValue(m_nPrimaryCamIdx,nLabelIdx)));
+    cv::dilate(oChangedNodes,oChangedNodes,cv::Mat_<uchar>(1,nMaxAbsOffset*2+1,uchar(1)));
+    oReusableNodes = oChangedNodes==0;
+    lvLog_(4,"Stereo init unaries can be reused for %d node(s) out of %d",cv::countNonZero(oReusableNodes&m_aROIs[m_nPrimaryCamIdx]),cv::countNonZero(m_aROIs[m_nPrimaryCamIdx]));
+}
+
 void SegmMatcher::GraphModelData::resetStereoLabelings() {
     lvDbgExceptionWatch;
     lvDbgAssert_(m_pStereoModel,"model must be initialized first!");
@@ -1419,6 +1904,12 @@ void SegmMatcher::GraphModelData::resetStereoLabelings() {
         //cv::imshow("flow",lv::getFlowColorMap(m_avFeatures[0][FeatPackOffset*m_nPrimaryCamIdx+FeatPackOffset_OptFlow]));
         lv::remap_offset(m_aaStereoLabelings[1][m_nPrimaryCamIdx],oPrimaryLabeling,m_avFeatures[0][FeatPackOffset*m_nPrimaryCamIdx+FeatPackOffset_OptFlow],cv::INTER_NEAREST);
         oPrimaryLabeling.setTo(m_nDontCareLabelIdx,m_aROIs[m_nPrimaryCamIdx]==0u);
+        if(m_nStereoReinitDiff>0u) {
+            // nodes with large motion-compensated temporal diffs are badly warped; they restart from the wta init below, others keep their last label
+            const cv::Mat_<uchar> oTempDiff = m_avFeatures[0][FeatPackOffset*m_nPrimaryCamIdx+FeatPackOffset_TempDiff];
+            lvDbgAssert(m_oGridSize==oTempDiff.size);
+            oPrimaryLabeling.setTo(m_nDontCareLabelIdx,oTempDiff>(double)m_nStereoReinitDiff);
+        }
         lvDbgAssert(((InternalLabelType*)oPrimaryLabeling.data)+oPrimaryLabeling.total()==((InternalLabelType*)m_aaStereoLabelings[1][m_nPrimaryCamIdx].data));
         lvDbgAssert(cv::countNonZero(oPrimaryLabeling>=m_nStereoLabels)==0);
         //oCurrLabelingDisplay = getStereoDispMapDisplay(0,m_nPrimaryCamIdx);
@@ -1426,7 +1917,7 @@ void SegmMatcher::GraphModelData::resetStereoLabelings() {
         //    cv::resize(oCurrLabelingDisplay,oCurrLabelingDisplay,cv::Size(),2,2,cv::INTER_NEAREST);
         //cv::imshow(std::string("postwarp-")+std::to_string(m_nPrimaryCamIdx),oCurrLabelingDisplay);
         //cv::waitKey(1);
-        lvLog(4,"stereo-warp-init");
+        lvLog_(4,"stereo-warp-init (%d nodes reset)",cv::countNonZero(oPrimaryLabeling==m_nDontCareLabelIdx));
     }
 #endif //SEGMMATCH_CONFIG_USE_LAST_STEREO_INIT
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
@@ -1437,7 +1928,7 @@ void SegmMatcher::GraphModelData::resetStereoLabelings() {
         lvDbgAssert(m_pStereoModel->numberOfLabels(oNode.nUnaryFactID)==m_nStereoLabels);
         if(oPrimaryLabeling(oNode.nRowIdx,oNode.nColIdx)==m_nDontCareLabelIdx) {
             InternalLabelType nEvalLabel = oPrimaryLabeling(oNode.nRowIdx,oNode.nColIdx) = 0;
-            const ExplicitFunction& vUnaryStereoLUT = *oNode.pUnaryFunc;
+            const SparseExplicitFunction& vUnaryStereoLUT = *oNode.pUnaryFunc;
             ValueType fOptimalEnergy = vUnaryStereoLUT(nEvalLabel);
             for(nEvalLabel=1; nEvalLabel<m_nStereoLabels; ++nEvalLabel) {
                 const ValueType fCurrEnergy = vUnaryStereoLUT(nEvalLabel);
@@ -1835,8 +2326,19 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
         const cv::Mat_<InternalLabelType>& oInputLabeling = m_aStackedResegmLabelings[nCamIdx];
         const cv::Mat_<uchar>& oROI = aGMMROIs[nCamIdx];
         cv::Mat_<int>& oAssignMap = m_aGMMCompAssignMap[nCamIdx];
-        if(bInit)
-            initGaussianMixtureParams(oInputImage,oInputLabeling,oROI,nCamIdx);
+        if(bInit) {
+            // kmeans can only draw from the thread's global rng, so it is seeded for the init and given back to the caller as it was
+            const cv::RNG oCallerRNG = cv::theRNG();
+            cv::theRNG() = cv::RNG(uint64(m_nResegmGMMRandomSeed+nCamIdx));
+            try {
+                initGaussianMixtureParams(oInputImage,oInputLabeling,oROI,nCamIdx);
+            }
+            catch(...) {
+                cv::theRNG() = oCallerRNG;
+                throw;
+            }
+            cv::theRNG() = oCallerRNG;
+        }
         assignGaussianMixtureComponents(oInputImage,oInputLabeling,oAssignMap,oROI,nCamIdx);
         learnGaussianMixtureParams(oInputImage,oInputLabeling,oAssignMap,oROI,nCamIdx);
         if(bDisplayDbgMaps) {
@@ -1968,6 +2470,7 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
         lvDbgAssert(oNode.nUnaryFactID!=SIZE_MAX && oNode.nUnaryFactID<m_nResegmUnaryFactCount && oNode.pUnaryFunc);
         lvDbgAssert(m_pResegmModel->operator[](oNode.nUnaryFactID).numberOfVariables()==size_t(1));
         ExplicitFunction& vUnaryResegmLUT = *oNode.pUnaryFunc;
+        // pairwise terms only depend on gradients & stereo labels, which are both fixed during a resegm pass; only rebuild them on init
         const InternalLabelType nStereoLabelIdx = ((InternalLabelType*)m_oSuperStackedStereoLabeling.data)[nLUTNodeIdx];
         const int nOffsetColIdx = (nStereoLabelIdx<m_nRealStereoLabels)?getOffsetColIdx(nCamIdx,nColIdx,nStereoLabelIdx):INT_MAX;
         if(nOffsetColIdx>=0 && nOffsetColIdx<nCols && m_aROIs[nCamIdx^1](nRowIdx,nOffsetColIdx)) {
@@ -1979,7 +2482,7 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
             vUnaryResegmLUT(s_nBackgroundLabelIdx) += tOffsetBGDistUnaryCost;
             for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx) {
                 PairwClique& oPairwClique = oNode.aPairwCliques[nOrientIdx];
-                if(oPairwClique) {
+                if(bInit && oPairwClique) {
                     lvDbgAssert(oPairwClique.m_nGraphFactorId>=m_nResegmUnaryFactCount && oPairwClique.m_nGraphFactorId<m_nResegmUnaryFactCount+m_nResegmPairwFactCount);
                     lvDbgAssert(m_pResegmModel->operator[](oPairwClique.m_nGraphFactorId).numberOfVariables()==size_t(2));
                     lvDbgAssert(oPairwClique.m_anGraphNodeIdxs[0]!=SIZE_MAX && oPairwClique.m_anLUTNodeIdxs[0]!=SIZE_MAX);
@@ -1998,16 +2501,14 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
                             vPairwResegmLUT(nLabelIdx1,nLabelIdx2) = cost_cast((nLabelIdx1^nLabelIdx2)*fScaleFact*SEGMMATCH_LBLSIM_RESEGM_SCALE_CST);
                         }
                     }
-                    if(bInit) {
-                        oNode.vpCliques.push_back(&oPairwClique);
-                    #if USING_OPENMP
-                        #pragma omp critical
-                    #endif //USING_OPENMP
-                        {
-                            const size_t nCurrCliqueIdx = nCliqueIdx++;
-                            for(size_t nPairIdx=0; nPairIdx<2u; ++nPairIdx)
-                                m_vResegmNodeMap[oPairwClique.m_anLUTNodeIdxs[nPairIdx]].vCliqueMemberLUT.push_back(std::make_pair(nCurrCliqueIdx,nPairIdx));
-                        }
+                    oNode.vpCliques.push_back(&oPairwClique);
+                #if USING_OPENMP
+                    #pragma omp critical
+                #endif //USING_OPENMP
+                    {
+                        const size_t nCurrCliqueIdx = nCliqueIdx++;
+                        for(size_t nPairIdx=0; nPairIdx<2u; ++nPairIdx)
+                            m_vResegmNodeMap[oPairwClique.m_anLUTNodeIdxs[nPairIdx]].vCliqueMemberLUT.push_back(std::make_pair(nCurrCliqueIdx,nPairIdx));
                     }
                 }
             }
@@ -2017,7 +2518,7 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
             vUnaryResegmLUT(s_nBackgroundLabelIdx) = cost_cast(0);
             for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx) {
                 PairwClique& oPairwClique = oNode.aPairwCliques[nOrientIdx];
-                if(oPairwClique) {
+                if(bInit && oPairwClique) {
                     lvDbgAssert(oPairwClique.m_nGraphFactorId>=m_nResegmUnaryFactCount && oPairwClique.m_nGraphFactorId<m_nResegmUnaryFactCount+m_nResegmPairwFactCount);
                     lvDbgAssert(m_pResegmModel->operator[](oPairwClique.m_nGraphFactorId).numberOfVariables()==size_t(2));
                     lvDbgAssert(oPairwClique.m_anGraphNodeIdxs[0]!=SIZE_MAX && oPairwClique.m_anLUTNodeIdxs[0]!=SIZE_MAX);
@@ -2032,16 +2533,14 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
                             vPairwResegmLUT(nLabelIdx1,nLabelIdx2) = cost_cast((nLabelIdx1^nLabelIdx2)*fLocalScaleFact*SEGMMATCH_LBLSIM_RESEGM_SCALE_CST);
                         }
                     }
-                    if(bInit) {
-                        oNode.vpCliques.push_back(&oPairwClique);
-                    #if USING_OPENMP
-                        #pragma omp critical
-                    #endif //USING_OPENMP
-                        {
-                            const size_t nCurrCliqueIdx = nCliqueIdx++;
-                            for(size_t nPairIdx=0; nPairIdx<2u; ++nPairIdx)
-                                m_vResegmNodeMap[oPairwClique.m_anLUTNodeIdxs[nPairIdx]].vCliqueMemberLUT.push_back(std::make_pair(nCurrCliqueIdx,nPairIdx));
-                        }
+                    oNode.vpCliques.push_back(&oPairwClique);
+                #if USING_OPENMP
+                    #pragma omp critical
+                #endif //USING_OPENMP
+                    {
+                        const size_t nCurrCliqueIdx = nCliqueIdx++;
+                        for(size_t nPairIdx=0; nPairIdx<2u; ++nPairIdx)
+                            m_vResegmNodeMap[oPairwClique.m_anLUTNodeIdxs[nPairIdx]].vCliqueMemberLUT.push_back(std::make_pair(nCurrCliqueIdx,nPairIdx));
                     }
                 }
             }
@@ -2208,7 +2707,41 @@ void SegmMatcher::GraphModelData::updateResegmModel(bool bInit) {
     lvLog_(4,"Resegm graph model energy terms update completed in %f second(s).",oLocalTimer.tock());
 }
 
-void SegmMatcher::GraphModelData::calcFeatures(const MatArrayIn& aInputs, cv::Mat* pFeaturesPacket) {
+template<typename TAffinityFunc>
+void SegmMatcher::GraphModelData::calcStereoAffinity(cv::Mat_<float>& oAffinity, bool bUseLabelPrior, TAffinityFunc&& lAffinityFunc) const {
+    lvDbgExceptionWatch;
+    std::vector<int> vDisparityOffsets;
+    std::vector<InternalLabelType> vAffinityLabels;
+    for(InternalLabelType nLabelIdx=0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx) {
+        if(!bUseLabelPrior || m_vWindowedStereoLabels[nLabelIdx]) {
+            vDisparityOffsets.push_back(getOffsetValue(0,nLabelIdx));
+            vAffinityLabels.push_back(nLabelIdx);
+        }
+    }
+    if(vAffinityLabels.size()==m_nRealStereoLabels) {
+        lAffinityFunc(oAffinity,vDisparityOffsets);
+        return;
+    }
+    // labels outside all candidate windows are never read by the unaries; only the window union is evaluated, and then scattered in the dense map
+    // (saliency maps are thus computed over the windowed affinity curve only; a window radius covering all labels gives the flat model back)
+    const std::array<int,3> anAffinityMapDims = {(int)m_oGridSize(0),(int)m_oGridSize(1),(int)m_nRealStereoLabels};
+    oAffinity.create(3,anAffinityMapDims.data());
+    oAffinity = -1.0f;
+    if(vAffinityLabels.empty())
+        return;
+    cv::Mat_<float> oWindowedAffinity;
+    lAffinityFunc(oWindowedAffinity,vDisparityOffsets);
+    lvDbgAssert(oWindowedAffinity.dims==3 && oWindowedAffinity.size[0]==anAffinityMapDims[0] && oWindowedAffinity.size[1]==anAffinityMapDims[1] && oWindowedAffinity.size[2]==(int)vAffinityLabels.size());
+    const size_t nNodeCount = m_oGridSize.total();
+    for(size_t nNodeIdx=0; nNodeIdx<nNodeCount; ++nNodeIdx) {
+        const float* pWindowedAffinity = ((float*)oWindowedAffinity.data)+nNodeIdx*vAffinityLabels.size();
+        float* pAffinity = ((float*)oAffinity.data)+nNodeIdx*m_nRealStereoLabels;
+        for(size_t nAffinityLabelIdx=0; nAffinityLabelIdx<vAffinityLabels.size(); ++nAffinityLabelIdx)
+            pAffinity[vAffinityLabels[nAffinityLabelIdx]] = pWindowedAffinity[nAffinityLabelIdx];
+    }
+}
+
+void SegmMatcher::GraphModelData::calcFeatures(const MatArrayIn& aInputs, cv::Mat* pFeaturesPacket, bool bUseLabelPrior) {
     static_assert(s_nInputArraySize==4 && getCameraCount()==2,"lots of hardcoded indices below");
     lvDbgExceptionWatch;
     for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
@@ -2220,23 +2753,44 @@ void SegmMatcher::GraphModelData::calcFeatures(const MatArrayIn& aInputs, cv::Ma
         lvAssert_(oInputMask.type()==CV_8UC1,"unexpected input mask type");
     }
     m_vTempFeatures.resize(FeatPackSize); // if this function was not called externally, features will be swapped from this temporary to the internal array
-    calcImageFeatures(CamArray<cv::Mat>{aInputs[InputPack_LeftImg],aInputs[InputPack_RightImg]},m_vTempFeatures);
-    calcShapeFeatures(CamArray<cv::Mat_<InternalLabelType>>{aInputs[InputPack_LeftMask],aInputs[InputPack_RightMask]},m_vTempFeatures);
+    calcImageFeatures(CamArray<cv::Mat>{aInputs[InputPack_LeftImg],aInputs[InputPack_RightImg]},m_vTempFeatures,bUseLabelPrior);
+    if(m_bStereoOnly) { // shape terms are left out of stereo-only models (no resegm will refine the input masks anyway)
+        const std::array<int,3> anAffinityMapDims = {(int)m_oGridSize(0),(int)m_oGridSize(1),(int)m_nRealStereoLabels};
+        m_vTempFeatures[FeatPack_ShpAffinity].create(3,anAffinityMapDims.data(),CV_32FC1);
+        m_vTempFeatures[FeatPack_ShpAffinity] = 0.0f;
+        m_vTempFeatures[FeatPack_ShpSaliency].create(2,anAffinityMapDims.data(),CV_32FC1);
+        m_vTempFeatures[FeatPack_ShpSaliency] = 0.0f;
+        for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+            calcShapeDistFeatures(aInputs[nCamIdx*InputPackOffset+InputPackOffset_Mask],nCamIdx,m_vTempFeatures);
+    }
+    else
+        calcShapeFeatures(CamArray<cv::Mat_<InternalLabelType>>{aInputs[InputPack_LeftMask],aInputs[InputPack_RightMask]},m_vTempFeatures,bUseLabelPrior);
     for(cv::Mat& oFeatMap : m_vTempFeatures)
         lvAssert_(oFeatMap.isContinuous(),"internal func used non-continuous data block for feature maps");
+    // affinity maps dominate the packet size, so they are stored in compact form; the internal copies are rounded the same
+    // way so that live and precalculated features always give identical results
+    std::vector<cv::Mat> vPackedFeatures = m_vTempFeatures;
+    if(m_eFeatsPackStorage!=lv::DescMapStorage_Float) {
+        for(size_t nFeatMapIdx : {size_t(FeatPack_ImgAffinity),size_t(FeatPack_ShpAffinity)}) {
+            cv::Mat_<float> oQuantParams,oAffinity = m_vTempFeatures[nFeatMapIdx];
+            lv::quantizeDescriptorMap(oAffinity,vPackedFeatures[nFeatMapIdx],oQuantParams,m_eFeatsPackStorage);
+            lv::dequantizeDescriptorMap(vPackedFeatures[nFeatMapIdx],oQuantParams,oAffinity);
+            lvDbgAssert(oAffinity.data==m_vTempFeatures[nFeatMapIdx].data);
+        }
+    }
     if(pFeaturesPacket)
-        *pFeaturesPacket = lv::packData(m_vTempFeatures,&m_vLatestFeatPackInfo);
+        *pFeaturesPacket = lv::packData(vPackedFeatures,&m_vLatestFeatPackInfo);
     else { // fill pack info manually
-        m_vLatestFeatPackInfo.resize(m_vTempFeatures.size());
-        for(size_t nFeatMapIdx=0; nFeatMapIdx<m_vTempFeatures.size(); ++nFeatMapIdx)
-            m_vLatestFeatPackInfo[nFeatMapIdx] = lv::MatInfo(m_vTempFeatures[nFeatMapIdx]);
+        m_vLatestFeatPackInfo.resize(vPackedFeatures.size());
+        for(size_t nFeatMapIdx=0; nFeatMapIdx<vPackedFeatures.size(); ++nFeatMapIdx)
+            m_vLatestFeatPackInfo[nFeatMapIdx] = lv::MatInfo(vPackedFeatures[nFeatMapIdx]);
     }
     if(m_vExpectedFeatPackInfo.empty())
         m_vExpectedFeatPackInfo = m_vLatestFeatPackInfo;
     lvAssert_(m_vLatestFeatPackInfo==m_vExpectedFeatPackInfo,"packed features info mismatch (should stay constant for all inputs)");
 }
 
-void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aInputImages, std::vector<cv::Mat>& vFeatures) {
+void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aInputImages, std::vector<cv::Mat>& vFeatures, bool bUseLabelPrior) {
     static_assert(getCameraCount()==2,"bad input image array size");
     lvDbgExceptionWatch;
     for(size_t nInputIdx=0; nInputIdx<aInputImages.size(); ++nInputIdx) {
@@ -2322,7 +2876,7 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
         cv::Mat& oTempDiff = vFeatures[nCamIdx*FeatPackOffset+FeatPackOffset_TempDiff];
         oOptFlow.create(m_oGridSize,CV_32FC2);
         oTempDiff.create(m_oGridSize,CV_8UC1);
-        if(getTemporalLayerCount()>1u && m_nFramesProcessed>0u) {
+        if(getTemporalLayerCount()>1u && m_nFramesProcessed>0u && !m_bStereoOnly) { // stereo-only models have no temporal resegm links to feed
             cv::Mat oPreviousInput;
             if(aInputImages[nCamIdx].data==m_aaInputs[0][nCamIdx*InputPackOffset+InputPackOffset_Img].data)
                 oPreviousInput = m_aaInputs[1][nCamIdx*InputPackOffset+InputPackOffset_Img];
@@ -2360,12 +2914,23 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
     const std::array<int,3> anAffinityMapDims = {nRows,nCols,(int)m_nRealStereoLabels};
     vFeatures[FeatPack_ImgAffinity].create(3,anAffinityMapDims.data(),CV_32FC1);
     cv::Mat_<float> oAffinity = vFeatures[FeatPack_ImgAffinity];
-    std::vector<int> vDisparityOffsets;
-    for(InternalLabelType nLabelIdx = 0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx)
-        vDisparityOffsets.push_back(getOffsetValue(0,nLabelIdx));
     // note: we only create the dense affinity map for 1st cam here; affinity for 2nd cam will be deduced from it
 #if SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
-    lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oAffinity,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1]);
+    if(m_eDescMapStorage!=lv::DescMapStorage_Float) {
+        // descriptors are matched in compact form to reduce memory traffic (float maps are kept for the saliency below)
+        CamArray<cv::Mat> aQuantDescs;
+        CamArray<cv::Mat_<float>> aQuantParams;
+        for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+            lv::quantizeDescriptorMap(aDescs[nCamIdx],aQuantDescs[nCamIdx],aQuantParams[nCamIdx],m_eDescMapStorage);
+        calcStereoAffinity(oAffinity,bUseLabelPrior,[&](cv::Mat_<float>& oOutput, const std::vector<int>& vDisparityOffsets) {
+            lv::computeDescriptorAffinity(aQuantDescs[0],aQuantParams[0],aQuantDescs[1],aQuantParams[1],nPatchSize,oOutput,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1]);
+        });
+    }
+    else {
+        calcStereoAffinity(oAffinity,bUseLabelPrior,[&](cv::Mat_<float>& oOutput, const std::vector<int>& vDisparityOffsets) {
+            lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oOutput,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1]);
+        });
+    }
     /*cv::Mat_<float> tmp;
     lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,tmp,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1],cv::Mat_<float>(),false);
     lvAssert(lv::MatInfo(tmp)==lv::MatInfo(oAffinity));
@@ -2374,9 +2939,13 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
             for(int k=0; k<anAffinityMapDims[2]; ++k)
                     lvAssert__(std::abs(tmp(i,j,k)-oAffinity(i,j,k))<0.0001f," %d,%d,%d =  %f vs %f,   w/ roi0 = %d",i,j,k,tmp(i,j,k),oAffinity(i,j,k),(int)m_aROIs[0](i,j));*/
 #elif SEGMMATCH_CONFIG_USE_MI_AFFINITY
-    lv::computeImageAffinity(aEnlargedInput[0],aEnlargedInput[1],nWinSize,oAffinity,vDisparityOffsets,lv::AffinityDist_MI,aEnlargedROIs[0],aEnlargedROIs[1]);
+    calcStereoAffinity(oAffinity,bUseLabelPrior,[&](cv::Mat_<float>& oOutput, const std::vector<int>& vDisparityOffsets) {
+        lv::computeImageAffinity(aEnlargedInput[0],aEnlargedInput[1],nWinSize,oOutput,vDisparityOffsets,lv::AffinityDist_MI,aEnlargedROIs[0],aEnlargedROIs[1]);
+    });
 #elif SEGMMATCH_CONFIG_USE_SSQDIFF_AFFINITY
-    lv::computeImageAffinity(aEnlargedInput[0],aEnlargedInput[1],nWinSize,oAffinity,vDisparityOffsets,lv::AffinityDist_SSD,aEnlargedROIs[0],aEnlargedROIs[1]);
+    calcStereoAffinity(oAffinity,bUseLabelPrior,[&](cv::Mat_<float>& oOutput, const std::vector<int>& vDisparityOffsets) {
+        lv::computeImageAffinity(aEnlargedInput[0],aEnlargedInput[1],nWinSize,oOutput,vDisparityOffsets,lv::AffinityDist_SSD,aEnlargedROIs[0],aEnlargedROIs[1]);
+    });
 #endif //SEGMMATCH_CONFIG_USE_..._AFFINITY
     lvDbgAssert(lv::MatInfo(oAffinity)==lv::MatInfo(lv::MatSize(3,anAffinityMapDims.data()),CV_32FC1));
     lvDbgAssert(vFeatures[FeatPack_ImgAffinity].data==oAffinity.data);
@@ -2395,6 +2964,7 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
         lvDbgAssert(oNode.bValidGraphNode && m_aROIs[m_nPrimaryCamIdx](nRowIdx,nColIdx)>0);
         vValidAffinityVals.resize(0);
         const float* pAffinityPtr = oAffinity.ptr<float>(nRowIdx,nColIdx);
+        // note: labels outside the candidate window union are flagged as invalid like oob disparities, so sparseness is only measured over the windowed curve
         std::copy_if(pAffinityPtr,pAffinityPtr+m_nRealStereoLabels,std::back_inserter(vValidAffinityVals),[](float v){return v>=0.0f;});
         const float fCurrDistSparseness = vValidAffinityVals.size()>1?(float)lv::sparseness(vValidAffinityVals.data(),vValidAffinityVals.size()):0.0f;
 #if SEGMMATCH_CONFIG_USE_DESC_BASED_AFFINITY
@@ -2426,7 +2996,7 @@ void SegmMatcher::GraphModelData::calcImageFeatures(const CamArray<cv::Mat>& aIn
     }*/
 }
 
-void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<InternalLabelType>>& aInputMasks, std::vector<cv::Mat>& vFeatures) {
+void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<InternalLabelType>>& aInputMasks, std::vector<cv::Mat>& vFeatures, bool bUseLabelPrior) {
     static_assert(getCameraCount()==2,"bad input mask array size");
     lvDbgExceptionWatch;
     for(size_t nInputIdx=0; nInputIdx<aInputMasks.size(); ++nInputIdx) {
@@ -2446,7 +3016,12 @@ void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<Inte
     for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
         const cv::Mat& oInputMask = aInputMasks[nCamIdx];
         lvLog_(3,"\tcam[%d] shape descriptors...",(int)nCamIdx);
-        m_pShpDescExtractor->compute2(oInputMask,aDescs[nCamIdx]);
+        m_pShpDescExtractor->compute2(oInputMask,m_aShpDescs[nCamIdx],m_aShpContourPts[nCamIdx]);
+    #if SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS
+        aDescs[nCamIdx] = m_aShpDescs[nCamIdx].clone(); // rootSIFT below works in-place, and the cached map must stay untouched
+    #else //!SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS
+        aDescs[nCamIdx] = m_aShpDescs[nCamIdx];
+    #endif //!SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS
         lvDbgAssert(aDescs[nCamIdx].dims==3 && aDescs[nCamIdx].size[0]==nRows && aDescs[nCamIdx].size[1]==nCols);
     #if SEGMMATCH_CONFIG_USE_ROOT_SIFT_DESCS
         const size_t nDescSize = size_t(aDescs[nCamIdx].size[2]);
@@ -2461,14 +3036,27 @@ void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<Inte
     const std::array<int,3> anAffinityMapDims = {nRows,nCols,(int)m_nRealStereoLabels};
     vFeatures[FeatPack_ShpAffinity].create(3,anAffinityMapDims.data(),CV_32FC1);
     cv::Mat_<float> oAffinity = vFeatures[FeatPack_ShpAffinity];
-    std::vector<int> vDisparityOffsets;
-    for(InternalLabelType nLabelIdx = 0; nLabelIdx<m_nRealStereoLabels; ++nLabelIdx)
-        vDisparityOffsets.push_back(getOffsetValue(0,nLabelIdx));
 #if SEGMMATCH_CONFIG_USE_SHAPE_EMD_AFFIN
-    lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oAffinity,vDisparityOffsets,lv::AffinityDist_EMD,m_aROIs[0],m_aROIs[1],m_pShpDescExtractor->getEMDCostMap());
+    const lv::AffinityDistType eShpAffinityDist = lv::AffinityDist_EMD;
+    const cv::Mat_<float> oEMDCostMap = m_pShpDescExtractor->getEMDCostMap();
 #else //!SEGMMATCH_CONFIG_USE_SHAPE_EMD_AFFIN
-    lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oAffinity,vDisparityOffsets,lv::AffinityDist_L2,m_aROIs[0],m_aROIs[1]);
+    const lv::AffinityDistType eShpAffinityDist = lv::AffinityDist_L2;
+    const cv::Mat_<float> oEMDCostMap;
 #endif //!SEGMMATCH_CONFIG_USE_SHAPE_EMD_AFFIN
+    if(m_eDescMapStorage!=lv::DescMapStorage_Float) {
+        CamArray<cv::Mat> aQuantDescs;
+        CamArray<cv::Mat_<float>> aQuantParams;
+        for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx)
+            lv::quantizeDescriptorMap(aDescs[nCamIdx],aQuantDescs[nCamIdx],aQuantParams[nCamIdx],m_eDescMapStorage);
+        calcStereoAffinity(oAffinity,bUseLabelPrior,[&](cv::Mat_<float>& oOutput, const std::vector<int>& vDisparityOffsets) {
+            lv::computeDescriptorAffinity(aQuantDescs[0],aQuantParams[0],aQuantDescs[1],aQuantParams[1],nPatchSize,oOutput,vDisparityOffsets,eShpAffinityDist,m_aROIs[0],m_aROIs[1],oEMDCostMap);
+        });
+    }
+    else {
+        calcStereoAffinity(oAffinity,bUseLabelPrior,[&](cv::Mat_<float>& oOutput, const std::vector<int>& vDisparityOffsets) {
+            lv::computeDescriptorAffinity(aDescs[0],aDescs[1],nPatchSize,oOutput,vDisparityOffsets,eShpAffinityDist,m_aROIs[0],m_aROIs[1],oEMDCostMap);
+        });
+    }
     lvDbgAssert(lv::MatInfo(oAffinity)==lv::MatInfo(lv::MatSize(3,anAffinityMapDims.data()),CV_32FC1));
     lvDbgAssert(vFeatures[FeatPack_ShpAffinity].data==oAffinity.data);
     lvLog_(3,"Shape affinity map computed in %f second(s).",oLocalTimer.tock());
@@ -2486,6 +3074,7 @@ void SegmMatcher::GraphModelData::calcShapeFeatures(const CamArray<cv::Mat_<Inte
         const int nColIdx = oNode.nColIdx;
         vValidAffinityVals.resize(0);
         const float* pAffinityPtr = oAffinity.ptr<float>(nRowIdx,nColIdx);
+        // note: labels outside the candidate window union are flagged as invalid like oob disparities, so sparseness is only measured over the windowed curve
         std::copy_if(pAffinityPtr,pAffinityPtr+m_nRealStereoLabels,std::back_inserter(vValidAffinityVals),[](float v){return v>=0.0f;});
         const float fCurrDistSparseness = vValidAffinityVals.size()>1?(float)lv::sparseness(vValidAffinityVals.data(),vValidAffinityVals.size()):0.0f;
         const float fCurrDescSparseness = (float)lv::sparseness(aDescs[m_nPrimaryCamIdx].ptr<float>(nRowIdx,nColIdx),size_t(aDescs[m_nPrimaryCamIdx].size[2]));
@@ -2594,13 +3183,38 @@ void SegmMatcher::GraphModelData::setNextFeatures(const cv::Mat& oPackedFeatures
         }
         m_vExpectedFeatPackInfo[FeatPack_ImgSaliency] = lv::MatInfo(m_oGridSize,CV_32FC1);
         m_vExpectedFeatPackInfo[FeatPack_ShpSaliency] = lv::MatInfo(m_oGridSize,CV_32FC1);
-        m_vExpectedFeatPackInfo[FeatPack_ImgAffinity] = lv::MatInfo(std::array<int,3>{(int)m_oGridSize(0),(int)m_oGridSize(1),(int)m_nRealStereoLabels},CV_32FC1);
-        m_vExpectedFeatPackInfo[FeatPack_ShpAffinity] = lv::MatInfo(std::array<int,3>{(int)m_oGridSize(0),(int)m_oGridSize(1),(int)m_nRealStereoLabels},CV_32FC1);
+        const int nPackedAffinityType = (m_eFeatsPackStorage==lv::DescMapStorage_Half)?CV_16UC1:CV_32FC1;
+        m_vExpectedFeatPackInfo[FeatPack_ImgAffinity] = lv::MatInfo(std::array<int,3>{(int)m_oGridSize(0),(int)m_oGridSize(1),(int)m_nRealStereoLabels},nPackedAffinityType);
+        m_vExpectedFeatPackInfo[FeatPack_ShpAffinity] = lv::MatInfo(std::array<int,3>{(int)m_oGridSize(0),(int)m_oGridSize(1),(int)m_nRealStereoLabels},nPackedAffinityType);
     }
-    const std::vector<cv::Mat> vLatestUnpackedFeatures = lv::unpackData(oPackedFeatures,m_vExpectedFeatPackInfo);
+    const auto lGetPackedSize = [](const std::vector<lv::MatInfo>& vPackInfo) {
+        size_t nPackedSize = 0u;
+        for(const lv::MatInfo& oPackInfo : vPackInfo)
+            nPackedSize += oPackInfo.size.total()*oPackInfo.type.elemSize();
+        return nPackedSize;
+    };
+    const size_t nPacketSize = oPackedFeatures.total()*oPackedFeatures.elemSize();
+    std::vector<lv::MatInfo> vPackInfo = m_vExpectedFeatPackInfo;
+    if(lGetPackedSize(vPackInfo)!=nPacketSize) {
+        // the affinity storage type is implied by the packet size; packets saved with the other supported type (e.g. caches
+        // written under another default) are still unpacked and converted, and anything else is rejected here
+        const int nAltAffinityType = (vPackInfo[FeatPack_ImgAffinity].type()==CV_32FC1)?CV_16UC1:CV_32FC1;
+        for(size_t nFeatsIdx : {size_t(FeatPack_ImgAffinity),size_t(FeatPack_ShpAffinity)})
+            vPackInfo[nFeatsIdx] = lv::MatInfo(vPackInfo[nFeatsIdx].size,nAltAffinityType);
+        lvAssert__(lGetPackedSize(vPackInfo)==nPacketSize,"features packet size mismatch (got %zu bytes, expected %zu); it was computed with another model configuration, and must be recomputed",nPacketSize,lGetPackedSize(m_vExpectedFeatPackInfo));
+        lvLog(2,"features packet affinity storage type differs from the current one, packet will be converted");
+    }
+    const std::vector<cv::Mat> vLatestUnpackedFeatures = lv::unpackData(oPackedFeatures,vPackInfo);
     m_vLoadedFeatures.resize(FeatPackSize);
-    for(size_t nFeatsIdx=0; nFeatsIdx<vLatestUnpackedFeatures.size(); ++nFeatsIdx)
-        vLatestUnpackedFeatures[nFeatsIdx].copyTo(m_vLoadedFeatures[nFeatsIdx]); // makes internal copy, user can discard packet before next 'apply' call
+    for(size_t nFeatsIdx=0; nFeatsIdx<vLatestUnpackedFeatures.size(); ++nFeatsIdx) {
+        if((nFeatsIdx==FeatPack_ImgAffinity || nFeatsIdx==FeatPack_ShpAffinity) && vLatestUnpackedFeatures[nFeatsIdx].depth()!=CV_32F) {
+            cv::Mat_<float> oAffinity;
+            lv::dequantizeDescriptorMap(vLatestUnpackedFeatures[nFeatsIdx],cv::Mat_<float>(),oAffinity);
+            m_vLoadedFeatures[nFeatsIdx] = oAffinity;
+        }
+        else
+            vLatestUnpackedFeatures[nFeatsIdx].copyTo(m_vLoadedFeatures[nFeatsIdx]); // makes internal copy, user can discard packet before next 'apply' call
+    }
     m_bUsePrecalcFeaturesNext = true;
 }
 
@@ -2734,6 +3348,15 @@ SegmMatcher::ValueType SegmMatcher::GraphModelData::calcTotalAssocCost() const {
     return tEnergy;
 }
 
+inline bool SegmMatcher::GraphModelData::isStereoLabelInWindow(size_t nLUTNodeIdx, InternalLabelType nLabel) const {
+    lvDbgExceptionWatch;
+    if(m_oStereoLabelPriorMap.empty())
+        return true;
+    lvDbgAssert(m_oGridSize==m_oStereoLabelPriorMap.size && nLUTNodeIdx<m_oGridSize.total());
+    const InternalLabelType nCenterLabel = ((InternalLabelType*)m_oStereoLabelPriorMap.data)[nLUTNodeIdx];
+    return nCenterLabel>=m_nRealStereoLabels || size_t(std::abs((int)nLabel-(int)nCenterLabel))<=m_nStereoLabelWindowRad;
+}
+
 inline SegmMatcher::ValueType SegmMatcher::GraphModelData::calcStereoUnaryMoveCost(size_t nGraphNodeIdx, InternalLabelType nOldLabel, InternalLabelType nNewLabel) const {
     lvDbgExceptionWatch;
     lvDbgAssert(nGraphNodeIdx<m_nValidStereoGraphNodes);
@@ -2743,7 +3366,7 @@ inline SegmMatcher::ValueType SegmMatcher::GraphModelData::calcStereoUnaryMoveCo
     if(nOldLabel!=nNewLabel) {
         lvDbgAssert(nOldLabel<m_nStereoLabels && nNewLabel<m_nStereoLabels);
         const ValueType tAssocEnergyCost = calcRemoveAssocCost(oNode.nRowIdx,oNode.nColIdx,nOldLabel)+calcAddAssocCost(oNode.nRowIdx,oNode.nColIdx,nNewLabel);
-        const ExplicitFunction& vUnaryStereoLUT = *oNode.pUnaryFunc;
+        const SparseExplicitFunction& vUnaryStereoLUT = *oNode.pUnaryFunc;
         const ValueType tUnaryEnergyInit = vUnaryStereoLUT(nOldLabel);
         const ValueType tUnaryEnergyModif = vUnaryStereoLUT(nNewLabel);
         return tAssocEnergyCost+tUnaryEnergyModif-tUnaryEnergyInit;
@@ -2800,7 +3423,7 @@ void SegmMatcher::GraphModelData::calcResegmMoveCosts(InternalLabelType nNewLabe
     }
 }
 
-#if (SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
+#if SEGMMATCH_HAVE_SOSPD_INF
 
 template<typename TNode>
 size_t SegmMatcher::GraphModelData::initMinimizer(sospd::SubmodularIBFS<ValueType,IndexType>& oMinimizer,
@@ -2840,21 +3463,25 @@ size_t SegmMatcher::GraphModelData::setupPrimalDual(const std::vector<TNode>& vN
                                                     const cv::Mat_<InternalLabelType>& oLabeling,
                                                     cv::Mat_<ValueType>& oDualMap,
                                                     cv::Mat_<ValueType>& oHeightMap,
-                                                    size_t nTotLabels, size_t nMaxCliques) {
+                                                    size_t nTotLabels, size_t nMaxCliques,
+                                                    bool bReuseDuals) {
     lvDbgExceptionWatch;
     const size_t nGraphNodes = vGraphIdxToMapIdxLUT.size();
     lvDbgAssert(nGraphNodes>size_t(0) && nMaxCliques>size_t(0));
     lvDbgAssert(nGraphNodes<=oLabeling.total());
     oHeightMap.create((int)nGraphNodes,(int)nTotLabels);
     oHeightMap = cost_cast(0);
-    oDualMap.create((int)nMaxCliques,(int)(s_nMaxOrder*nTotLabels));
-    oDualMap = cost_cast(0);
+    const bool bKeepDualMap = bReuseDuals && oDualMap.rows==(int)nMaxCliques && oDualMap.cols==(int)(s_nMaxOrder*nTotLabels);
+    if(!bKeepDualMap) {
+        oDualMap.create((int)nMaxCliques,(int)(s_nMaxOrder*nTotLabels));
+        oDualMap = cost_cast(0);
+    }
     std::array<InternalLabelType,s_nMaxOrder> aLabelingBuffer;
-    size_t nCliqueCount = 0;
+    size_t nCliqueCount = 0, nReusedCliqueCount = 0;
     for(size_t nGraphNodeIdx=0; nGraphNodeIdx<nGraphNodes; ++nGraphNodeIdx) {
         const size_t nLUTNodeIdx = vGraphIdxToMapIdxLUT[nGraphNodeIdx];
-        const NodeInfo& oNode = vNodeMap[nLUTNodeIdx];
-        const ExplicitFunction& vUnaryLUT = *oNode.pUnaryFunc;
+        const TNode& oNode = vNodeMap[nLUTNodeIdx];
+        const auto& vUnaryLUT = *oNode.pUnaryFunc;
         for(size_t nLabelIdx=0; nLabelIdx<nTotLabels; ++nLabelIdx)
             oHeightMap((int)nGraphNodeIdx,(int)nLabelIdx) += vUnaryLUT(nLabelIdx);
         for(auto& pClique : oNode.vpCliques) {
@@ -2873,10 +3500,25 @@ size_t SegmMatcher::GraphModelData::setupPrimalDual(const std::vector<TNode>& vN
             lvDbgAssert(tCurrCost>=cost_cast(0));
             lvDbgAssert(nCliqueCount<nMaxCliques);
             ValueType* pLambdas = oDualMap.ptr<ValueType>((int)nCliqueCount);
-            ValueType tAvgCost = tCurrCost/nCliqueSize;
-            const int tRemainderCost = int(tCurrCost)%int(nCliqueSize);
             const IndexType* aGraphNodeIdxs = oClique.getGraphNodeIter();
             lvDbgAssert(std::find(aGraphNodeIdxs,aGraphNodeIdxs+nCliqueSize,nGraphNodeIdx)<aGraphNodeIdxs+nCliqueSize);
+            if(bKeepDualMap && !oNode.bUpdatedCliques) {
+                // duals left by the last inference (i.e. the flow pushed so far) stay valid for an unchanged energy table, as long as they are tight for the current labeling
+                ValueType tCurrLambdaSum = cost_cast(0);
+                for(IndexType nDimIdx=0; nDimIdx<nCliqueSize; ++nDimIdx)
+                    tCurrLambdaSum += pLambdas[nDimIdx*nTotLabels+aLabelingBuffer[nDimIdx]];
+                if(tCurrLambdaSum==tCurrCost) {
+                    for(IndexType nDimIdx=0; nDimIdx<nCliqueSize; ++nDimIdx)
+                        for(size_t nLabelIdx=0; nLabelIdx<nTotLabels; ++nLabelIdx)
+                            oHeightMap((int)aGraphNodeIdxs[nDimIdx],(int)nLabelIdx) += pLambdas[nDimIdx*nTotLabels+nLabelIdx];
+                    ++nReusedCliqueCount;
+                    ++nCliqueCount;
+                    continue;
+                }
+            }
+            std::fill_n(pLambdas,s_nMaxOrder*nTotLabels,cost_cast(0));
+            ValueType tAvgCost = tCurrCost/nCliqueSize;
+            const int tRemainderCost = int(tCurrCost)%int(nCliqueSize);
             for(IndexType nDimIdx=0; nDimIdx<nCliqueSize; ++nDimIdx) {
                 const IndexType nOffsetGraphNodeIdx = aGraphNodeIdxs[nDimIdx];
                 lvDbgAssert(nOffsetGraphNodeIdx!=SIZE_MAX && nOffsetGraphNodeIdx<nGraphNodes);
@@ -2888,7 +3530,10 @@ size_t SegmMatcher::GraphModelData::setupPrimalDual(const std::vector<TNode>& vN
             }
             ++nCliqueCount;
         }
+        oNode.bUpdatedCliques = false;
     }
+    if(bKeepDualMap)
+        lvLog_(4,"Primal-dual setup reused the duals of %d clique(s) out of %d",(int)nReusedCliqueCount,(int)nCliqueCount);
     return nCliqueCount;
 }
 
@@ -3066,7 +3711,7 @@ void SegmMatcher::GraphModelData::solvePrimalDual(sospd::SubmodularIBFS<ValueTyp
     }
 }
 
-#endif //(SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF || SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF)
+#endif //SEGMMATCH_HAVE_SOSPD_INF
 
 opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
     static_assert(s_nInputArraySize==4 && getCameraCount()==2,"hardcoded indices below will break");
@@ -3102,56 +3747,185 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
     resetStereoLabelings();
     lvDbgAssert(m_nValidResegmGraphNodes==m_vResegmGraphIdxToMapIdxLUT.size());
     lvLog_(2,"Running inference for primary camera idx=%d...",(int)m_nPrimaryCamIdx);
-#if (SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF)
+    const InferenceSolverType eStereoSolver = m_oStereoSolverParams.eSolver;
+    const InferenceSolverType eResegmSolver = m_oResegmSolverParams.eSolver;
+    lvAssert__(isStereoSolverAvailable(eStereoSolver),"stereo inference solver '%s' is unavailable in this build",getSolverName(eStereoSolver).c_str());
+    lvAssert__(isResegmSolverAvailable(eResegmSolver),"resegm inference solver '%s' is unavailable in this build",getSolverName(eResegmSolver).c_str());
+    lvLog_(2,"Using stereo solver '%s' and resegm solver '%s'",getSolverName(eStereoSolver).c_str(),getSolverName(eResegmSolver).c_str());
+#if SEGMMATCH_HAVE_FGBZ_INF
     using HOEReducer = HigherOrderEnergy<ValueType,s_nMaxOrder>;
-#endif //(SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF || SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF)
+    using QPBOMinimizer = kolmogorov::qpbo::QPBO<ValueType>;
+#endif //SEGMMATCH_HAVE_FGBZ_INF
     cv::Mat_<InternalLabelType>& oCurrStereoLabeling = m_aaStereoLabelings[0][m_nPrimaryCamIdx];
-#if SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
-    //calcStereoCosts(m_nPrimaryCamIdx);
-    //const size_t nStereoPairwCount = m_nValidStereoGraphNodes*s_nPairwOrients; (max, not actual) // numPairs_
-    // pairs_ : lookup node, 1st pairw node idx + 2nd pairw node idx
-    // distance_[2ndlabel*nlabels + 1stlabel] : m_aaStereoPairwFuncIDs_base[nCamIdx][nOrientIdx](1stlabel,2ndlabel)
-    // weights_ : lookup node, each orient has its weight
-    /* still need to cleanup fastpd setup...
-    setLabelCosts();
-    getNumPairs();
-    setPairs();
-    setDistance();
-    setWeights();
-    pdInference_ = new fastPDLib::CV_Fast_PD(
-            gm_.numberOfVariables(),
-            gm_.numberOfLabels(0),
-            labelCosts_,
-            numPairs_,
-            pairs_,
-            distance_,
-            parameter_.numberOfIterations_,
-            weights_
-    );*/
-    // see if maxflow used in fastpd can be replaced by https://github.com/gerddie/maxflow?
-#elif SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF
-    constexpr int nMaxStereoEdgesPerNode = (s_nPairwOrients+s_nEpipolarCliqueEdges);
-    kolmogorov::qpbo::QPBO<ValueType> oStereoMinimizer((int)m_nValidStereoGraphNodes,(int)m_nValidStereoGraphNodes*nMaxStereoEdgesPerNode);
-    HOEReducer oStereoReducer;
     size_t nStereoLabelOrderingIdx = 0;
-#elif SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF
+#if SEGMMATCH_HAVE_FGBZ_INF
+    // solver objects are only allocated once, and then reused for all moves of all frames (graph sizes are fixed)
+    std::unique_ptr<QPBOMinimizer>& pStereoQPBOMinimizer = m_pStereoQPBOMinimizer;
+    std::unique_ptr<QPBOMinimizer>& pResegmQPBOMinimizer = m_pResegmQPBOMinimizer;
+    std::unique_ptr<HOEReducer>& pStereoReducer = m_pStereoReducer;
+    std::unique_ptr<HOEReducer>& pResegmReducer = m_pResegmReducer;
+    if(eStereoSolver==InferenceSolver_FGBZ && !pStereoQPBOMinimizer) {
+        constexpr int nMaxStereoEdgesPerNode = (s_nPairwOrients+s_nEpipolarCliqueEdges);
+        pStereoQPBOMinimizer = std::make_unique<QPBOMinimizer>((int)m_nValidStereoGraphNodes,(int)m_nValidStereoGraphNodes*nMaxStereoEdgesPerNode);
+        pStereoReducer = std::make_unique<HOEReducer>();
+    }
+    if(eResegmSolver==InferenceSolver_FGBZ && !pResegmQPBOMinimizer && !m_bStereoOnly) {
+        constexpr int nMaxResegmEdgesPerNode = (s_nPairwOrients+s_nTemporalCliqueEdges);
+        pResegmQPBOMinimizer = std::make_unique<QPBOMinimizer>((int)m_nValidResegmGraphNodes,(int)m_nValidResegmGraphNodes*nMaxResegmEdgesPerNode);
+        pResegmReducer = std::make_unique<HOEReducer>();
+    }
+    // stereo fusion moves can be split over a checkerboard of tiles; same-color tiles share no pairwise clique, so their
+    // sub-moves (conditioned on the current labels of all outside nodes) are independent and can be solved concurrently
+    const size_t nStereoMoveTileSize = m_oStereoSolverParams.nMoveTileSize;
+    const bool bUseTiledStereoMoves = (eStereoSolver==InferenceSolver_FGBZ && nStereoMoveTileSize>0u && !SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN);
+    const int nStereoTileSize = (int)nStereoMoveTileSize;
+    const int nStereoTileRows = bUseTiledStereoMoves?((int)m_oGridSize[0]+nStereoTileSize-1)/nStereoTileSize:0;
+    const int nStereoTileCols = bUseTiledStereoMoves?((int)m_oGridSize[1]+nStereoTileSize-1)/nStereoTileSize:0;
+    std::vector<int> vStereoGraphNodeTileIdxs,vStereoGraphNodeTileVarIdxs;
+    std::vector<std::vector<size_t>> vvStereoTileGraphNodeIdxs;
+    std::array<std::vector<size_t>,2> avStereoTileIdxsPerColor;
+    std::vector<std::unique_ptr<QPBOMinimizer>> vpStereoTileQPBOMinimizers;
+    std::vector<std::unique_ptr<HOEReducer>> vpStereoTileReducers;
+    cv::Mat_<InternalLabelType> oPreMoveStereoLabeling;
+    if(bUseTiledStereoMoves) {
+        vvStereoTileGraphNodeIdxs.resize(size_t(nStereoTileRows*nStereoTileCols));
+        vStereoGraphNodeTileIdxs.resize(m_nValidStereoGraphNodes);
+        vStereoGraphNodeTileVarIdxs.resize(m_nValidStereoGraphNodes);
+        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+            const StereoNodeInfo& oNode = m_vStereoNodeMap[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]];
+            const int nTileIdx = (oNode.nRowIdx/nStereoTileSize)*nStereoTileCols+(oNode.nColIdx/nStereoTileSize);
+            vStereoGraphNodeTileIdxs[nGraphNodeIdx] = nTileIdx;
+            vStereoGraphNodeTileVarIdxs[nGraphNodeIdx] = (int)vvStereoTileGraphNodeIdxs[nTileIdx].size();
+            vvStereoTileGraphNodeIdxs[nTileIdx].push_back(nGraphNodeIdx);
+        }
+        vpStereoTileQPBOMinimizers.resize(vvStereoTileGraphNodeIdxs.size());
+        vpStereoTileReducers.resize(vvStereoTileGraphNodeIdxs.size());
+        for(size_t nTileIdx=0; nTileIdx<vvStereoTileGraphNodeIdxs.size(); ++nTileIdx) {
+            const int nTileNodes = (int)vvStereoTileGraphNodeIdxs[nTileIdx].size();
+            if(nTileNodes>0) {
+                avStereoTileIdxsPerColor[((nTileIdx/nStereoTileCols)+(nTileIdx%nStereoTileCols))%2].push_back(nTileIdx);
+                vpStereoTileQPBOMinimizers[nTileIdx] = std::make_unique<QPBOMinimizer>(nTileNodes,nTileNodes*(int)s_nPairwOrients);
+                vpStereoTileReducers[nTileIdx] = std::make_unique<HOEReducer>();
+            }
+        }
+        lvLog_(3,"Using %d concurrent stereo move tiles of %dx%d nodes",(int)(avStereoTileIdxsPerColor[0].size()+avStereoTileIdxsPerColor[1].size()),nStereoTileSize,nStereoTileSize);
+    }
+    const auto lApplyStereoMoveLabel = [&](size_t nGraphNodeIdx, InternalLabelType nNewLabel) {
+        const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
+        const int nRowIdx = m_vStereoNodeMap[nLUTNodeIdx].nRowIdx;
+        const int nColIdx = m_vStereoNodeMap[nLUTNodeIdx].nColIdx;
+        const InternalLabelType nOldLabel = oCurrStereoLabeling(nRowIdx,nColIdx);
+        if(nOldLabel!=nNewLabel) {
+            if(nOldLabel<m_nDontCareLabelIdx)
+                removeAssoc(nRowIdx,nColIdx,nOldLabel);
+            oCurrStereoLabeling(nRowIdx,nColIdx) = nNewLabel;
+            if(nNewLabel<m_nDontCareLabelIdx)
+                addAssoc(nRowIdx,nColIdx,nNewLabel);
+        }
+    };
+    const auto lSolveStereoMove = [&](InternalLabelType nAlphaLabel) {
+        pStereoReducer->Clear();
+        pStereoReducer->AddVars((int)m_nValidStereoGraphNodes);
+        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+            const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
+            const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
+            if(oNode.nUnaryFactID!=SIZE_MAX) {
+                const ValueType& tUnaryCost = ((ValueType*)m_oStereoUnaryCosts.data)[nLUTNodeIdx];
+                lvDbgAssert(&tUnaryCost==&m_oStereoUnaryCosts(oNode.nRowIdx,oNode.nColIdx));
+                pStereoReducer->AddUnaryTerm((int)nGraphNodeIdx,tUnaryCost);
+            }
+            for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
+                lv::gm::factorReducer<ExplicitScaledFunction>(oNode.aPairwCliques[nOrientIdx],*pStereoReducer,nAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data);
+        #if SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN
+            lv::gm::factorReducer<ExplicitScaledFunction>(oNode.oEpipolarClique,*pStereoReducer,nAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data);
+        #endif //SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN
+        }
+        pStereoQPBOMinimizer->Reset();
+        pStereoReducer->ToQuadratic(*pStereoQPBOMinimizer);
+        pStereoQPBOMinimizer->Solve();
+        pStereoQPBOMinimizer->ComputeWeakPersistencies();
+        size_t nChangedLabels = 0;
+        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+            const int nMoveLabel = pStereoQPBOMinimizer->GetLabel((int)nGraphNodeIdx);
+            lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
+            if(nMoveLabel==1) { // node label changed to alpha
+                lApplyStereoMoveLabel(nGraphNodeIdx,nAlphaLabel);
+                ++nChangedLabels;
+            }
+        }
+        return nChangedLabels;
+    };
+    const auto lSolveTiledStereoMove = [&](InternalLabelType nAlphaLabel) {
+        size_t nChangedLabels = 0;
+        for(size_t nColorIdx=0; nColorIdx<avStereoTileIdxsPerColor.size(); ++nColorIdx) {
+            const std::vector<size_t>& vColorTileIdxs = avStereoTileIdxsPerColor[nColorIdx];
+            if(nColorIdx>0) // assoc costs may have changed due to the labels merged from the previous color
+                calcStereoMoveCosts(nAlphaLabel);
+        #if USING_OPENMP
+            #pragma omp parallel for schedule(dynamic)
+        #endif //USING_OPENMP
+            for(int nColorTileIdx=0; nColorTileIdx<(int)vColorTileIdxs.size(); ++nColorTileIdx) {
+                const int nTileIdx = (int)vColorTileIdxs[nColorTileIdx];
+                const std::vector<size_t>& vTileGraphNodeIdxs = vvStereoTileGraphNodeIdxs[nTileIdx];
+                HOEReducer& oTileReducer = *vpStereoTileReducers[nTileIdx];
+                QPBOMinimizer& oTileMinimizer = *vpStereoTileQPBOMinimizers[nTileIdx];
+                const auto lTileVarIdxMapper = [&](size_t nGraphNodeIdx) {
+                    return (vStereoGraphNodeTileIdxs[nGraphNodeIdx]==nTileIdx)?vStereoGraphNodeTileVarIdxs[nGraphNodeIdx]:-1;
+                };
+                oTileReducer.Clear();
+                oTileReducer.AddVars((int)vTileGraphNodeIdxs.size());
+                for(size_t nTileVarIdx=0; nTileVarIdx<vTileGraphNodeIdxs.size(); ++nTileVarIdx) {
+                    const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[vTileGraphNodeIdxs[nTileVarIdx]];
+                    if(m_vStereoNodeMap[nLUTNodeIdx].nUnaryFactID!=SIZE_MAX)
+                        oTileReducer.AddUnaryTerm((int)nTileVarIdx,((ValueType*)m_oStereoUnaryCosts.data)[nLUTNodeIdx]);
+                }
+                // cliques touching this tile are owned by its own nodes, or by the nodes right above/left of it
+                const int nRowStart = std::max((nTileIdx/nStereoTileCols)*nStereoTileSize-1,0);
+                const int nRowEnd = std::min((nTileIdx/nStereoTileCols+1)*nStereoTileSize,(int)m_oGridSize[0]);
+                const int nColStart = std::max((nTileIdx%nStereoTileCols)*nStereoTileSize-1,0);
+                const int nColEnd = std::min((nTileIdx%nStereoTileCols+1)*nStereoTileSize,(int)m_oGridSize[1]);
+                for(int nRowIdx=nRowStart; nRowIdx<nRowEnd; ++nRowIdx) {
+                    for(int nColIdx=nColStart; nColIdx<nColEnd; ++nColIdx) {
+                        const StereoNodeInfo& oNode = m_vStereoNodeMap[nRowIdx*m_oGridSize[1]+nColIdx];
+                        if(oNode.bValidGraphNode)
+                            for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
+                                lv::gm::factorReducer<ExplicitScaledFunction>(oNode.aPairwCliques[nOrientIdx],oTileReducer,nAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data,lTileVarIdxMapper);
+                    }
+                }
+                oTileMinimizer.Reset();
+                oTileReducer.ToQuadratic(oTileMinimizer);
+                oTileMinimizer.Solve();
+                oTileMinimizer.ComputeWeakPersistencies();
+            }
+            // consistency pass; assoc updates touch whole rows, so tile results are merged serially
+            for(size_t nTileIdx : vColorTileIdxs) {
+                const std::vector<size_t>& vTileGraphNodeIdxs = vvStereoTileGraphNodeIdxs[nTileIdx];
+                for(size_t nTileVarIdx=0; nTileVarIdx<vTileGraphNodeIdxs.size(); ++nTileVarIdx)
+                    if(vpStereoTileQPBOMinimizers[nTileIdx]->GetLabel((int)nTileVarIdx)==1) {
+                        lApplyStereoMoveLabel(vTileGraphNodeIdxs[nTileVarIdx],nAlphaLabel);
+                        ++nChangedLabels;
+                    }
+            }
+        }
+        return nChangedLabels;
+    };
+#endif //SEGMMATCH_HAVE_FGBZ_INF
+#if SEGMMATCH_HAVE_SOSPD_INF
     static_assert(std::is_integral<SegmMatcher::ValueType>::value,"sospd height weight redistr requires integer type");
     constexpr bool bUseHeightAlphaExp = SEGMMATCH_CONFIG_USE_SOSPD_ALPHA_HEIGHTS_LABEL_ORDERING;
     lvAssert_(!bUseHeightAlphaExp,"missing impl");
-    size_t nStereoLabelOrderingIdx = 0;
-    sospd::SubmodularIBFS<ValueType,IndexType> oStereoMinimizer;
-    const size_t nInternalStereoCliqueCount = initMinimizer(oStereoMinimizer,m_vStereoNodeMap,m_vStereoGraphIdxToMapIdxLUT);
-    lvAssert(nInternalStereoCliqueCount==m_nStereoCliqueCount);
-    const size_t nSetupStereoCliqueCount = setupPrimalDual<ExplicitScaledFunction>(m_vStereoNodeMap,m_vStereoGraphIdxToMapIdxLUT,oCurrStereoLabeling,m_oStereoDualMap,m_oStereoHeightMap,m_nStereoLabels,m_nStereoCliqueCount);
-    lvAssert(nSetupStereoCliqueCount==m_nStereoCliqueCount);
-#endif //SEGMMATCH_CONFIG_USE_..._STEREO_INF
-#if SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF
-    constexpr int nMaxResegmEdgesPerNode = (s_nPairwOrients+s_nTemporalCliqueEdges);
-    kolmogorov::qpbo::QPBO<ValueType> oResegmMinimizer((int)m_nValidResegmGraphNodes,(int)m_nValidResegmGraphNodes*nMaxResegmEdgesPerNode);
-    HOEReducer oResegmReducer;
-#elif SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF
-    static_assert(std::is_integral<SegmMatcher::ValueType>::value,"sospd height weight redistr requires integer type");
-#endif //SEGMMATCH_CONFIG_USE_..._RESEGM_INF
+    std::unique_ptr<sospd::SubmodularIBFS<ValueType,IndexType>>& pStereoIBFSMinimizer = m_pStereoIBFSMinimizer;
+    if(eStereoSolver==InferenceSolver_SoSPD) {
+        if(!pStereoIBFSMinimizer) { // clique structure is reused across frames; energy tables & unaries are rewritten for each move
+            pStereoIBFSMinimizer = std::make_unique<sospd::SubmodularIBFS<ValueType,IndexType>>();
+            const size_t nInternalStereoCliqueCount = initMinimizer(*pStereoIBFSMinimizer,m_vStereoNodeMap,m_vStereoGraphIdxToMapIdxLUT);
+            lvAssert(nInternalStereoCliqueCount==m_nStereoCliqueCount);
+        }
+        // with warm-started labelings, the duals (flow) of the previous frame are kept for all unchanged cliques, as in dynamic graph cuts
+        const size_t nSetupStereoCliqueCount = setupPrimalDual<ExplicitScaledFunction>(m_vStereoNodeMap,m_vStereoGraphIdxToMapIdxLUT,oCurrStereoLabeling,m_oStereoDualMap,m_oStereoHeightMap,m_nStereoLabels,m_nStereoCliqueCount,bool(SEGMMATCH_CONFIG_USE_LAST_STEREO_INIT));
+        lvAssert(nSetupStereoCliqueCount==m_nStereoCliqueCount);
+    }
+#endif //SEGMMATCH_HAVE_SOSPD_INF
     size_t nStereoMoveIter=0, nResegmMoveIter=0, nConsecUnchangedStereoLabels=0;
     std::vector<int> vInitLabelCounts = lv::calcHistCounts(m_aaStereoLabelings[0][m_nPrimaryCamIdx],m_aROIs[m_nPrimaryCamIdx]);
     vInitLabelCounts.resize(m_nStereoLabels);
@@ -3163,117 +3937,127 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
     // note: sospd might not follow this label order if using alpha heights strategy (reimpl to use same strat in every solver?) ####
     lv::StopWatch oLocalTimer;
     ValueType tLastStereoEnergy=m_pStereoInf->value(),tLastResegmEnergy=std::numeric_limits<ValueType>::max();
+    ValueType tTiledMoveRefStereoEnergy = tLastStereoEnergy; // lowest energy reached so far; tiled moves may only drift above it by the allowed gap
     m_oSuperStackedResegmLabeling.copyTo(m_oInitSuperStackedResegmLabeling);
     cv::Mat_<InternalLabelType> oPreStereoUpdateLabeling = m_oSuperStackedResegmLabeling.clone();
     cv::Mat_<InternalLabelType> oPreResegmUpdateLabeling = m_oSuperStackedResegmLabeling.clone();
-    bool bJustUpdatedSegm = false;
-    while(nStereoMoveIter<m_nMaxStereoMoveCount && nConsecUnchangedStereoLabels<m_nStereoLabels) {
-    #if SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
-
-        // fastpd only works with shared+scaled pairwise costs, and no higher order terms
-        opengm::external::FastPD<StereoModelType> oStereoMinimizer2(*m_apStereoModels[nPrimaryCamIdx],opengm::external::FastPD<StereoModelType>::Parameter());
-        oStereoMinimizer2.infer();
-        std::vector<InternalLabelType> outputlabels;
-        oStereoMinimizer2.arg(outputlabels);
-        lvAssert(outputlabels.size()==m_anValidGraphNodes[nPrimaryCamIdx]);
-
-        //pdInference_->run(); just one iter at a time --- split and use while above; add nullify stereo pairw costs?
-
-        size_t nChangedStereoLabels = 0;
-        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_anValidGraphNodes[nPrimaryCamIdx]; ++nGraphNodeIdx) {
-            const size_t nLUTNodeIdx = m_avValidLUTNodeIdxs[nPrimaryCamIdx][nGraphNodeIdx];
-            const int nRowIdx = m_vNodeInfos[nLUTNodeIdx].nRowIdx;
-            const int nColIdx = m_vNodeInfos[nLUTNodeIdx].nColIdx;
-            const InternalLabelType nOldLabel = oCurrStereoLabeling(nRowIdx,nColIdx);
-            //const InternalLabelType nNewLabel = pdInference_->_pinfo[nGraphNodeIdx].label;
-            const InternalLabelType nNewLabel = outputlabels[nGraphNodeIdx];
-            if(nOldLabel!=nNewLabel) {
-                if(nOldLabel<m_nDontCareLabelIdx)
-                    removeAssoc(nPrimaryCamIdx,nRowIdx,nColIdx,nOldLabel);
-                oCurrStereoLabeling(nRowIdx,nColIdx) = nNewLabel;
-                if(nNewLabel<m_nDontCareLabelIdx)
-                    addAssoc(nPrimaryCamIdx,nRowIdx,nColIdx,nNewLabel);
-                ++nChangedStereoLabels;
-            }
-        }
-        nStereoMoveIter += m_nRealStereoLabels;
-        nConsecUnchangedStereoLabels = (nChangedStereoLabels>0)?0:nConsecUnchangedStereoLabels+m_nRealStereoLabels;
-        const bool bResegmNext = true;
-    #elif SEGMMATCH_CONFIG_USE_FGBZ_STEREO_INF
-        // each iter below is a fusion move based on A. Fix's energy minimization method for higher-order MRFs
-        // see "A Graph Cut Algorithm for Higher-order Markov Random Fields" in ICCV2011 for more info (doi = 10.1109/ICCV.2011.6126347)
-        // (note: this approach is very generic, and not very well adapted to a dynamic MRF problem!)
+    bool bJustUpdatedSegm = false, bStereoModelUpdated = true;
+    const double dMaxStereoTimeSec = m_oStereoSolverParams.dMaxTimeSec;
+    while(nStereoMoveIter<m_oStereoSolverParams.nMaxMoveCount && nConsecUnchangedStereoLabels<m_nStereoLabels && (dMaxStereoTimeSec<=0.0 || oLocalTimer.elapsed()<dMaxStereoTimeSec)) {
+        // note: fastpd runs over all labels at once, so it does not follow the label ordering below
+        if(eStereoSolver==InferenceSolver_FastPD && !bStereoModelUpdated)
+            break; // fastpd only sees the model, so re-solving it without a resegm update would yield the same labeling
         const InternalLabelType nStereoAlphaLabel = m_vStereoLabelOrdering[nStereoLabelOrderingIdx];
-        calcStereoMoveCosts(nStereoAlphaLabel);
-        oStereoReducer.Clear();
-        oStereoReducer.AddVars((int)m_nValidStereoGraphNodes);
-        if(lv::getVerbosity()>=5) {
-            cv::Mat oStereoUnaryCostsDisplay;
-            cv::normalize(m_oStereoUnaryCosts,oStereoUnaryCostsDisplay,255,0,cv::NORM_MINMAX,CV_8U,m_aROIs[m_nPrimaryCamIdx]);
-            cv::imshow("oStereoUnaryCostsDisplay",oStereoUnaryCostsDisplay);
-            cv::waitKey(1);
+        if(!m_vActiveStereoLabels[nStereoAlphaLabel] && eStereoSolver!=InferenceSolver_FastPD) {
+            ++nConsecUnchangedStereoLabels;
+            ++nStereoLabelOrderingIdx %= m_vStereoLabelOrdering.size();
+            continue;
         }
-        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
-            const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
-            const StereoNodeInfo& oNode = m_vStereoNodeMap[nLUTNodeIdx];
-            if(oNode.nUnaryFactID!=SIZE_MAX) {
-                const ValueType& tUnaryCost = ((ValueType*)m_oStereoUnaryCosts.data)[nLUTNodeIdx];
-                lvDbgAssert(&tUnaryCost==&m_oStereoUnaryCosts(oNode.nRowIdx,oNode.nColIdx));
-                oStereoReducer.AddUnaryTerm((int)nGraphNodeIdx,tUnaryCost);
+        bool bResegmNext = false, bStereoMoveWithinGap = false;
+        ValueType tTiledMoveCurrStereoEnergy = cost_cast(0);
+        switch(eStereoSolver) {
+        #if SEGMMATCH_HAVE_FGBZ_INF
+            case InferenceSolver_FGBZ: {
+                // each iter below is a fusion move based on A. Fix's energy minimization method for higher-order MRFs
+                // see "A Graph Cut Algorithm for Higher-order Markov Random Fields" in ICCV2011 for more info (doi = 10.1109/ICCV.2011.6126347)
+                // (note: this approach is very generic, and not very well adapted to a dynamic MRF problem!)
+                calcStereoMoveCosts(nStereoAlphaLabel);
+                if(lv::getVerbosity()>=5) {
+                    cv::Mat oStereoUnaryCostsDisplay;
+                    cv::normalize(m_oStereoUnaryCosts,oStereoUnaryCostsDisplay,255,0,cv::NORM_MINMAX,CV_8U,m_aROIs[m_nPrimaryCamIdx]);
+                    cv::imshow("oStereoUnaryCostsDisplay",oStereoUnaryCostsDisplay);
+                    cv::waitKey(1);
+                }
+                size_t nChangedStereoLabels = 0;
+                if(bUseTiledStereoMoves) {
+                    if(bJustUpdatedSegm) // model changed, previous energies are no longer comparable
+                        tTiledMoveRefStereoEnergy = m_pStereoInf->value();
+                    oCurrStereoLabeling.copyTo(oPreMoveStereoLabeling);
+                    nChangedStereoLabels = lSolveTiledStereoMove(nStereoAlphaLabel);
+                    const ValueType tTiledMoveStereoEnergy = m_pStereoInf->value();
+                    // gap is checked against the best energy reached so far (not the pre-move one), so that accepted moves cannot accumulate drift
+                    const ValueType tMaxStereoEnergy = tTiledMoveRefStereoEnergy+cost_cast(std::floor(m_oStereoSolverParams.dMaxTiledMoveEnergyGap*std::abs(tTiledMoveRefStereoEnergy)));
+                    if(tTiledMoveStereoEnergy>tMaxStereoEnergy) {
+                        // tile borders kept the move from finding a good enough solution; revert it, and solve over the whole graph instead
+                        lvLog_(4,"\t\t\t(tiled move rejected, e = %d; falling back to full graph move)",(int)tTiledMoveStereoEnergy);
+                        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx)
+                            lApplyStereoMoveLabel(nGraphNodeIdx,((InternalLabelType*)oPreMoveStereoLabeling.data)[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]]);
+                        calcStereoMoveCosts(nStereoAlphaLabel);
+                        nChangedStereoLabels = lSolveStereoMove(nStereoAlphaLabel);
+                    }
+                    else {
+                        tTiledMoveCurrStereoEnergy = tTiledMoveStereoEnergy;
+                        bStereoMoveWithinGap = true;
+                    }
+                }
+                else
+                    nChangedStereoLabels = lSolveStereoMove(nStereoAlphaLabel);
+                nConsecUnchangedStereoLabels = (nChangedStereoLabels>0)?0:nConsecUnchangedStereoLabels+1;
+                bResegmNext = (nStereoMoveIter++%SEGMMATCH_DEFAULT_ITER_PER_RESEGM)==0;
+                break;
             }
-            for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
-                lv::gm::factorReducer<ExplicitScaledFunction>(oNode.aPairwCliques[nOrientIdx],oStereoReducer,nStereoAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data);
-        #if SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN
-            lv::gm::factorReducer<ExplicitScaledFunction>(oNode.oEpipolarClique,oStereoReducer,nStereoAlphaLabel,(InternalLabelType*)oCurrStereoLabeling.data);
-        #endif //SEGMMATCH_CONFIG_USE_EPIPOLAR_CONN
-        }
-        oStereoMinimizer.Reset();
-        oStereoReducer.ToQuadratic(oStereoMinimizer);
-        oStereoMinimizer.Solve();
-        oStereoMinimizer.ComputeWeakPersistencies();
-        size_t nChangedStereoLabels = 0;
-        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
-            const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
-            const int nRowIdx = m_vStereoNodeMap[nLUTNodeIdx].nRowIdx;
-            const int nColIdx = m_vStereoNodeMap[nLUTNodeIdx].nColIdx;
-            const int nMoveLabel = oStereoMinimizer.GetLabel((int)nGraphNodeIdx);
-            lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
-            if(nMoveLabel==1) { // node label changed to alpha
-                const InternalLabelType nOldLabel = oCurrStereoLabeling(nRowIdx,nColIdx);
-                if(nOldLabel<m_nDontCareLabelIdx)
-                    removeAssoc(nRowIdx,nColIdx,nOldLabel);
-                oCurrStereoLabeling(nRowIdx,nColIdx) = nStereoAlphaLabel;
-                if(nStereoAlphaLabel<m_nDontCareLabelIdx)
-                    addAssoc(nRowIdx,nColIdx,nStereoAlphaLabel);
-                ++nChangedStereoLabels;
+        #endif //SEGMMATCH_HAVE_FGBZ_INF
+        #if SEGMMATCH_HAVE_FASTPD_INF
+            case InferenceSolver_FastPD: {
+                // fastpd only works with shared+scaled pairwise costs, and no higher order terms; it also only
+                // sees the static unary costs stored in the model (i.e. no association costs), and solves all labels at once
+                using FastPDMinimizer = opengm::external::FastPD<StereoModelType>;
+                FastPDMinimizer oFastPDMinimizer(*m_pStereoModel,FastPDMinimizer::Parameter());
+                oFastPDMinimizer.infer();
+                std::vector<InternalLabelType> vFastPDLabels;
+                oFastPDMinimizer.arg(vFastPDLabels);
+                lvAssert(vFastPDLabels.size()==m_nValidStereoGraphNodes);
+                size_t nChangedStereoLabels = 0;
+                for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+                    const size_t nLUTNodeIdx = m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx];
+                    const int nRowIdx = m_vStereoNodeMap[nLUTNodeIdx].nRowIdx;
+                    const int nColIdx = m_vStereoNodeMap[nLUTNodeIdx].nColIdx;
+                    const InternalLabelType nOldLabel = oCurrStereoLabeling(nRowIdx,nColIdx);
+                    const InternalLabelType nNewLabel = vFastPDLabels[nGraphNodeIdx];
+                    if(nOldLabel!=nNewLabel) {
+                        if(nOldLabel<m_nDontCareLabelIdx)
+                            removeAssoc(nRowIdx,nColIdx,nOldLabel);
+                        oCurrStereoLabeling(nRowIdx,nColIdx) = nNewLabel;
+                        if(nNewLabel<m_nDontCareLabelIdx)
+                            addAssoc(nRowIdx,nColIdx,nNewLabel);
+                        ++nChangedStereoLabels;
+                    }
+                }
+                nStereoMoveIter += m_nRealStereoLabels;
+                nConsecUnchangedStereoLabels = (nChangedStereoLabels>0)?0:nConsecUnchangedStereoLabels+m_nRealStereoLabels;
+                bResegmNext = true;
+                bStereoModelUpdated = false;
+                break;
             }
+        #endif //SEGMMATCH_HAVE_FASTPD_INF
+        #if SEGMMATCH_HAVE_SOSPD_INF
+            case InferenceSolver_SoSPD: {
+                calcStereoMoveCosts(nStereoAlphaLabel);
+                const bool bStereoMoveCanFlipLabels = std::any_of(StereoGraphNodeIter(this,0),StereoGraphNodeIter(this,m_nValidStereoGraphNodes),[&](const StereoNodeInfo& oNode) {
+                    return (((InternalLabelType*)oCurrStereoLabeling.data)[oNode.nMapIdx])!=nStereoAlphaLabel;
+                });
+                TemporalArray<CamArray<size_t>> aanChangedStereoLabels{};
+                if(bStereoMoveCanFlipLabels)
+                    solvePrimalDual<ExplicitScaledFunction>(*pStereoIBFSMinimizer,
+                                                            m_vStereoNodeMap,
+                                                            m_vStereoGraphIdxToMapIdxLUT,
+                                                            m_oStereoUnaryCosts,
+                                                            oCurrStereoLabeling,
+                                                            m_oStereoDualMap,
+                                                            m_oStereoHeightMap,
+                                                            nStereoAlphaLabel,
+                                                            m_nStereoLabels,true,
+                                                            aanChangedStereoLabels);
+                const bool bGotStereoLabelChange = aanChangedStereoLabels[0][m_nPrimaryCamIdx]>0;
+                nConsecUnchangedStereoLabels = bGotStereoLabelChange?0:nConsecUnchangedStereoLabels+1;
+                bResegmNext = (nStereoMoveIter++%SEGMMATCH_DEFAULT_ITER_PER_RESEGM)==0;
+                break;
+            }
+        #endif //SEGMMATCH_HAVE_SOSPD_INF
+            default:
+                lvError("unsupported stereo inference solver");
         }
         ++nStereoLabelOrderingIdx %= m_vStereoLabelOrdering.size();
-        nConsecUnchangedStereoLabels = (nChangedStereoLabels>0)?0:nConsecUnchangedStereoLabels+1;
-        const bool bResegmNext = (nStereoMoveIter++%SEGMMATCH_DEFAULT_ITER_PER_RESEGM)==0;
-    #elif SEGMMATCH_CONFIG_USE_SOSPD_STEREO_INF
-        const InternalLabelType nStereoAlphaLabel = m_vStereoLabelOrdering[nStereoLabelOrderingIdx];
-        calcStereoMoveCosts(nStereoAlphaLabel);
-        const bool bStereoMoveCanFlipLabels = std::any_of(StereoGraphNodeIter(this,0),StereoGraphNodeIter(this,m_nValidStereoGraphNodes),[&](const StereoNodeInfo& oNode) {
-            return (((InternalLabelType*)oCurrStereoLabeling.data)[oNode.nMapIdx])!=nStereoAlphaLabel;
-        });
-        TemporalArray<CamArray<size_t>> aanChangedStereoLabels{};
-        if(bStereoMoveCanFlipLabels)
-            solvePrimalDual<ExplicitScaledFunction>(oStereoMinimizer,
-                                                    m_vStereoNodeMap,
-                                                    m_vStereoGraphIdxToMapIdxLUT,
-                                                    m_oStereoUnaryCosts,
-                                                    oCurrStereoLabeling,
-                                                    m_oStereoDualMap,
-                                                    m_oStereoHeightMap,
-                                                    nStereoAlphaLabel,
-                                                    m_nStereoLabels,true,
-                                                    aanChangedStereoLabels);
-        const bool bGotStereoLabelChange = aanChangedStereoLabels[0][m_nPrimaryCamIdx]>0;
-        ++nStereoLabelOrderingIdx %= m_vStereoLabelOrdering.size();
-        nConsecUnchangedStereoLabels = bGotStereoLabelChange?0:nConsecUnchangedStereoLabels+1;
-        const bool bResegmNext = (nStereoMoveIter++%SEGMMATCH_DEFAULT_ITER_PER_RESEGM)==0;
-    #endif //SEGMMATCH_CONFIG_USE_..._STEREO_INF
         if(lv::getVerbosity()>=3) {
             cv::Mat oCurrLabelingDisplay = getStereoDispMapDisplay(0,m_nPrimaryCamIdx);
             if(oCurrLabelingDisplay.size().area()<640*480)
@@ -3281,26 +4065,27 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
             cv::imshow(std::string("disp-")+std::to_string(m_nPrimaryCamIdx),oCurrLabelingDisplay);
             cv::waitKey(1);
         }
-        const ValueType tCurrStereoEnergy = m_pStereoInf->value();
+        const ValueType tCurrStereoEnergy = bStereoMoveWithinGap?tTiledMoveCurrStereoEnergy:m_pStereoInf->value();
         lvDbgAssert(tCurrStereoEnergy>=cost_cast(0));
         std::stringstream ssStereoEnergyDiff;
         if((tCurrStereoEnergy-tLastStereoEnergy)==cost_cast(0))
             ssStereoEnergyDiff << "null";
         else
             ssStereoEnergyDiff << std::showpos << tCurrStereoEnergy-tLastStereoEnergy;
-    #if SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
-        // no control on label w/ fastpd (could decompose algo later on...)
-        lvLog_(2,"\t\tdisp      e = %d      (delta=%s)      [stereo-iter=%d]",(int)tCurrStereoEnergy,ssStereoEnergyDiff.str().c_str(),(int)nStereoMoveIter);
-    #else //!SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
-        lvLog_(2,"\t\tdisp [+label:%d]   e = %d   (delta=%s)      [stereo-iter=%d]",(int)nStereoAlphaLabel,(int)tCurrStereoEnergy,ssStereoEnergyDiff.str().c_str(),(int)nStereoMoveIter);
-    #endif //!SEGMMATCH_CONFIG_USE_FASTPD_STEREO_INF
+        if(eStereoSolver==InferenceSolver_FastPD) // no control on label w/ fastpd (could decompose algo later on...)
+            lvLog_(2,"\t\tdisp      e = %d      (delta=%s)      [stereo-iter=%d]",(int)tCurrStereoEnergy,ssStereoEnergyDiff.str().c_str(),(int)nStereoMoveIter);
+        else
+            lvLog_(2,"\t\tdisp [+label:%d]   e = %d   (delta=%s)      [stereo-iter=%d]",(int)nStereoAlphaLabel,(int)tCurrStereoEnergy,ssStereoEnergyDiff.str().c_str(),(int)nStereoMoveIter);
         if(bJustUpdatedSegm) // if segmentation changes, stereo priors change, thus energy can spike up
             lvLog(4,"\t\t\t(just updated segmentation)");
-        else
-            lvAssert_(tLastStereoEnergy>=tCurrStereoEnergy,"stereo energy not minimizing!");
+        else if(eStereoSolver!=InferenceSolver_FastPD) // fastpd ignores association costs, so no guarantee here
+            lvAssert_(tLastStereoEnergy>=tCurrStereoEnergy || bStereoMoveWithinGap,"stereo energy not minimizing!"); // tiled moves may stay within the allowed gap
         tLastStereoEnergy = tCurrStereoEnergy;
+        tTiledMoveRefStereoEnergy = std::min(tTiledMoveRefStereoEnergy,tCurrStereoEnergy);
+        if(m_pInferenceTrace)
+            m_pInferenceTrace->push_back(InferenceTracePoint{oLocalTimer.elapsed(),nStereoMoveIter,nResegmMoveIter,tCurrStereoEnergy,tLastResegmEnergy});
         bJustUpdatedSegm = false;
-        if(bResegmNext) {
+        if(bResegmNext && !m_bStereoOnly) { // stereo-only models keep the input masks as-is (no gmm or resegm passes)
             lvLog(4,"init resegm pass...");
             for(size_t nCamIdx=0; nCamIdx<nCameraCount; ++nCamIdx) {
                 if(nCamIdx!=m_nPrimaryCamIdx)
@@ -3314,12 +4099,16 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
             size_t nTotChangedResegmLabels=0,nConsecUnchangedResegmLabels=0;
             constexpr std::array<InternalLabelType,2> anResegmLabels = {s_nForegroundLabelIdx,s_nBackgroundLabelIdx};
             const size_t nInitResegmMoveIter = nResegmMoveIter;
-        #if SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF
-            sospd::SubmodularIBFS<ValueType,IndexType> oResegmMinimizer;
+        #if SEGMMATCH_HAVE_SOSPD_INF
+            std::unique_ptr<sospd::SubmodularIBFS<ValueType,IndexType>> pResegmIBFSMinimizer;
+            if(eResegmSolver==InferenceSolver_SoSPD)
+                pResegmIBFSMinimizer = std::make_unique<sospd::SubmodularIBFS<ValueType,IndexType>>();
             size_t nInternalResegmCliqueCount = 0;
-        #endif //SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF
+        #endif //SEGMMATCH_HAVE_SOSPD_INF
             TemporalArray<CamArray<size_t>> aanChangedResegmLabels{};
-            while((++nResegmMoveIter-nInitResegmMoveIter)<=m_nMaxResegmMoveCount && nConsecUnchangedResegmLabels<s_nResegmLabels) {
+            const double dMaxResegmTimeSec = m_oResegmSolverParams.dMaxTimeSec;
+            lv::StopWatch oResegmPassTimer;
+            while((++nResegmMoveIter-nInitResegmMoveIter)<=m_oResegmSolverParams.nMaxMoveCount && nConsecUnchangedResegmLabels<s_nResegmLabels && (dMaxResegmTimeSec<=0.0 || oResegmPassTimer.elapsed()<dMaxResegmTimeSec)) {
                 const bool bInitResegmIter = (nResegmMoveIter-nInitResegmMoveIter)==1u;
                 const bool bNewResegmIter = ((nResegmMoveIter-nInitResegmMoveIter)%s_nResegmLabels)==1u;
                 const InternalLabelType nResegmAlphaLabel = anResegmLabels[nResegmMoveIter%s_nResegmLabels];
@@ -3333,69 +4122,80 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
                     if(bNewResegmIter)
                         m_oSuperStackedResegmLabeling.copyTo(oPreResegmUpdateLabeling);
                 }
-            #if SEGMMATCH_CONFIG_USE_FGBZ_RESEGM_INF
-                calcResegmMoveCosts(nResegmAlphaLabel);
-                oResegmReducer.Clear();
-                oResegmReducer.AddVars((int)m_nValidResegmGraphNodes);
-                for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
-                    const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
-                    const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
-                    if(oNode.nUnaryFactID!=SIZE_MAX) {
-                        const ValueType& tUnaryCost = ((ValueType*)m_oResegmUnaryCosts.data)[nLUTNodeIdx];
-                        lvDbgAssert(&tUnaryCost==&m_oResegmUnaryCosts(oNode.nRowIdx+int((oNode.nCamIdx*nTemporalLayerCount+oNode.nLayerIdx)*m_oGridSize[0]),oNode.nColIdx));
-                        oResegmReducer.AddUnaryTerm((int)nGraphNodeIdx,tUnaryCost);
-                    }
-                    for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
-                        lv::gm::factorReducer<ExplicitFunction>(oNode.aPairwCliques[nOrientIdx],oResegmReducer,nResegmAlphaLabel,(InternalLabelType*)m_oSuperStackedResegmLabeling.data);
-                #if SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
-                    lv::gm::factorReducer<ExplicitFunction>(oNode.oTemporalClique,oResegmReducer,nResegmAlphaLabel,(InternalLabelType*)m_oSuperStackedResegmLabeling.data);
-                #endif //SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
-                }
-                oResegmMinimizer.Reset();
-                oResegmReducer.ToQuadratic(oResegmMinimizer);
-                oResegmMinimizer.Solve();
-                oResegmMinimizer.ComputeWeakPersistencies();
-                for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
-                    const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
-                    const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
-                    const int nMoveLabel = oResegmMinimizer.GetLabel((int)nGraphNodeIdx);
-                    lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
-                    if(nMoveLabel==1) { // node label changed to alpha
-                        ((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[nLUTNodeIdx] = nResegmAlphaLabel;
-                        ++aanChangedResegmLabels[oNode.nLayerIdx][oNode.nCamIdx];
+                switch(eResegmSolver) {
+                #if SEGMMATCH_HAVE_FGBZ_INF
+                    case InferenceSolver_FGBZ: {
+                        calcResegmMoveCosts(nResegmAlphaLabel);
+                        pResegmReducer->Clear();
+                        pResegmReducer->AddVars((int)m_nValidResegmGraphNodes);
+                        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
+                            const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
+                            const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
+                            if(oNode.nUnaryFactID!=SIZE_MAX) {
+                                const ValueType& tUnaryCost = ((ValueType*)m_oResegmUnaryCosts.data)[nLUTNodeIdx];
+                                lvDbgAssert(&tUnaryCost==&m_oResegmUnaryCosts(oNode.nRowIdx+int((oNode.nCamIdx*nTemporalLayerCount+oNode.nLayerIdx)*m_oGridSize[0]),oNode.nColIdx));
+                                pResegmReducer->AddUnaryTerm((int)nGraphNodeIdx,tUnaryCost);
+                            }
+                            for(size_t nOrientIdx=0; nOrientIdx<s_nPairwOrients; ++nOrientIdx)
+                                lv::gm::factorReducer<ExplicitFunction>(oNode.aPairwCliques[nOrientIdx],*pResegmReducer,nResegmAlphaLabel,(InternalLabelType*)m_oSuperStackedResegmLabeling.data);
+                        #if SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
+                            lv::gm::factorReducer<ExplicitFunction>(oNode.oTemporalClique,*pResegmReducer,nResegmAlphaLabel,(InternalLabelType*)m_oSuperStackedResegmLabeling.data);
+                        #endif //SEGMMATCH_CONFIG_USE_TEMPORAL_CONN
+                        }
+                        pResegmQPBOMinimizer->Reset();
+                        pResegmReducer->ToQuadratic(*pResegmQPBOMinimizer);
+                        pResegmQPBOMinimizer->Solve();
+                        pResegmQPBOMinimizer->ComputeWeakPersistencies();
+                        for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidResegmGraphNodes; ++nGraphNodeIdx) {
+                            const size_t nLUTNodeIdx = m_vResegmGraphIdxToMapIdxLUT[nGraphNodeIdx];
+                            const ResegmNodeInfo& oNode = m_vResegmNodeMap[nLUTNodeIdx];
+                            const int nMoveLabel = pResegmQPBOMinimizer->GetLabel((int)nGraphNodeIdx);
+                            lvDbgAssert(nMoveLabel==0 || nMoveLabel==1 || nMoveLabel<0);
+                            if(nMoveLabel==1) { // node label changed to alpha
+                                ((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[nLUTNodeIdx] = nResegmAlphaLabel;
+                                ++aanChangedResegmLabels[oNode.nLayerIdx][oNode.nCamIdx];
+                            }
+                        }
+                        break;
                     }
-                }
-            #elif SEGMMATCH_CONFIG_USE_SOSPD_RESEGM_INF
-                if(bNewResegmIter || SEGMMATCH_CONFIG_USE_CONT_RESEGM_UPDT) {
-                    if(bInitResegmIter) { // on the very first iteration, init minimizer with updated clique count
-                        nInternalResegmCliqueCount = initMinimizer(oResegmMinimizer,m_vResegmNodeMap,m_vResegmGraphIdxToMapIdxLUT);
-                        lvDbgAssert(nInternalResegmCliqueCount<=m_nResegmCliqueCount);
+                #endif //SEGMMATCH_HAVE_FGBZ_INF
+                #if SEGMMATCH_HAVE_SOSPD_INF
+                    case InferenceSolver_SoSPD: {
+                        if(bNewResegmIter || SEGMMATCH_CONFIG_USE_CONT_RESEGM_UPDT) {
+                            if(bInitResegmIter) { // on the very first iteration, init minimizer with updated clique count
+                                nInternalResegmCliqueCount = initMinimizer(*pResegmIBFSMinimizer,m_vResegmNodeMap,m_vResegmGraphIdxToMapIdxLUT);
+                                lvDbgAssert(nInternalResegmCliqueCount<=m_nResegmCliqueCount);
+                            }
+                            const size_t nSetupResegmCliqueCount = setupPrimalDual<ExplicitFunction>(m_vResegmNodeMap,m_vResegmGraphIdxToMapIdxLUT,m_oSuperStackedResegmLabeling,m_oResegmDualMap,m_oResegmHeightMap,s_nResegmLabels,m_nResegmCliqueCount);
+                            lvAssert(nSetupResegmCliqueCount==nInternalResegmCliqueCount && nSetupResegmCliqueCount<=m_nResegmCliqueCount);
+                        }
+                        calcResegmMoveCosts(nResegmAlphaLabel);
+                        const bool bResegmMoveCanFlipLabels = std::any_of(ResegmGraphNodeIter(this,0),ResegmGraphNodeIter(this,m_nValidResegmGraphNodes),[&](const ResegmNodeInfo& oNode) {
+                            return (((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[oNode.nLUTIdx])!=nResegmAlphaLabel;
+                        });
+                        //cv::Mat costtest;
+                        //m_oResegmUnaryCosts.convertTo(costtest,CV_32F);
+                        //cv::normalize(costtest,costtest,1,0,cv::NORM_MINMAX,-1,m_oSuperStackedROI);
+                        //cv::resize(costtest,costtest,cv::Size(),0.25,0.25);
+                        //cv::imshow("costtest",costtest);
+                        //cv::waitKey(1);
+                        if(bResegmMoveCanFlipLabels)
+                            solvePrimalDual<ExplicitFunction>(*pResegmIBFSMinimizer,
+                                                              m_vResegmNodeMap,
+                                                              m_vResegmGraphIdxToMapIdxLUT,
+                                                              m_oResegmUnaryCosts,
+                                                              m_oSuperStackedResegmLabeling,
+                                                              m_oResegmDualMap,
+                                                              m_oResegmHeightMap,
+                                                              nResegmAlphaLabel,
+                                                              s_nResegmLabels,false,
+                                                              aanChangedResegmLabels);
+                        break;
                     }
-                    const size_t nSetupResegmCliqueCount = setupPrimalDual<ExplicitFunction>(m_vResegmNodeMap,m_vResegmGraphIdxToMapIdxLUT,m_oSuperStackedResegmLabeling,m_oResegmDualMap,m_oResegmHeightMap,s_nResegmLabels,m_nResegmCliqueCount);
-                    lvAssert(nSetupResegmCliqueCount==nInternalResegmCliqueCount && nSetupResegmCliqueCount<=m_nResegmCliqueCount);
+                #endif //SEGMMATCH_HAVE_SOSPD_INF
+                    default:
+                        lvError("unsupported resegm inference solver");
                 }
-                calcResegmMoveCosts(nResegmAlphaLabel);
-                const bool bResegmMoveCanFlipLabels = std::any_of(ResegmGraphNodeIter(this,0),ResegmGraphNodeIter(this,m_nValidResegmGraphNodes),[&](const ResegmNodeInfo& oNode) {
-                    return (((InternalLabelType*)m_oSuperStackedResegmLabeling.data)[oNode.nLUTIdx])!=nResegmAlphaLabel;
-                });
-                //cv::Mat costtest;
-                //m_oResegmUnaryCosts.convertTo(costtest,CV_32F);
-                //cv::normalize(costtest,costtest,1,0,cv::NORM_MINMAX,-1,m_oSuperStackedROI);
-                //cv::resize(costtest,costtest,cv::Size(),0.25,0.25);
-                //cv::imshow("costtest",costtest);
-                //cv::waitKey(1);
-                if(bResegmMoveCanFlipLabels)
-                    solvePrimalDual<ExplicitFunction>(oResegmMinimizer,
-                                                      m_vResegmNodeMap,
-                                                      m_vResegmGraphIdxToMapIdxLUT,
-                                                      m_oResegmUnaryCosts,
-                                                      m_oSuperStackedResegmLabeling,
-                                                      m_oResegmDualMap,
-                                                      m_oResegmHeightMap,
-                                                      nResegmAlphaLabel,
-                                                      s_nResegmLabels,false,
-                                                      aanChangedResegmLabels);
-            #endif //SEGMMATCH_CONFIG_USE_..._RESEGM_INF
                 const ValueType tCurrResegmEnergy = m_pResegmInf->value();
                 lvDbgAssert(tCurrResegmEnergy>=cost_cast(0));
                 std::stringstream ssResegmEnergyDiff;
@@ -3406,6 +4206,8 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
                 lvLog_(2,"\t\tsegm [+%s]   e = %d   (delta=%s)      [resegm-iter=%d]",(nResegmAlphaLabel==s_nForegroundLabelIdx?"fg":"bg"),(int)tCurrResegmEnergy,ssResegmEnergyDiff.str().c_str(),(int)nResegmMoveIter);
                 // note: resegm energy cannot be strictly minimized every iteration since segmentation priors continually change in the loop (it should however stabilize over time)
                 tLastResegmEnergy = tCurrResegmEnergy;
+                if(m_pInferenceTrace)
+                    m_pInferenceTrace->push_back(InferenceTracePoint{oLocalTimer.elapsed(),nStereoMoveIter,nResegmMoveIter,tLastStereoEnergy,tCurrResegmEnergy});
                 if(lv::getVerbosity()>=3) {
                     for(size_t nLayerIdx=0; nLayerIdx<nTemporalLayerCount; ++nLayerIdx) {
                         if(m_nFramesProcessed>=nLayerIdx) {
@@ -3435,7 +4237,7 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
                 }
             }
             if(nTotChangedResegmLabels) {
-                calcShapeFeatures(m_aaResegmLabelings[0],m_avFeatures[0]); // only need to update latest labeling set for stereo
+                calcShapeFeatures(m_aaResegmLabelings[0],m_avFeatures[0],true); // only need to update latest labeling set for stereo
             #if SEGMMATCH_CONFIG_USE_FULL_DISP_RESETS
                 updateStereoModel(false);
                 resetStereoLabelings();
@@ -3448,7 +4250,7 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
             #if SEGMMATCH_CONFIG_USE_FULL_DISP_RESETS
                 resetStereoLabelings();
             #endif //SEGMMATCH_CONFIG_USE_FULL_DISP_RESETS
-                bJustUpdatedSegm = true;
+                bJustUpdatedSegm = bStereoModelUpdated = true;
                 nConsecUnchangedStereoLabels = 0;
             }
             const double dStereoIterChangeFraction = ((double)cv::countNonZero(oPreStereoUpdateLabeling^m_oSuperStackedResegmLabeling))/m_oSuperStackedResegmLabeling.total();
@@ -3475,6 +4277,77 @@ opengm::InferenceTermination SegmMatcher::GraphModelData::infer() {
     return opengm::InferenceTermination::NORMAL;
 }
 
+void SegmMatcher::GraphModelData::saveInferenceState(InferenceState& oState) {
+    lvDbgExceptionWatch;
+    m_oSuperStackedStereoLabeling.copyTo(oState.oStereoLabeling);
+    m_oSuperStackedResegmLabeling.copyTo(oState.oResegmLabeling);
+    for(size_t nLayerIdx=0; nLayerIdx<getTemporalLayerCount(); ++nLayerIdx) {
+        oState.avFeatures[nLayerIdx].resize(m_avFeatures[nLayerIdx].size());
+        for(size_t nFeatsIdx=0; nFeatsIdx<m_avFeatures[nLayerIdx].size(); ++nFeatsIdx)
+            m_avFeatures[nLayerIdx][nFeatsIdx].copyTo(oState.avFeatures[nLayerIdx][nFeatsIdx]);
+    }
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        m_aShpDescs[nCamIdx].copyTo(oState.aShpDescs[nCamIdx]);
+        m_aShpContourPts[nCamIdx].copyTo(oState.aShpContourPts[nCamIdx]);
+    }
+    const auto lSaveGMM = [](auto& oModel, std::vector<double>& vModelData) {
+        vModelData.assign(oModel.getModelData(),oModel.getModelData()+oModel.getModelSize());
+    };
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        lSaveGMM(m_aFGModels_3ch[nCamIdx],oState.avFGModelData_3ch[nCamIdx]);
+        lSaveGMM(m_aBGModels_3ch[nCamIdx],oState.avBGModelData_3ch[nCamIdx]);
+        lSaveGMM(m_aFGModels_1ch[nCamIdx],oState.avFGModelData_1ch[nCamIdx]);
+        lSaveGMM(m_aBGModels_1ch[nCamIdx],oState.avBGModelData_1ch[nCamIdx]);
+    }
+    oState.vStereoPairwWeights.resize(m_nValidStereoGraphNodes*s_nPairwOrients);
+    oState.vStereoUpdatedCliques.resize(m_nValidStereoGraphNodes);
+    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+        const StereoNodeInfo& oNode = m_vStereoNodeMap[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]];
+        std::copy_n(oNode.afPairwWeights.begin(),s_nPairwOrients,oState.vStereoPairwWeights.begin()+nGraphNodeIdx*s_nPairwOrients);
+        oState.vStereoUpdatedCliques[nGraphNodeIdx] = uchar(oNode.bUpdatedCliques);
+    }
+#if SEGMMATCH_HAVE_SOSPD_INF
+    m_oStereoDualMap.copyTo(oState.oStereoDualMap);
+#endif //SEGMMATCH_HAVE_SOSPD_INF
+}
+
+void SegmMatcher::GraphModelData::loadInferenceState(const InferenceState& oState) {
+    lvDbgExceptionWatch;
+    lvAssert_(lv::MatInfo(oState.oStereoLabeling)==lv::MatInfo(m_oSuperStackedStereoLabeling),"bad stereo labeling size/type in saved state");
+    lvAssert_(lv::MatInfo(oState.oResegmLabeling)==lv::MatInfo(m_oSuperStackedResegmLabeling),"bad resegm labeling size/type in saved state");
+    // labelings must be copied in-place, as per-layer/per-cam matrices are views into the super-stacked versions
+    oState.oStereoLabeling.copyTo(m_oSuperStackedStereoLabeling);
+    oState.oResegmLabeling.copyTo(m_oSuperStackedResegmLabeling);
+    for(size_t nLayerIdx=0; nLayerIdx<getTemporalLayerCount(); ++nLayerIdx) {
+        m_avFeatures[nLayerIdx].resize(oState.avFeatures[nLayerIdx].size());
+        for(size_t nFeatsIdx=0; nFeatsIdx<oState.avFeatures[nLayerIdx].size(); ++nFeatsIdx)
+            oState.avFeatures[nLayerIdx][nFeatsIdx].copyTo(m_avFeatures[nLayerIdx][nFeatsIdx]);
+    }
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        oState.aShpDescs[nCamIdx].copyTo(m_aShpDescs[nCamIdx]);
+        oState.aShpContourPts[nCamIdx].copyTo(m_aShpContourPts[nCamIdx]);
+    }
+    const auto lLoadGMM = [](auto& oModel, const std::vector<double>& vModelData) {
+        lvAssert_(vModelData.size()==oModel.getModelSize(),"bad gmm model size in saved state");
+        std::copy(vModelData.begin(),vModelData.end(),oModel.getModelData());
+    };
+    for(size_t nCamIdx=0; nCamIdx<getCameraCount(); ++nCamIdx) {
+        lLoadGMM(m_aFGModels_3ch[nCamIdx],oState.avFGModelData_3ch[nCamIdx]);
+        lLoadGMM(m_aBGModels_3ch[nCamIdx],oState.avBGModelData_3ch[nCamIdx]);
+        lLoadGMM(m_aFGModels_1ch[nCamIdx],oState.avFGModelData_1ch[nCamIdx]);
+        lLoadGMM(m_aBGModels_1ch[nCamIdx],oState.avBGModelData_1ch[nCamIdx]);
+    }
+    lvAssert_(oState.vStereoPairwWeights.size()==m_nValidStereoGraphNodes*s_nPairwOrients && oState.vStereoUpdatedCliques.size()==m_nValidStereoGraphNodes,"bad stereo node count in saved state");
+    for(size_t nGraphNodeIdx=0; nGraphNodeIdx<m_nValidStereoGraphNodes; ++nGraphNodeIdx) {
+        const StereoNodeInfo& oNode = m_vStereoNodeMap[m_vStereoGraphIdxToMapIdxLUT[nGraphNodeIdx]];
+        std::copy_n(oState.vStereoPairwWeights.begin()+nGraphNodeIdx*s_nPairwOrients,s_nPairwOrients,oNode.afPairwWeights.begin());
+        oNode.bUpdatedCliques = bool(oState.vStereoUpdatedCliques[nGraphNodeIdx]);
+    }
+#if SEGMMATCH_HAVE_SOSPD_INF
+    oState.oStereoDualMap.copyTo(m_oStereoDualMap);
+#endif //SEGMMATCH_HAVE_SOSPD_INF
+}
+
 cv::Mat SegmMatcher::GraphModelData::getResegmMapDisplay(size_t nLayerIdx, size_t nCamIdx) const {
     lvDbgExceptionWatch;
     lvAssert_(nLayerIdx<getTemporalLayerCount(),"layer index out of range");
@@ -368,14 +368,6 @@ void lv::computeImageAffinity(const cv::Mat& oImage1, const cv::Mat& oImage2, in
     lvAssert_(nPatchSize>=1 && (nPatchSize%2)==1,"bad patch size");
     lvAssert_(nPatchSize<=oImage1.rows && nPatchSize<=oImage1.cols,"patch too large for input images");
     lvAssert_(vDispRange.size()>=1,"bad disparity range");
-    cv::Mat_<uchar> oImage1_uchar,oImage2_uchar;
-    if(eDist==lv::AffinityDist_MI) {
-        lvAssert_(oImage1.type()==oImage2.type() && oImage1.type()==CV_8UC1,"bad input image types/depth");
-        oImage1_uchar = oImage1;
-        oImage2_uchar = oImage2;
-    }
-    else /*if(eDist==lv::AffinityDist_SSD)*/
-        lvAssert_(oImage1.type()==oImage2.type() && oImage1.channels()==1,"bad input image types/depth");
     const bool bValidROI1 = !oROI1.empty();
     const bool bValidROI2 = !oROI2.empty();
     const int nRows = oImage1.rows;
@@ -385,7 +377,27 @@ void lv::computeImageAffinity(const cv::Mat& oImage1, const cv::Mat& oImage2, in
     const std::array<int,3> anAffinityMapDims = {nRows-nPatchRadius*2,nCols-nPatchRadius*2,nOffsets};
     oAffinityMap.create(3,anAffinityMapDims.data());
     oAffinityMap = -1.0f; // default value for OOB pixels
-    thread_local lv::JointSparseHistData<uchar,uchar> oSparseHistData;
+    if(eDist==lv::AffinityDist_MI) {
+        lvAssert_(oImage1.type()==oImage2.type() && oImage1.type()==CV_8UC1,"bad input image types/depth");
+        // dense MI scores are computed with sliding joint histograms instead of rebuilding one per window/offset pair
+        // (the full-size score map is scoped to this call so that its memory does not outlive it)
+        cv::Mat_<float> oMutualInfoMap;
+        MutualInfo(cv::Size(nPatchSize,nPatchSize),true).compute2(oImage1,oImage2,vDispRange,oMutualInfoMap,oROI1,oROI2);
+    #if USING_OPENMP
+        #pragma omp parallel for
+    #endif //USING_OPENMP
+        for(int nRowIdx=nPatchRadius; nRowIdx<nRows-nPatchRadius; ++nRowIdx) {
+            for(int nColIdx=nPatchRadius; nColIdx<nCols-nPatchRadius; ++nColIdx) {
+                const float* pMutualInfoScores = oMutualInfoMap.ptr<float>(nRowIdx,nColIdx);
+                float* pAffinity = oAffinityMap.ptr<float>(nRowIdx-nPatchRadius,nColIdx-nPatchRadius);
+                for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx)
+                    if(pMutualInfoScores[nOffsetIdx]>=0.0f)
+                        pAffinity[nOffsetIdx] = std::max(1.0f-pMutualInfoScores[nOffsetIdx],0.0f);
+            }
+        }
+        return;
+    }
+    lvAssert_(oImage1.type()==oImage2.type() && oImage1.channels()==1,"bad input image types/depth");
 #if USING_OPENMP
 #ifdef _MSC_VER
     #pragma omp parallel for // msvc only supports openmp 2.0
@@ -402,17 +414,245 @@ void lv::computeImageAffinity(const cv::Mat& oImage1, const cv::Mat& oImage2, in
                     continue;
                 const cv::Rect oWindow(nColIdx-nPatchRadius,nRowIdx-nPatchRadius,nPatchSize,nPatchSize);
                 const cv::Rect oOffsetWindow(nOffsetColIdx-nPatchRadius,nRowIdx-nPatchRadius,nPatchSize,nPatchSize);
-                if(eDist==lv::AffinityDist_MI) {
-                    const double dMutualInfoScore = lv::calcMutualInfo<1,true,true,false,false>(oImage1_uchar(oWindow),oImage2_uchar(oOffsetWindow),&oSparseHistData);
-                    oAffinityMap.at<float>(nRowIdx-nPatchRadius,nColIdx-nPatchRadius,nOffsetIdx) = std::max(float(1.0-dMutualInfoScore),0.0f);
+                oAffinityMap.at<float>(nRowIdx-nPatchRadius,nColIdx-nPatchRadius,nOffsetIdx) = (float)cv::norm(oImage1(oWindow),oImage2(oOffsetWindow),cv::NORM_L2);
+            }
+        }
+    }
+}
+
+namespace {
+
+    /// converts a float to the nearest IEEE 754 binary16 value (with round-half-to-even, subnormals & inf/nan support) and returns its raw bits
+    inline ushort float2half(float fVal) {
+        uint nBits;
+        std::memcpy(&nBits,&fVal,sizeof(float));
+        const uint nSign = (nBits>>16)&0x8000u;
+        nBits &= 0x7FFFFFFFu;
+        if(nBits>=0x47800000u) // overflow, inf or nan
+            return ushort(nSign|((nBits>0x7F800000u)?0x7E00u:0x7C00u));
+        if(nBits<0x38800000u) { // subnormal half or zero
+            if(nBits<0x33000000u)
+                return ushort(nSign);
+            const uint nShift = 126u-(nBits>>23);
+            const uint nMantissa = (nBits&0x7FFFFFu)|0x800000u;
+            const uint nRemainder = nMantissa&((1u<<nShift)-1u), nHalfway = 1u<<(nShift-1u);
+            uint nHalf = nMantissa>>nShift;
+            nHalf += uint(nRemainder>nHalfway || (nRemainder==nHalfway && (nHalf&1u)));
+            return ushort(nSign|nHalf);
+        }
+        const uint nRemainder = nBits&0x1FFFu;
+        uint nHalf = (nBits-0x38000000u)>>13; // rebias exponent from 127 to 15
+        nHalf += uint(nRemainder>0x1000u || (nRemainder==0x1000u && (nHalf&1u))); // mantissa carry correctly rolls into exponent (and up to inf)
+        return ushort(nSign|nHalf);
+    }
+
+    /// converts the raw bits of an IEEE 754 binary16 value to a float
+    inline float half2float(ushort nHalf) {
+        const uint nSign = uint(nHalf&0x8000u)<<16;
+        uint nExponent = (nHalf>>10)&0x1Fu, nMantissa = nHalf&0x3FFu, nBits;
+        if(nExponent==0x1Fu) // inf or nan
+            nBits = nSign|0x7F800000u|(nMantissa<<13);
+        else if(nExponent) // normal
+            nBits = nSign|((nExponent+112u)<<23)|(nMantissa<<13);
+        else if(nMantissa) { // subnormal, needs to be normalized
+            nExponent = 113u;
+            while(!(nMantissa&0x400u)) {
+                nMantissa <<= 1;
+                --nExponent;
+            }
+            nBits = nSign|(nExponent<<23)|((nMantissa&0x3FFu)<<13);
+        }
+        else
+            nBits = nSign;
+        float fVal;
+        std::memcpy(&fVal,&nBits,sizeof(float));
+        return fVal;
+    }
+
+    /// validates the storage type & params of a (possibly) quantized 3d descriptor map
+    inline void checkQuantDescMap(const cv::Mat& oQuantDescMap, const cv::Mat_<float>& oQuantParams) {
+        lvAssert_(oQuantDescMap.isContinuous(),"quantized desc maps must be continuous");
+        lvAssert_(oQuantDescMap.type()==CV_32FC1 || oQuantDescMap.type()==CV_16UC1 || oQuantDescMap.type()==CV_8UC1,"unsupported desc map storage type");
+        lvAssert_(oQuantDescMap.type()!=CV_8UC1 || (oQuantParams.rows==2 && oQuantParams.cols==oQuantDescMap.size[2]),"bad quantization params for 8-bit desc map");
+    }
+
+    /// returns a pointer to the full-precision descriptors of a map row, decoding them in the given buffer if needed
+    inline const float* decodeDescMapRow(const cv::Mat& oQuantDescMap, const cv::Mat_<float>& oQuantParams, int nRowIdx, lv::AutoBuffer<float>& aBuffer) {
+        const int nCols = oQuantDescMap.size[1];
+        const int nDescSize = oQuantDescMap.size[2];
+        if(oQuantDescMap.depth()==CV_32F)
+            return oQuantDescMap.ptr<float>(nRowIdx);
+        aBuffer.resize(size_t(nCols)*nDescSize);
+        float* pOutput = aBuffer.data();
+        if(oQuantDescMap.depth()==CV_16U) {
+            const ushort* pInput = oQuantDescMap.ptr<ushort>(nRowIdx);
+            for(size_t nValIdx=0; nValIdx<size_t(nCols)*nDescSize; ++nValIdx)
+                pOutput[nValIdx] = half2float(pInput[nValIdx]);
+        }
+        else /*if(oQuantDescMap.depth()==CV_8U)*/ {
+            const uchar* pInput = oQuantDescMap.ptr<uchar>(nRowIdx);
+            const float* pOffsets = oQuantParams.ptr<float>(0);
+            const float* pScales = oQuantParams.ptr<float>(1);
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx, pInput+=nDescSize, pOutput+=nDescSize)
+                for(int nChIdx=0; nChIdx<nDescSize; ++nChIdx)
+                    pOutput[nChIdx] = pOffsets[nChIdx]+pScales[nChIdx]*pInput[nChIdx];
+        }
+        return aBuffer.data();
+    }
+
+    /// returns the L2 distance between two float descriptors (squares are accumulated in double precision, as in cv::norm, but in a different order, so results only match it within float ULP tolerance)
+    inline float calcDescL2Dist(const float* pDesc1, const float* pDesc2, int nDescSize) {
+        int nIdx = 0;
+        double dSqrDist = 0.0;
+    #if HAVE_SSE2
+        __m128d adAccum = _mm_setzero_pd();
+    #if HAVE_AVX
+        __m256d adAccumLo = _mm256_setzero_pd(), adAccumHi = _mm256_setzero_pd();
+        for(; nIdx+8<=nDescSize; nIdx+=8) {
+            const __m256 afDiff = _mm256_sub_ps(_mm256_loadu_ps(pDesc1+nIdx),_mm256_loadu_ps(pDesc2+nIdx));
+            const __m256d adDiffLo = _mm256_cvtps_pd(_mm256_castps256_ps128(afDiff));
+            const __m256d adDiffHi = _mm256_cvtps_pd(_mm256_extractf128_ps(afDiff,1));
+            adAccumLo = _mm256_add_pd(adAccumLo,_mm256_mul_pd(adDiffLo,adDiffLo));
+            adAccumHi = _mm256_add_pd(adAccumHi,_mm256_mul_pd(adDiffHi,adDiffHi));
+        }
+        const __m256d adAccum4 = _mm256_add_pd(adAccumLo,adAccumHi);
+        adAccum = _mm_add_pd(_mm256_castpd256_pd128(adAccum4),_mm256_extractf128_pd(adAccum4,1));
+    #endif //HAVE_AVX
+        for(; nIdx+4<=nDescSize; nIdx+=4) {
+            const __m128 afDiff = _mm_sub_ps(_mm_loadu_ps(pDesc1+nIdx),_mm_loadu_ps(pDesc2+nIdx));
+            const __m128d adDiffLo = _mm_cvtps_pd(afDiff);
+            const __m128d adDiffHi = _mm_cvtps_pd(_mm_movehl_ps(afDiff,afDiff));
+            adAccum = _mm_add_pd(adAccum,_mm_add_pd(_mm_mul_pd(adDiffLo,adDiffLo),_mm_mul_pd(adDiffHi,adDiffHi)));
+        }
+        dSqrDist = _mm_cvtsd_f64(_mm_add_sd(adAccum,_mm_unpackhi_pd(adAccum,adAccum)));
+    #endif //HAVE_SSE2
+        for(; nIdx<nDescSize; ++nIdx) {
+            const double dDiff = double(pDesc1[nIdx]-pDesc2[nIdx]);
+            dSqrDist += dDiff*dDiff;
+        }
+        return float(std::sqrt(dSqrDist));
+    }
+
+    /// computes the pixel-wise raw affinities of one map row for all disparity offsets (OOB/masked values are left untouched)
+    void calcRawDescAffinityRow(const float* pDescRow1, const float* pDescRow2, int nRowIdx, int nCols, int nDescSize,
+                                const std::vector<int>& vDispRange, lv::AffinityDistType eDist, const cv::Mat_<uchar>& oROI1,
+                                const cv::Mat_<uchar>& oROI2, const cv::Mat_<float>& oEMDCostMap, cv::Mat_<float>& oRawAffinity) {
+        const bool bValidROI1 = !oROI1.empty();
+        const bool bValidROI2 = !oROI2.empty();
+        const int nOffsets = int(vDispRange.size());
+        for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+            if(bValidROI1 && !oROI1(nRowIdx,nColIdx))
+                continue;
+            float* pRawAffinityPtr = oRawAffinity.ptr<float>(nRowIdx,nColIdx);
+            const float* pDesc = pDescRow1+size_t(nColIdx)*nDescSize;
+            for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+                const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
+                if(nOffsetColIdx<0 || nOffsetColIdx>=nCols || (bValidROI2 && !oROI2(nRowIdx,nOffsetColIdx)))
+                    continue;
+                const float* pOffsetDesc = pDescRow2+size_t(nOffsetColIdx)*nDescSize;
+                if(eDist==lv::AffinityDist_L2)
+                    pRawAffinityPtr[nOffsetIdx] = calcDescL2Dist(pDesc,pOffsetDesc,nDescSize);
+                else /*if(eDist==lv::AffinityDist_EMD)*/ {
+                    const cv::Mat_<float> oDesc(nDescSize,1,const_cast<float*>(pDesc));
+                    const cv::Mat_<float> oOffsetDesc(nDescSize,1,const_cast<float*>(pOffsetDesc));
+                    lvDbgAssert_(!std::all_of(pDesc,pDesc+nDescSize,[](float v){
+                        lvDbgAssert(v>=0.0f);
+                        return v==0.0f;
+                    }),"opencv emd cannot handle null descriptors");
+                    lvDbgAssert_(!std::all_of(pOffsetDesc,pOffsetDesc+nDescSize,[](float v){
+                        lvDbgAssert(v>=0.0f);
+                        return v==0.0f;
+                    }),"opencv emd cannot handle null descriptors");
+                    pRawAffinityPtr[nOffsetIdx] = cv::EMD(oDesc,oOffsetDesc,-1,oEMDCostMap);
+                    lvDbgAssert(pRawAffinityPtr[nOffsetIdx]>=0.0f);
                 }
-                else /*if(eDist==lv::AffinityDist_SSD)*/ {
-                    oAffinityMap.at<float>(nRowIdx-nPatchRadius,nColIdx-nPatchRadius,nOffsetIdx) = (float)cv::norm(oImage1(oWindow),oImage2(oOffsetWindow),cv::NORM_L2);
+            }
+        }
+    }
+
+    /// averages pixel-wise raw affinities over square patches, ignoring OOB (-1) values
+    void aggregateRawAffinity(const cv::Mat_<float>& oRawAffinity, int nPatchSize, cv::Mat_<float>& oAffinityMap) {
+        lvDbgAssert(oRawAffinity.isContinuous() && oAffinityMap.isContinuous() && oRawAffinity.size==oAffinityMap.size);
+        const int nRows = oRawAffinity.size[0];
+        const int nCols = oRawAffinity.size[1];
+        const int nOffsets = oRawAffinity.size[2];
+        const int nRowValues = nCols*nOffsets;
+        const int nPatchRadius = nPatchSize/2;
+        // patch sums are separable: valid values & counts are first summed over the vertical window (for all columns/offsets at once, sliding
+        // down a block of rows), then over the horizontal window (sliding across the columns); all sums are kept in double precision, but
+        // running sums add/subtract values in a different order than a direct per-patch sum, so outputs are equal only within float ULP tolerance
+        const int nRowBlockSize = 16;
+        const int nRowBlocks = (nRows+nRowBlockSize-1)/nRowBlockSize;
+    #if USING_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif //USING_OPENMP
+        for(int nRowBlockIdx=0; nRowBlockIdx<nRowBlocks; ++nRowBlockIdx) {
+            static thread_local lv::AutoBuffer<double> s_adColSums,s_adPatchSums;
+            static thread_local lv::AutoBuffer<int> s_anColCounts,s_anPatchCounts;
+            s_adColSums.resize(size_t(nRowValues));
+            s_anColCounts.resize(size_t(nRowValues));
+            s_adPatchSums.resize(size_t(nOffsets));
+            s_anPatchCounts.resize(size_t(nOffsets));
+            double* adColSums = s_adColSums.data();
+            int* anColCounts = s_anColCounts.data();
+            double* adPatchSums = s_adPatchSums.data();
+            int* anPatchCounts = s_anPatchCounts.data();
+            const auto lAddRow = [&](int nRawRowIdx, double dSign, int nSign) {
+                const float* pRawAffinity = oRawAffinity.ptr<float>(nRawRowIdx);
+                for(int nValIdx=0; nValIdx<nRowValues; ++nValIdx) {
+                    const bool bValid = (pRawAffinity[nValIdx]!=-1.0f);
+                    adColSums[nValIdx] += bValid?dSign*pRawAffinity[nValIdx]:0.0;
+                    anColCounts[nValIdx] += bValid?nSign:0;
+                }
+            };
+            const int nFirstRowIdx = nRowBlockIdx*nRowBlockSize;
+            const int nLastRowIdx = std::min(nFirstRowIdx+nRowBlockSize,nRows)-1;
+            for(int nRowIdx=nFirstRowIdx; nRowIdx<=nLastRowIdx; ++nRowIdx) {
+                if(nRowIdx==nFirstRowIdx) {
+                    std::fill_n(adColSums,nRowValues,0.0);
+                    std::fill_n(anColCounts,nRowValues,0);
+                    for(int nPatchRowIdx=std::max(nRowIdx-nPatchRadius,0); nPatchRowIdx<=std::min(nRowIdx+nPatchRadius,nRows-1); ++nPatchRowIdx)
+                        lAddRow(nPatchRowIdx,1.0,1);
+                }
+                else {
+                    if(nRowIdx+nPatchRadius<nRows)
+                        lAddRow(nRowIdx+nPatchRadius,1.0,1);
+                    if(nRowIdx-nPatchRadius-1>=0)
+                        lAddRow(nRowIdx-nPatchRadius-1,-1.0,-1);
+                }
+                std::fill_n(adPatchSums,nOffsets,0.0);
+                std::fill_n(anPatchCounts,nOffsets,0);
+                for(int nPatchColIdx=0; nPatchColIdx<std::min(nPatchRadius,nCols); ++nPatchColIdx) {
+                    for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+                        adPatchSums[nOffsetIdx] += adColSums[nPatchColIdx*nOffsets+nOffsetIdx];
+                        anPatchCounts[nOffsetIdx] += anColCounts[nPatchColIdx*nOffsets+nOffsetIdx];
+                    }
+                }
+                float* pAffinity = oAffinityMap.ptr<float>(nRowIdx);
+                for(int nColIdx=0; nColIdx<nCols; ++nColIdx, pAffinity+=nOffsets) {
+                    if(nColIdx+nPatchRadius<nCols) {
+                        const int nAddIdx = (nColIdx+nPatchRadius)*nOffsets;
+                        for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+                            adPatchSums[nOffsetIdx] += adColSums[nAddIdx+nOffsetIdx];
+                            anPatchCounts[nOffsetIdx] += anColCounts[nAddIdx+nOffsetIdx];
+                        }
+                    }
+                    if(nColIdx-nPatchRadius-1>=0) {
+                        const int nRemoveIdx = (nColIdx-nPatchRadius-1)*nOffsets;
+                        for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+                            adPatchSums[nOffsetIdx] -= adColSums[nRemoveIdx+nOffsetIdx];
+                            anPatchCounts[nOffsetIdx] -= anColCounts[nRemoveIdx+nOffsetIdx];
+                        }
+                    }
+                    for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx)
+                        if(anPatchCounts[nOffsetIdx])
+                            pAffinity[nOffsetIdx] = float(adPatchSums[nOffsetIdx]/anPatchCounts[nOffsetIdx]);
                 }
             }
         }
     }
-}
+
+} // anonymous namespace
 
 void lv::computeDescriptorAffinity(const cv::Mat_<float>& oDescMap1, const cv::Mat_<float>& oDescMap2,
                                    int nPatchSize, cv::Mat_<float>& oAffinityMap, const std::vector<int>& vDispRange,
@@ -461,9 +701,6 @@ void lv::computeDescriptorAffinity(const cv::Mat_<float>& oDescMap1, const cv::M
         return;
     }
 #endif //HAVE_CUDA
-    const bool bValidROI1 = !oROI1.empty();
-    const bool bValidROI2 = !oROI2.empty();
-    const int nPatchRadius = nPatchSize/2;
     oAffinityMap.create(3,anAffinityMapDims.data());
     oAffinityMap = -1.0f; // default value for OOB pixels
     cv::Mat_<float> oRawAffinity; // used to cache pixel-wise descriptor distances
@@ -475,76 +712,142 @@ void lv::computeDescriptorAffinity(const cv::Mat_<float>& oDescMap1, const cv::M
     }
     else
         oRawAffinity = oAffinityMap;
+    // the row kernel below expects the descriptors of each map row to be packed
+    const bool bPackedRows = (oDescMap1.step[1]==oDescMap1.elemSize()*nDescSize && oDescMap2.step[1]==oDescMap2.elemSize()*nDescSize);
+    const cv::Mat_<float> oPackedDescMap1 = bPackedRows?oDescMap1:oDescMap1.clone();
+    const cv::Mat_<float> oPackedDescMap2 = bPackedRows?oDescMap2:oDescMap2.clone();
     lvDbgExceptionWatch;
 #if USING_OPENMP
-#ifdef _MSC_VER
-    #pragma omp parallel for // msvc only supports openmp 2.0
-#else //ndef(_MSC_VER)
-    #pragma omp parallel for collapse(2)
-#endif //ndef(_MSC_VER)
+    #pragma omp parallel for schedule(dynamic)
+#endif //USING_OPENMP
+    for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx)
+        calcRawDescAffinityRow(oPackedDescMap1.ptr<float>(nRowIdx),oPackedDescMap2.ptr<float>(nRowIdx),nRowIdx,nCols,nDescSize,vDispRange,eDist,oROI1,oROI2,oEMDCostMap,oRawAffinity);
+    if(nPatchSize==1)
+        return;
+    lvDbgExceptionWatch;
+    aggregateRawAffinity(oRawAffinity,nPatchSize,oAffinityMap);
+}
+
+void lv::computeDescriptorAffinity(const cv::Mat& oQuantDescMap1, const cv::Mat_<float>& oQuantParams1,
+                                   const cv::Mat& oQuantDescMap2, const cv::Mat_<float>& oQuantParams2, int nPatchSize,
+                                   cv::Mat_<float>& oAffinityMap, const std::vector<int>& vDispRange, AffinityDistType eDist,
+                                   const cv::Mat_<uchar>& oROI1, const cv::Mat_<uchar>& oROI2, const cv::Mat_<float>& oEMDCostMap) {
+    lvDbgExceptionWatch;
+    lvAssert_(!oQuantDescMap1.empty() && oQuantDescMap1.size==oQuantDescMap2.size && oQuantDescMap1.dims==3 && oQuantDescMap1.size[2]>1,"bad input desc map sizes");
+    lvAssert_(oQuantDescMap1.type()==oQuantDescMap2.type(),"input desc maps must have the same storage type");
+    lvAssert_(oROI1.empty() || (oROI1.dims==2 && oROI1.rows==oQuantDescMap1.size[0] && oROI1.cols==oQuantDescMap1.size[1]),"bad ROI1 map size");
+    lvAssert_(oROI2.empty() || (oROI2.dims==2 && oROI2.rows==oQuantDescMap2.size[0] && oROI2.cols==oQuantDescMap2.size[1]),"bad ROI2 map size");
+    lvAssert_(eDist==lv::AffinityDist_L2 || eDist==lv::AffinityDist_EMD,"unsupported distance type");
+    lvAssert_(nPatchSize>=1 && (nPatchSize%2)==1,"bad patch size");
+    lvAssert_(!vDispRange.empty(),"bad disparity range");
+    const int nRows = oQuantDescMap1.size[0];
+    const int nCols = oQuantDescMap1.size[1];
+    const int nDescSize = oQuantDescMap1.size[2];
+    checkQuantDescMap(oQuantDescMap1,oQuantParams1);
+    checkQuantDescMap(oQuantDescMap2,oQuantParams2);
+    if(eDist==lv::AffinityDist_EMD) {
+        lvAssert_(!oEMDCostMap.empty() && oEMDCostMap.dims==2 && oEMDCostMap.rows==oEMDCostMap.cols,"bad emd cost map size");
+        lvAssert_(oEMDCostMap.rows==nDescSize,"bad emd cost map size for given desc size");
+    }
+    const int nOffsets = int(vDispRange.size());
+    const std::array<int,3> anAffinityMapDims = {nRows,nCols,nOffsets};
+    oAffinityMap.create(3,anAffinityMapDims.data());
+    oAffinityMap = -1.0f; // default value for OOB pixels
+    cv::Mat_<float> oRawAffinity; // used to cache pixel-wise descriptor distances
+    static thread_local lv::AutoBuffer<float> s_aRawAffinityData;
+    if(nPatchSize>1) {
+        s_aRawAffinityData.resize(oAffinityMap.total());
+        oRawAffinity = cv::Mat_<float>(3,anAffinityMapDims.data(),s_aRawAffinityData.data());
+        oRawAffinity = -1.0f; // default value for OOB pixels
+    }
+    else
+        oRawAffinity = oAffinityMap;
+    lvDbgExceptionWatch;
+    // descriptors are decoded one map row at a time, so the (compact) maps are only streamed once, and decoding is amortized over all offsets
+#if USING_OPENMP
+    #pragma omp parallel for schedule(dynamic)
 #endif //USING_OPENMP
     for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
-        for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
-            if(bValidROI1 && !oROI1(nRowIdx,nColIdx))
-                continue;
-            float* pRawAffinityPtr = oRawAffinity.ptr<float>(nRowIdx,nColIdx);
-            for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
-                const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
-                if(nOffsetColIdx<0 || nOffsetColIdx>=nCols || (bValidROI2 && !oROI2(nRowIdx,nOffsetColIdx)))
-                    continue;
-                if(eDist==lv::AffinityDist_L2) {
-                    const cv::Mat_<float> oDesc(1,nDescSize,const_cast<float*>(oDescMap1.ptr<float>(nRowIdx,nColIdx)));
-                    const cv::Mat_<float> oOffsetDesc(1,nDescSize,const_cast<float*>(oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx)));
-                    pRawAffinityPtr[nOffsetIdx] = float(cv::norm(oDesc,oOffsetDesc,cv::NORM_L2));
-                    lvDbgAssert(pRawAffinityPtr[nOffsetIdx]>=0.0f && pRawAffinityPtr[nOffsetIdx]<=(float)M_SQRT2);
-                }
-                else /*if(eDist==lv::AffinityDist_EMD)*/ {
-                    const float* pDesc = oDescMap1.ptr<float>(nRowIdx,nColIdx);
-                    const float* pOffsetDesc = oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx);
-                    const cv::Mat_<float> oDesc(nDescSize,1,const_cast<float*>(pDesc));
-                    const cv::Mat_<float> oOffsetDesc(nDescSize,1,const_cast<float*>(pOffsetDesc));
-                    lvDbgAssert_(!std::all_of(pDesc,pDesc+nDescSize,[](float v){
-                        lvDbgAssert(v>=0.0f);
-                        return v==0.0f;
-                    }),"opencv emd cannot handle null descriptors");
-                    lvDbgAssert_(!std::all_of(pOffsetDesc,pOffsetDesc+nDescSize,[](float v){
-                        lvDbgAssert(v>=0.0f);
-                        return v==0.0f;
-                    }),"opencv emd cannot handle null descriptors");
-                    pRawAffinityPtr[nOffsetIdx] = cv::EMD(oDesc,oOffsetDesc,-1,oEMDCostMap);
-                    lvDbgAssert(pRawAffinityPtr[nOffsetIdx]>=0.0f);
-                }
-            }
-        }
+        static thread_local lv::AutoBuffer<float> s_aDescRowData1,s_aDescRowData2;
+        const float* pDescRow1 = decodeDescMapRow(oQuantDescMap1,oQuantParams1,nRowIdx,s_aDescRowData1);
+        const float* pDescRow2 = decodeDescMapRow(oQuantDescMap2,oQuantParams2,nRowIdx,s_aDescRowData2);
+        calcRawDescAffinityRow(pDescRow1,pDescRow2,nRowIdx,nCols,nDescSize,vDispRange,eDist,oROI1,oROI2,oEMDCostMap,oRawAffinity);
     }
     if(nPatchSize==1)
         return;
     lvDbgExceptionWatch;
+    aggregateRawAffinity(oRawAffinity,nPatchSize,oAffinityMap);
+}
+
+void lv::quantizeDescriptorMap(const cv::Mat_<float>& oDescMap, cv::Mat& oQuantDescMap, cv::Mat_<float>& oQuantParams, DescMapStorageType eType) {
+    lvAssert_(!oDescMap.empty() && oDescMap.dims==3 && oDescMap.isContinuous(),"bad input desc map");
+    lvAssert_(eType==DescMapStorage_Float || eType==DescMapStorage_Half || eType==DescMapStorage_UInt8,"unsupported storage type");
+    const int nDescSize = oDescMap.size[2];
+    const int nDescCount = int(oDescMap.total()/nDescSize);
+    if(eType==DescMapStorage_Float) {
+        oDescMap.copyTo(oQuantDescMap);
+        oQuantParams.release();
+        return;
+    }
+    const float* pDescMapData = (const float*)oDescMap.data;
+    if(eType==DescMapStorage_Half) {
+        oQuantDescMap.create(3,oDescMap.size,CV_16UC1);
+        ushort* pQuantDescMapData = (ushort*)oQuantDescMap.data;
+    #if USING_OPENMP
+        #pragma omp parallel for
+    #endif //USING_OPENMP
+        for(int nDescIdx=0; nDescIdx<nDescCount; ++nDescIdx)
+            for(size_t nValIdx=size_t(nDescIdx)*nDescSize; nValIdx<size_t(nDescIdx+1)*nDescSize; ++nValIdx)
+                pQuantDescMapData[nValIdx] = float2half(pDescMapData[nValIdx]);
+        oQuantParams.release();
+        return;
+    }
+    // 8-bit mode: each channel is mapped from its own [min,max] range to [0,255]
+    oQuantParams.create(2,nDescSize);
+    float* pOffsets = oQuantParams.ptr<float>(0);
+    float* pScales = oQuantParams.ptr<float>(1);
+    std::fill_n(pOffsets,nDescSize,std::numeric_limits<float>::max());
+    std::fill_n(pScales,nDescSize,std::numeric_limits<float>::lowest()); // holds max values until the scales are computed
+    for(int nDescIdx=0; nDescIdx<nDescCount; ++nDescIdx) {
+        const float* pDesc = pDescMapData+size_t(nDescIdx)*nDescSize;
+        for(int nChIdx=0; nChIdx<nDescSize; ++nChIdx) {
+            pOffsets[nChIdx] = std::min(pOffsets[nChIdx],pDesc[nChIdx]);
+            pScales[nChIdx] = std::max(pScales[nChIdx],pDesc[nChIdx]);
+        }
+    }
+    static thread_local lv::AutoBuffer<float> s_aInvScales;
+    s_aInvScales.resize(size_t(nDescSize));
+    float* pInvScales = s_aInvScales.data();
+    for(int nChIdx=0; nChIdx<nDescSize; ++nChIdx) {
+        pScales[nChIdx] = (pScales[nChIdx]-pOffsets[nChIdx])/float(UCHAR_MAX);
+        pInvScales[nChIdx] = (pScales[nChIdx]>0.0f)?(1.0f/pScales[nChIdx]):0.0f;
+    }
+    oQuantDescMap.create(3,oDescMap.size,CV_8UC1);
+    uchar* pQuantDescMapData = oQuantDescMap.data;
 #if USING_OPENMP
-#ifdef _MSC_VER
-    #pragma omp parallel for // msvc only supports openmp 2.0
-#else //ndef(_MSC_VER)
-    #pragma omp parallel for collapse(3)
-#endif //ndef(_MSC_VER)
+    #pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nDescIdx=0; nDescIdx<nDescCount; ++nDescIdx) {
+        const float* pDesc = pDescMapData+size_t(nDescIdx)*nDescSize;
+        uchar* pQuantDesc = pQuantDescMapData+size_t(nDescIdx)*nDescSize;
+        for(int nChIdx=0; nChIdx<nDescSize; ++nChIdx)
+            pQuantDesc[nChIdx] = cv::saturate_cast<uchar>((pDesc[nChIdx]-pOffsets[nChIdx])*pInvScales[nChIdx]);
+    }
+}
+
+void lv::dequantizeDescriptorMap(const cv::Mat& oQuantDescMap, const cv::Mat_<float>& oQuantParams, cv::Mat_<float>& oDescMap) {
+    lvAssert_(!oQuantDescMap.empty() && oQuantDescMap.dims==3,"bad input desc map");
+    checkQuantDescMap(oQuantDescMap,oQuantParams);
+    oDescMap.create(3,oQuantDescMap.size);
+    const int nRows = oQuantDescMap.size[0];
+    const int nRowValues = oQuantDescMap.size[1]*oQuantDescMap.size[2];
+#if USING_OPENMP
+    #pragma omp parallel for
 #endif //USING_OPENMP
     for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
-        for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
-            for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
-                size_t nValidCount = size_t(0);
-                double afAccumAff = 0.0f;
-                for(int nPatchRowIdx=std::max(nRowIdx-nPatchRadius,0); nPatchRowIdx<=std::min(nRowIdx+nPatchRadius,nRows-1); ++nPatchRowIdx) {
-                    for(int nPatchColIdx=std::max(nColIdx-nPatchRadius,0); nPatchColIdx<=std::min(nColIdx+nPatchRadius,nCols-1); ++nPatchColIdx) {
-                        const float* pRawAffinityPtr = oRawAffinity.ptr<float>(nPatchRowIdx,nPatchColIdx);
-                        if(pRawAffinityPtr[nOffsetIdx]!=-1.0f) {
-                            afAccumAff += pRawAffinityPtr[nOffsetIdx];
-                            ++nValidCount;
-                        }
-                    }
-                }
-                if(nValidCount)
-                    oAffinityMap.at<float>(nRowIdx,nColIdx,nOffsetIdx) = float(afAccumAff/nValidCount);
-            }
-        }
+        static thread_local lv::AutoBuffer<float> s_aDescRowData;
+        const float* pDescRow = decodeDescMapRow(oQuantDescMap,oQuantParams,nRowIdx,s_aDescRowData);
+        std::copy(pDescRow,pDescRow+nRowValues,oDescMap.ptr<float>(nRowIdx));
     }
 }
 
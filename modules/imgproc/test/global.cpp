@@ -556,6 +556,124 @@ TEST(descriptor_affinity,regression_L2_dasc) {
 
 #endif //ndef(_MSC_VER)
 
+namespace {
+
+    // reference impl (original per-pixel/per-patch version of the cpu descriptor affinity computation)
+    void computeDescriptorAffinity_naive(const cv::Mat_<float>& oDescMap1, const cv::Mat_<float>& oDescMap2, int nPatchSize,
+                                         cv::Mat_<float>& oAffinityMap, const std::vector<int>& vDispRange,
+                                         const cv::Mat_<uchar>& oROI1, const cv::Mat_<uchar>& oROI2) {
+        const int nRows = oDescMap1.size[0], nCols = oDescMap1.size[1], nDescSize = oDescMap1.size[2], nOffsets = int(vDispRange.size());
+        const int nPatchRadius = nPatchSize/2;
+        const std::array<int,3> anAffinityMapDims = {nRows,nCols,nOffsets};
+        cv::Mat_<float> oRawAffinity(3,anAffinityMapDims.data());
+        oRawAffinity = -1.0f;
+        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                if(!oROI1.empty() && !oROI1(nRowIdx,nColIdx))
+                    continue;
+                for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+                    const int nOffsetColIdx = nColIdx+vDispRange[nOffsetIdx];
+                    if(nOffsetColIdx<0 || nOffsetColIdx>=nCols || (!oROI2.empty() && !oROI2(nRowIdx,nOffsetColIdx)))
+                        continue;
+                    const cv::Mat_<float> oDesc(1,nDescSize,const_cast<float*>(oDescMap1.ptr<float>(nRowIdx,nColIdx)));
+                    const cv::Mat_<float> oOffsetDesc(1,nDescSize,const_cast<float*>(oDescMap2.ptr<float>(nRowIdx,nOffsetColIdx)));
+                    oRawAffinity(nRowIdx,nColIdx,nOffsetIdx) = float(cv::norm(oDesc,oOffsetDesc,cv::NORM_L2));
+                }
+            }
+        }
+        oAffinityMap.create(3,anAffinityMapDims.data());
+        oAffinityMap = -1.0f;
+        for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                for(int nOffsetIdx=0; nOffsetIdx<nOffsets; ++nOffsetIdx) {
+                    size_t nValidCount = size_t(0);
+                    double dAccumAff = 0.0;
+                    for(int nPatchRowIdx=std::max(nRowIdx-nPatchRadius,0); nPatchRowIdx<=std::min(nRowIdx+nPatchRadius,nRows-1); ++nPatchRowIdx) {
+                        for(int nPatchColIdx=std::max(nColIdx-nPatchRadius,0); nPatchColIdx<=std::min(nColIdx+nPatchRadius,nCols-1); ++nPatchColIdx) {
+                            if(oRawAffinity(nPatchRowIdx,nPatchColIdx,nOffsetIdx)!=-1.0f) {
+                                dAccumAff += oRawAffinity(nPatchRowIdx,nPatchColIdx,nOffsetIdx);
+                                ++nValidCount;
+                            }
+                        }
+                    }
+                    if(nValidCount)
+                        oAffinityMap(nRowIdx,nColIdx,nOffsetIdx) = float(dAccumAff/nValidCount);
+                }
+            }
+        }
+    }
+
+} // anonymous namespace
+
+TEST(descriptor_affinity,regression_L2_vs_naive) {
+    const int nRows=41, nCols=67;
+    const std::vector<int> vDispRange = {-12,-5,-3,-2,-1,0,3};
+    cv::Mat_<uchar> oROI1(nRows,nCols,uchar(255)),oROI2(nRows,nCols,uchar(255));
+    oROI1(cv::Rect(10,3,12,20)) = uchar(0);
+    oROI2(cv::Rect(30,20,25,4)) = uchar(0);
+    for(int nDescSize : {3,8,29}) {
+        const std::array<int,3> anDescMapDims = {nRows,nCols,nDescSize};
+        cv::Mat_<float> oDescMap1(3,anDescMapDims.data()),oDescMap2(3,anDescMapDims.data());
+        cv::randu(oDescMap1,0.0f,1.0f);
+        cv::randu(oDescMap2,0.0f,1.0f);
+        for(int nPatchSize : {1,7,15}) {
+            for(bool bUseROIs : {false,true}) {
+                cv::Mat_<float> oAffMap,oRefAffMap;
+                lv::computeDescriptorAffinity(oDescMap1,oDescMap2,nPatchSize,oAffMap,vDispRange,lv::AffinityDist_L2,bUseROIs?oROI1:cv::Mat_<uchar>(),bUseROIs?oROI2:cv::Mat_<uchar>(),cv::Mat(),false);
+                computeDescriptorAffinity_naive(oDescMap1,oDescMap2,nPatchSize,oRefAffMap,vDispRange,bUseROIs?oROI1:cv::Mat_<uchar>(),bUseROIs?oROI2:cv::Mat_<uchar>());
+                ASSERT_EQ(lv::MatInfo(oAffMap),lv::MatInfo(oRefAffMap));
+                // the vectorized distances and running box sums change the accumulation order, so results are not bit-identical (ASSERT_FLOAT_EQ allows 4 ULPs)
+                for(int i=0; i<nRows; ++i)
+                    for(int j=0; j<nCols; ++j)
+                        for(int k=0; k<(int)vDispRange.size(); ++k)
+                            ASSERT_FLOAT_EQ(oAffMap(i,j,k),oRefAffMap(i,j,k)) << "ijk=[" << i << "," << j << "," << k << "], p=" << nPatchSize << ", d=" << nDescSize;
+            }
+        }
+    }
+}
+
+TEST(descriptor_affinity,regression_L2_quantized) {
+    const int nRows=37, nCols=53, nDescSize=24;
+    const std::array<int,3> anDescMapDims = {nRows,nCols,nDescSize};
+    cv::Mat_<float> oDescMap1(3,anDescMapDims.data()),oDescMap2(3,anDescMapDims.data());
+    cv::randu(oDescMap1,0.0f,1.0f);
+    cv::randu(oDescMap2,-0.5f,2.0f);
+    const std::vector<int> vDispRange = {-7,-2,0,1,4,9};
+    cv::Mat_<uchar> oROI1(nRows,nCols,uchar(255)),oROI2(nRows,nCols,uchar(255));
+    oROI1(cv::Rect(0,0,5,nRows)) = uchar(0);
+    oROI2(cv::Rect(40,10,8,8)) = uchar(0);
+    for(int nPatchSize : {1,5}) {
+        cv::Mat_<float> oRefAffMap;
+        lv::computeDescriptorAffinity(oDescMap1,oDescMap2,nPatchSize,oRefAffMap,vDispRange,lv::AffinityDist_L2,oROI1,oROI2,cv::Mat(),false);
+        for(lv::DescMapStorageType eType : {lv::DescMapStorage_Float,lv::DescMapStorage_Half,lv::DescMapStorage_UInt8}) {
+            cv::Mat oQuantDescMap1,oQuantDescMap2;
+            cv::Mat_<float> oQuantParams1,oQuantParams2,oDequantDescMap1;
+            lv::quantizeDescriptorMap(oDescMap1,oQuantDescMap1,oQuantParams1,eType);
+            lv::quantizeDescriptorMap(oDescMap2,oQuantDescMap2,oQuantParams2,eType);
+            ASSERT_EQ(oQuantDescMap1.size,oDescMap1.size);
+            ASSERT_EQ(oQuantDescMap1.type(),(eType==lv::DescMapStorage_Float)?CV_32FC1:(eType==lv::DescMapStorage_Half)?CV_16UC1:CV_8UC1);
+            lv::dequantizeDescriptorMap(oQuantDescMap1,oQuantParams1,oDequantDescMap1);
+            ASSERT_EQ(lv::MatInfo(oDequantDescMap1),lv::MatInfo(oDescMap1));
+            // fp16 keeps 11 significant bits, and 8-bit storage is off by at most half a step (1/510 of the [0,1] range here)
+            const float fMaxValErr = (eType==lv::DescMapStorage_Float)?0.0f:(eType==lv::DescMapStorage_Half)?(1.0f/2048):(0.5f/255+1e-6f);
+            for(size_t nValIdx=0; nValIdx<oDescMap1.total(); ++nValIdx)
+                ASSERT_LE(std::abs(((float*)oDescMap1.data)[nValIdx]-((float*)oDequantDescMap1.data)[nValIdx]),fMaxValErr) << "idx=" << nValIdx;
+            cv::Mat_<float> oAffMap;
+            lv::computeDescriptorAffinity(oQuantDescMap1,oQuantParams1,oQuantDescMap2,oQuantParams2,nPatchSize,oAffMap,vDispRange,lv::AffinityDist_L2,oROI1,oROI2);
+            ASSERT_EQ(lv::MatInfo(oAffMap),lv::MatInfo(oRefAffMap));
+            const float fMaxAffErr = (eType==lv::DescMapStorage_Float)?1e-5f:(eType==lv::DescMapStorage_Half)?0.005f:(std::sqrt(float(nDescSize))*2.5f/255);
+            for(int i=0; i<nRows; ++i) {
+                for(int j=0; j<nCols; ++j) {
+                    for(int k=0; k<(int)vDispRange.size(); ++k) {
+                        ASSERT_EQ(oAffMap(i,j,k)==-1.0f,oRefAffMap(i,j,k)==-1.0f) << "ijk=[" << i << "," << j << "," << k << "]";
+                        ASSERT_NEAR(oAffMap(i,j,k),oRefAffMap(i,j,k),fMaxAffErr) << "ijk=[" << i << "," << j << "," << k << "]";
+                    }
+                }
+            }
+        }
+    }
+}
+
 TEST(integral,regression) {
     for(size_t i=0u; i<200u; ++i) {
         cv::Mat oTestMat((rand()%500)+1,(rand()%500)+1,CV_8UC((rand()%4)+1));
@@ -567,8 +685,379 @@ TEST(integral,regression) {
     }
 }
 
+#if (HAVE_OPENGM && HAVE_BOOST)
+
 namespace {
 
+    void initSegmMatcherTestPair(SegmMatcher::MatArrayIn& aInputs, std::array<cv::Mat,SegmMatcher::s_nCameraCount>& aROIs, const cv::Size& oSize, int nDispOffset) {
+        cv::RNG oRNG(42);
+        cv::Mat oTexture(oSize.height,oSize.width+nDispOffset,CV_8UC3);
+        oRNG.fill(oTexture,cv::RNG::UNIFORM,0,256);
+        cv::GaussianBlur(oTexture,oTexture,cv::Size(3,3),0);
+        const cv::Rect oObjRect(oSize.width/3,oSize.height/4,oSize.width/3,oSize.height/2);
+        aInputs[SegmMatcher::InputPack_LeftImg] = oTexture(cv::Rect(nDispOffset,0,oSize.width,oSize.height)).clone();
+        aInputs[SegmMatcher::InputPack_RightImg] = oTexture(cv::Rect(0,0,oSize.width,oSize.height)).clone();
+        aInputs[SegmMatcher::InputPack_LeftMask] = cv::Mat(oSize,CV_8UC1,cv::Scalar_<uchar>(0));
+        aInputs[SegmMatcher::InputPack_LeftMask](oObjRect) = cv::Scalar_<uchar>(255);
+        aInputs[SegmMatcher::InputPack_RightMask] = cv::Mat(oSize,CV_8UC1,cv::Scalar_<uchar>(0));
+        aInputs[SegmMatcher::InputPack_RightMask](oObjRect-cv::Point(nDispOffset,0)) = cv::Scalar_<uchar>(255);
+        for(size_t nCamIdx=0; nCamIdx<SegmMatcher::s_nCameraCount; ++nCamIdx)
+            aROIs[nCamIdx] = cv::Mat(oSize,CV_8UC1,cv::Scalar_<uchar>(255));
+    }
+
+    /// records the (summed) coefficient of every reduced term, indexed by its sorted var ids
+    struct FactorTermRecorder {
+        typedef int VarId;
+        void AddTerm(int nCoeff, int nDegree, const VarId* pVarIds) {
+            m_mTerms[std::vector<VarId>(pVarIds,pVarIds+nDegree)] += nCoeff;
+        }
+        std::map<std::vector<VarId>,int> m_mTerms;
+    };
+
+    /// arbitrary (non-submodular) higher-order clique function used to test term reduction
+    struct FactorTestFunc {
+        template<typename TIter>
+        int operator()(TIter pLabels) const {
+            int nEnergy = 0;
+            for(size_t nVarIdx=0; nVarIdx<m_anWeights.size(); ++nVarIdx)
+                nEnergy += m_anWeights[nVarIdx]*int(pLabels[nVarIdx])*int(pLabels[(nVarIdx+1)%m_anWeights.size()]+1);
+            return nEnergy;
+        }
+        std::array<int,4> m_anWeights;
+    };
+
+    /// full-clique higher-order term reduction as implemented before the sub-graph overload was added (used as reference)
+    template<typename TFunc, size_t nOrder, typename TValue, typename TIndex, typename TLabel, typename ReducerType>
+    void factorReducer_fullclique(const lv::gm::Clique<nOrder,TValue,TIndex,TLabel>& oClique, ReducerType& oReducer, TLabel nAlphaLabel, const TLabel* aLabeling) {
+        std::array<typename ReducerType::VarId,nOrder> aTermEnergyLUT;
+        std::array<TLabel,nOrder> aCliqueLabels;
+        std::array<TValue,(1u<<nOrder)> aCliqueCoeffs{};
+        constexpr size_t nAssignCount = 1UL<<nOrder;
+        for(size_t nAssignIdx=0; nAssignIdx<nAssignCount; ++nAssignIdx) {
+            for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx)
+                aCliqueLabels[nVarIdx] = (nAssignIdx&(1<<nVarIdx))?nAlphaLabel:aLabeling[oClique.m_anLUTNodeIdxs[nVarIdx]];
+            for(size_t nAssignSubsetIdx=1; nAssignSubsetIdx<nAssignCount; ++nAssignSubsetIdx) {
+                if(!(nAssignIdx&~nAssignSubsetIdx)) {
+                    int nParityBit = 0;
+                    for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx)
+                        nParityBit ^= (((nAssignIdx^nAssignSubsetIdx)&(1<<nVarIdx))!=0);
+                    const TValue fCurrAssignEnergy = (*(TFunc*)oClique.m_pGraphFunctionPtr)(aCliqueLabels.begin());
+                    aCliqueCoeffs[nAssignSubsetIdx] += nParityBit?-fCurrAssignEnergy:fCurrAssignEnergy;
+                }
+            }
+        }
+        for(size_t nAssignSubsetIdx=1; nAssignSubsetIdx<nAssignCount; ++nAssignSubsetIdx) {
+            int nCurrTermDegree = 0;
+            for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx)
+                if(nAssignSubsetIdx&(1<<nVarIdx))
+                    aTermEnergyLUT[nCurrTermDegree++] = (typename ReducerType::VarId)oClique.m_anGraphNodeIdxs[nVarIdx];
+            std::sort(aTermEnergyLUT.begin(),aTermEnergyLUT.begin()+nCurrTermDegree);
+            oReducer.AddTerm(aCliqueCoeffs[nAssignSubsetIdx],nCurrTermDegree,aTermEnergyLUT.data());
+        }
+    }
+
+} // anonymous namespace
+
+TEST(gm_factor_reducer,regression_identity_mapper) {
+    cv::RNG oRNG(42);
+    const size_t nLabels = 5, nNodes = 12;
+    for(size_t nTestIdx=0; nTestIdx<100u; ++nTestIdx) {
+        std::array<size_t,nNodes> anLabeling;
+        for(size_t nNodeIdx=0; nNodeIdx<nNodes; ++nNodeIdx)
+            anLabeling[nNodeIdx] = size_t(oRNG.uniform(0,int(nLabels)));
+        FactorTestFunc oFunc;
+        for(int& nWeight : oFunc.m_anWeights)
+            nWeight = oRNG.uniform(-10,11);
+        lv::gm::Clique<4,int,size_t,size_t> oClique;
+        oClique.m_bValid = true;
+        oClique.m_nGraphFactorId = 0;
+        oClique.m_pGraphFunctionPtr = &oFunc;
+        for(size_t nVarIdx=0; nVarIdx<4u; ++nVarIdx) {
+            // lut & graph node idxs are deliberately unordered/unaligned to catch mixups
+            oClique.m_anLUTNodeIdxs[nVarIdx] = (nTestIdx+nVarIdx*5)%nNodes;
+            oClique.m_anGraphNodeIdxs[nVarIdx] = nNodes-1-nVarIdx*3;
+        }
+        const size_t nAlphaLabel = size_t(oRNG.uniform(0,int(nLabels)));
+        FactorTermRecorder oRefRecorder,oTestRecorder,oMappedRecorder;
+        factorReducer_fullclique<FactorTestFunc>(oClique,oRefRecorder,nAlphaLabel,anLabeling.data());
+        lv::gm::factorReducer<FactorTestFunc>(oClique,oTestRecorder,nAlphaLabel,anLabeling.data());
+        lv::gm::factorReducer<FactorTestFunc>(oClique,oMappedRecorder,nAlphaLabel,anLabeling.data(),[](size_t nGraphNodeIdx) {return std::ptrdiff_t(nGraphNodeIdx);});
+        ASSERT_EQ(oRefRecorder.m_mTerms,oTestRecorder.m_mTerms) << "nTestIdx=" << nTestIdx;
+        ASSERT_EQ(oRefRecorder.m_mTerms,oMappedRecorder.m_mTerms) << "nTestIdx=" << nTestIdx;
+    }
+}
+
+TEST(segm_matcher,solver_registry) {
+    SegmMatcher oMatcher(0,16);
+    std::set<std::string> mSolverNames;
+    size_t nAvailableStereoSolvers = 0u, nAvailableResegmSolvers = 0u;
+    for(int nSolverIdx=0; nSolverIdx<(int)SegmMatcher::InferenceSolverCount; ++nSolverIdx) {
+        const SegmMatcher::InferenceSolverType eSolver = (SegmMatcher::InferenceSolverType)nSolverIdx;
+        const std::string sSolverName = SegmMatcher::getSolverName(eSolver);
+        ASSERT_FALSE(sSolverName.empty());
+        ASSERT_TRUE(mSolverNames.insert(sSolverName).second);
+        if(SegmMatcher::isStereoSolverAvailable(eSolver)) {
+            ++nAvailableStereoSolvers;
+            oMatcher.setStereoSolver(eSolver,(size_t)nSolverIdx+10u,0.5);
+            ASSERT_EQ(oMatcher.getStereoSolver().eSolver,eSolver);
+            ASSERT_EQ(oMatcher.getStereoSolver().nMaxMoveCount,(size_t)nSolverIdx+10u);
+            ASSERT_EQ(oMatcher.getStereoSolver().dMaxTimeSec,0.5);
+            ASSERT_THROW_LV_QUIET(oMatcher.setStereoSolver(eSolver,0u));
+        }
+        else
+            ASSERT_THROW_LV_QUIET(oMatcher.setStereoSolver(eSolver,10u));
+        if(SegmMatcher::isResegmSolverAvailable(eSolver)) {
+            ++nAvailableResegmSolvers;
+            oMatcher.setResegmSolver(eSolver,(size_t)nSolverIdx+20u);
+            ASSERT_EQ(oMatcher.getResegmSolver().eSolver,eSolver);
+            ASSERT_EQ(oMatcher.getResegmSolver().nMaxMoveCount,(size_t)nSolverIdx+20u);
+            ASSERT_EQ(oMatcher.getResegmSolver().dMaxTimeSec,0.0);
+            ASSERT_THROW_LV_QUIET(oMatcher.setResegmSolver(eSolver,0u));
+        }
+        else
+            ASSERT_THROW_LV_QUIET(oMatcher.setResegmSolver(eSolver,10u));
+    }
+    ASSERT_FALSE(SegmMatcher::isResegmSolverAvailable(SegmMatcher::InferenceSolver_FastPD));
+    ASSERT_GT(nAvailableStereoSolvers,0u);
+    ASSERT_GT(nAvailableResegmSolvers,0u);
+}
+
+TEST(segm_matcher,regression_inference_state_replay) {
+    SegmMatcher::MatArrayIn aInputs;
+    std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+    initSegmMatcherTestPair(aInputs,aROIs,cv::Size(96,64),4);
+    SegmMatcher oRefMatcher(0,16),oBenchMatcher(0,16);
+    for(SegmMatcher* pMatcher : {&oRefMatcher,&oBenchMatcher}) {
+        pMatcher->setStereoSolver(pMatcher->getStereoSolver().eSolver,30u);
+        pMatcher->setResegmSolver(pMatcher->getResegmSolver().eSolver,10u);
+        pMatcher->initialize(aROIs);
+    }
+    SegmMatcher::MatArrayOut aRefOutputs,aBenchOutputs;
+    // the first frame is processed identically by both matchers, so the second one starts from kept labelings & duals
+    oRefMatcher.apply(aInputs,aRefOutputs);
+    oBenchMatcher.apply(aInputs,aBenchOutputs);
+    oRefMatcher.apply(aInputs,aRefOutputs);
+    // every solver pair is replayed from the saved state before the selected one runs; if the state is not fully restored, outputs diverge
+    const std::vector<SegmMatcher::InferenceSolverTrace> vTraces = oBenchMatcher.benchmarkSolvers(aInputs,aBenchOutputs);
+    size_t nExpectedTraces = 0u;
+    for(int nStereoSolverIdx=0; nStereoSolverIdx<(int)SegmMatcher::InferenceSolverCount; ++nStereoSolverIdx)
+        for(int nResegmSolverIdx=0; nResegmSolverIdx<(int)SegmMatcher::InferenceSolverCount; ++nResegmSolverIdx)
+            nExpectedTraces += size_t(SegmMatcher::isStereoSolverAvailable((SegmMatcher::InferenceSolverType)nStereoSolverIdx) &&
+                                      SegmMatcher::isResegmSolverAvailable((SegmMatcher::InferenceSolverType)nResegmSolverIdx));
+    ASSERT_EQ(vTraces.size(),nExpectedTraces);
+    for(const SegmMatcher::InferenceSolverTrace& oTrace : vTraces) {
+        ASSERT_FALSE(oTrace.vPoints.empty());
+        ASSERT_GE(oTrace.dTotalTimeSec,oTrace.vPoints.back().dElapsedSec);
+    }
+    for(size_t nOutputIdx=0; nOutputIdx<aRefOutputs.size(); ++nOutputIdx) {
+        ASSERT_EQ(aRefOutputs[nOutputIdx].size(),aBenchOutputs[nOutputIdx].size());
+        ASSERT_TRUE(lv::isEqual<SegmMatcher::OutputLabelType>(aRefOutputs[nOutputIdx],aBenchOutputs[nOutputIdx])) << "output #" << nOutputIdx << " differs after state replay";
+    }
+}
+
+TEST(segm_matcher,regression_tiled_moves) {
+    SegmMatcher::MatArrayIn aInputs;
+    std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+    initSegmMatcherTestPair(aInputs,aROIs,cv::Size(96,64),4);
+    const double dMaxEnergyGap = 0.0;
+    for(size_t nTileSize : {size_t(0),size_t(16)}) {
+        SegmMatcher oMatcher(0,16);
+        if(SegmMatcher::isStereoSolverAvailable(SegmMatcher::InferenceSolver_FGBZ)) // tiling only applies to fgbz stereo moves
+            oMatcher.setStereoSolver(SegmMatcher::InferenceSolver_FGBZ,30u);
+        oMatcher.setResegmSolver(oMatcher.getResegmSolver().eSolver,10u);
+        oMatcher.setStereoMoveTiling(nTileSize,dMaxEnergyGap);
+        oMatcher.initialize(aROIs);
+        ASSERT_EQ(oMatcher.getStereoSolver().nMoveTileSize,nTileSize);
+        SegmMatcher::MatArrayOut aOutputs;
+        const std::vector<SegmMatcher::InferenceSolverTrace> vTraces = oMatcher.benchmarkSolvers(aInputs,aOutputs);
+        ASSERT_FALSE(vTraces.empty());
+        for(const SegmMatcher::InferenceSolverTrace& oTrace : vTraces) {
+            if(oTrace.eStereoSolver!=oMatcher.getStereoSolver().eSolver || oTrace.vPoints.empty())
+                continue;
+            // resegm moves change the stereo model, so the lowest energy reached is only comparable within the last resegm iteration
+            const SegmMatcher::InferenceTracePoint& oLastPoint = oTrace.vPoints.back();
+            SegmMatcher::ValueType tMinStereoEnergy = oLastPoint.tStereoEnergy;
+            for(const SegmMatcher::InferenceTracePoint& oPoint : oTrace.vPoints)
+                if(oPoint.nResegmMoveIter==oLastPoint.nResegmMoveIter)
+                    tMinStereoEnergy = std::min(tMinStereoEnergy,oPoint.tStereoEnergy);
+            EXPECT_LE(double(oLastPoint.tStereoEnergy),double(tMinStereoEnergy)+std::floor(dMaxEnergyGap*std::abs(double(tMinStereoEnergy))))
+                << "tile size " << nTileSize << " w/ " << SegmMatcher::getSolverName(oTrace.eStereoSolver) << "/" << SegmMatcher::getSolverName(oTrace.eResegmSolver)
+                << " drifted above the lowest stereo energy reached";
+        }
+    }
+}
+
+TEST(segm_matcher,regression_coarse_to_fine_windows) {
+    SegmMatcher::MatArrayIn aInputs;
+    std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+    initSegmMatcherTestPair(aInputs,aROIs,cv::Size(96,64),4);
+    const auto lRunMatcher = [&](size_t nPyramidLevels, size_t nLabelWindowRad, SegmMatcher::MatArrayOut& aOutputs) {
+        SegmMatcher oMatcher(0,16);
+        oMatcher.setStereoSolver(oMatcher.getStereoSolver().eSolver,30u);
+        oMatcher.setResegmSolver(oMatcher.getResegmSolver().eSolver,10u);
+        oMatcher.setCoarseToFineStereo(nPyramidLevels,nLabelWindowRad);
+        oMatcher.initialize(aROIs);
+        oMatcher.apply(aInputs,aOutputs);
+        return oMatcher.getLabels().size();
+    };
+    SegmMatcher::MatArrayOut aFlatOutputs,aFullWindowOutputs,aWindowOutputs;
+    const size_t nLabels = lRunMatcher(0u,0u,aFlatOutputs);
+    // windows covering every label leave the affinity/saliency curves and unaries untouched, so the flat solve must be reproduced
+    lRunMatcher(1u,nLabels,aFullWindowOutputs);
+    for(size_t nOutputIdx=0; nOutputIdx<aFlatOutputs.size(); ++nOutputIdx) {
+        ASSERT_EQ(aFlatOutputs[nOutputIdx].size(),aFullWindowOutputs[nOutputIdx].size());
+        ASSERT_TRUE(lv::isEqual<SegmMatcher::OutputLabelType>(aFlatOutputs[nOutputIdx],aFullWindowOutputs[nOutputIdx])) << "output #" << nOutputIdx << " differs from flat solve";
+    }
+    // narrow windows also restrict saliency to the windowed affinity curve; on this constant-disparity pair, outputs should stay close to the flat ones
+    lRunMatcher(1u,2u,aWindowOutputs);
+    const cv::Mat_<SegmMatcher::OutputLabelType>& oFlatDisp = aFlatOutputs[SegmMatcher::OutputPack_LeftDisp];
+    const cv::Mat_<SegmMatcher::OutputLabelType>& oWindowDisp = aWindowOutputs[SegmMatcher::OutputPack_LeftDisp];
+    ASSERT_EQ(oFlatDisp.size(),oWindowDisp.size());
+    int nDispMismatches = 0;
+    for(int nRowIdx=0; nRowIdx<oFlatDisp.rows; ++nRowIdx)
+        for(int nColIdx=0; nColIdx<oFlatDisp.cols; ++nColIdx)
+            nDispMismatches += int(std::abs(int64_t(oFlatDisp(nRowIdx,nColIdx))-int64_t(oWindowDisp(nRowIdx,nColIdx)))>1);
+    EXPECT_LE(double(nDispMismatches)/oFlatDisp.total(),0.05) << "windowed disparity output gap vs flat model too large";
+}
+
+TEST(segm_matcher,regression_stereo_unary_reuse) {
+    SegmMatcher::MatArrayIn aInputs,aNextInputs;
+    std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+    initSegmMatcherTestPair(aInputs,aROIs,cv::Size(96,64),4);
+    for(size_t nInputIdx=0; nInputIdx<aInputs.size(); ++nInputIdx)
+        aNextInputs[nInputIdx] = aInputs[nInputIdx].clone();
+    // only a small patch changes in the next frame; unaries of nodes away from it (and from its epipolar range) can be reused
+    cv::RNG oRNG(24);
+    oRNG.fill(aNextInputs[SegmMatcher::InputPack_LeftImg](cv::Rect(4,4,12,8)),cv::RNG::UNIFORM,0,256);
+    SegmMatcher oRefMatcher(0,16),oReuseMatcher(0,16);
+    ASSERT_THROW_LV_QUIET(oReuseMatcher.setStereoTemporalUpdates(256u,0u));
+    oReuseMatcher.setStereoTemporalUpdates(8u,0u);
+    for(SegmMatcher* pMatcher : {&oRefMatcher,&oReuseMatcher}) {
+        pMatcher->setStereoSolver(pMatcher->getStereoSolver().eSolver,30u);
+        pMatcher->setResegmSolver(pMatcher->getResegmSolver().eSolver,10u);
+        pMatcher->initialize(aROIs);
+    }
+    // reused unaries must be identical to re-evaluated ones, so outputs cannot differ from the reference for unchanged or partly changed frames
+    for(const SegmMatcher::MatArrayIn* pInputs : {&aInputs,&aInputs,&aNextInputs}) {
+        SegmMatcher::MatArrayOut aRefOutputs,aReuseOutputs;
+        oRefMatcher.apply(*pInputs,aRefOutputs);
+        oReuseMatcher.apply(*pInputs,aReuseOutputs);
+        for(size_t nOutputIdx=0; nOutputIdx<aRefOutputs.size(); ++nOutputIdx) {
+            ASSERT_EQ(aRefOutputs[nOutputIdx].size(),aReuseOutputs[nOutputIdx].size());
+            ASSERT_TRUE(lv::isEqual<SegmMatcher::OutputLabelType>(aRefOutputs[nOutputIdx],aReuseOutputs[nOutputIdx])) << "output #" << nOutputIdx << " differs with reused unaries";
+        }
+    }
+}
+
+TEST(segm_matcher,regression_feats_pack_storage) {
+    SegmMatcher::MatArrayIn aInputs;
+    std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+    initSegmMatcherTestPair(aInputs,aROIs,cv::Size(96,64),4);
+    SegmMatcher oHalfMatcher(0,16),oFloatMatcher(0,16);
+    ASSERT_THROW_LV_QUIET(oHalfMatcher.setDescriptorStorage(lv::DescMapStorage_Half,lv::DescMapStorage_UInt8));
+    oHalfMatcher.setDescriptorStorage(lv::DescMapStorage_Half,lv::DescMapStorage_Half);
+    oHalfMatcher.initialize(aROIs);
+    oFloatMatcher.initialize(aROIs);
+    ASSERT_THROW_LV_QUIET(oFloatMatcher.setDescriptorStorage(lv::DescMapStorage_Float,lv::DescMapStorage_Float));
+    cv::Mat oHalfPacket,oFloatPacket;
+    oHalfMatcher.calcFeatures(aInputs,&oHalfPacket);
+    oFloatMatcher.calcFeatures(aInputs,&oFloatPacket);
+    ASSERT_LT(oHalfPacket.total()*oHalfPacket.elemSize(),oFloatPacket.total()*oFloatPacket.elemSize());
+    // packets saved with the other affinity storage type are converted on load, and anything else is rejected
+    oFloatMatcher.setNextFeatures(oHalfPacket);
+    oHalfMatcher.setNextFeatures(oFloatPacket);
+    const cv::Mat oBadPacket = oFloatPacket.reshape(0,1).colRange(0,int(oFloatPacket.total()/2)).clone();
+    ASSERT_THROW_LV_QUIET(oFloatMatcher.setNextFeatures(oBadPacket));
+    SegmMatcher::MatArrayOut aOutputs;
+    oFloatMatcher.setNextFeatures(oHalfPacket);
+    oFloatMatcher.apply(aInputs,aOutputs);
+    ASSERT_EQ(aOutputs[SegmMatcher::OutputPack_LeftDisp].size(),aInputs[SegmMatcher::InputPack_LeftImg].size());
+}
+
+TEST(segm_matcher,regression_topk_vs_dense) {
+    SegmMatcher::MatArrayIn aInputs;
+    std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+    initSegmMatcherTestPair(aInputs,aROIs,cv::Size(96,64),4);
+    const auto lRunMatcher = [&](size_t nTopKLabels, SegmMatcher::MatArrayOut& aOutputs) {
+        SegmMatcher oMatcher(0,16);
+        oMatcher.setStereoSolver(oMatcher.getStereoSolver().eSolver,30u);
+        oMatcher.setResegmSolver(oMatcher.getResegmSolver().eSolver,10u);
+        oMatcher.setStereoLabelPruning(nTopKLabels);
+        oMatcher.initialize(aROIs);
+        EXPECT_EQ(oMatcher.getStereoSolver().nTopKLabels,nTopKLabels);
+        const std::vector<SegmMatcher::InferenceSolverTrace> vTraces = oMatcher.benchmarkSolvers(aInputs,aOutputs);
+        for(const SegmMatcher::InferenceSolverTrace& oTrace : vTraces)
+            if(oTrace.eStereoSolver==oMatcher.getStereoSolver().eSolver && oTrace.eResegmSolver==oMatcher.getResegmSolver().eSolver && !oTrace.vPoints.empty())
+                return oTrace.vPoints.back().tStereoEnergy;
+        ADD_FAILURE() << "missing trace for selected solvers";
+        return SegmMatcher::ValueType(0);
+    };
+    SegmMatcher oLabelsMatcher(0,16);
+    oLabelsMatcher.initialize(aROIs);
+    const size_t nRealLabels = oLabelsMatcher.getLabels().size()-2u; // dontcare & occluded labels are never pruned
+    ASSERT_EQ(nRealLabels,size_t(17));
+    SegmMatcher::MatArrayOut aDenseOutputs,aFullTopKOutputs,aNearlyFullTopKOutputs,aTopKOutputs;
+    const SegmMatcher::ValueType tDenseEnergy = lRunMatcher(0u,aDenseOutputs);
+    // keeping every real label must give exactly the dense model
+    const SegmMatcher::ValueType tFullTopKEnergy = lRunMatcher(nRealLabels,aFullTopKOutputs);
+    ASSERT_EQ(tDenseEnergy,tFullTopKEnergy);
+    for(size_t nOutputIdx=0; nOutputIdx<aDenseOutputs.size(); ++nOutputIdx)
+        ASSERT_TRUE(lv::isEqual<SegmMatcher::OutputLabelType>(aDenseOutputs[nOutputIdx],aFullTopKOutputs[nOutputIdx]));
+    // pruning only the worst label of each node actually goes through the sparse path, but should barely change the solution
+    const SegmMatcher::ValueType tNearlyFullTopKEnergy = lRunMatcher(nRealLabels-1u,aNearlyFullTopKOutputs);
+    EXPECT_LE(double(tNearlyFullTopKEnergy),double(tDenseEnergy)*1.01) << "top-k energy gap vs dense model too large with a single pruned label";
+    EXPECT_LE(double(cv::countNonZero(aDenseOutputs[SegmMatcher::OutputPack_LeftDisp]!=aNearlyFullTopKOutputs[SegmMatcher::OutputPack_LeftDisp]))/aDenseOutputs[SegmMatcher::OutputPack_LeftDisp].total(),0.01);
+    // pruned model energies are measured with pruned labels at max cost, so they can only be above the dense optimum by the pruning loss
+    const SegmMatcher::ValueType tTopKEnergy = lRunMatcher(6u,aTopKOutputs);
+    EXPECT_LE(double(tTopKEnergy),double(tDenseEnergy)*1.1) << "top-k energy gap vs dense model too large";
+    const cv::Mat_<SegmMatcher::OutputLabelType>& oDenseDisp = aDenseOutputs[SegmMatcher::OutputPack_LeftDisp];
+    const cv::Mat_<SegmMatcher::OutputLabelType>& oTopKDisp = aTopKOutputs[SegmMatcher::OutputPack_LeftDisp];
+    ASSERT_EQ(oDenseDisp.size(),oTopKDisp.size());
+    int nDispMismatches = 0;
+    for(int nRowIdx=0; nRowIdx<oDenseDisp.rows; ++nRowIdx)
+        for(int nColIdx=0; nColIdx<oDenseDisp.cols; ++nColIdx)
+            nDispMismatches += int(std::abs(int64_t(oDenseDisp(nRowIdx,nColIdx))-int64_t(oTopKDisp(nRowIdx,nColIdx)))>1);
+    EXPECT_LE(double(nDispMismatches)/oDenseDisp.total(),0.05) << "top-k disparity output gap vs dense model too large";
+}
+
+#endif //(HAVE_OPENGM && HAVE_BOOST)
+
+namespace {
+
+    void descriptor_affinity_perftest(benchmark::State& st) {
+        const int nCols = int(st.range(0)), nRows = nCols*3/4, nDescSize = 32, nPatchSize = int(st.range(1));
+        const std::array<int,3> anDescMapDims = {nRows,nCols,nDescSize};
+        cv::Mat_<float> oDescMap1(3,anDescMapDims.data()),oDescMap2(3,anDescMapDims.data()),oAffMap;
+        cv::randu(oDescMap1,0.0f,1.0f);
+        cv::randu(oDescMap2,0.0f,1.0f);
+        const std::vector<int> vDispRange = lv::make_range(-31,0);
+        while(st.KeepRunning()) {
+            if(st.range(2))
+                computeDescriptorAffinity_naive(oDescMap1,oDescMap2,nPatchSize,oAffMap,vDispRange,cv::Mat_<uchar>(),cv::Mat_<uchar>());
+            else
+                lv::computeDescriptorAffinity(oDescMap1,oDescMap2,nPatchSize,oAffMap,vDispRange,lv::AffinityDist_L2,cv::Mat(),cv::Mat(),cv::Mat(),false);
+            benchmark::DoNotOptimize(oAffMap.data);
+        }
+    }
+
+    void descriptor_affinity_quantized_perftest(benchmark::State& st) {
+        const int nCols = int(st.range(0)), nRows = nCols*3/4, nDescSize = 32;
+        const std::array<int,3> anDescMapDims = {nRows,nCols,nDescSize};
+        cv::Mat_<float> oDescMap1(3,anDescMapDims.data()),oDescMap2(3,anDescMapDims.data());
+        cv::randu(oDescMap1,0.0f,1.0f);
+        cv::randu(oDescMap2,0.0f,1.0f);
+        cv::Mat oQuantDescMap1,oQuantDescMap2;
+        cv::Mat_<float> oQuantParams1,oQuantParams2,oAffMap;
+        lv::quantizeDescriptorMap(oDescMap1,oQuantDescMap1,oQuantParams1,lv::DescMapStorageType(st.range(1)));
+        lv::quantizeDescriptorMap(oDescMap2,oQuantDescMap2,oQuantParams2,lv::DescMapStorageType(st.range(1)));
+        const std::vector<int> vDispRange = lv::make_range(-31,0);
+        while(st.KeepRunning()) {
+            lv::computeDescriptorAffinity(oQuantDescMap1,oQuantParams1,oQuantDescMap2,oQuantParams2,1,oAffMap,vDispRange,lv::AffinityDist_L2);
+            benchmark::DoNotOptimize(oAffMap.data);
+        }
+        st.SetLabel(lv::putf("%.1f MB/map",double(oQuantDescMap1.total()*oQuantDescMap1.elemSize())/(1024*1024)));
+    }
+
     void medianBlur_perftest(benchmark::State& st) {
         const volatile int nMatSize = st.range(0);
         const volatile int nKernelSize = st.range(1);
@@ -626,6 +1115,11 @@ namespace {
 
 }
 
+// args = {map width, patch size, use naive impl}
+BENCHMARK(descriptor_affinity_perftest)->Args({320,15,0})->Args({320,15,1})->Args({640,15,0})->Args({640,15,1})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+// args = {map width, desc map storage type}
+BENCHMARK(descriptor_affinity_quantized_perftest)->Args({320,0})->Args({320,1})->Args({320,2})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+
 BENCHMARK(medianBlur_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_conv_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_raw_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
@@ -645,3 +1139,49 @@ BENCHMARK(medianBlur_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->R
 BENCHMARK(binaryMedianBlur_conv_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_raw_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryConsensus_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+
+#if (HAVE_OPENGM && HAVE_BOOST)
+
+namespace {
+
+    void segm_matcher_tiled_stereo_perftest(benchmark::State& st) {
+        const size_t nTileSize = (size_t)st.range(0);
+        SegmMatcher::MatArrayIn aInputs;
+        std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+        initSegmMatcherTestPair(aInputs,aROIs,cv::Size(320,240),12);
+        SegmMatcher oMatcher(0,32);
+        if(SegmMatcher::isStereoSolverAvailable(SegmMatcher::InferenceSolver_FGBZ)) // tiling only applies to fgbz stereo moves
+            oMatcher.setStereoSolver(SegmMatcher::InferenceSolver_FGBZ,oMatcher.getStereoSolver().nMaxMoveCount);
+        oMatcher.setStereoMoveTiling(nTileSize,0.01);
+        oMatcher.initialize(aROIs);
+        SegmMatcher::MatArrayOut aOutputs;
+        while(st.KeepRunning()) {
+            oMatcher.apply(aInputs,aOutputs);
+            benchmark::DoNotOptimize(aOutputs[SegmMatcher::OutputPack_LeftDisp].data);
+        }
+        st.SetLabel(lv::putf("%s stereo",SegmMatcher::getSolverName(oMatcher.getStereoSolver().eSolver).c_str()));
+    }
+
+    void segm_matcher_coarse_to_fine_perftest(benchmark::State& st) {
+        const size_t nPyramidLevels = (size_t)st.range(0), nLabelWindowRad = (size_t)st.range(1);
+        SegmMatcher::MatArrayIn aInputs;
+        std::array<cv::Mat,SegmMatcher::s_nCameraCount> aROIs;
+        initSegmMatcherTestPair(aInputs,aROIs,cv::Size(320,240),12);
+        SegmMatcher oMatcher(0,32);
+        oMatcher.setCoarseToFineStereo(nPyramidLevels,nLabelWindowRad);
+        oMatcher.initialize(aROIs);
+        SegmMatcher::MatArrayOut aOutputs;
+        while(st.KeepRunning()) {
+            oMatcher.apply(aInputs,aOutputs);
+            benchmark::DoNotOptimize(aOutputs[SegmMatcher::OutputPack_LeftDisp].data);
+        }
+    }
+
+}
+
+// args = {stereo move tile size (0 = untiled)}
+BENCHMARK(segm_matcher_tiled_stereo_perftest)->Args({0})->Args({32})->Args({64})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+// args = {stereo pyramid levels (0 = flat), label window radius}
+BENCHMARK(segm_matcher_coarse_to_fine_perftest)->Args({0,0})->Args({1,4})->Args({2,4})->Args({1,8})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+
+#endif //(HAVE_OPENGM && HAVE_BOOST)
@@ -23,6 +23,7 @@
 #include <mutex>
 #include <array>
 #include <queue>
+#include <deque>
 #include <tuple>
 #include <utility>
 #include <type_traits>
@@ -54,6 +55,7 @@
 #include <clocale>
 #include <functional>
 #include <condition_variable>
+#include <shared_mutex>
 #if USE_CVCORE_WITH_UTILS
 #include <opencv2/core.hpp>
 #endif //USE_CVCORE_WITH_UTILS
@@ -399,29 +401,83 @@ namespace lv {
         return vRet;
     }
 
-    /// implements a work thread pool used to process packaged tasks asynchronously
-    template<size_t nWorkers>
-    struct WorkerPool {
-        static_assert(nWorkers>0,"Worker pool must have at least one work thread");
-        /// default constructor; creates 'nWorkers' threads to process queued tasks
-        WorkerPool();
+    /// work thread pool declaration; 'nWorkers=0' corresponds to the runtime-sized impl (see below)
+    template<size_t nWorkers=0>
+    struct WorkerPool;
+
+    /// implements a resizable work-stealing thread pool used to process packaged tasks asynchronously
+    template<>
+    struct WorkerPool<0> {
+        /// groups a subset of queued tasks so that they can be waited on together (see WorkerPool::wait)
+        struct TaskGroup {
+            /// default constructor; the group starts without any pending task
+            TaskGroup() : m_nPendingTasks(0) {}
+            /// returns whether all tasks queued in this group have been processed
+            bool done() const {return m_nPendingTasks==0;}
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+        private:
+            friend struct WorkerPool<0>;
+            std::atomic_size_t m_nPendingTasks;
+        };
+        /// default constructor; creates 'nWorkers' threads to process queued tasks (uses all hardware threads by default)
+        explicit WorkerPool(size_t nWorkers=0);
         /// default destructor; will block until all queued tasks have been processed
         ~WorkerPool();
+        /// returns the current number of work threads in the pool
+        size_t workers() const;
+        /// modifies the number of work threads in the pool (blocks until excess threads have finished their current task)
+        void resize(size_t nWorkers);
         /// queues a task to be processed by the pool, and returns a future tied to its result
         template<typename Tfunc, typename... Targs>
         std::future<std::result_of_t<Tfunc(Targs...)>> queueTask(Tfunc&& lTaskEntryPoint, Targs&&... args);
+        /// queues a task to be processed by the pool as part of the given group, and returns a future tied to its result
+        template<typename Tfunc, typename... Targs>
+        std::future<std::result_of_t<Tfunc(Targs...)>> queueTask(TaskGroup& oGroup, Tfunc&& lTaskEntryPoint, Targs&&... args);
+        /// blocks until all tasks in the given group have been processed (the calling thread helps process queued tasks in the meantime)
+        void wait(TaskGroup& oGroup);
+        /// calls 'lFunc(idx)' for all indices in [nBegin,nEnd) using chunks of 'nGrainSize' indices per task (0 = auto), and blocks until done
+        template<typename Tinteger, typename Tfunc>
+        void parallel_for(Tinteger nBegin, Tinteger nEnd, Tfunc&& lFunc, size_t nGrainSize=0);
         WorkerPool(const WorkerPool&) = delete;
         WorkerPool& operator=(const WorkerPool&) = delete;
     protected:
-        std::queue<std::function<void()>> m_qTasks;
+        /// per-worker task deque (owner pops from the back, thieves steal from the front)
+        struct TaskQueue {
+            std::deque<std::function<void()>> qTasks;
+            std::mutex oMutex;
+        };
+        /// pushes a type-erased task in a worker queue (the local one if called from a pool worker)
+        void pushTask(std::function<void()>&& lTask);
+        /// pops a task from the given worker queue, or steals one from another queue if it is empty
+        bool popTask(size_t nQueueIdx, bool bIsOwner, std::function<void()>& lTask);
+        /// returns the index of the calling thread in this pool (or SIZE_MAX if it is not one of its workers)
+        size_t getLocalWorkerIdx() const;
+        std::vector<std::unique_ptr<TaskQueue>> m_vpQueues;
         std::vector<std::thread> m_vhWorkers;
+        std::shared_timed_mutex m_oQueuesMutex;
+        std::mutex m_oResizeMutex;
         std::mutex m_oSyncMutex;
         std::condition_variable m_oSyncVar;
+        std::atomic_size_t m_nQueuedTasks;
+        std::atomic_size_t m_nTargetWorkers;
+        std::atomic_size_t m_nNextQueueIdx;
         std::atomic_bool m_bIsActive;
     private:
-        void entry();
+        void entry(size_t nWorkerIdx);
+    };
+
+    /// implements a work thread pool with a compile-time initial thread count (kept for backward compatibility)
+    template<size_t nWorkers>
+    struct WorkerPool : public WorkerPool<0> {
+        static_assert(nWorkers>0,"Worker pool must have at least one work thread");
+        /// default constructor; creates 'nWorkers' threads to process queued tasks
+        WorkerPool() : WorkerPool<0>(nWorkers) {}
     };
 
+    /// returns a process-wide worker pool instance (lazily created with one thread per hardware thread)
+    WorkerPool<>& getSharedWorkerPool();
+
     /// stopwatch/chrono helper class; relies on std::chrono::high_resolution_clock internally
     struct StopWatch {
         /// default constructor; calls 'tick' for member initialization
@@ -1050,52 +1106,69 @@ namespace lv {
 
 } // namespace lv
 
-template<size_t nWorkers>
-lv::WorkerPool<nWorkers>::WorkerPool() : m_bIsActive(true) {
-    lv::unroll<nWorkers>([this](size_t){m_vhWorkers.emplace_back(std::bind(&WorkerPool::entry,this));});
-}
-
-template<size_t nWorkers>
-lv::WorkerPool<nWorkers>::~WorkerPool() {
-    {
-        std::unique_lock<std::mutex> oLock(m_oSyncMutex);
-        m_bIsActive = false;
-        m_oSyncVar.notify_all();
-    }
-    for(std::thread& oWorker : m_vhWorkers)
-        oWorker.join();
+template<typename Tfunc, typename... Targs>
+std::future<std::result_of_t<Tfunc(Targs...)>> lv::WorkerPool<0>::queueTask(Tfunc&& lTaskEntryPoint, Targs&&... args) {
+    if(!m_bIsActive)
+        lvStdError_(runtime_error,"cannot queue task, destruction in progress");
+    using task_return_t = std::result_of_t<Tfunc(Targs...)>;
+    using task_t = std::packaged_task<task_return_t()>;
+    // http://stackoverflow.com/questions/28179817/how-can-i-store-generic-packaged-tasks-in-a-container
+    std::shared_ptr<task_t> pSharableTask = std::make_shared<task_t>(std::bind(std::forward<Tfunc>(lTaskEntryPoint),std::forward<Targs>(args)...));
+    std::future<task_return_t> oTaskRes = pSharableTask->get_future();
+    pushTask([pSharableTask](){(*pSharableTask)();}); // lambda keeps a copy of the task in the queue
+    return oTaskRes;
 }
 
-template<size_t nWorkers>
 template<typename Tfunc, typename... Targs>
-std::future<std::result_of_t<Tfunc(Targs...)>> lv::WorkerPool<nWorkers>::queueTask(Tfunc&& lTaskEntryPoint, Targs&&... args) {
+std::future<std::result_of_t<Tfunc(Targs...)>> lv::WorkerPool<0>::queueTask(TaskGroup& oGroup, Tfunc&& lTaskEntryPoint, Targs&&... args) {
     if(!m_bIsActive)
         lvStdError_(runtime_error,"cannot queue task, destruction in progress");
     using task_return_t = std::result_of_t<Tfunc(Targs...)>;
     using task_t = std::packaged_task<task_return_t()>;
-    // http://stackoverflow.com/questions/28179817/how-can-i-store-generic-packaged-tasks-in-a-container
     std::shared_ptr<task_t> pSharableTask = std::make_shared<task_t>(std::bind(std::forward<Tfunc>(lTaskEntryPoint),std::forward<Targs>(args)...));
     std::future<task_return_t> oTaskRes = pSharableTask->get_future();
-    {
-        lv::mutex_lock_guard sync_lock(m_oSyncMutex);
-        m_qTasks.emplace([pSharableTask](){(*pSharableTask)();}); // lambda keeps a copy of the task in the queue
-    }
-    m_oSyncVar.notify_one();
+    ++oGroup.m_nPendingTasks;
+    pushTask([this,pSharableTask,&oGroup](){
+        (*pSharableTask)();
+        if(--oGroup.m_nPendingTasks==0) {
+            lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+            m_oSyncVar.notify_all();
+        }
+    });
     return oTaskRes;
 }
 
-template<size_t nWorkers>
-void lv::WorkerPool<nWorkers>::entry() {
-    lv::mutex_unique_lock sync_lock(m_oSyncMutex);
-    while(m_bIsActive || !m_qTasks.empty()) {
-        m_oSyncVar.wait(sync_lock,[&](){return !m_bIsActive || !m_qTasks.empty();});
-        if(!m_qTasks.empty()) {
-            std::function<void()> task = std::move(m_qTasks.front());
-            m_qTasks.pop();
-            lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock);
-            task(); // if the execution throws, the exception will be contained in the shared state returned on queue
+template<typename Tinteger, typename Tfunc>
+void lv::WorkerPool<0>::parallel_for(Tinteger nBegin, Tinteger nEnd, Tfunc&& lFunc, size_t nGrainSize) {
+    static_assert(std::is_integral<Tinteger>::value,"index type must be integral");
+    if(nEnd<=nBegin)
+        return;
+    const size_t nTotIdxCount = size_t(nEnd-nBegin);
+    if(nGrainSize==0) // by default, split the range in four chunks per worker to balance the load
+        nGrainSize = std::max(nTotIdxCount/(workers()*4),size_t(1));
+    const size_t nChunkCount = (nTotIdxCount+nGrainSize-1)/nGrainSize;
+    std::mutex oExceptionMutex;
+    std::exception_ptr pException;
+    const auto lChunk = [&](size_t nChunkIdx) {
+        try {
+            const Tinteger nChunkBegin = Tinteger(nBegin+nChunkIdx*nGrainSize);
+            const Tinteger nChunkEnd = Tinteger(nBegin+std::min((nChunkIdx+1)*nGrainSize,nTotIdxCount));
+            for(Tinteger nIdx=nChunkBegin; nIdx<nChunkEnd; ++nIdx)
+                lFunc(nIdx);
         }
-    }
+        catch(...) {
+            lv::mutex_lock_guard oLock(oExceptionMutex);
+            if(!pException)
+                pException = std::current_exception();
+        }
+    };
+    TaskGroup oGroup;
+    for(size_t nChunkIdx=1; nChunkIdx<nChunkCount; ++nChunkIdx)
+        queueTask(oGroup,lChunk,nChunkIdx);
+    lChunk(0); // the calling thread always processes the first chunk itself
+    wait(oGroup);
+    if(pException)
+        std::rethrow_exception(pException);
 }
 
 template<typename TVal, size_t nStaticSize, size_t nByteAlign>
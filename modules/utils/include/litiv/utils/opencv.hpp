@@ -27,6 +27,7 @@
 #endif //HAVE_CUDA
 #include <unordered_set>
 #include <map>
+#include <fstream>
 
 #ifndef CV_MAT_COND_DEPTH_TYPE
 #define CV_MAT_COND_DEPTH_TYPE(cvtype_flag,depth_flag,depth_type,depth_alt) \
@@ -81,6 +82,8 @@ namespace lv {
     struct MatType;
     struct DisplayHelper;
     using DisplayHelperPtr = std::shared_ptr<DisplayHelper>;
+    struct PooledMatAllocator;
+    using PooledMatAllocatorPtr = std::shared_ptr<PooledMatAllocator>;
 
     /// returns a 16-byte aligned matrix allocator for SSE(1/2/3/4.1/4.2) support (should never be modified, despite non-const!)
     cv::MatAllocator* getMatAllocator16a();
@@ -1428,6 +1431,9 @@ namespace lv {
         MatArchive_BINARY_LZ4,
 #endif //USING_LZ4
         MatArchive_BINARY,
+#if USING_LZ4
+        MatArchive_BINARY_LZ4_BLOCKS, ///< independent lz4 blocks, (de)compressed in parallel (supports >2GB mats & partial reads)
+#endif //USING_LZ4
     };
 
     /// writes matrix data locally using a binary/yml/text file format
@@ -1441,8 +1447,70 @@ namespace lv {
         return oData;
     }
 
+    /// reads a slice of matrix data [oRange.start,oRange.end) along its first dimension (only the required bytes/blocks are read for binary archives)
+    void readSlice(const std::string& sFilePath, cv::Mat& oData, const cv::Range& oRange, MatArchiveList eArchiveType=MatArchive_BINARY);
+
+    /// writes many matrices into a single container file with an index table (entries are 64-byte aligned, and can each be lz4-compressed)
+    struct MatContainerWriter {
+        /// creates (or overwrites) the container file at the given path
+        explicit MatContainerWriter(const std::string& sFilePath);
+        /// closes the container (see 'close')
+        ~MatContainerWriter();
+        /// appends a matrix to the container, and returns its entry index (compression is skipped if unavailable or useless)
+        size_t append(const cv::Mat& oData, bool bCompress=false);
+        /// writes the index table and header, and closes the file (no more entries can be appended)
+        void close();
+        /// returns the number of entries appended so far
+        inline size_t size() const {return m_vEntries.size();}
+        /// container entry descriptor, as stored in the index table
+        struct Entry {
+            uint64_t nOffset; ///< byte offset of the entry data from the beginning of the file
+            uint64_t nStoredSize; ///< byte size of the stored (possibly compressed) entry data
+            uint64_t nRawSize; ///< byte size of the matrix data once decompressed
+            int32_t nDataType; ///< opencv matrix data type
+            int32_t nDims; ///< number of matrix dimensions
+            std::array<int32_t,8> anSizes; ///< matrix dimension sizes
+            int32_t nFlags; ///< entry flags (bit 0 = lz4-compressed)
+            int32_t nReserved; ///< reserved for future use (always zero)
+        };
+        MatContainerWriter(const MatContainerWriter&) = delete;
+        MatContainerWriter& operator=(const MatContainerWriter&) = delete;
+    private:
+        const std::string m_sFilePath;
+        std::ofstream m_ssFile;
+        std::vector<Entry> m_vEntries;
+        uint64_t m_nNextOffset;
+    };
+
+    /// reads matrices from a container file via memory mapping (uncompressed entries are returned without copy, as headers into the mapping)
+    struct MatContainerReader {
+        /// maps the container file at the given path, and validates its index table
+        explicit MatContainerReader(const std::string& sFilePath);
+        /// returns the number of entries in the container
+        inline size_t size() const {return m_nEntryCount;}
+        /// returns the size/type of the matrix at the given entry index
+        lv::MatInfo getInfo(size_t nIdx) const;
+        /// returns whether the matrix at the given entry index is stored lz4-compressed
+        bool isCompressed(size_t nIdx) const;
+        /// returns the matrix at the given entry index (uncompressed entries point into the copy-on-write mapping: modifying them never alters the file, and their lifetime is tied to the reader's)
+        cv::Mat read(size_t nIdx) const;
+        MatContainerReader(const MatContainerReader&) = delete;
+        MatContainerReader& operator=(const MatContainerReader&) = delete;
+    private:
+        const MatContainerWriter::Entry& getEntry(size_t nIdx) const;
+        const lv::MappedFile m_oFile;
+        const MatContainerWriter::Entry* m_pEntries;
+        size_t m_nEntryCount;
+    };
+
+    /// packs all per-frame archives (sorted by name) of a directory into a single container file, and returns the entry count
+    size_t convertToMatContainer(const std::string& sInputDirPath, const std::string& sOutputFilePath, bool bCompress=false,
+                                 const std::string& sInputFileExt=".bin", MatArchiveList eInputArchiveType=MatArchive_BINARY);
+
     /// packs the data of several matrices into a bigger one (memalloc defrag helper)
     cv::Mat packData(const std::vector<cv::Mat>& vMats, std::vector<MatInfo>* pvOutputPackInfo=nullptr);
+    /// packs the data of several matrices into the given output matrix (reuses its allocator/buffer, e.g. for pool-allocated packets)
+    void packData(const std::vector<cv::Mat>& vMats, cv::Mat& oPacket, std::vector<MatInfo>* pvOutputPackInfo=nullptr);
     /// unpacks the data of a matrix into several matrices (note: no allocation is done! lifetime of mat vec is tied to lifetime of input mat)
     std::vector<cv::Mat> unpackData(const cv::Mat& oPacket, const std::vector<MatInfo>& vPackInfo);
 
@@ -1497,6 +1565,43 @@ namespace lv {
         }
     };
 
+    /// defines a recycling matrix allocator which returns released buffers to a pool instead of freeing them (must be created via PooledMatAllocator::create due to enable_shared_from_this interface)
+    struct PooledMatAllocator : public cv::MatAllocator, public lv::enable_shared_from_this<PooledMatAllocator> {
+        /// creates a new allocator which keeps at most nMaxPooledSize bytes of released buffers for reuse
+        static PooledMatAllocatorPtr create(size_t nMaxPooledSize=SIZE_MAX);
+        /// frees all pooled buffers (matrices still using the allocator keep it alive, so this only happens once they are all released)
+        virtual ~PooledMatAllocator();
+        /// allocates a continuous 16-byte aligned buffer, reusing a pooled one of identical size if possible
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, int flags, cv::UMatUsageFlags usageFlags) const override;
+        /// no-op, as data is always host-side
+        bool allocate(cv::UMatData* data, int accessFlags, cv::UMatUsageFlags usageFlags) const override;
+        /// returns the buffer to the pool (or frees it if the pool is full) once its last reference is released
+        void deallocate(cv::UMatData* data) const override;
+        /// frees all currently pooled buffers (buffers still in use are not affected)
+        void clear();
+        /// returns the number of buffers currently used by matrices
+        size_t getActiveBufferCount() const;
+        /// returns the number of released buffers currently held for reuse
+        size_t getPooledBufferCount() const;
+        /// returns the total number of buffers allocated on the heap since creation (i.e. excluding reuses)
+        size_t getHeapAllocCount() const;
+        PooledMatAllocator(const PooledMatAllocator&) = delete;
+        PooledMatAllocator& operator=(const PooledMatAllocator&) = delete;
+    protected:
+        /// should always be constructor via static 'create' member due to enable_shared_from_this interface
+        PooledMatAllocator(size_t nMaxPooledSize);
+        /// maximum byte count of released buffers to keep for reuse
+        const size_t m_nMaxPooledSize;
+        /// mutex protecting all pool members (allocations may happen from different threads)
+        mutable std::mutex m_oPoolMutex;
+        /// released buffers ready for reuse, with their (recycled) mat data headers, indexed by byte size
+        mutable std::multimap<size_t,cv::UMatData*> m_mPooledBuffers;
+        /// internal counters for pooled bytes, active buffers, and heap allocations
+        mutable size_t m_nPooledSize,m_nActiveBuffers,m_nHeapAllocs;
+        /// self-reference held while buffers are in use, so that matrices never outlive their allocator
+        mutable std::shared_ptr<const PooledMatAllocator> m_pSelfRef;
+    };
+
     /// temp function; msvc seems to disable cuda output unless it is passed as argument to an external-lib function call...?
     void doNotOptimize(const cv::Mat& m);
 
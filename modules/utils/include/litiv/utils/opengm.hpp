@@ -168,6 +168,59 @@ namespace lv {
             TScale m_fScale;
         };
 
+        /// sparse explicit view function wrapper for unary terms (only a sorted label subset points to explicit values, others share a default value)
+        template<typename TValue, typename TIndex=size_t, typename TLabel=size_t>
+        struct SparseExplicitViewFunction :
+                public opengm::FunctionBase<SparseExplicitViewFunction<TValue,TIndex,TLabel>,TValue,TIndex,TLabel> {
+            /// default constructor (null view data)
+            SparseExplicitViewFunction() : m_nLabelCount(0),m_nSparseSize(0),m_pLabels(nullptr),m_pValues(nullptr),m_tDefaultValue(TValue(0)) {}
+            /// view data assignment (labels must be sorted & unique; if all labels are explicit, they must also be in order, and lookups become direct)
+            void assign(TIndex nLabelCount, TIndex nSparseSize, TLabel* pLabels, TValue* pValues, TValue tDefaultValue) {
+                lvDbgAssert(nSparseSize<=nLabelCount && (nSparseSize==TIndex(0) || (pLabels && pValues)));
+                m_nLabelCount = nLabelCount;
+                m_nSparseSize = nSparseSize;
+                m_pLabels = pLabels;
+                m_pValues = pValues;
+                m_tDefaultValue = tDefaultValue;
+            }
+            /// element access function (iterator-based, as used by opengm)
+            template<class TIterator>
+            std::enable_if_t<!std::is_integral<TIterator>::value,TValue> operator()(TIterator begin) const {
+                return operator()(size_t(*begin));
+            }
+            /// element access function (returns the default value for labels outside the sparse set)
+            TValue operator()(const size_t nLabel) const {
+                lvDbgAssert(nLabel<size_t(m_nLabelCount));
+                if(m_nSparseSize==m_nLabelCount) {
+                    lvDbgAssert(size_t(m_pLabels[nLabel])==nLabel);
+                    return m_pValues[nLabel];
+                }
+                const TLabel* pLabel = std::lower_bound(m_pLabels,m_pLabels+m_nSparseSize,TLabel(nLabel));
+                return (pLabel<m_pLabels+m_nSparseSize && size_t(*pLabel)==nLabel)?m_pValues[pLabel-m_pLabels]:m_tDefaultValue;
+            }
+            /// returns the function's dimension (unary terms only)
+            size_t dimension() const {return size_t(1);}
+            /// returns the label count of the full function domain
+            size_t shape(const size_t nDimIdx) const {lvDbgAssert(nDimIdx==size_t(0)); lvIgnore(nDimIdx); return size_t(m_nLabelCount);}
+            /// returns the element count of the full function domain
+            size_t size() const {return size_t(m_nLabelCount);}
+            /// returns the number of labels that point to explicit values
+            TIndex sparseSize() const {return m_nSparseSize;}
+            /// returns the (sorted) labels that point to explicit values
+            TLabel* labels() const {return m_pLabels;}
+            /// returns the explicit values, in the same order as their labels
+            TValue* values() const {return m_pValues;}
+            /// returns the value shared by all labels outside the sparse set
+            TValue defaultValue() const {return m_tDefaultValue;}
+            /// sets the value shared by all labels outside the sparse set
+            void setDefaultValue(TValue tDefaultValue) {m_tDefaultValue = tDefaultValue;}
+        private:
+            TIndex m_nLabelCount,m_nSparseSize;
+            TLabel* m_pLabels;
+            TValue* m_pValues;
+            TValue m_tDefaultValue;
+        };
+
         /// clique interface used used for faster factor/energy/nodes access through graph model
         /// note: for optimal performance, users that know the clique's size should cast, and use derived public members instead of virtual functions
         template<typename TValue, typename TIndex=size_t, typename TLabel=size_t>
@@ -309,39 +362,57 @@ namespace lv {
             static constexpr TIndex s_nCliqueSize = TIndex(0);
         };
 
-        /// higher-order term reducer (used by FGBZ solver w/ QPBO-compatible interface)
-        template<typename TFunc, size_t nOrder, typename TValue, typename TIndex, typename TLabel, typename ReducerType>
-        inline void factorReducer(const Clique<nOrder,TValue,TIndex,TLabel>& oClique, ReducerType& oReducer, TLabel nAlphaLabel, const TLabel* aLabeling) {
+        /// higher-order term reducer for sub-graph moves (nodes mapped to a negative var idx by 'lVarIdxMapper' keep their current label, and condition the remaining terms)
+        template<typename TFunc, size_t nOrder, typename TValue, typename TIndex, typename TLabel, typename ReducerType, typename TVarIdxMapper>
+        inline void factorReducer(const Clique<nOrder,TValue,TIndex,TLabel>& oClique, ReducerType& oReducer, TLabel nAlphaLabel, const TLabel* aLabeling, TVarIdxMapper&& lVarIdxMapper) {
             if(oClique) {
-                std::array<typename ReducerType::VarId,nOrder> aTermEnergyLUT;
+                std::array<typename ReducerType::VarId,nOrder> aFreeVarIds,aTermEnergyLUT;
+                std::array<size_t,nOrder> aFreeVarPos;
                 std::array<TLabel,nOrder> aCliqueLabels;
+                size_t nFreeVars = 0;
+                for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx) {
+                    aCliqueLabels[nVarIdx] = aLabeling[oClique.m_anLUTNodeIdxs[nVarIdx]];
+                    const auto nLocalVarIdx = lVarIdxMapper(oClique.m_anGraphNodeIdxs[nVarIdx]);
+                    if(nLocalVarIdx>=0) {
+                        aFreeVarPos[nFreeVars] = nVarIdx;
+                        aFreeVarIds[nFreeVars++] = (typename ReducerType::VarId)nLocalVarIdx;
+                    }
+                }
+                if(nFreeVars==0)
+                    return;
                 std::array<TValue,(1u<<nOrder)> aCliqueCoeffs{};
-                constexpr size_t nAssignCount = 1UL<<nOrder;
+                const size_t nAssignCount = 1UL<<nFreeVars;
                 for(size_t nAssignIdx=0; nAssignIdx<nAssignCount; ++nAssignIdx) {
-                    for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx)
-                        aCliqueLabels[nVarIdx] = (nAssignIdx&(1<<nVarIdx))?nAlphaLabel:aLabeling[oClique.m_anLUTNodeIdxs[nVarIdx]];
+                    for(size_t nFreeVarIdx=0; nFreeVarIdx<nFreeVars; ++nFreeVarIdx)
+                        aCliqueLabels[aFreeVarPos[nFreeVarIdx]] = (nAssignIdx&(1<<nFreeVarIdx))?nAlphaLabel:aLabeling[oClique.m_anLUTNodeIdxs[aFreeVarPos[nFreeVarIdx]]];
+                    lvDbgAssert(oClique.m_pGraphFunctionPtr);
+                    const TValue fCurrAssignEnergy = (*(TFunc*)oClique.m_pGraphFunctionPtr)(aCliqueLabels.begin());
                     for(size_t nAssignSubsetIdx=1; nAssignSubsetIdx<nAssignCount; ++nAssignSubsetIdx) {
                         if(!(nAssignIdx&~nAssignSubsetIdx)) {
                             int nParityBit = 0;
-                            for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx)
-                                nParityBit ^= (((nAssignIdx^nAssignSubsetIdx)&(1<<nVarIdx))!=0);
-                            lvDbgAssert(oClique.m_pGraphFunctionPtr);
-                            const TValue fCurrAssignEnergy = (*(TFunc*)oClique.m_pGraphFunctionPtr)(aCliqueLabels.begin());
+                            for(size_t nFreeVarIdx=0; nFreeVarIdx<nFreeVars; ++nFreeVarIdx)
+                                nParityBit ^= (((nAssignIdx^nAssignSubsetIdx)&(1<<nFreeVarIdx))!=0);
                             aCliqueCoeffs[nAssignSubsetIdx] += nParityBit?-fCurrAssignEnergy:fCurrAssignEnergy;
                         }
                     }
                 }
                 for(size_t nAssignSubsetIdx=1; nAssignSubsetIdx<nAssignCount; ++nAssignSubsetIdx) {
                     int nCurrTermDegree = 0;
-                    for(size_t nVarIdx=0; nVarIdx<nOrder; ++nVarIdx)
-                        if(nAssignSubsetIdx&(1<<nVarIdx))
-                            aTermEnergyLUT[nCurrTermDegree++] = (typename ReducerType::VarId)oClique.m_anGraphNodeIdxs[nVarIdx];
+                    for(size_t nFreeVarIdx=0; nFreeVarIdx<nFreeVars; ++nFreeVarIdx)
+                        if(nAssignSubsetIdx&(1<<nFreeVarIdx))
+                            aTermEnergyLUT[nCurrTermDegree++] = aFreeVarIds[nFreeVarIdx];
                     std::sort(aTermEnergyLUT.begin(),aTermEnergyLUT.begin()+nCurrTermDegree);
                     oReducer.AddTerm(aCliqueCoeffs[nAssignSubsetIdx],nCurrTermDegree,aTermEnergyLUT.data());
                 }
             }
         }
 
+        /// higher-order term reducer (used by FGBZ solver w/ QPBO-compatible interface)
+        template<typename TFunc, size_t nOrder, typename TValue, typename TIndex, typename TLabel, typename ReducerType>
+        inline void factorReducer(const Clique<nOrder,TValue,TIndex,TLabel>& oClique, ReducerType& oReducer, TLabel nAlphaLabel, const TLabel* aLabeling) {
+            factorReducer<TFunc>(oClique,oReducer,nAlphaLabel,aLabeling,[](TIndex nGraphNodeIdx) {return std::ptrdiff_t(nGraphNodeIdx);});
+        }
+
         /// higher-order term reducer (opengm variation; used by FGBZ solver w/ QPBO-compatible interface)
         template<size_t nMaxOrder, typename ValueType, typename LabelType, typename FactorType, typename ReducerType>
         inline void factorReducer(FactorType& oGraphFactor, size_t nFactOrder, ReducerType& oReducer, LabelType nAlphaLabel, const size_t* pValidLUTNodeIdxs, const LabelType* aLabeling) {
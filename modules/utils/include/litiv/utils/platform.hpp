@@ -42,6 +42,29 @@ namespace lv {
     /// returns the amount of physical memory currently used on the system
     size_t getCurrentPhysMemBytesUsed();
 
+    /// private (copy-on-write) memory mapping of a whole local file (the file itself is never modified; the mapping is released on destruction)
+    struct MappedFile {
+        /// maps the file located at the given path in memory (throws if the file cannot be opened or mapped)
+        explicit MappedFile(const std::string& sFilePath);
+        /// unmaps the file (all pointers to its data become invalid)
+        ~MappedFile();
+        /// returns a pointer to the beginning of the mapped file data (page-aligned, or null if the file is empty)
+        inline const uint8_t* data() const {return m_pData;}
+        /// returns a writable pointer to the mapped file data (modified pages are privately copied, and never written back to the file)
+        inline uint8_t* writableData() const {return m_pData;}
+        /// returns the size of the mapped file, in bytes
+        inline size_t size() const {return m_nSize;}
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+    private:
+        uint8_t* m_pData;
+        size_t m_nSize;
+#if defined(_MSC_VER)
+        void* m_hFile;
+        void* m_hMapping;
+#endif //defined(_MSC_VER)
+    };
+
 } // namespace lv
 
 #if defined(_MSC_VER)
@@ -175,4 +175,149 @@ void lv::setVerbosity(int nLevel) {
     g_nVerbosity = nLevel;
 }
 
-void lv::doNotOptimizeCharPointer(char const volatile*) {}
\ No newline at end of file
+void lv::doNotOptimizeCharPointer(char const volatile*) {}
+namespace {
+
+    /// identifies the pool (and worker index) the current thread belongs to, if any
+    struct LocalWorkerInfo {
+        const void* pPool = nullptr;
+        size_t nWorkerIdx = SIZE_MAX;
+    };
+
+    thread_local LocalWorkerInfo g_oLocalWorkerInfo;
+
+} // anonymous namespace
+
+lv::WorkerPool<0>::WorkerPool(size_t nWorkers) :
+        m_nQueuedTasks(0),m_nTargetWorkers(0),m_nNextQueueIdx(0),m_bIsActive(true) {
+    resize(nWorkers?nWorkers:std::max(size_t(std::thread::hardware_concurrency()),size_t(1)));
+}
+
+lv::WorkerPool<0>::~WorkerPool() {
+    {
+        lv::mutex_unique_lock sync_lock(m_oSyncMutex);
+        m_bIsActive = false;
+        m_oSyncVar.notify_all();
+    }
+    lv::mutex_lock_guard resize_lock(m_oResizeMutex);
+    for(std::thread& oWorker : m_vhWorkers)
+        oWorker.join();
+}
+
+size_t lv::WorkerPool<0>::workers() const {
+    return m_nTargetWorkers;
+}
+
+void lv::WorkerPool<0>::resize(size_t nWorkers) {
+    lvAssert_(nWorkers>0,"worker pool must have at least one work thread");
+    lvAssert_(getLocalWorkerIdx()==SIZE_MAX,"worker pool cannot be resized from one of its own work threads");
+    lv::mutex_lock_guard resize_lock(m_oResizeMutex);
+    if(!m_bIsActive)
+        lvStdError_(runtime_error,"cannot resize pool, destruction in progress");
+    const size_t nPrevWorkers = m_vhWorkers.size();
+    if(nWorkers>nPrevWorkers) {
+        {
+            // queues are never removed, so tasks left in the queues of stopped workers can still be stolen
+            std::unique_lock<std::shared_timed_mutex> queues_lock(m_oQueuesMutex);
+            while(m_vpQueues.size()<nWorkers)
+                m_vpQueues.push_back(std::make_unique<TaskQueue>());
+        }
+        m_nTargetWorkers = nWorkers;
+        for(size_t nWorkerIdx=nPrevWorkers; nWorkerIdx<nWorkers; ++nWorkerIdx)
+            m_vhWorkers.emplace_back(std::bind(&WorkerPool::entry,this,nWorkerIdx));
+    }
+    else if(nWorkers<nPrevWorkers) {
+        {
+            lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+            m_nTargetWorkers = nWorkers;
+            m_oSyncVar.notify_all();
+        }
+        for(size_t nWorkerIdx=nWorkers; nWorkerIdx<nPrevWorkers; ++nWorkerIdx)
+            m_vhWorkers[nWorkerIdx].join();
+        m_vhWorkers.resize(nWorkers);
+    }
+}
+
+void lv::WorkerPool<0>::wait(TaskGroup& oGroup) {
+    const size_t nLocalWorkerIdx = getLocalWorkerIdx();
+    std::function<void()> lTask;
+    while(!oGroup.done()) {
+        if(popTask(nLocalWorkerIdx==SIZE_MAX?m_nNextQueueIdx.load():nLocalWorkerIdx,nLocalWorkerIdx!=SIZE_MAX,lTask)) {
+            lTask(); // tasks queued with a group never throw (exceptions are kept in their shared state)
+            lTask = nullptr;
+        }
+        else {
+            lv::mutex_unique_lock sync_lock(m_oSyncMutex);
+            m_oSyncVar.wait(sync_lock,[&](){return oGroup.done() || m_nQueuedTasks>0;});
+        }
+    }
+}
+
+void lv::WorkerPool<0>::pushTask(std::function<void()>&& lTask) {
+    const size_t nLocalWorkerIdx = getLocalWorkerIdx();
+    ++m_nQueuedTasks; // incremented before the push so that the counter never underflows when the task is popped right away
+    {
+        std::shared_lock<std::shared_timed_mutex> queues_lock(m_oQueuesMutex);
+        const size_t nQueueIdx = (nLocalWorkerIdx!=SIZE_MAX)?nLocalWorkerIdx:((m_nNextQueueIdx++)%std::max(m_nTargetWorkers.load(),size_t(1)));
+        TaskQueue& oQueue = *m_vpQueues[nQueueIdx];
+        lv::mutex_lock_guard queue_lock(oQueue.oMutex);
+        oQueue.qTasks.push_back(std::move(lTask));
+    }
+    lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+    m_oSyncVar.notify_one();
+}
+
+bool lv::WorkerPool<0>::popTask(size_t nQueueIdx, bool bIsOwner, std::function<void()>& lTask) {
+    std::shared_lock<std::shared_timed_mutex> queues_lock(m_oQueuesMutex);
+    const size_t nQueueCount = m_vpQueues.size();
+    for(size_t nOffset=0; nOffset<nQueueCount; ++nOffset) {
+        TaskQueue& oQueue = *m_vpQueues[(nQueueIdx+nOffset)%nQueueCount];
+        lv::mutex_lock_guard queue_lock(oQueue.oMutex);
+        if(!oQueue.qTasks.empty()) {
+            if(bIsOwner && nOffset==0) { // owner processes its most recent task first (better cache locality)
+                lTask = std::move(oQueue.qTasks.back());
+                oQueue.qTasks.pop_back();
+            }
+            else { // thieves take the oldest tasks first (usually the biggest ones)
+                lTask = std::move(oQueue.qTasks.front());
+                oQueue.qTasks.pop_front();
+            }
+            --m_nQueuedTasks;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t lv::WorkerPool<0>::getLocalWorkerIdx() const {
+    return (g_oLocalWorkerInfo.pPool==this)?g_oLocalWorkerInfo.nWorkerIdx:SIZE_MAX;
+}
+
+void lv::WorkerPool<0>::entry(size_t nWorkerIdx) {
+    g_oLocalWorkerInfo.pPool = this;
+    g_oLocalWorkerInfo.nWorkerIdx = nWorkerIdx;
+    std::function<void()> lTask;
+    while(nWorkerIdx<m_nTargetWorkers) {
+        if(popTask(nWorkerIdx,true,lTask)) {
+            lTask(); // if the execution throws, the exception will be contained in the shared state returned on queue
+            lTask = nullptr;
+            continue;
+        }
+        lv::mutex_unique_lock sync_lock(m_oSyncMutex);
+        if(!m_bIsActive && m_nQueuedTasks==0)
+            break;
+        m_oSyncVar.wait(sync_lock,[&](){return !m_bIsActive || m_nQueuedTasks>0 || nWorkerIdx>=m_nTargetWorkers;});
+    }
+    {
+        // a stopped worker might have consumed a wake-up notification meant for another one
+        lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+        if(m_nQueuedTasks>0)
+            m_oSyncVar.notify_one();
+    }
+    g_oLocalWorkerInfo = LocalWorkerInfo();
+}
+
+lv::WorkerPool<>& lv::getSharedWorkerPool() {
+    static lv::WorkerPool<> s_oPool;
+    return s_oPool;
+}
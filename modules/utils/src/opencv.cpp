@@ -22,6 +22,8 @@
 #endif //USING_LZ4
 
 #define DISPLAY_HELPER_USE_LARGE_CROSSHAIR 1
+#define MAT_ARCHIVE_LZ4_BLOCK_SIZE (size_t(4)*1024*1024) // raw byte size of independently compressed blocks
+#define MAT_ARCHIVE_MAX_SCRATCH_SIZE (size_t(64)*1024*1024) // max byte size of thread-local (de)compression buffers kept between calls
 
 // these are really empty shells, but we need actual allocation due to ocv's virtual interface
 lv::AlignedMatAllocator<16,false> g_oMatAlloc16a = lv::AlignedMatAllocator<16,false>();
@@ -30,6 +32,117 @@ lv::AlignedMatAllocator<32,false> g_oMatAlloc32a = lv::AlignedMatAllocator<32,fa
 cv::MatAllocator* lv::getMatAllocator16a() {return (cv::MatAllocator*)&g_oMatAlloc16a;}
 cv::MatAllocator* lv::getMatAllocator32a() {return (cv::MatAllocator*)&g_oMatAlloc32a;}
 
+lv::PooledMatAllocatorPtr lv::PooledMatAllocator::create(size_t nMaxPooledSize) {
+    struct PooledMatAllocatorWrapper : public PooledMatAllocator {
+        PooledMatAllocatorWrapper(size_t _nMaxPooledSize) : PooledMatAllocator(_nMaxPooledSize) {}
+    };
+    return std::make_shared<PooledMatAllocatorWrapper>(nMaxPooledSize);
+}
+
+lv::PooledMatAllocator::PooledMatAllocator(size_t nMaxPooledSize) :
+        m_nMaxPooledSize(nMaxPooledSize),
+        m_nPooledSize(0),
+        m_nActiveBuffers(0),
+        m_nHeapAllocs(0) {}
+
+lv::PooledMatAllocator::~PooledMatAllocator() {
+    lvDbgAssert(m_nActiveBuffers==0);
+    clear();
+}
+
+cv::UMatData* lv::PooledMatAllocator::allocate(int dims, const int* sizes, int type, void* data, size_t* step, int /*flags*/, cv::UMatUsageFlags /*usageFlags*/) const {
+    step[dims-1] = CV_ELEM_SIZE(type);
+    for(int d=dims-2; d>=0; --d)
+        step[d] = step[d+1]*sizes[d+1];
+    const size_t nBufferSize = step[0]*size_t(sizes[0]);
+    if(data!=nullptr) {
+        // user-provided buffers are only wrapped, never pooled
+        cv::UMatData* u = new cv::UMatData(this);
+        u->size = nBufferSize;
+        u->data = u->origdata = static_cast<uint8_t*>(data);
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+        return u;
+    }
+    lv::mutex_lock_guard oLock(m_oPoolMutex);
+    cv::UMatData* u;
+    auto pPooledBuffer = m_mPooledBuffers.find(nBufferSize);
+    if(pPooledBuffer!=m_mPooledBuffers.end()) {
+        u = pPooledBuffer->second;
+        m_mPooledBuffers.erase(pPooledBuffer);
+        m_nPooledSize -= nBufferSize;
+        uint8_t* pData = u->origdata;
+        // recycle the mat data header as well, so that reuses never touch the heap
+        u->~UMatData();
+        new(u) cv::UMatData(this);
+        u->data = u->origdata = pData;
+    }
+    else {
+        u = new cv::UMatData(this);
+        u->data = u->origdata = lv::AlignedMemAllocator<uint8_t,16,true>::allocate(nBufferSize);
+        ++m_nHeapAllocs;
+    }
+    u->size = nBufferSize;
+    if(m_nActiveBuffers++==0)
+        m_pSelfRef = shared_from_this();
+    return u;
+}
+
+bool lv::PooledMatAllocator::allocate(cv::UMatData* data, int /*accessFlags*/, cv::UMatUsageFlags /*usageFlags*/) const {
+    return (data!=nullptr);
+}
+
+void lv::PooledMatAllocator::deallocate(cv::UMatData* data) const {
+    if(data==nullptr)
+        return;
+    lvDbgAssert(data->urefcount>=0 && data->refcount>=0);
+    if(data->refcount!=0)
+        return;
+    if((data->flags & cv::UMatData::USER_ALLOCATED)!=0) {
+        delete data;
+        return;
+    }
+    std::shared_ptr<const PooledMatAllocator> pSelfRef; // released after the pool lock, as it might hold the last reference to this allocator
+    lv::mutex_lock_guard oLock(m_oPoolMutex);
+    lvDbgAssert(m_nPooledSize<=m_nMaxPooledSize && m_nActiveBuffers>0);
+    if(data->size<=m_nMaxPooledSize-m_nPooledSize) {
+        m_mPooledBuffers.emplace(data->size,data);
+        m_nPooledSize += data->size;
+    }
+    else {
+        lv::AlignedMemAllocator<uint8_t,16,true>::deallocate(data->origdata,data->size);
+        data->origdata = nullptr;
+        delete data;
+    }
+    if(--m_nActiveBuffers==0)
+        std::swap(pSelfRef,m_pSelfRef);
+}
+
+void lv::PooledMatAllocator::clear() {
+    lv::mutex_lock_guard oLock(m_oPoolMutex);
+    for(auto& oPooledBuffer : m_mPooledBuffers) {
+        lv::AlignedMemAllocator<uint8_t,16,true>::deallocate(oPooledBuffer.second->origdata,oPooledBuffer.first);
+        oPooledBuffer.second->origdata = nullptr;
+        delete oPooledBuffer.second;
+    }
+    m_mPooledBuffers.clear();
+    m_nPooledSize = 0;
+}
+
+size_t lv::PooledMatAllocator::getActiveBufferCount() const {
+    lv::mutex_lock_guard oLock(m_oPoolMutex);
+    return m_nActiveBuffers;
+}
+
+size_t lv::PooledMatAllocator::getPooledBufferCount() const {
+    lv::mutex_lock_guard oLock(m_oPoolMutex);
+    return m_mPooledBuffers.size();
+}
+
+size_t lv::PooledMatAllocator::getHeapAllocCount() const {
+    lv::mutex_lock_guard oLock(m_oPoolMutex);
+    return m_nHeapAllocs;
+}
+
 void lv::getLogPolarMask(int nMaskSize, int nRadialBins, int nAngularBins, cv::Mat_<int>& oOutputMask, bool bUseLienhartMask, float fRadiusOffset, int* pnFirstMaskIdx, int* pnLastMaskIdx) {
     // the mask computation strategies of Lienhart and Chatfield are inspired from their LSS implementations; see the originals at:
     //    http://www.robots.ox.ac.uk/~vgg/software/SelfSimilarity/
@@ -437,6 +550,94 @@ void lv::DisplayHelper::onMouseEvent(int nEvent, int x, int y, int nFlags, void*
     (*(std::function<void(int,int,int,int)>*)pData)(nEvent,x,y,nFlags);
 }
 
+namespace {
+
+    /// writes the common header (type, elem size/count, dims & sizes) of binary mat archives
+    void writeBinaryMatHeader(std::ostream& ssStr, const cv::Mat& oData) {
+        const int32_t nDataType = (int32_t)oData.type();
+        ssStr.write((const char*)&nDataType,sizeof(nDataType));
+        const uint64_t nElemSize = (uint64_t)oData.elemSize();
+        ssStr.write((const char*)&nElemSize,sizeof(nElemSize));
+        const uint64_t nElemCount = (uint64_t)oData.total();
+        ssStr.write((const char*)&nElemCount,sizeof(nElemCount));
+        const int32_t nDims = (int32_t)oData.dims;
+        ssStr.write((const char*)&nDims,sizeof(nDims));
+        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx) {
+            const int32_t nDimSize = (int32_t)oData.size[nDimIdx];
+            ssStr.write((const char*)&nDimSize,sizeof(nDimSize));
+        }
+    }
+
+    /// reads the common header (type, elem size/count, dims & sizes) of binary mat archives
+    void readBinaryMatHeader(std::istream& ssStr, int32_t& nDataType, uint64_t& nElemSize, uint64_t& nElemCount, std::vector<int32_t>& anSizes) {
+        ssStr.read((char*)&nDataType,sizeof(nDataType));
+        ssStr.read((char*)&nElemSize,sizeof(nElemSize));
+        ssStr.read((char*)&nElemCount,sizeof(nElemCount));
+        int32_t nDims = 0;
+        ssStr.read((char*)&nDims,sizeof(nDims));
+        lvAssert_(ssStr && nDims>=0 && nDims<=CV_MAX_DIM,"binary archive header read failed");
+        anSizes.resize(size_t(nDims));
+        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx)
+            ssStr.read((char*)&anSizes[nDimIdx],sizeof(anSizes[nDimIdx]));
+        lvAssert_(ssStr,"binary archive header read failed");
+    }
+
+#if USING_LZ4
+
+    /// releases a thread-local scratch buffer if it grew larger than what is worth keeping around between calls
+    void trimScratchBuffer(lv::AutoBuffer<char>& aBuffer) {
+        if(aBuffer.size()>MAT_ARCHIVE_MAX_SCRATCH_SIZE)
+            aBuffer.clear();
+    }
+
+    /// lz4 block table of a MatArchive_BINARY_LZ4_BLOCKS archive (compressed size of zero means the block is stored raw)
+    struct LZ4BlockTable {
+        uint64_t nBlockSize,nTotSize;
+        std::vector<int64_t> vnComprSizes;
+        std::vector<uint64_t> vnOffsets; ///< block offsets from the beginning of the block data (with an extra one for the end)
+        inline uint64_t getRawSize(size_t nBlockIdx) const {return std::min(nBlockSize,nTotSize-nBlockIdx*nBlockSize);}
+    };
+
+    /// reads the lz4 block table (which directly follows the binary mat header)
+    LZ4BlockTable readLZ4BlockTable(std::istream& ssStr, uint64_t nTotSize) {
+        LZ4BlockTable oTable;
+        oTable.nTotSize = nTotSize;
+        uint64_t nBlockCount = 0;
+        ssStr.read((char*)&oTable.nBlockSize,sizeof(oTable.nBlockSize));
+        ssStr.read((char*)&nBlockCount,sizeof(nBlockCount));
+        lvAssert_(ssStr && oTable.nBlockSize>0 && oTable.nBlockSize<=uint64_t(LZ4_MAX_INPUT_SIZE) &&
+                  nBlockCount==(nTotSize+oTable.nBlockSize-1)/oTable.nBlockSize,"bad lz4 block table header");
+        oTable.vnComprSizes.resize(size_t(nBlockCount));
+        ssStr.read((char*)oTable.vnComprSizes.data(),std::streamsize(nBlockCount*sizeof(int64_t)));
+        lvAssert_(ssStr,"lz4 block table read failed");
+        oTable.vnOffsets.resize(size_t(nBlockCount+1),0);
+        for(size_t nBlockIdx=0; nBlockIdx<size_t(nBlockCount); ++nBlockIdx) {
+            const int64_t nComprSize = oTable.vnComprSizes[nBlockIdx];
+            lvAssert_(nComprSize>=0 && uint64_t(nComprSize)<oTable.getRawSize(nBlockIdx),"bad lz4 block compressed size");
+            oTable.vnOffsets[nBlockIdx+1] = oTable.vnOffsets[nBlockIdx]+(nComprSize?uint64_t(nComprSize):oTable.getRawSize(nBlockIdx));
+        }
+        return oTable;
+    }
+
+    /// decompresses a range of lz4 blocks (read contiguously in pSrc) into pDst, using the shared worker pool
+    void decompressLZ4Blocks(const LZ4BlockTable& oTable, size_t nFirstBlockIdx, size_t nEndBlockIdx, const char* pSrc, char* pDst) {
+        lv::getSharedWorkerPool().parallel_for(nFirstBlockIdx,nEndBlockIdx,[&](size_t nBlockIdx) {
+            const char* pBlockSrc = pSrc+(oTable.vnOffsets[nBlockIdx]-oTable.vnOffsets[nFirstBlockIdx]);
+            char* pBlockDst = pDst+(nBlockIdx-nFirstBlockIdx)*oTable.nBlockSize;
+            const uint64_t nRawSize = oTable.getRawSize(nBlockIdx);
+            if(oTable.vnComprSizes[nBlockIdx]==0) // block could not be compressed, use raw data instead
+                std::copy(pBlockSrc,pBlockSrc+nRawSize,pBlockDst);
+            else {
+                const int nDecomprRes = LZ4_decompress_safe(pBlockSrc,pBlockDst,int(oTable.vnComprSizes[nBlockIdx]),int(nRawSize));
+                lvAssert__(nDecomprRes==int(nRawSize),"lz4 block decompression failed (%d)",nDecomprRes);
+            }
+        },1);
+    }
+
+#endif //USING_LZ4
+
+} // anonymous namespace
+
 void lv::write(const std::string& sFilePath, const cv::Mat& _oData, lv::MatArchiveList eArchiveType) {
     lvAssert_(!sFilePath.empty() && !_oData.empty(),"output file path and matrix must both be non-empty");
     cv::Mat oData = _oData.isContinuous()?_oData:_oData.clone();
@@ -480,18 +681,8 @@ void lv::write(const std::string& sFilePath, const cv::Mat& _oData, lv::MatArchi
     else if(eArchiveType==MatArchive_BINARY_LZ4) {
         std::ofstream ssStr(sFilePath,std::ios::binary);
         lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for writing",sFilePath.c_str());
-        const int32_t nDataType = (int32_t)oData.type();
-        ssStr.write((const char*)&nDataType,sizeof(nDataType));
-        const uint64_t nElemSize = (uint64_t)oData.elemSize();
-        ssStr.write((const char*)&nElemSize,sizeof(nElemSize));
-        const uint64_t nElemCount = (uint64_t)oData.total();
-        ssStr.write((const char*)&nElemCount,sizeof(nElemCount));
-        const int32_t nDims = (int32_t)oData.dims;
-        ssStr.write((const char*)&nDims,sizeof(nDims));
-        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx) {
-            const int32_t nDimSize = (int32_t)oData.size[nDimIdx];
-            ssStr.write((const char*)&nDimSize,sizeof(nDimSize));
-        }
+        writeBinaryMatHeader(ssStr,oData);
+        const uint64_t nElemSize = (uint64_t)oData.elemSize(), nElemCount = (uint64_t)oData.total();
         if(nElemSize*nElemCount>0u) {
             static thread_local lv::AutoBuffer<char> s_aDataBuffer;
             s_aDataBuffer.resize(size_t(nElemSize*nElemCount));
@@ -503,6 +694,7 @@ void lv::write(const std::string& sFilePath, const cv::Mat& _oData, lv::MatArchi
                 ssStr.write((const char*)(oData.data),nElemSize*nElemCount);
             else
                 ssStr.write(s_aDataBuffer.data(),nComprSize);
+            trimScratchBuffer(s_aDataBuffer);
         }
         else {
             const int32_t nComprSize = 0;
@@ -510,22 +702,52 @@ void lv::write(const std::string& sFilePath, const cv::Mat& _oData, lv::MatArchi
         }
         lvAssert_(ssStr,"binary archive write failed");
     }
+    else if(eArchiveType==MatArchive_BINARY_LZ4_BLOCKS) {
+        std::ofstream ssStr(sFilePath,std::ios::binary);
+        lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for writing",sFilePath.c_str());
+        writeBinaryMatHeader(ssStr,oData);
+        const uint64_t nTotSize = uint64_t(oData.total()*oData.elemSize());
+        const uint64_t nBlockSize = uint64_t(MAT_ARCHIVE_LZ4_BLOCK_SIZE);
+        const uint64_t nBlockCount = (nTotSize+nBlockSize-1)/nBlockSize;
+        ssStr.write((const char*)&nBlockSize,sizeof(nBlockSize));
+        ssStr.write((const char*)&nBlockCount,sizeof(nBlockCount));
+        // block table is filled once all blocks are compressed
+        const std::streampos nBlockTablePos = ssStr.tellp();
+        std::vector<int64_t> vnComprSizes(size_t(nBlockCount),0);
+        ssStr.write((const char*)vnComprSizes.data(),std::streamsize(nBlockCount*sizeof(int64_t)));
+        // blocks are compressed in parallel by batches (to bound memory usage), and written in order
+        lv::WorkerPool<>& oPool = lv::getSharedWorkerPool();
+        const size_t nBatchSize = oPool.workers()*2+1;
+        const size_t nMaxComprBlockSize = size_t(LZ4_compressBound(int(nBlockSize)));
+        static thread_local lv::AutoBuffer<char> s_aDataBuffer;
+        s_aDataBuffer.resize(nMaxComprBlockSize*nBatchSize);
+        char* pComprBuffer = s_aDataBuffer.data(); // thread-local buffer is only reachable from the calling thread
+        for(size_t nBatchBlockIdx=0; nBatchBlockIdx<size_t(nBlockCount); nBatchBlockIdx+=nBatchSize) {
+            const size_t nBatchBlockEndIdx = std::min(nBatchBlockIdx+nBatchSize,size_t(nBlockCount));
+            oPool.parallel_for(nBatchBlockIdx,nBatchBlockEndIdx,[&](size_t nBlockIdx) {
+                const uint64_t nRawSize = std::min(nBlockSize,nTotSize-nBlockIdx*nBlockSize);
+                const int nComprSize = LZ4_compress_default((const char*)oData.data+nBlockIdx*nBlockSize,pComprBuffer+(nBlockIdx-nBatchBlockIdx)*nMaxComprBlockSize,int(nRawSize),int(nMaxComprBlockSize));
+                lvAssert__(nComprSize>0,"lz4 block compression failed (%d)",nComprSize);
+                vnComprSizes[nBlockIdx] = (uint64_t(nComprSize)<nRawSize)?int64_t(nComprSize):int64_t(0);
+            },1);
+            for(size_t nBlockIdx=nBatchBlockIdx; nBlockIdx<nBatchBlockEndIdx; ++nBlockIdx) {
+                if(vnComprSizes[nBlockIdx]==0) // cannot compress any more, use raw data instead
+                    ssStr.write((const char*)oData.data+nBlockIdx*nBlockSize,std::streamsize(std::min(nBlockSize,nTotSize-nBlockIdx*nBlockSize)));
+                else
+                    ssStr.write(pComprBuffer+(nBlockIdx-nBatchBlockIdx)*nMaxComprBlockSize,std::streamsize(vnComprSizes[nBlockIdx]));
+            }
+        }
+        trimScratchBuffer(s_aDataBuffer);
+        ssStr.seekp(nBlockTablePos);
+        ssStr.write((const char*)vnComprSizes.data(),std::streamsize(nBlockCount*sizeof(int64_t)));
+        lvAssert_(ssStr,"binary archive write failed");
+    }
 #endif //USING_LZ4
     else if(eArchiveType==MatArchive_BINARY) {
         std::ofstream ssStr(sFilePath,std::ios::binary);
         lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for writing",sFilePath.c_str());
-        const int32_t nDataType = (int32_t)oData.type();
-        ssStr.write((const char*)&nDataType,sizeof(nDataType));
-        const uint64_t nElemSize = (uint64_t)oData.elemSize();
-        ssStr.write((const char*)&nElemSize,sizeof(nElemSize));
-        const uint64_t nElemCount = (uint64_t)oData.total();
-        ssStr.write((const char*)&nElemCount,sizeof(nElemCount));
-        const int32_t nDims = (int32_t)oData.dims;
-        ssStr.write((const char*)&nDims,sizeof(nDims));
-        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx) {
-            const int32_t nDimSize = (int32_t)oData.size[nDimIdx];
-            ssStr.write((const char*)&nDimSize,sizeof(nDimSize));
-        }
+        writeBinaryMatHeader(ssStr,oData);
+        const uint64_t nElemSize = (uint64_t)oData.elemSize(), nElemCount = (uint64_t)oData.total();
         ssStr.write((const char*)(oData.data),nElemSize*nElemCount);
         lvAssert_(ssStr,"binary archive write failed");
     }
@@ -575,18 +797,11 @@ void lv::read(const std::string& sFilePath, cv::Mat& oData, lv::MatArchiveList e
         std::ifstream ssStr(sFilePath,std::ios::binary);
         lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for reading",sFilePath.c_str());
         int32_t nDataType;
-        ssStr.read((char*)&nDataType,sizeof(nDataType));
-        uint64_t nElemSize;
-        ssStr.read((char*)&nElemSize,sizeof(nElemSize));
-        uint64_t nElemCount;
-        ssStr.read((char*)&nElemCount,sizeof(nElemCount));
-        int32_t nDims;
-        ssStr.read((char*)&nDims,sizeof(nDims));
-        std::vector<int32_t> anSizes(nDims);
-        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx)
-            ssStr.read((char*)&anSizes[nDimIdx],sizeof(anSizes[nDimIdx]));
-        oData.create(nDims,anSizes.data(),nDataType);
-        lvAssert_(ssStr,"binary archive read failed");
+        uint64_t nElemSize,nElemCount;
+        std::vector<int32_t> anSizes;
+        readBinaryMatHeader(ssStr,nDataType,nElemSize,nElemCount,anSizes);
+        oData.create((int)anSizes.size(),anSizes.data(),nDataType);
+        lvAssert_(uint64_t(oData.total()*oData.elemSize())==nElemSize*nElemCount,"bad binary archive header");
         if(oData.total()>0u) {
             int32_t nComprSize;
             ssStr.read((char*)&nComprSize,sizeof(nComprSize));
@@ -600,26 +815,44 @@ void lv::read(const std::string& sFilePath, cv::Mat& oData, lv::MatArchiveList e
                 lvAssert_(ssStr,"binary archive read failed");
                 lvAssert_(nElemSize*nElemCount<uint64_t(std::numeric_limits<int32_t>::max()),"binary mat size too big for lz4");
                 const int nDecomprRes = LZ4_decompress_safe(s_aDataBuffer.data(),(char*)(oData.data),nComprSize,int(nElemSize*nElemCount));
+                trimScratchBuffer(s_aDataBuffer);
                 lvAssert__(nDecomprRes==int(nElemSize*nElemCount),"lz4 decompression failed (%d)",nDecomprRes);
             }
         }
     }
+    else if(eArchiveType==MatArchive_BINARY_LZ4_BLOCKS) {
+        std::ifstream ssStr(sFilePath,std::ios::binary);
+        lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for reading",sFilePath.c_str());
+        int32_t nDataType;
+        uint64_t nElemSize,nElemCount;
+        std::vector<int32_t> anSizes;
+        readBinaryMatHeader(ssStr,nDataType,nElemSize,nElemCount,anSizes);
+        oData.create((int)anSizes.size(),anSizes.data(),nDataType);
+        lvAssert_(uint64_t(oData.total()*oData.elemSize())==nElemSize*nElemCount,"bad binary archive header");
+        const LZ4BlockTable oTable = readLZ4BlockTable(ssStr,nElemSize*nElemCount);
+        // blocks are read & decompressed by batches (to bound memory usage), straight into the output mat
+        const size_t nBlockCount = oTable.vnComprSizes.size(), nBatchSize = lv::getSharedWorkerPool().workers()*2+1;
+        static thread_local lv::AutoBuffer<char> s_aDataBuffer;
+        for(size_t nBatchBlockIdx=0; nBatchBlockIdx<nBlockCount; nBatchBlockIdx+=nBatchSize) {
+            const size_t nBatchBlockEndIdx = std::min(nBatchBlockIdx+nBatchSize,nBlockCount);
+            const size_t nComprBatchSize = size_t(oTable.vnOffsets[nBatchBlockEndIdx]-oTable.vnOffsets[nBatchBlockIdx]);
+            s_aDataBuffer.resize(nComprBatchSize);
+            ssStr.read(s_aDataBuffer.data(),std::streamsize(nComprBatchSize));
+            lvAssert_(ssStr,"binary archive read failed");
+            decompressLZ4Blocks(oTable,nBatchBlockIdx,nBatchBlockEndIdx,s_aDataBuffer.data(),(char*)oData.data+nBatchBlockIdx*oTable.nBlockSize);
+        }
+        trimScratchBuffer(s_aDataBuffer);
+    }
 #endif //USING_LZ4
     else if(eArchiveType==MatArchive_BINARY) {
         std::ifstream ssStr(sFilePath,std::ios::binary);
         lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for reading",sFilePath.c_str());
         int32_t nDataType;
-        ssStr.read((char*)&nDataType,sizeof(nDataType));
-        uint64_t nElemSize;
-        ssStr.read((char*)&nElemSize,sizeof(nElemSize));
-        uint64_t nElemCount;
-        ssStr.read((char*)&nElemCount,sizeof(nElemCount));
-        int32_t nDims;
-        ssStr.read((char*)&nDims,sizeof(nDims));
-        std::vector<int32_t> anSizes(nDims);
-        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx)
-            ssStr.read((char*)&anSizes[nDimIdx],sizeof(anSizes[nDimIdx]));
-        oData.create(nDims,anSizes.data(),nDataType);
+        uint64_t nElemSize,nElemCount;
+        std::vector<int32_t> anSizes;
+        readBinaryMatHeader(ssStr,nDataType,nElemSize,nElemCount,anSizes);
+        oData.create((int)anSizes.size(),anSizes.data(),nDataType);
+        lvAssert_(uint64_t(oData.total()*oData.elemSize())==nElemSize*nElemCount,"bad binary archive header");
         ssStr.read((char*)(oData.data),nElemSize*nElemCount);
         lvAssert_(ssStr,"binary archive read failed");
     }
@@ -627,7 +860,240 @@ void lv::read(const std::string& sFilePath, cv::Mat& oData, lv::MatArchiveList e
         lvError("unrecognized mat archive type flag");
 }
 
-cv::Mat lv::packData(const std::vector<cv::Mat>& vMats, std::vector<lv::MatInfo>* pvOutputPackInfo) {
+namespace {
+
+    /// mat container file header (the index table is written at the end of the file, once all entries are known)
+    struct MatContainerHeader {
+        std::array<char,8> acMagic; ///< container type tag, always 'LVMATCNT'
+        uint32_t nVersion; ///< container format version
+        uint32_t nReserved; ///< reserved for future use (always zero)
+        uint64_t nEntryCount; ///< number of entries in the index table
+        uint64_t nIndexOffset; ///< byte offset of the index table from the beginning of the file
+    };
+
+    constexpr std::array<char,8> s_acMatContainerMagic = {{'L','V','M','A','T','C','N','T'}};
+    constexpr uint32_t s_nMatContainerVersion = 1;
+    constexpr uint64_t s_nMatContainerAlign = 64; // entries are aligned for simd-friendly access from the mapping
+    constexpr int32_t s_nMatContainerLZ4Flag = 1;
+    static_assert(sizeof(MatContainerHeader)==32 && sizeof(lv::MatContainerWriter::Entry)==72,"unexpected mat container struct padding");
+
+} // anonymous namespace
+
+lv::MatContainerWriter::MatContainerWriter(const std::string& sFilePath) :
+        m_sFilePath(sFilePath),
+        m_ssFile(sFilePath,std::ios::binary|std::ios::trunc),
+        m_nNextOffset(s_nMatContainerAlign) {
+    lvAssert__(m_ssFile.is_open(),"could not open container file at '%s' for writing",sFilePath.c_str());
+    // header is only valid once closed; until then, the magic tag is left blank
+    const std::vector<char> vcPadding(size_t(s_nMatContainerAlign),0);
+    m_ssFile.write(vcPadding.data(),vcPadding.size());
+    lvAssert_(m_ssFile,"container header write failed");
+}
+
+lv::MatContainerWriter::~MatContainerWriter() {
+    if(m_ssFile.is_open()) {
+        try {
+            close();
+        }
+        catch(...) {
+            lvLog_(1,"could not properly close mat container at '%s'",m_sFilePath.c_str());
+        }
+    }
+}
+
+size_t lv::MatContainerWriter::append(const cv::Mat& _oData, bool bCompress) {
+    lvAssert_(m_ssFile.is_open(),"mat container already closed");
+    lvAssert_(_oData.dims<=8,"mat container entries are limited to 8 dimensions");
+    const cv::Mat oData = _oData.isContinuous()?_oData:_oData.clone();
+    Entry oEntry = {};
+    oEntry.nOffset = m_nNextOffset;
+    oEntry.nRawSize = uint64_t(oData.total()*oData.elemSize());
+    oEntry.nDataType = (int32_t)oData.type();
+    oEntry.nDims = (int32_t)oData.dims;
+    for(int nDimIdx=0; nDimIdx<oData.dims; ++nDimIdx)
+        oEntry.anSizes[nDimIdx] = (int32_t)oData.size[nDimIdx];
+    const char* pDataToWrite = (const char*)oData.data;
+    oEntry.nStoredSize = oEntry.nRawSize;
+#if USING_LZ4
+    static thread_local lv::AutoBuffer<char> s_aDataBuffer;
+    if(bCompress && oEntry.nRawSize>0u && oEntry.nRawSize<uint64_t(std::numeric_limits<int32_t>::max())) {
+        s_aDataBuffer.resize(size_t(oEntry.nRawSize));
+        const int32_t nComprSize = LZ4_compress_default((const char*)oData.data,s_aDataBuffer.data(),int32_t(oEntry.nRawSize),int32_t(oEntry.nRawSize));
+        lvAssert__(nComprSize>=0,"lz4 compression failed (%d)",nComprSize);
+        if(nComprSize>0 && uint64_t(nComprSize)<oEntry.nRawSize) { // otherwise, cannot compress any more, use raw data instead
+            pDataToWrite = s_aDataBuffer.data();
+            oEntry.nStoredSize = uint64_t(nComprSize);
+            oEntry.nFlags |= s_nMatContainerLZ4Flag;
+        }
+    }
+#else //!USING_LZ4
+    UNUSED(bCompress);
+#endif //!USING_LZ4
+    m_ssFile.write(pDataToWrite,std::streamsize(oEntry.nStoredSize));
+#if USING_LZ4
+    trimScratchBuffer(s_aDataBuffer);
+#endif //USING_LZ4
+    const uint64_t nPaddedSize = ((oEntry.nStoredSize+s_nMatContainerAlign-1)/s_nMatContainerAlign)*s_nMatContainerAlign;
+    static const std::array<char,s_nMatContainerAlign> s_acPadding = {};
+    m_ssFile.write(s_acPadding.data(),std::streamsize(nPaddedSize-oEntry.nStoredSize));
+    lvAssert_(m_ssFile,"container entry write failed");
+    m_nNextOffset += nPaddedSize;
+    m_vEntries.push_back(oEntry);
+    return m_vEntries.size()-1;
+}
+
+void lv::MatContainerWriter::close() {
+    if(!m_ssFile.is_open())
+        return;
+    m_ssFile.write((const char*)m_vEntries.data(),std::streamsize(m_vEntries.size()*sizeof(Entry)));
+    MatContainerHeader oHeader = {};
+    oHeader.acMagic = s_acMatContainerMagic;
+    oHeader.nVersion = s_nMatContainerVersion;
+    oHeader.nEntryCount = uint64_t(m_vEntries.size());
+    oHeader.nIndexOffset = m_nNextOffset;
+    m_ssFile.seekp(0);
+    m_ssFile.write((const char*)&oHeader,sizeof(oHeader));
+    lvAssert_(m_ssFile,"container index write failed");
+    m_ssFile.close();
+}
+
+lv::MatContainerReader::MatContainerReader(const std::string& sFilePath) :
+        m_oFile(sFilePath),
+        m_pEntries(nullptr),
+        m_nEntryCount(0) {
+    lvAssert__(m_oFile.size()>=sizeof(MatContainerHeader),"file at '%s' is too small to be a mat container",sFilePath.c_str());
+    const MatContainerHeader& oHeader = *(const MatContainerHeader*)m_oFile.data();
+    lvAssert__(oHeader.acMagic==s_acMatContainerMagic,"file at '%s' is not a mat container (or it was not properly closed)",sFilePath.c_str());
+    lvAssert__(oHeader.nVersion==s_nMatContainerVersion,"unsupported mat container version (%d)",(int)oHeader.nVersion);
+    lvAssert_((oHeader.nIndexOffset%alignof(MatContainerWriter::Entry))==0 && oHeader.nIndexOffset<=m_oFile.size() &&
+              oHeader.nEntryCount<=(m_oFile.size()-oHeader.nIndexOffset)/sizeof(MatContainerWriter::Entry),"bad mat container index table");
+    m_pEntries = (const MatContainerWriter::Entry*)(m_oFile.data()+oHeader.nIndexOffset);
+    m_nEntryCount = size_t(oHeader.nEntryCount);
+    for(size_t nIdx=0; nIdx<m_nEntryCount; ++nIdx) {
+        const MatContainerWriter::Entry& oEntry = m_pEntries[nIdx];
+        lvAssert__(oEntry.nOffset<=oHeader.nIndexOffset && oEntry.nStoredSize<=oHeader.nIndexOffset-oEntry.nOffset,"bad mat container entry #%zu range",nIdx);
+        lvAssert__(oEntry.nDims>=0 && oEntry.nDims<=8,"bad mat container entry #%zu dims",nIdx);
+        lvAssert__((oEntry.nFlags&s_nMatContainerLZ4Flag) || oEntry.nStoredSize==oEntry.nRawSize,"bad mat container entry #%zu size",nIdx);
+        // the entry header must describe exactly the stored data, as views into the mapping are created from it directly
+        lvAssert__((oEntry.nDataType&~CV_MAT_TYPE_MASK)==0,"bad mat container entry #%zu data type",nIdx);
+        uint64_t nExpectedRawSize = oEntry.nDims>0?uint64_t(CV_ELEM_SIZE(oEntry.nDataType)):uint64_t(0);
+        for(int32_t nDimIdx=0; nDimIdx<oEntry.nDims; ++nDimIdx) {
+            lvAssert__(oEntry.anSizes[nDimIdx]>=0,"bad mat container entry #%zu dim size",nIdx);
+            lvAssert__(oEntry.anSizes[nDimIdx]==0 || nExpectedRawSize<=std::numeric_limits<uint64_t>::max()/uint64_t(oEntry.anSizes[nDimIdx]),"bad mat container entry #%zu dim sizes (overflow)",nIdx);
+            nExpectedRawSize *= uint64_t(oEntry.anSizes[nDimIdx]);
+        }
+        lvAssert__(nExpectedRawSize==oEntry.nRawSize,"bad mat container entry #%zu raw size (got %zu bytes, expected %zu)",nIdx,size_t(oEntry.nRawSize),size_t(nExpectedRawSize));
+    }
+}
+
+const lv::MatContainerWriter::Entry& lv::MatContainerReader::getEntry(size_t nIdx) const {
+    lvAssert__(nIdx<m_nEntryCount,"mat container entry index out of range (%zu, max is %zu)",nIdx,m_nEntryCount);
+    return m_pEntries[nIdx];
+}
+
+lv::MatInfo lv::MatContainerReader::getInfo(size_t nIdx) const {
+    const MatContainerWriter::Entry& oEntry = getEntry(nIdx);
+    if(oEntry.nDims==0)
+        return lv::MatInfo();
+    return lv::MatInfo(lv::MatSize(oEntry.nDims,oEntry.anSizes.data()),oEntry.nDataType);
+}
+
+bool lv::MatContainerReader::isCompressed(size_t nIdx) const {
+    return (getEntry(nIdx).nFlags&s_nMatContainerLZ4Flag)!=0;
+}
+
+cv::Mat lv::MatContainerReader::read(size_t nIdx) const {
+    const MatContainerWriter::Entry& oEntry = getEntry(nIdx);
+    if(oEntry.nDims==0)
+        return cv::Mat();
+    if((oEntry.nFlags&s_nMatContainerLZ4Flag)==0) // size & bounds validated on construction; writes to the view are copy-on-write
+        return cv::Mat(oEntry.nDims,oEntry.anSizes.data(),oEntry.nDataType,m_oFile.writableData()+oEntry.nOffset);
+    const uint8_t* pEntryData = m_oFile.data()+oEntry.nOffset;
+#if USING_LZ4
+    cv::Mat oData(oEntry.nDims,oEntry.anSizes.data(),oEntry.nDataType);
+    lvAssert_(uint64_t(oData.total()*oData.elemSize())==oEntry.nRawSize,"bad mat container entry raw size");
+    const int nDecomprRes = LZ4_decompress_safe((const char*)pEntryData,(char*)oData.data,int(oEntry.nStoredSize),int(oEntry.nRawSize));
+    lvAssert__(nDecomprRes==int(oEntry.nRawSize),"lz4 decompression failed (%d)",nDecomprRes);
+    return oData;
+#else //!USING_LZ4
+    lvError("mat container entry is lz4-compressed, but framework was built without lz4 support");
+#endif //!USING_LZ4
+}
+
+size_t lv::convertToMatContainer(const std::string& sInputDirPath, const std::string& sOutputFilePath, bool bCompress,
+                                 const std::string& sInputFileExt, lv::MatArchiveList eInputArchiveType) {
+    std::vector<std::string> vsInputFilePaths = lv::getFilesFromDir(sInputDirPath);
+    vsInputFilePaths.erase(std::remove_if(vsInputFilePaths.begin(),vsInputFilePaths.end(),[&](const std::string& sFilePath) {
+        return sFilePath.size()<sInputFileExt.size() || sFilePath.compare(sFilePath.size()-sInputFileExt.size(),sInputFileExt.size(),sInputFileExt)!=0;
+    }),vsInputFilePaths.end());
+    lvLog_(2,"converting %zu archive(s) from '%s' into mat container at '%s'...",vsInputFilePaths.size(),sInputDirPath.c_str(),sOutputFilePath.c_str());
+    lv::MatContainerWriter oWriter(sOutputFilePath);
+    for(const std::string& sInputFilePath : vsInputFilePaths)
+        oWriter.append(lv::read(sInputFilePath,eInputArchiveType),bCompress);
+    oWriter.close();
+    return vsInputFilePaths.size();
+}
+
+void lv::readSlice(const std::string& sFilePath, cv::Mat& oData, const cv::Range& oRange, lv::MatArchiveList eArchiveType) {
+    lvAssert_(!sFilePath.empty(),"input file path must be non-empty");
+    lvAssert_(oRange.start>=0 && oRange.start<oRange.end,"invalid slice range");
+    const bool bIsBlockArchive =
+#if USING_LZ4
+        eArchiveType==MatArchive_BINARY_LZ4_BLOCKS;
+#else //!USING_LZ4
+        false;
+#endif //!USING_LZ4
+    if(eArchiveType!=MatArchive_BINARY && !bIsBlockArchive) {
+        // other archive types cannot be read partially; read everything, and only keep the slice
+        const cv::Mat oFullData = lv::read(sFilePath,eArchiveType);
+        lvAssert_(oFullData.dims>0 && oRange.end<=oFullData.size[0],"slice range out of bounds");
+        std::vector<cv::Range> voRanges((size_t)oFullData.dims,cv::Range::all());
+        voRanges[0] = oRange;
+        oFullData(voRanges.data()).copyTo(oData);
+        return;
+    }
+    std::ifstream ssStr(sFilePath,std::ios::binary);
+    lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for reading",sFilePath.c_str());
+    int32_t nDataType;
+    uint64_t nElemSize,nElemCount;
+    std::vector<int32_t> anSizes;
+    readBinaryMatHeader(ssStr,nDataType,nElemSize,nElemCount,anSizes);
+    lvAssert_(!anSizes.empty() && oRange.end<=anSizes[0],"slice range out of bounds");
+    const uint64_t nSliceStride = (nElemSize*nElemCount)/uint64_t(anSizes[0]);
+    const uint64_t nByteBegin = uint64_t(oRange.start)*nSliceStride, nByteEnd = uint64_t(oRange.end)*nSliceStride;
+    anSizes[0] = oRange.size();
+    oData.create((int)anSizes.size(),anSizes.data(),nDataType);
+    lvAssert_(uint64_t(oData.total()*oData.elemSize())==nByteEnd-nByteBegin,"bad binary archive header");
+    if(!bIsBlockArchive) {
+        ssStr.seekg(std::streamoff(nByteBegin),std::ios::cur);
+        ssStr.read((char*)oData.data,std::streamsize(nByteEnd-nByteBegin));
+        lvAssert_(ssStr,"binary archive read failed");
+        return;
+    }
+#if USING_LZ4
+    const LZ4BlockTable oTable = readLZ4BlockTable(ssStr,nElemSize*nElemCount);
+    const size_t nFirstBlockIdx = size_t(nByteBegin/oTable.nBlockSize), nEndBlockIdx = size_t((nByteEnd-1)/oTable.nBlockSize+1);
+    // only the blocks overlapping the slice are read & decompressed, by batches (to bound memory usage)
+    const size_t nBatchSize = lv::getSharedWorkerPool().workers()*2+1;
+    static thread_local lv::AutoBuffer<char> s_aDataBuffer;
+    ssStr.seekg(std::streamoff(oTable.vnOffsets[nFirstBlockIdx]),std::ios::cur);
+    for(size_t nBatchBlockIdx=nFirstBlockIdx; nBatchBlockIdx<nEndBlockIdx; nBatchBlockIdx+=nBatchSize) {
+        const size_t nBatchBlockEndIdx = std::min(nBatchBlockIdx+nBatchSize,nEndBlockIdx);
+        const size_t nComprBatchSize = size_t(oTable.vnOffsets[nBatchBlockEndIdx]-oTable.vnOffsets[nBatchBlockIdx]);
+        s_aDataBuffer.resize(nComprBatchSize+(nBatchBlockEndIdx-nBatchBlockIdx)*size_t(oTable.nBlockSize));
+        ssStr.read(s_aDataBuffer.data(),std::streamsize(nComprBatchSize));
+        lvAssert_(ssStr,"binary archive read failed");
+        char* pRawBatch = s_aDataBuffer.data()+nComprBatchSize;
+        decompressLZ4Blocks(oTable,nBatchBlockIdx,nBatchBlockEndIdx,s_aDataBuffer.data(),pRawBatch);
+        const uint64_t nRawBatchBegin = uint64_t(nBatchBlockIdx)*oTable.nBlockSize;
+        const uint64_t nCopyBegin = std::max(nByteBegin,nRawBatchBegin), nCopyEnd = std::min(nByteEnd,uint64_t(nBatchBlockEndIdx)*oTable.nBlockSize);
+        std::copy(pRawBatch+(nCopyBegin-nRawBatchBegin),pRawBatch+(nCopyEnd-nRawBatchBegin),(char*)oData.data+(nCopyBegin-nByteBegin));
+    }
+    trimScratchBuffer(s_aDataBuffer);
+#endif //USING_LZ4
+}
+
+void lv::packData(const std::vector<cv::Mat>& vMats, cv::Mat& oPacket, std::vector<lv::MatInfo>* pvOutputPackInfo) {
     if(pvOutputPackInfo!=nullptr) {
         std::vector<lv::MatInfo>& vPackInfo = *pvOutputPackInfo;
         vPackInfo.resize(vMats.size());
@@ -636,10 +1102,14 @@ cv::Mat lv::packData(const std::vector<cv::Mat>& vMats, std::vector<lv::MatInfo>
             vPackInfo[nMatIdx].type = vMats[nMatIdx].type();
         }
     }
-    if(vMats.empty())
-        return cv::Mat();
-    if(vMats.size()==1)
-        return vMats[0].clone();
+    if(vMats.empty()) {
+        oPacket.release();
+        return;
+    }
+    if(vMats.size()==1) {
+        vMats[0].copyTo(oPacket);
+        return;
+    }
     size_t nTotPacketSize = 0;
     size_t nFirstNonEmptyMatIdx = size_t(-1);
     bool bAllSameType = true;
@@ -652,11 +1122,12 @@ cv::Mat lv::packData(const std::vector<cv::Mat>& vMats, std::vector<lv::MatInfo>
             bAllSameType = bAllSameType && (vMats[nMatIdx].type()==vMats[nFirstNonEmptyMatIdx].type());
         }
     }
-    if(nTotPacketSize==0)
-        return cv::Mat();
+    if(nTotPacketSize==0) {
+        oPacket.release();
+        return;
+    }
     lvDbgAssert_(nTotPacketSize<(size_t)std::numeric_limits<int>::max(),"packed mat data alloc too big");
     lvDbgAssert(nFirstNonEmptyMatIdx!=size_t(-1));
-    cv::Mat oPacket;
     if(bAllSameType)
         oPacket.create(1,(int)(nTotPacketSize/vMats[nFirstNonEmptyMatIdx].elemSize()),vMats[nFirstNonEmptyMatIdx].type());
     else
@@ -671,6 +1142,11 @@ cv::Mat lv::packData(const std::vector<cv::Mat>& vMats, std::vector<lv::MatInfo>
         }
     }
     lvDbgAssert_(nCurrPacketIdxOffset==nTotPacketSize,"unpack has leftover data");
+}
+
+cv::Mat lv::packData(const std::vector<cv::Mat>& vMats, std::vector<lv::MatInfo>* pvOutputPackInfo) {
+    cv::Mat oPacket;
+    lv::packData(vMats,oPacket,pvOutputPackInfo);
     return oPacket;
 }
 
@@ -32,6 +32,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/resource.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #endif //(!defined(_MSC_VER))
 #include <fstream>
 #include <csignal>
@@ -252,4 +254,69 @@ size_t lv::getCurrentPhysMemBytesUsed() {
     fclose(fp);
     return size_t(nMemUsed*sysconf(_SC_PAGESIZE));
 #endif //ndef(_MSC_VER)
-}
\ No newline at end of file
+}
+
+lv::MappedFile::MappedFile(const std::string& sFilePath) :
+        m_pData(nullptr),
+        m_nSize(0) {
+#if defined(_MSC_VER)
+    m_hFile = m_hMapping = nullptr;
+    const std::wstring swFilePath(sFilePath.begin(),sFilePath.end());
+    // wide-char APIs are called explicitly, as the path is always converted to a wide string (regardless of UNICODE)
+    HANDLE hFile = CreateFileW(swFilePath.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL|FILE_FLAG_RANDOM_ACCESS,NULL);
+    lvAssert__(hFile!=INVALID_HANDLE_VALUE,"could not open file at '%s' for mapping",sFilePath.c_str());
+    // the destructor is never called if the constructor throws, so handles are released here before reporting errors
+    LARGE_INTEGER nFileSize;
+    if(!GetFileSizeEx(hFile,&nFileSize)) {
+        CloseHandle(hFile);
+        lvError_("could not query size of file at '%s'",sFilePath.c_str());
+    }
+    m_nSize = size_t(nFileSize.QuadPart);
+    if(m_nSize>0) {
+        HANDLE hMapping = CreateFileMappingW(hFile,NULL,PAGE_WRITECOPY,0,0,NULL);
+        if(hMapping==NULL) {
+            CloseHandle(hFile);
+            lvError_("could not create mapping for file at '%s'",sFilePath.c_str());
+        }
+        m_pData = (uint8_t*)MapViewOfFile(hMapping,FILE_MAP_COPY,0,0,0);
+        if(m_pData==nullptr) {
+            CloseHandle(hMapping);
+            CloseHandle(hFile);
+            lvError_("could not map file at '%s'",sFilePath.c_str());
+        }
+        m_hMapping = hMapping;
+    }
+    m_hFile = hFile;
+#else //(!defined(_MSC_VER))
+    const int nFileDesc = open(sFilePath.c_str(),O_RDONLY);
+    lvAssert__(nFileDesc!=-1,"could not open file at '%s' for mapping",sFilePath.c_str());
+    struct stat st;
+    if(fstat(nFileDesc,&st)!=0) {
+        close(nFileDesc);
+        lvError_("could not query size of file at '%s'",sFilePath.c_str());
+    }
+    m_nSize = size_t(st.st_size);
+    if(m_nSize>0) {
+        void* pData = mmap(nullptr,m_nSize,PROT_READ|PROT_WRITE,MAP_PRIVATE,nFileDesc,0);
+        close(nFileDesc); // the mapping keeps its own reference to the file
+        lvAssert__(pData!=MAP_FAILED,"could not map file at '%s'",sFilePath.c_str());
+        m_pData = (uint8_t*)pData;
+    }
+    else
+        close(nFileDesc);
+#endif //(!defined(_MSC_VER))
+}
+
+lv::MappedFile::~MappedFile() {
+#if defined(_MSC_VER)
+    if(m_pData)
+        UnmapViewOfFile(m_pData);
+    if(m_hMapping)
+        CloseHandle((HANDLE)m_hMapping);
+    if(m_hFile)
+        CloseHandle((HANDLE)m_hFile);
+#else //(!defined(_MSC_VER))
+    if(m_pData)
+        munmap((void*)m_pData,m_nSize);
+#endif //(!defined(_MSC_VER))
+}
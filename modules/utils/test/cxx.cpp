@@ -306,6 +306,62 @@ TEST(WorkerPool,regression_4threads) {
         ASSERT_EQ(vRes[i].get(),size_t(13));
 }
 
+TEST(WorkerPool,regression_resize) {
+    lv::WorkerPool<> wp(2);
+    ASSERT_EQ(wp.workers(),size_t(2));
+    ASSERT_THROW_LV_QUIET(wp.resize(0));
+    std::vector<std::future<size_t>> vRes;
+    for(size_t i=0; i<10; ++i)
+        vRes.push_back(wp.queueTask([](size_t n){std::this_thread::sleep_for(std::chrono::milliseconds(20));return n;},i));
+    wp.resize(5);
+    ASSERT_EQ(wp.workers(),size_t(5));
+    for(size_t i=0; i<10; ++i)
+        vRes.push_back(wp.queueTask([](size_t n){std::this_thread::sleep_for(std::chrono::milliseconds(20));return n;},i+10));
+    wp.resize(1);
+    ASSERT_EQ(wp.workers(),size_t(1));
+    for(size_t i=0; i<vRes.size(); ++i) {
+        ASSERT_EQ(vRes[i].wait_for(std::chrono::seconds(2)),std::future_status::ready);
+        ASSERT_EQ(vRes[i].get(),i);
+    }
+}
+
+TEST(WorkerPool,regression_taskgroup) {
+    lv::WorkerPool<> wp(3);
+    lv::WorkerPool<>::TaskGroup oGroup;
+    ASSERT_TRUE(oGroup.done());
+    std::atomic_size_t nCount(0);
+    for(size_t i=0; i<20; ++i)
+        wp.queueTask(oGroup,[&](){std::this_thread::sleep_for(std::chrono::milliseconds(rand()%10));++nCount;});
+    wp.wait(oGroup);
+    ASSERT_TRUE(oGroup.done());
+    ASSERT_EQ(nCount.load(),size_t(20));
+}
+
+TEST(WorkerPool,regression_parallel_for) {
+    lv::WorkerPool<> wp(4);
+    for(size_t nGrainSize : {size_t(0),size_t(1),size_t(7),size_t(1000)}) {
+        std::vector<int> vnVals(997,0);
+        wp.parallel_for(0,int(vnVals.size()),[&](int nIdx){vnVals[nIdx] += nIdx;},nGrainSize);
+        for(int nIdx=0; nIdx<int(vnVals.size()); ++nIdx)
+            ASSERT_EQ(vnVals[nIdx],nIdx);
+    }
+    // nested loops should not deadlock, as waiting workers help process queued tasks
+    std::atomic_size_t nCount(0);
+    wp.parallel_for(size_t(0),size_t(16),[&](size_t){wp.parallel_for(size_t(0),size_t(64),[&](size_t){++nCount;},4);},1);
+    ASSERT_EQ(nCount.load(),size_t(16*64));
+    ASSERT_THROW(wp.parallel_for(0,100,[](int nIdx){if(nIdx==42) throw std::runtime_error("test");}),std::runtime_error);
+    wp.parallel_for(10,10,[](int){FAIL();});
+}
+
+TEST(WorkerPool,regression_shared) {
+    lv::WorkerPool<>& wp = lv::getSharedWorkerPool();
+    ASSERT_EQ(&wp,&lv::getSharedWorkerPool());
+    ASSERT_GT(wp.workers(),size_t(0));
+    std::future<size_t> nRes = wp.queueTask([](){return size_t(13);});
+    ASSERT_EQ(nRes.wait_for(std::chrono::seconds(2)),std::future_status::ready);
+    ASSERT_EQ(nRes.get(),size_t(13));
+}
+
 TEST(StopWatch,regression) {
     lv::StopWatch sw;
     std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -695,6 +695,112 @@ TYPED_TEST(readwrite_fixture,regression) {
     }
 }
 
+TEST(readwrite_slice,regression) {
+    cv::RNG rng((unsigned int)time(NULL));
+    // big enough to be split in several lz4 blocks, with compressible and incompressible parts
+    cv::Mat_<float> oMat(1500,2000);
+    rng.fill(oMat.rowRange(0,700),cv::RNG::UNIFORM,-200,200,true);
+    oMat.rowRange(700,1500) = 3.0f;
+    std::vector<lv::MatArchiveList> veArchiveTypes = {lv::MatArchive_BINARY};
+#if USING_LZ4
+    veArchiveTypes.push_back(lv::MatArchive_BINARY_LZ4_BLOCKS);
+#endif //USING_LZ4
+    for(lv::MatArchiveList eArchiveType : veArchiveTypes) {
+        const std::string sArchivePath = TEST_OUTPUT_DATA_ROOT "/test_readwrite_slice.mat";
+        lv::write(sArchivePath,oMat,eArchiveType);
+        const cv::Mat oNewMat = lv::read(sArchivePath,eArchiveType);
+        ASSERT_TRUE(lv::isEqual<float>(oNewMat,oMat));
+        for(const cv::Range& oRange : {cv::Range(0,1),cv::Range(0,1500),cv::Range(650,750),cv::Range(1499,1500),cv::Range(rng.uniform(0,750),rng.uniform(750,1500))}) {
+            cv::Mat oSlice;
+            lv::readSlice(sArchivePath,oSlice,oRange,eArchiveType);
+            ASSERT_TRUE(lv::isEqual<float>(oSlice,oMat.rowRange(oRange).clone())) << "range=[" << oRange.start << "," << oRange.end << ")";
+        }
+        cv::Mat oSlice;
+        ASSERT_THROW_LV_QUIET(lv::readSlice(sArchivePath,oSlice,cv::Range(1000,1501),eArchiveType));
+    }
+}
+
+TEST(mat_container,regression) {
+    cv::RNG rng((unsigned int)time(NULL));
+    const std::string sContainerPath = TEST_OUTPUT_DATA_ROOT "/test_container.lvmc";
+    std::vector<cv::Mat> vMats;
+    {
+        lv::MatContainerWriter oWriter(sContainerPath);
+        for(size_t i=0; i<50; ++i) {
+            cv::Mat oMat(rng.uniform(10,100),rng.uniform(10,100),(i%3)?CV_16UC1:CV_32FC2);
+            if(i%2)
+                rng.fill(oMat,cv::RNG::UNIFORM,0,200,true);
+            else
+                oMat = cv::Scalar::all(double(i)); // highly compressible
+            ASSERT_EQ(oWriter.append(oMat,(i%4)<2),i);
+            vMats.push_back(oMat);
+        }
+        oWriter.append(cv::Mat());
+        vMats.push_back(cv::Mat());
+    }
+    lv::MatContainerReader oReader(sContainerPath);
+    ASSERT_EQ(oReader.size(),vMats.size());
+    for(size_t i=0; i<vMats.size(); ++i) {
+        const cv::Mat oNewMat = oReader.read(i);
+        ASSERT_EQ(lv::MatInfo(oNewMat),lv::MatInfo(vMats[i]));
+        ASSERT_EQ(oReader.getInfo(i),lv::MatInfo(vMats[i]));
+        if(!vMats[i].empty()) {
+            ASSERT_TRUE(lv::isEqual<uchar>(oNewMat,vMats[i])) << "i=" << i;
+            if(!oReader.isCompressed(i))
+                ASSERT_TRUE(((uintptr_t)oNewMat.data%64)==size_t(0));
+        }
+    }
+#if USING_LZ4
+    ASSERT_TRUE(oReader.isCompressed(0));
+#endif //USING_LZ4
+    ASSERT_FALSE(oReader.isCompressed(3));
+    ASSERT_THROW_LV_QUIET(oReader.read(vMats.size()));
+}
+
+TEST(mat_container,validation) {
+    const std::string sContainerPath = TEST_OUTPUT_DATA_ROOT "/test_container_valid.lvmc";
+    {
+        lv::MatContainerWriter oWriter(sContainerPath);
+        oWriter.append(cv::Mat(24,32,CV_16UC1,cv::Scalar_<ushort>(7)));
+    }
+    {
+        lv::MatContainerReader oReader(sContainerPath);
+        cv::Mat oView = oReader.read(0);
+        ASSERT_EQ(oView.at<ushort>(23,31),ushort(7));
+        // views are copy-on-write: modifications are local to the process, and never reach the file
+        oView = cv::Scalar_<ushort>(42);
+        ASSERT_EQ(oReader.read(0).at<ushort>(23,31),ushort(42));
+        lv::MatContainerReader oOtherReader(sContainerPath);
+        ASSERT_EQ(oOtherReader.read(0).at<ushort>(23,31),ushort(7));
+    }
+    {
+        // entry raw size must match its dims/type, otherwise the view would overrun the stored data
+        std::fstream ssFile(sContainerPath,std::ios::in|std::ios::out|std::ios::binary);
+        ASSERT_TRUE(ssFile.is_open());
+        uint64_t nIndexOffset;
+        ssFile.seekg(24);
+        ssFile.read((char*)&nIndexOffset,sizeof(nIndexOffset));
+        int32_t anSizes[2] = {48,32};
+        ssFile.seekp(std::streamoff(nIndexOffset+offsetof(lv::MatContainerWriter::Entry,anSizes)));
+        ssFile.write((const char*)anSizes,sizeof(anSizes));
+        ASSERT_TRUE((bool)ssFile);
+    }
+    ASSERT_THROW_LV_QUIET(lv::MatContainerReader oReader(sContainerPath));
+}
+
+TEST(mat_container,convert) {
+    const std::string sInputDirPath = TEST_OUTPUT_DATA_ROOT "/test_container_frames/";
+    lv::createDirIfNotExist(sInputDirPath);
+    for(size_t i=0; i<12; ++i)
+        lv::write(sInputDirPath+lv::putf("%06d.bin",(int)i),cv::Mat(24,32,CV_16UC1,cv::Scalar_<ushort>(ushort(i))));
+    const std::string sContainerPath = TEST_OUTPUT_DATA_ROOT "/test_container_frames.lvmc";
+    ASSERT_EQ(lv::convertToMatContainer(sInputDirPath,sContainerPath,true),size_t(12));
+    lv::MatContainerReader oReader(sContainerPath);
+    ASSERT_EQ(oReader.size(),size_t(12));
+    for(size_t i=0; i<oReader.size(); ++i)
+        ASSERT_EQ(oReader.read(i).at<ushort>(23,31),ushort(i));
+}
+
 TEST(pack_unpack,regression) {
     srand((uint)time(nullptr));
     cv::RNG rng((unsigned int)time(NULL));
@@ -791,6 +897,54 @@ TEST(AlignedMatAllocatorPremade,regression) {
     ASSERT_TRUE(((uintptr_t)oTest.datastart%32)==size_t(0));
 }
 
+TEST(PooledMatAllocator,regression) {
+    lv::PooledMatAllocatorPtr pAlloc = lv::PooledMatAllocator::create();
+    const uchar* pFirstData = nullptr;
+    {
+        cv::Mat_<float> oTest;
+        oTest.allocator = pAlloc.get();
+        oTest.create(12,13);
+        ASSERT_TRUE(((uintptr_t)oTest.datastart%16)==size_t(0));
+        ASSERT_EQ(pAlloc->getActiveBufferCount(),size_t(1));
+        pFirstData = oTest.data;
+    }
+    ASSERT_EQ(pAlloc->getActiveBufferCount(),size_t(0));
+    ASSERT_EQ(pAlloc->getPooledBufferCount(),size_t(1));
+    for(size_t nIter=0; nIter<10; ++nIter) {
+        cv::Mat oTest;
+        oTest.allocator = pAlloc.get();
+        oTest.create(13,12,CV_32FC1);
+        ASSERT_EQ(oTest.data,pFirstData);
+        cv::Mat oShared = oTest;
+        oTest.release();
+        ASSERT_EQ(pAlloc->getActiveBufferCount(),size_t(1));
+    }
+    ASSERT_EQ(pAlloc->getHeapAllocCount(),size_t(1));
+    cv::Mat oTest, oTest2;
+    oTest.allocator = oTest2.allocator = pAlloc.get();
+    oTest.create(12,13,CV_32FC1);
+    oTest2.create(12,13,CV_32FC1);
+    ASSERT_EQ(pAlloc->getHeapAllocCount(),size_t(2));
+    ASSERT_EQ(pAlloc->getPooledBufferCount(),size_t(0));
+    oTest.release();
+    oTest2.release();
+    ASSERT_EQ(pAlloc->getPooledBufferCount(),size_t(2));
+    pAlloc->clear();
+    ASSERT_EQ(pAlloc->getPooledBufferCount(),size_t(0));
+    lv::PooledMatAllocatorPtr pAlloc_nopool = lv::PooledMatAllocator::create(0);
+    oTest.allocator = pAlloc_nopool.get();
+    oTest.create(12,13,CV_32FC1);
+    oTest.release();
+    ASSERT_EQ(pAlloc_nopool->getPooledBufferCount(),size_t(0));
+    // matrices keep their allocator alive until released
+    oTest.allocator = pAlloc_nopool.get();
+    oTest.create(5,5,CV_8UC3);
+    pAlloc_nopool = nullptr;
+    oTest = cv::Scalar_<uchar>::all(42);
+    ASSERT_EQ(oTest.at<cv::Vec3b>(4,4),cv::Vec3b::all(42));
+    oTest.release();
+}
+
 #if USE_OPENCV_x264_TEST
 
 TEST(ffmpeg_compat,read_x264) {
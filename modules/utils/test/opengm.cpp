@@ -0,0 +1,59 @@
+
+#include "litiv/utils/defines.hpp"
+#include "litiv/test.hpp"
+#if HAVE_OPENGM
+#include "litiv/utils/opengm.hpp"
+
+TEST(gm_sparse_explicit_view_function,regression) {
+    typedef lv::gm::SparseExplicitViewFunction<float,size_t,uint8_t> SparseFunc;
+    const SparseFunc oEmptyFunc;
+    ASSERT_EQ(oEmptyFunc.size(),size_t(0));
+    ASSERT_EQ(oEmptyFunc.sparseSize(),size_t(0));
+    ASSERT_EQ(oEmptyFunc.defaultValue(),0.0f);
+    std::array<uint8_t,4> anSparseLabels = {1,4,5,9};
+    std::array<float,4> afSparseValues = {0.5f,-2.0f,7.0f,3.25f};
+    SparseFunc oSparseFunc;
+    oSparseFunc.assign(size_t(12),anSparseLabels.size(),anSparseLabels.data(),afSparseValues.data(),100.0f);
+    ASSERT_EQ(oSparseFunc.dimension(),size_t(1));
+    ASSERT_EQ(oSparseFunc.shape(0),size_t(12));
+    ASSERT_EQ(oSparseFunc.size(),size_t(12));
+    ASSERT_EQ(oSparseFunc.sparseSize(),anSparseLabels.size());
+    ASSERT_EQ(oSparseFunc.labels(),anSparseLabels.data());
+    ASSERT_EQ(oSparseFunc.values(),afSparseValues.data());
+    ASSERT_EQ(oSparseFunc.defaultValue(),100.0f);
+    for(size_t nLabel=0; nLabel<oSparseFunc.size(); ++nLabel) {
+        const auto pLabel = std::find(anSparseLabels.begin(),anSparseLabels.end(),uint8_t(nLabel));
+        const float fExpectedValue = (pLabel!=anSparseLabels.end())?afSparseValues[pLabel-anSparseLabels.begin()]:100.0f;
+        ASSERT_EQ(oSparseFunc(nLabel),fExpectedValue) << "nLabel=" << nLabel;
+        // opengm accesses factor values through label iterators (which may not be of the function's label type)
+        const std::array<size_t,1> anLabelIter = {nLabel};
+        ASSERT_EQ(oSparseFunc(anLabelIter.begin()),fExpectedValue) << "nLabel=" << nLabel;
+        const uint16_t anShortLabelIter[1] = {uint16_t(nLabel)};
+        ASSERT_EQ(oSparseFunc(anShortLabelIter),fExpectedValue) << "nLabel=" << nLabel;
+    }
+    oSparseFunc.setDefaultValue(-1.0f);
+    ASSERT_EQ(oSparseFunc.defaultValue(),-1.0f);
+    ASSERT_EQ(oSparseFunc(size_t(0)),-1.0f);
+    ASSERT_EQ(oSparseFunc(size_t(11)),-1.0f);
+    ASSERT_EQ(oSparseFunc(size_t(9)),3.25f);
+    // view data is not copied; explicit values can be updated in place
+    afSparseValues[2] = 42.0f;
+    ASSERT_EQ(oSparseFunc(size_t(5)),42.0f);
+    // when all labels are explicit, lookups are direct, and the default value is never used
+    std::array<uint8_t,5> anDenseLabels = {0,1,2,3,4};
+    std::array<float,5> afDenseValues = {4.0f,3.0f,2.0f,1.0f,0.0f};
+    SparseFunc oDenseFunc;
+    oDenseFunc.assign(size_t(5),anDenseLabels.size(),anDenseLabels.data(),afDenseValues.data(),100.0f);
+    for(size_t nLabel=0; nLabel<oDenseFunc.size(); ++nLabel) {
+        ASSERT_EQ(oDenseFunc(nLabel),afDenseValues[nLabel]) << "nLabel=" << nLabel;
+        const std::array<size_t,1> anLabelIter = {nLabel};
+        ASSERT_EQ(oDenseFunc(anLabelIter.begin()),afDenseValues[nLabel]) << "nLabel=" << nLabel;
+    }
+    // without any explicit label, every lookup returns the default value
+    SparseFunc oDefaultFunc;
+    oDefaultFunc.assign(size_t(3),size_t(0),nullptr,nullptr,5.0f);
+    for(size_t nLabel=0; nLabel<oDefaultFunc.size(); ++nLabel)
+        ASSERT_EQ(oDefaultFunc(nLabel),5.0f) << "nLabel=" << nLabel;
+}
+
+#endif //HAVE_OPENGM
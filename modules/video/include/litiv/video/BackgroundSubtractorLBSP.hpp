@@ -39,6 +39,13 @@ struct IBackgroundSubtractorLBSP_ : public IBackgroundSubtractor_<eImpl> {
 
     /// returns a copy of the latest reconstructed background descriptors image
     virtual void getBackgroundDescriptorsImage(cv::OutputArray oBGDescImg) const = 0;
+    /// toggles the interleaved per-pixel sample model layout for sample-based impls (must be set before initialization)
+    void setInterleavedModelLayout(bool bEnabled) {
+        lvAssert_(!this->m_bInitialized,"model layout must be set before initialization");
+        m_bUseInterleavedModel = bEnabled;
+    }
+    /// returns whether the interleaved per-pixel sample model layout is used or not
+    bool isUsingInterleavedModelLayout() const {return m_bUseInterleavedModel;}
 
 protected:
     /// default impl constructor (defined here as MSVC is very prude with template-class-template-cstor-definitions)
@@ -49,7 +56,11 @@ protected:
                                std::enable_if_t<eImplTemp==lv::NonParallel>* /*pUnused*/=0) :
             m_nLBSPThresholdOffset(nLBSPThresholdOffset),
             m_fRelLBSPThreshold(fRelLBSPThreshold),
-            m_nDefaultMedianBlurKernelSize(nDefaultMedianBlurKernelSize) {
+            m_nDefaultMedianBlurKernelSize(nDefaultMedianBlurKernelSize),
+            m_bUseInterleavedModel(false),
+            m_nPxModelDescOffset(0),
+            m_nPxModelSampleStepSize(0),
+            m_nPxModelStepSize(0) {
         lvAssert_(m_fRelLBSPThreshold>=0,"relative threshold for LBSP features must be non-negative");
         IIBackgroundSubtractor::m_nROIBorderSize = LBSP::PATCH_SIZE/2;
     }
@@ -66,7 +77,11 @@ protected:
             IBackgroundSubtractor_GLSL(nLevels,nComputeStages,nExtraSSBOs,nExtraACBOs,nExtraImages,nExtraTextures,nDebugType,bUseDisplay,bUseTimers,bUseIntegralFormat),
             m_nLBSPThresholdOffset(nLBSPThresholdOffset),
             m_fRelLBSPThreshold(fRelLBSPThreshold),
-            m_nDefaultMedianBlurKernelSize(nDefaultMedianBlurKernelSize) {
+            m_nDefaultMedianBlurKernelSize(nDefaultMedianBlurKernelSize),
+            m_bUseInterleavedModel(false),
+            m_nPxModelDescOffset(0),
+            m_nPxModelSampleStepSize(0),
+            m_nPxModelStepSize(0) {
         lvAssert_(m_fRelLBSPThreshold>=0,"relative threshold for LBSP features must be non-negative");
         IIBackgroundSubtractor::m_nROIBorderSize = LBSP::PATCH_SIZE/2;
     }
@@ -97,6 +112,53 @@ protected:
     const int m_nDefaultMedianBlurKernelSize;
     /// copy of latest descriptors (used when refreshing model)
     cv::Mat m_oLastDescFrame;
+
+    /// (re)allocates the sample-based bg model using the selected layout (should be called in impl-specific initialize func)
+    void initialize_model(size_t nBGSamples);
+    /// returns a pointer to the interleaved model block of a given pixel (all its samples are contiguous & 32-byte aligned)
+    inline uchar* getBGPxModelPtr(size_t nPxIter) {
+        lvDbgAssert(m_bUseInterleavedModel && nPxIter*m_nPxModelStepSize<m_vnBGPxModelData.size());
+        return m_vnBGPxModelData.data()+nPxIter*m_nPxModelStepSize;
+    }
+    /// returns a pointer to the interleaved model block of a given pixel (all its samples are contiguous & 32-byte aligned)
+    inline const uchar* getBGPxModelPtr(size_t nPxIter) const {
+        lvDbgAssert(m_bUseInterleavedModel && nPxIter*m_nPxModelStepSize<m_vnBGPxModelData.size());
+        return m_vnBGPxModelData.data()+nPxIter*m_nPxModelStepSize;
+    }
+    /// returns a pointer to the color intensities of a given bg sample for a given pixel (valid for both layouts)
+    inline uchar* getBGColorSamplePtr(size_t nSampleIdx, size_t nPxIter) {
+        if(m_bUseInterleavedModel)
+            return getBGPxModelPtr(nPxIter)+nSampleIdx*m_nPxModelSampleStepSize;
+        return m_voBGColorSamples[nSampleIdx].data+nPxIter*this->m_nImgChannels;
+    }
+    /// returns a pointer to the color intensities of a given bg sample for a given pixel (valid for both layouts)
+    inline const uchar* getBGColorSamplePtr(size_t nSampleIdx, size_t nPxIter) const {
+        if(m_bUseInterleavedModel)
+            return getBGPxModelPtr(nPxIter)+nSampleIdx*m_nPxModelSampleStepSize;
+        return m_voBGColorSamples[nSampleIdx].data+nPxIter*this->m_nImgChannels;
+    }
+    /// returns a pointer to the LBSP descriptors of a given bg sample for a given pixel (valid for both layouts)
+    inline ushort* getBGDescSamplePtr(size_t nSampleIdx, size_t nPxIter) {
+        if(m_bUseInterleavedModel)
+            return (ushort*)(getBGPxModelPtr(nPxIter)+nSampleIdx*m_nPxModelSampleStepSize+m_nPxModelDescOffset);
+        return (ushort*)(m_voBGDescSamples[nSampleIdx].data)+nPxIter*this->m_nImgChannels;
+    }
+    /// returns a pointer to the LBSP descriptors of a given bg sample for a given pixel (valid for both layouts)
+    inline const ushort* getBGDescSamplePtr(size_t nSampleIdx, size_t nPxIter) const {
+        if(m_bUseInterleavedModel)
+            return (const ushort*)(getBGPxModelPtr(nPxIter)+nSampleIdx*m_nPxModelSampleStepSize+m_nPxModelDescOffset);
+        return (const ushort*)(m_voBGDescSamples[nSampleIdx].data)+nPxIter*this->m_nImgChannels;
+    }
+    /// specifies whether the bg samples are kept in the interleaved per-pixel buffer, or in one matrix per sample
+    bool m_bUseInterleavedModel;
+    /// interleaved model layout: byte offset of the descriptors inside a sample, sample step size, and pixel block step size
+    size_t m_nPxModelDescOffset, m_nPxModelSampleStepSize, m_nPxModelStepSize;
+    /// interleaved model buffer, where all color+desc samples of a pixel are contiguous
+    lv::aligned_vector<uchar,32> m_vnBGPxModelData;
+    /// background model pixel intensity samples (one matrix per sample, unused with the interleaved layout)
+    std::vector<cv::Mat> m_voBGColorSamples;
+    /// background model descriptors samples (one matrix per sample, unused with the interleaved layout)
+    std::vector<cv::Mat> m_voBGDescSamples;
 };
 
 #if HAVE_GLSL
@@ -144,12 +144,6 @@ public:
     virtual void getBackgroundImage(cv::OutputArray oBGImg) const override;
     /// returns a copy of the latest reconstructed background descriptors image
     virtual void getBackgroundDescriptorsImage(cv::OutputArray oBGDescImg) const override;
-
-protected:
-    /// background model pixel intensity samples
-    std::vector<cv::Mat> m_voBGColorSamples;
-    /// background model descriptors samples
-    std::vector<cv::Mat> m_voBGDescSamples;
 };
 
 using BackgroundSubtractorLOBSTER = BackgroundSubtractorLOBSTER_<lv::NonParallel>;
@@ -29,6 +29,8 @@
 #define BGSSUBSENSE_DEFAULT_REQUIRED_NB_BG_SAMPLES (2)
 /// defines the default value for BackgroundSubtractorSuBSENSE::m_nSamplesForMovingAvgs
 #define BGSSUBSENSE_DEFAULT_N_SAMPLES_FOR_MV_AVGS (100)
+/// defines the default value for BackgroundSubtractorSuBSENSE::m_nParallelBandHeight (must be at least as large as the biggest spread pattern)
+#define BGSSUBSENSE_DEFAULT_PARALLEL_BAND_HEIGHT (8)
 
 /**
     Self-Balanced Sensitivity segmenTER (SuBSENSE) algorithm for FG/BG video segmentation via change detection.
@@ -67,8 +69,14 @@ public:
     void getBackgroundDescriptorsImage(cv::OutputArray backgroundDescImage) const override;
     /// returns the default learning rate value used in 'apply'
     virtual double getDefaultLearningRate() const override {return 0;}
+    /// toggles the row-band parallel mode used in 'apply' (results then only depend on the seed, and not on the thread count)
+    void setParallelBandMode(bool bEnabled, uint nSeed=0, size_t nBandHeight=BGSSUBSENSE_DEFAULT_PARALLEL_BAND_HEIGHT);
+    /// returns whether the row-band parallel mode is used in 'apply' or not
+    bool isUsingParallelBandMode() const {return m_bUseParallelBands;}
 
 protected:
+    /// recomputes the row band offsets in the model index LUT (used in parallel mode)
+    void updateParallelBandOffsets();
     /// absolute minimal color distance threshold ('R' or 'radius' in the original ViBe paper, used as the default/initial 'R(x)' value here)
     const size_t m_nMinColorDistThreshold;
     /// absolute descriptor distance threshold offset
@@ -91,11 +99,14 @@ protected:
     bool m_bUse3x3Spread;
     /// specifies the downsampled frame size used for cam motion analysis
     cv::Size m_oDownSampledFrameSize;
-
-    /// background model pixel color intensity samples (equivalent to 'B(x)' in PBAS)
-    std::vector<cv::Mat> m_voBGColorSamples;
-    /// background model descriptors samples
-    std::vector<cv::Mat> m_voBGDescSamples;
+    /// specifies whether pixels are processed in concurrent row bands or not
+    bool m_bUseParallelBands;
+    /// seed used to initialize the per-band random generators in parallel mode
+    uint m_nParallelBandSeed;
+    /// height of the row bands used in parallel mode (in pixels)
+    size_t m_nParallelBandHeight;
+    /// model index LUT offsets delimiting each row band (with an extra end offset)
+    std::vector<size_t> m_vnBandModelIdxOffsets;
 
     /// per-pixel update rates ('T(x)' in PBAS, which contains pixel-level 'sigmas', as referred to in ViBe)
     cv::Mat m_oUpdateRateFrame;
@@ -24,42 +24,61 @@ void IBackgroundSubtractorLBSP_<eImpl>::initialize_common(const cv::Mat& oInitIm
     m_oLastDescFrame.create(this->m_oImgSize,CV_16UC((int)this->m_nImgChannels));
     m_oLastDescFrame = cv::Scalar_<ushort>::all(0);
     const int nLBSPBorderSize = (int)LBSP::PATCH_SIZE/2;
+    lvAssert(m_oLastDescFrame.step.p[0]==this->m_oLastColorFrame.step.p[0]*2 && m_oLastDescFrame.step.p[1]==this->m_oLastColorFrame.step.p[1]*2);
     if(this->m_nImgChannels==1) {
-        lvAssert(m_oLastDescFrame.step.p[0]==this->m_oLastColorFrame.step.p[0]*2 && m_oLastDescFrame.step.p[1]==this->m_oLastColorFrame.step.p[1]*2);
         for(size_t t=0; t<=UCHAR_MAX; ++t)
             m_anLBSPThreshold_8bitLUT[t] = cv::saturate_cast<uchar>((t*m_fRelLBSPThreshold+m_nLBSPThresholdOffset)/3);
-        for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter) {
-            const int nImgCoord_X = this->m_voPxInfoLUT[nPxIter].nImgCoord_X;
-            const int nImgCoord_Y = this->m_voPxInfoLUT[nPxIter].nImgCoord_Y;
-            if(this->m_oROI.data[nPxIter] && nImgCoord_X>nLBSPBorderSize && nImgCoord_Y>nLBSPBorderSize && nImgCoord_X<oInitImg.cols-nLBSPBorderSize && nImgCoord_Y<oInitImg.rows-nLBSPBorderSize) {
-                const size_t nDescIter = nPxIter*2;
-                LBSP::computeDescriptor<1>(oInitImg,oInitImg.data[nPxIter],nImgCoord_X,nImgCoord_Y,0,m_anLBSPThreshold_8bitLUT[oInitImg.data[nPxIter]],*((ushort*)(m_oLastDescFrame.data+nDescIter)));
-            }
-        }
     }
     else { //(m_nImgChannels==3 || m_nImgChannels==4)
-        lvAssert(m_oLastDescFrame.step.p[0]==this->m_oLastColorFrame.step.p[0]*2 && m_oLastDescFrame.step.p[1]==this->m_oLastColorFrame.step.p[1]*2);
         for(size_t t=0; t<=UCHAR_MAX; ++t)
             m_anLBSPThreshold_8bitLUT[t] = cv::saturate_cast<uchar>(t*m_fRelLBSPThreshold+m_nLBSPThresholdOffset);
-        for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter) {
-            const int nImgCoord_X = this->m_voPxInfoLUT[nPxIter].nImgCoord_X;
-            const int nImgCoord_Y = this->m_voPxInfoLUT[nPxIter].nImgCoord_Y;
-            if(this->m_oROI.data[nPxIter] && nImgCoord_X>nLBSPBorderSize && nImgCoord_Y>nLBSPBorderSize && nImgCoord_X<oInitImg.cols-nLBSPBorderSize && nImgCoord_Y<oInitImg.rows-nLBSPBorderSize) {
-                const size_t nPxRGBIter = nPxIter*this->m_nImgChannels;
-                const size_t nDescRGBIter = nPxRGBIter*2;
-                if(this->m_nImgChannels==3) {
-                    alignas(16) std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,3> aanLBSPLookupVals;
-                    LBSP::computeDescriptor_lookup(oInitImg,nImgCoord_X,nImgCoord_Y,aanLBSPLookupVals);
-                    for(size_t c=0; c<3; ++c)
-                        ((ushort*)(m_oLastDescFrame.data+nDescRGBIter))[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],oInitImg.data[nPxRGBIter+c],m_anLBSPThreshold_8bitLUT[oInitImg.data[nPxRGBIter+c]]);
-                }
-                else { //m_nImgChannels==4
-                    alignas(16) std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,4> aanLBSPLookupVals;
-                    LBSP::computeDescriptor_lookup(oInitImg,nImgCoord_X,nImgCoord_Y,aanLBSPLookupVals);
-                    for(size_t c=0; c<4; ++c)
-                        ((ushort*)(m_oLastDescFrame.data+nDescRGBIter))[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],oInitImg.data[nPxRGBIter+c],m_anLBSPThreshold_8bitLUT[oInitImg.data[nPxRGBIter+c]]);
-                }
-            }
+    }
+    // descriptors are computed row-wise for all pixels strictly inside the LBSP border, and then cleared outside the ROI
+    const int nFirstCoord = nLBSPBorderSize+1;
+    const size_t nRowPxCount = size_t(std::max(oInitImg.cols-nLBSPBorderSize-nFirstCoord,0));
+    for(int nImgCoord_Y=nFirstCoord; nImgCoord_Y<oInitImg.rows-nLBSPBorderSize; ++nImgCoord_Y) {
+        ushort* const anDescRow = m_oLastDescFrame.ptr<ushort>(nImgCoord_Y,nFirstCoord);
+        if(this->m_nImgChannels==1)
+            LBSP::computeDescriptor_strip<1>(oInitImg,nFirstCoord,nImgCoord_Y,nRowPxCount,m_anLBSPThreshold_8bitLUT,anDescRow);
+        else if(this->m_nImgChannels==3)
+            LBSP::computeDescriptor_strip<3>(oInitImg,nFirstCoord,nImgCoord_Y,nRowPxCount,m_anLBSPThreshold_8bitLUT,anDescRow);
+        else //m_nImgChannels==4
+            LBSP::computeDescriptor_strip<4>(oInitImg,nFirstCoord,nImgCoord_Y,nRowPxCount,m_anLBSPThreshold_8bitLUT,anDescRow);
+        const uchar* const anROIRow = this->m_oROI.template ptr<uchar>(nImgCoord_Y,nFirstCoord);
+        for(size_t nPxIdx=0; nPxIdx<nRowPxCount; ++nPxIdx)
+            if(!anROIRow[nPxIdx])
+                std::fill_n(anDescRow+nPxIdx*this->m_nImgChannels,this->m_nImgChannels,ushort(0));
+    }
+}
+
+template<lv::ParallelAlgoType eImpl>
+void IBackgroundSubtractorLBSP_<eImpl>::initialize_model(size_t nBGSamples) {
+    lvDbgExceptionWatch;
+    static_assert(LBSP::DESC_SIZE==2,"bad assumptions in impl below");
+    lvAssert_(nBGSamples>0,"bg model must contain at least one sample");
+    lvAssert_(this->m_nImgChannels>=1 && this->m_nImgChannels<=4,"unexpected input image channel count");
+    m_voBGColorSamples.clear();
+    m_voBGDescSamples.clear();
+    m_vnBGPxModelData.clear();
+    if(m_bUseInterleavedModel) {
+        // each sample holds its color intensities, followed by its (2-byte aligned) descriptors; each pixel block then
+        // holds all its samples contiguously, and is padded to 32 bytes so that its first sample starts on a cache line
+        // boundary (e.g. a grayscale sample is 4 bytes, so 16 samples fit in a single cache line)
+        m_nPxModelDescOffset = ((this->m_nImgChannels+1)/2)*2;
+        m_nPxModelSampleStepSize = ((m_nPxModelDescOffset+this->m_nImgChannels*LBSP::DESC_SIZE+3)/4)*4;
+        m_nPxModelStepSize = ((nBGSamples*m_nPxModelSampleStepSize+31)/32)*32;
+        m_vnBGPxModelData.resize(this->m_nTotPxCount*m_nPxModelStepSize,uchar(0));
+    }
+    else {
+        m_nPxModelDescOffset = m_nPxModelSampleStepSize = m_nPxModelStepSize = 0;
+        m_vnBGPxModelData.shrink_to_fit();
+        m_voBGColorSamples.resize(nBGSamples);
+        m_voBGDescSamples.resize(nBGSamples);
+        for(size_t s=0; s<nBGSamples; ++s) {
+            m_voBGColorSamples[s].create(this->m_oImgSize,CV_8UC((int)this->m_nImgChannels));
+            m_voBGColorSamples[s] = cv::Scalar_<uchar>::all(0);
+            m_voBGDescSamples[s].create(this->m_oImgSize,CV_16UC((int)this->m_nImgChannels));
+            m_voBGDescSamples[s] = cv::Scalar_<ushort>::all(0);
         }
     }
 }
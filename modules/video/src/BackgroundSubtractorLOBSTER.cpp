@@ -414,6 +414,18 @@ void BackgroundSubtractorLOBSTER::refreshModel(float fSamplesRefreshFrac, bool b
     lvAssert_(fSamplesRefreshFrac>0.0f && fSamplesRefreshFrac<=1.0f,"model refresh must be given as a non-null fraction");
     const size_t nModelSamplesToRefresh = fSamplesRefreshFrac<1.0f?(size_t)(fSamplesRefreshFrac*m_nBGSamples):m_nBGSamples;
     const size_t nRefreshSampleStartPos = fSamplesRefreshFrac<1.0f?rand()%m_nBGSamples:0;
+    // all descriptors which might be sampled below are computed beforehand using the row-wise LBSP kernel
+    const int nLBSPBorderSize = (int)LBSP::PATCH_SIZE/2;
+    const size_t nRowPxCount = size_t(std::max(m_oImgSize.width-nLBSPBorderSize*2,0));
+    for(int nImgCoord_Y=nLBSPBorderSize; nImgCoord_Y<m_oImgSize.height-nLBSPBorderSize; ++nImgCoord_Y) {
+        ushort* const anDescRow = m_oLastDescFrame.ptr<ushort>(nImgCoord_Y,nLBSPBorderSize);
+        if(m_nImgChannels==1)
+            LBSP::computeDescriptor_strip<1>(m_oLastColorFrame,nLBSPBorderSize,nImgCoord_Y,nRowPxCount,m_anLBSPThreshold_8bitLUT,anDescRow);
+        else if(m_nImgChannels==3)
+            LBSP::computeDescriptor_strip<3>(m_oLastColorFrame,nLBSPBorderSize,nImgCoord_Y,nRowPxCount,m_anLBSPThreshold_8bitLUT,anDescRow);
+        else //m_nImgChannels==4
+            LBSP::computeDescriptor_strip<4>(m_oLastColorFrame,nLBSPBorderSize,nImgCoord_Y,nRowPxCount,m_anLBSPThreshold_8bitLUT,anDescRow);
+    }
     for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
         const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
         if(bForceFGUpdate || !m_oLastFGMask.data[nPxIter]) {
@@ -423,15 +435,11 @@ void BackgroundSubtractorLOBSTER::refreshModel(float fSamplesRefreshFrac, bool b
                 const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
                 if(bForceFGUpdate || !m_oLastFGMask.data[nSamplePxIdx]) {
                     const size_t nCurrRealModelSampleIdx = nCurrModelSampleIdx%m_nBGSamples;
+                    uchar* const anBGColor = getBGColorSamplePtr(nCurrRealModelSampleIdx,nPxIter);
+                    ushort* const anBGDesc = getBGDescSamplePtr(nCurrRealModelSampleIdx,nPxIter);
                     for(size_t c=0; c<m_nImgChannels; ++c) {
-                        m_voBGColorSamples[nCurrRealModelSampleIdx].data[nPxIter*m_nImgChannels+c] = m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c];
-                        if(m_nImgChannels==1)
-                            LBSP::computeDescriptor<1>(m_oLastColorFrame,m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,0,m_anLBSPThreshold_8bitLUT[m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c]],*((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2)));
-                        else if(m_nImgChannels==3)
-                            LBSP::computeDescriptor<3>(m_oLastColorFrame,m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,c,m_anLBSPThreshold_8bitLUT[m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c]],*((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2)));
-                        else //m_nImgChannels==4
-                            LBSP::computeDescriptor<4>(m_oLastColorFrame,m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,c,m_anLBSPThreshold_8bitLUT[m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c]],*((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2)));
-                        *((ushort*)(m_voBGDescSamples[nCurrRealModelSampleIdx].data+(nPxIter*m_nImgChannels+c)*2)) = *((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2));
+                        anBGColor[c] = m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c];
+                        anBGDesc[c] = *((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2));
                     }
                 }
             }
@@ -443,14 +451,7 @@ void BackgroundSubtractorLOBSTER::initialize(const cv::Mat& oInitImg, const cv::
     lvDbgExceptionWatch;
     // == init
     IBackgroundSubtractorLBSP::initialize_common(oInitImg,oROI);
-    m_voBGColorSamples.resize(m_nBGSamples);
-    m_voBGDescSamples.resize(m_nBGSamples);
-    for(size_t s=0; s<m_nBGSamples; ++s) {
-        m_voBGColorSamples[s].create(m_oImgSize,CV_8UC((int)m_nImgChannels));
-        m_voBGColorSamples[s] = cv::Scalar_<uchar>::all(0);
-        m_voBGDescSamples[s].create(m_oImgSize,CV_16UC((int)m_nImgChannels));
-        m_voBGDescSamples[s] = cv::Scalar_<ushort>::all(0);
-    }
+    IBackgroundSubtractorLBSP::initialize_model(m_nBGSamples);
     m_bInitialized = true;
     refreshModel(1.0f,true);
     m_bModelInitialized = true;
@@ -471,7 +472,6 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _oInputImg, cv::OutputArr
     if(m_nImgChannels==1) {
         for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
             const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
-            const size_t nDescIter = nPxIter*2;
             const int nCurrImgCoord_X = m_voPxInfoLUT[nPxIter].nImgCoord_X;
             const int nCurrImgCoord_Y = m_voPxInfoLUT[nPxIter].nImgCoord_Y;
             const uchar nCurrColor = oInputImg.data[nPxIter];
@@ -479,13 +479,13 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _oInputImg, cv::OutputArr
             LBSP::computeDescriptor_lookup<1>(oInputImg,nCurrImgCoord_X,nCurrImgCoord_Y,0,anLBSPLookupVals);
             size_t nGoodSamplesCount=0, nModelIdx=0;
             while(nGoodSamplesCount<m_nRequiredBGSamples && nModelIdx<m_nBGSamples) {
-                const uchar nBGColor = m_voBGColorSamples[nModelIdx].data[nPxIter];
+                const uchar nBGColor = *getBGColorSamplePtr(nModelIdx,nPxIter);
                 {
                     const size_t nColorDist = lv::L1dist(nCurrColor,nBGColor);
                     if(nColorDist>m_nColorDistThreshold/2)
                         goto failedcheck1ch;
                     const ushort nCurrInputDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nBGColor,m_anLBSPThreshold_8bitLUT[nBGColor]);
-                    const size_t nDescDist = lv::hdist(nCurrInputDesc,*((ushort*)(m_voBGDescSamples[nModelIdx].data+nDescIter)));
+                    const size_t nDescDist = lv::hdist(nCurrInputDesc,*getBGDescSamplePtr(nModelIdx,nPxIter));
                     if(nDescDist>m_nDescDistThreshold)
                         goto failedcheck1ch;
                     nGoodSamplesCount++;
@@ -498,17 +498,16 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _oInputImg, cv::OutputArr
             else {
                 if((rand()%nLearningRate)==0) {
                     const size_t nSampleModelIdx = rand()%m_nBGSamples;
-                    ushort& nRandInputDesc = *((ushort*)(m_voBGDescSamples[nSampleModelIdx].data+nDescIter));
-                    nRandInputDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,m_anLBSPThreshold_8bitLUT[nCurrColor]);
-                    m_voBGColorSamples[nSampleModelIdx].data[nPxIter] = nCurrColor;
+                    *getBGDescSamplePtr(nSampleModelIdx,nPxIter) = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,m_anLBSPThreshold_8bitLUT[nCurrColor]);
+                    *getBGColorSamplePtr(nSampleModelIdx,nPxIter) = nCurrColor;
                 }
                 if((rand()%nLearningRate)==0) {
                     int nSampleImgCoord_Y, nSampleImgCoord_X;
                     lv::getNeighborPosition_3x3(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
                     const size_t nSampleModelIdx = rand()%m_nBGSamples;
-                    ushort& nRandInputDesc = m_voBGDescSamples[nSampleModelIdx].at<ushort>(nSampleImgCoord_Y,nSampleImgCoord_X);
-                    nRandInputDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,m_anLBSPThreshold_8bitLUT[nCurrColor]);
-                    m_voBGColorSamples[nSampleModelIdx].at<uchar>(nSampleImgCoord_Y,nSampleImgCoord_X) = nCurrColor;
+                    const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
+                    *getBGDescSamplePtr(nSampleModelIdx,nSamplePxIdx) = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,m_anLBSPThreshold_8bitLUT[nCurrColor]);
+                    *getBGColorSamplePtr(nSampleModelIdx,nSamplePxIdx) = nCurrColor;
                 }
             }
         }
@@ -518,21 +517,18 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _oInputImg, cv::OutputArr
         const size_t nCurrColorDistThreshold = m_nColorDistThreshold*3;
         const size_t nCurrSCDescDistThreshold = nCurrDescDistThreshold/2;
         const size_t nCurrSCColorDistThreshold = nCurrColorDistThreshold/2;
-        const size_t desc_row_step = m_voBGDescSamples[0].step.p[0];
-        const size_t img_row_step = m_voBGColorSamples[0].step.p[0];
         for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
             const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
             const int nCurrImgCoord_X = m_voPxInfoLUT[nPxIter].nImgCoord_X;
             const int nCurrImgCoord_Y = m_voPxInfoLUT[nPxIter].nImgCoord_Y;
             const size_t nPxIterRGB = nPxIter*3;
-            const size_t nDescIterRGB = nPxIterRGB*2;
             const uchar* const anCurrColor = oInputImg.data+nPxIterRGB;
             alignas(16) std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,3> aanLBSPLookupVals;
             LBSP::computeDescriptor_lookup(oInputImg,nCurrImgCoord_X,nCurrImgCoord_Y,aanLBSPLookupVals);
             size_t nGoodSamplesCount=0, nModelIdx=0;
             while(nGoodSamplesCount<m_nRequiredBGSamples && nModelIdx<m_nBGSamples) {
-                const ushort* const anBGDesc = (ushort*)(m_voBGDescSamples[nModelIdx].data+nDescIterRGB);
-                const uchar* const anBGColor = m_voBGColorSamples[nModelIdx].data+nPxIterRGB;
+                const ushort* const anBGDesc = getBGDescSamplePtr(nModelIdx,nPxIter);
+                const uchar* const anBGColor = getBGColorSamplePtr(nModelIdx,nPxIter);
                 size_t nTotColorDist = 0;
                 size_t nTotDescDist = 0;
                 for(size_t c=0;c<3; ++c) {
@@ -556,9 +552,10 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _oInputImg, cv::OutputArr
             else {
                 if((rand()%nLearningRate)==0) {
                     const size_t nSampleModelIdx = rand()%m_nBGSamples;
-                    ushort* anRandInputDesc = ((ushort*)(m_voBGDescSamples[nSampleModelIdx].data+nDescIterRGB));
+                    ushort* const anRandInputDesc = getBGDescSamplePtr(nSampleModelIdx,nPxIter);
+                    uchar* const anRandInputColor = getBGColorSamplePtr(nSampleModelIdx,nPxIter);
                     for(size_t c=0; c<3; ++c) {
-                        *(m_voBGColorSamples[nSampleModelIdx].data+nPxIterRGB+c) = anCurrColor[c];
+                        anRandInputColor[c] = anCurrColor[c];
                         anRandInputDesc[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anCurrColor[c],m_anLBSPThreshold_8bitLUT[anCurrColor[c]]);
                     }
                 }
@@ -566,9 +563,11 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _oInputImg, cv::OutputArr
                     int nSampleImgCoord_Y, nSampleImgCoord_X;
                     lv::getNeighborPosition_3x3(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
                     const size_t nSampleModelIdx = rand()%m_nBGSamples;
-                    ushort* anRandInputDesc = ((ushort*)(m_voBGDescSamples[nSampleModelIdx].data + desc_row_step*nSampleImgCoord_Y + 6*nSampleImgCoord_X));
+                    const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
+                    ushort* const anRandInputDesc = getBGDescSamplePtr(nSampleModelIdx,nSamplePxIdx);
+                    uchar* const anRandInputColor = getBGColorSamplePtr(nSampleModelIdx,nSamplePxIdx);
                     for(size_t c=0; c<3; ++c) {
-                        *(m_voBGColorSamples[nSampleModelIdx].data+img_row_step*nSampleImgCoord_Y+3*nSampleImgCoord_X+c) = anCurrColor[c];
+                        anRandInputColor[c] = anCurrColor[c];
                         anRandInputDesc[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anCurrColor[c],m_anLBSPThreshold_8bitLUT[anCurrColor[c]]);
                     }
                 }
@@ -584,16 +583,12 @@ void BackgroundSubtractorLOBSTER::getBackgroundImage(cv::OutputArray oBGImg) con
     lvDbgExceptionWatch;
     lvAssert_(m_bInitialized,"algo must be initialized first");
     cv::Mat oAvgBGImg = cv::Mat::zeros(m_oImgSize,CV_32FC((int)m_nImgChannels));
-    for(size_t s=0; s<m_nBGSamples; ++s) {
-        for(int y=0; y<m_oImgSize.height; ++y) {
-            for(int x=0; x<m_oImgSize.width; ++x) {
-                const size_t idx_nimg = m_voBGColorSamples[s].step.p[0]*y + m_voBGColorSamples[s].step.p[1]*x;
-                const size_t idx_flt32 = idx_nimg*4;
-                float* oAvgBgImgPtr = (float*)(oAvgBGImg.data+idx_flt32);
-                const uchar* const oBGImgPtr = m_voBGColorSamples[s].data+idx_nimg;
-                for(size_t c=0; c<m_nImgChannels; ++c)
-                    oAvgBgImgPtr[c] += ((float)oBGImgPtr[c])/m_nBGSamples;
-            }
+    for(size_t nPxIter=0; nPxIter<m_nTotPxCount; ++nPxIter) {
+        float* oAvgBgImgPtr = ((float*)oAvgBGImg.data)+nPxIter*m_nImgChannels;
+        for(size_t s=0; s<m_nBGSamples; ++s) {
+            const uchar* const oBGImgPtr = getBGColorSamplePtr(s,nPxIter);
+            for(size_t c=0; c<m_nImgChannels; ++c)
+                oAvgBgImgPtr[c] += ((float)oBGImgPtr[c])/m_nBGSamples;
         }
     }
     oAvgBGImg.convertTo(oBGImg,CV_8U);
@@ -604,16 +599,12 @@ void BackgroundSubtractorLOBSTER::getBackgroundDescriptorsImage(cv::OutputArray
     lvDbgExceptionWatch;
     lvAssert_(m_bInitialized,"algo must be initialized first");
     cv::Mat oAvgBGDesc = cv::Mat::zeros(m_oImgSize,CV_32FC((int)m_nImgChannels));
-    for(size_t n=0; n<m_voBGDescSamples.size(); ++n) {
-        for(int y=0; y<m_oImgSize.height; ++y) {
-            for(int x=0; x<m_oImgSize.width; ++x) {
-                const size_t idx_ndesc = m_voBGDescSamples[n].step.p[0]*y + m_voBGDescSamples[n].step.p[1]*x;
-                const size_t idx_flt32 = idx_ndesc*2;
-                float* oAvgBgDescPtr = (float*)(oAvgBGDesc.data+idx_flt32);
-                const ushort* const oBGDescPtr = (ushort*)(m_voBGDescSamples[n].data+idx_ndesc);
-                for(size_t c=0; c<m_nImgChannels; ++c)
-                    oAvgBgDescPtr[c] += ((float)oBGDescPtr[c])/m_voBGDescSamples.size();
-            }
+    for(size_t nPxIter=0; nPxIter<m_nTotPxCount; ++nPxIter) {
+        float* oAvgBgDescPtr = ((float*)oAvgBGDesc.data)+nPxIter*m_nImgChannels;
+        for(size_t s=0; s<m_nBGSamples; ++s) {
+            const ushort* const oBGDescPtr = getBGDescSamplePtr(s,nPxIter);
+            for(size_t c=0; c<m_nImgChannels; ++c)
+                oAvgBgDescPtr[c] += ((float)oBGDescPtr[c])/m_nBGSamples;
         }
     }
     oAvgBGDesc.convertTo(oBGDescImg,CV_16U);
@@ -0,0 +1,153 @@
+
+#include "litiv/video.hpp"
+#include "litiv/test.hpp"
+#if USING_OPENMP
+#include <omp.h>
+#endif //USING_OPENMP
+
+namespace {
+
+    std::vector<cv::Mat> genTestFrames(size_t nFrames, const cv::Size& oSize, int nChannels, uint64 nSeed=42) {
+        cv::RNG oRNG(nSeed);
+        cv::Mat oBGImg(oSize,CV_8UC(nChannels));
+        oRNG.fill(oBGImg,cv::RNG::UNIFORM,cv::Scalar::all(0),cv::Scalar::all(256));
+        cv::GaussianBlur(oBGImg,oBGImg,cv::Size(5,5),0);
+        std::vector<cv::Mat> voFrames(nFrames);
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx) {
+            cv::Mat oNoise(oSize,CV_8UC(nChannels));
+            oRNG.fill(oNoise,cv::RNG::UNIFORM,cv::Scalar::all(0),cv::Scalar::all(8));
+            cv::add(oBGImg,oNoise,voFrames[nFrameIdx]);
+            const int nOffset = int(nFrameIdx*4)%std::max(oSize.width-oSize.width/4,1);
+            cv::rectangle(voFrames[nFrameIdx],cv::Rect(nOffset,oSize.height/3,oSize.width/4,oSize.height/3),cv::Scalar::all(255),-1);
+        }
+        return voFrames;
+    }
+
+    template<typename TAlgo>
+    void runAlgo(TAlgo& oAlgo, const std::vector<cv::Mat>& voFrames, std::vector<cv::Mat>& voFGMasks, double dLearningRate) {
+        srand(0u);
+        oAlgo.initialize(voFrames[0],cv::Mat(voFrames[0].size(),CV_8UC1,cv::Scalar_<uchar>(255)));
+        voFGMasks.resize(voFrames.size());
+        for(size_t nFrameIdx=0; nFrameIdx<voFrames.size(); ++nFrameIdx)
+            oAlgo.apply(voFrames[nFrameIdx],voFGMasks[nFrameIdx],dLearningRate);
+    }
+
+    template<typename TAlgo>
+    void testInterleavedModelLayout(int nChannels, double dLearningRate) {
+        const std::vector<cv::Mat> voFrames = genTestFrames(20,cv::Size(80,60),nChannels);
+        TAlgo oAlgo_mat, oAlgo_interl;
+        oAlgo_interl.setInterleavedModelLayout(true);
+        ASSERT_FALSE(oAlgo_mat.isUsingInterleavedModelLayout());
+        ASSERT_TRUE(oAlgo_interl.isUsingInterleavedModelLayout());
+        std::vector<cv::Mat> voFGMasks_mat, voFGMasks_interl;
+        runAlgo(oAlgo_mat,voFrames,voFGMasks_mat,dLearningRate);
+        runAlgo(oAlgo_interl,voFrames,voFGMasks_interl,dLearningRate);
+        for(size_t nFrameIdx=0; nFrameIdx<voFrames.size(); ++nFrameIdx)
+            ASSERT_TRUE(lv::isEqual<uchar>(voFGMasks_mat[nFrameIdx],voFGMasks_interl[nFrameIdx])) << "nFrameIdx=" << nFrameIdx;
+        cv::Mat oBGImg_mat, oBGImg_interl, oBGDescImg_mat, oBGDescImg_interl;
+        oAlgo_mat.getBackgroundImage(oBGImg_mat);
+        oAlgo_interl.getBackgroundImage(oBGImg_interl);
+        ASSERT_TRUE(lv::isEqual<uchar>(oBGImg_mat,oBGImg_interl));
+        oAlgo_mat.getBackgroundDescriptorsImage(oBGDescImg_mat);
+        oAlgo_interl.getBackgroundDescriptorsImage(oBGDescImg_interl);
+        ASSERT_TRUE(lv::isEqual<ushort>(oBGDescImg_mat,oBGDescImg_interl));
+        ASSERT_THROW_LV_QUIET(oAlgo_interl.setInterleavedModelLayout(false));
+    }
+
+}
+
+TEST(BackgroundSubtractorLOBSTER,interleaved_model_regression) {
+    testInterleavedModelLayout<BackgroundSubtractorLOBSTER>(1,BGSLOBSTER_DEFAULT_LEARNING_RATE);
+    testInterleavedModelLayout<BackgroundSubtractorLOBSTER>(3,BGSLOBSTER_DEFAULT_LEARNING_RATE);
+}
+
+TEST(BackgroundSubtractorSuBSENSE,interleaved_model_regression) {
+    testInterleavedModelLayout<BackgroundSubtractorSuBSENSE>(1,0);
+    testInterleavedModelLayout<BackgroundSubtractorSuBSENSE>(3,0);
+}
+
+TEST(BackgroundSubtractorSuBSENSE,parallel_band_thread_invariance) {
+    for(int nChannels : {1,3}) {
+        const std::vector<cv::Mat> voFrames = genTestFrames(20,cv::Size(80,60),nChannels);
+        std::vector<cv::Mat> voFGMasks_1t, voFGMasks_nt;
+        cv::Mat oBGImg_1t, oBGImg_nt;
+    #if USING_OPENMP
+        const int nPrevThreads = omp_get_max_threads();
+        omp_set_num_threads(1);
+    #endif //USING_OPENMP
+        BackgroundSubtractorSuBSENSE oAlgo_1t;
+        oAlgo_1t.setParallelBandMode(true,1234u);
+        ASSERT_TRUE(oAlgo_1t.isUsingParallelBandMode());
+        runAlgo(oAlgo_1t,voFrames,voFGMasks_1t,0);
+        oAlgo_1t.getBackgroundImage(oBGImg_1t);
+    #if USING_OPENMP
+        omp_set_num_threads(std::max(nPrevThreads,4));
+    #endif //USING_OPENMP
+        BackgroundSubtractorSuBSENSE oAlgo_nt;
+        oAlgo_nt.setParallelBandMode(true,1234u);
+        runAlgo(oAlgo_nt,voFrames,voFGMasks_nt,0);
+        oAlgo_nt.getBackgroundImage(oBGImg_nt);
+    #if USING_OPENMP
+        omp_set_num_threads(nPrevThreads);
+    #endif //USING_OPENMP
+        for(size_t nFrameIdx=0; nFrameIdx<voFrames.size(); ++nFrameIdx)
+            ASSERT_TRUE(lv::isEqual<uchar>(voFGMasks_1t[nFrameIdx],voFGMasks_nt[nFrameIdx])) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        ASSERT_TRUE(lv::isEqual<uchar>(oBGImg_1t,oBGImg_nt)) << "nChannels=" << nChannels;
+    }
+}
+
+namespace {
+
+    template<typename TAlgo>
+    void bgs_model_perftest(benchmark::State& st, double dLearningRate) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        const std::vector<cv::Mat> voFrames = genTestFrames(10,oSize,int(st.range(1)));
+        TAlgo oAlgo;
+        oAlgo.setInterleavedModelLayout(st.range(2)!=0);
+        srand(0u);
+        oAlgo.initialize(voFrames[0],cv::Mat(oSize,CV_8UC1,cv::Scalar_<uchar>(255)));
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[(nFrameIdx++)%voFrames.size()],oFGMask,dLearningRate);
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+    }
+
+    void lobster_model_perftest(benchmark::State& st) {
+        bgs_model_perftest<BackgroundSubtractorLOBSTER>(st,BGSLOBSTER_DEFAULT_LEARNING_RATE);
+    }
+
+    void subsense_model_perftest(benchmark::State& st) {
+        bgs_model_perftest<BackgroundSubtractorSuBSENSE>(st,0);
+    }
+
+    void subsense_band_perftest(benchmark::State& st) {
+        const cv::Size oSize(int(st.range(0)),int(st.range(0))*3/4);
+        const std::vector<cv::Mat> voFrames = genTestFrames(10,oSize,int(st.range(1)));
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setParallelBandMode(st.range(2)>0);
+    #if USING_OPENMP
+        const int nPrevThreads = omp_get_max_threads();
+        omp_set_num_threads(std::max(int(st.range(2)),1));
+    #endif //USING_OPENMP
+        srand(0u);
+        oAlgo.initialize(voFrames[0],cv::Mat(oSize,CV_8UC1,cv::Scalar_<uchar>(255)));
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[(nFrameIdx++)%voFrames.size()],oFGMask,0);
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+    #if USING_OPENMP
+        omp_set_num_threads(nPrevThreads);
+    #endif //USING_OPENMP
+    }
+
+}
+
+// args = {frame width, channel count, use interleaved model}
+BENCHMARK(lobster_model_perftest)->Args({320,1,0})->Args({320,1,1})->Args({320,3,0})->Args({320,3,1})->Unit(benchmark::kMillisecond)->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_model_perftest)->Args({320,1,0})->Args({320,1,1})->Args({320,3,0})->Args({320,3,1})->Unit(benchmark::kMillisecond)->Repetitions(10)->ReportAggregatesOnly(true);
+// args = {frame width, channel count, band mode thread count (0 = serial rand()-based path)}
+BENCHMARK(subsense_band_perftest)->Args({640,3,0})->Args({640,3,1})->Args({640,3,2})->Args({640,3,4})->Args({640,3,8})->Unit(benchmark::kMillisecond)->Repetitions(10)->ReportAggregatesOnly(true);